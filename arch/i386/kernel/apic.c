@@ -26,6 +26,7 @@
 #include <linux/mc146818rtc.h>
 #include <linux/kernel_stat.h>
 #include <linux/sysdev.h>
+#include <linux/rcupdate.h>
 
 #include <asm/atomic.h>
 #include <asm/smp.h>
@@ -1103,6 +1104,147 @@ int setup_profiling_timer(unsigned int multiplier)
 	return 0;
 }
 
+#ifdef CONFIG_NO_IDLE_HZ
+/*
+ * Tickless idle.  IRQ0 keeps jiffies going, so an idle CPU can turn its
+ * local APIC timer from periodic into one-shot mode and sleep until the
+ * first timer on its own timer wheel expires.  Whatever interrupt wakes
+ * it first puts the periodic tick back and charges the ticks it slept
+ * through to the idle task.
+ *
+ * With CONFIG_NO_HZ_FULL a nohz_full CPU also stops the tick while its
+ * only task runs in user mode; those ticks are charged as user time.
+ */
+#define HZ_STOPPED_IDLE	1
+#define HZ_STOPPED_BUSY	2
+
+static DEFINE_PER_CPU(int, hz_timer_stopped);
+static DEFINE_PER_CPU(unsigned long, hz_timer_stopped_at);
+
+/*
+ * Switch the local APIC timer to a one-shot that fires when the next
+ * timer on this CPU's wheel is due.  Returns 0 if that is too close to
+ * bother.
+ */
+static int program_hz_oneshot(int cpu)
+{
+	unsigned long delta, max_delta;
+
+	delta = next_timer_interrupt() - jiffies;
+	if ((long)delta <= 1)
+		return 0;
+
+	/* The APIC current-count register is only 32 bits wide */
+	max_delta = 0xffffffffUL / (calibration_result / APIC_DIVISOR);
+	if (delta > max_delta)
+		delta = max_delta;
+
+	per_cpu(hz_timer_stopped_at, cpu) = jiffies;
+
+	apic_write_around(APIC_LVTT, apic_read(APIC_LVTT) &
+				~APIC_LVT_TIMER_PERIODIC);
+	apic_write_around(APIC_TMICT,
+			(calibration_result / APIC_DIVISOR) * delta);
+	return 1;
+}
+
+/*
+ * Must be called with interrupts disabled, right before the idle
+ * routine halts the CPU.
+ */
+void stop_hz_timer(void)
+{
+	int cpu = smp_processor_id();
+
+	if (sysctl_hz_timer || !using_apic_timer ||
+			per_cpu(prof_multiplier, cpu) != 1)
+		return;
+	if (per_cpu(hz_timer_stopped, cpu))
+		return;
+	if (local_softirq_pending() || rcu_needs_cpu(cpu))
+		return;
+
+	/*
+	 * Publish the CPU in nohz_cpu_mask before looking at RCU state: a
+	 * grace period that started without seeing the bit still waits
+	 * for us, and rcu_pending() tells us so.
+	 */
+	cpu_set(cpu, nohz_cpu_mask);
+	smp_mb();
+	if (rcu_pending(cpu) || !program_hz_oneshot(cpu)) {
+		cpu_clear(cpu, nohz_cpu_mask);
+		return;
+	}
+	per_cpu(hz_timer_stopped, cpu) = HZ_STOPPED_IDLE;
+}
+
+#ifdef CONFIG_NO_HZ_FULL
+/*
+ * Called at the end of a local tick that interrupted user mode.  The
+ * tick comes back on the next interrupt, when schedule() runs, when a
+ * second task is queued here (nohz_full_kick()) or when a new RCU grace
+ * period needs this CPU (rcu_start_batch()).
+ */
+static void stop_hz_timer_busy(struct pt_regs *regs, int cpu)
+{
+	if (sysctl_hz_timer || !user_mode(regs) ||
+			per_cpu(prof_multiplier, cpu) != 1)
+		return;
+	if (!sched_can_stop_tick())
+		return;
+	/* Expired timers still sit on the wheel, see program_hz_oneshot() */
+	if (local_softirq_pending() & ~(1 << TIMER_SOFTIRQ))
+		return;
+
+	if (rcu_needs_cpu(cpu))
+		rcu_offload_callbacks(cpu);
+
+	cpu_set(cpu, nohz_busy_cpu_mask);
+	smp_mb();
+	if (rcu_pending(cpu) || !program_hz_oneshot(cpu)) {
+		cpu_clear(cpu, nohz_busy_cpu_mask);
+		return;
+	}
+	per_cpu(hz_timer_stopped, cpu) = HZ_STOPPED_BUSY;
+}
+#endif
+
+/*
+ * Called on every interrupt entry and when the idle routine returns.
+ * Cheap when the tick is running.
+ */
+void start_hz_timer(void)
+{
+	int cpu, stopped;
+	unsigned long ticks, flags;
+
+	local_irq_save(flags);
+	cpu = smp_processor_id();
+	stopped = per_cpu(hz_timer_stopped, cpu);
+	if (likely(!stopped))
+		goto out;
+
+	__setup_APIC_LVTT(calibration_result);
+	per_cpu(hz_timer_stopped, cpu) = 0;
+	if (stopped == HZ_STOPPED_BUSY)
+		cpu_clear(cpu, nohz_busy_cpu_mask);
+	else
+		cpu_clear(cpu, nohz_cpu_mask);
+	smp_mb();
+
+	ticks = jiffies - per_cpu(hz_timer_stopped_at, cpu);
+	if (!ticks)
+		goto out;
+	if (stopped == HZ_STOPPED_BUSY)
+		account_user_time(current, jiffies_to_cputime(ticks));
+	else
+		account_system_time(current, hardirq_count(),
+					jiffies_to_cputime(ticks));
+out:
+	local_irq_restore(flags);
+}
+#endif /* CONFIG_NO_IDLE_HZ */
+
 #undef APIC_DIVISOR
 
 /*
@@ -1150,6 +1292,9 @@ inline void smp_local_timer_interrupt(struct pt_regs * regs)
 		 * 鵱ǰеʱ䲢һЩCPUͳƼ
 		 */
 		update_process_times(user_mode(regs));
+#endif
+#ifdef CONFIG_NO_HZ_FULL
+		stop_hz_timer_busy(regs, cpu);
 #endif
 	}
 
@@ -1208,6 +1353,7 @@ fastcall void smp_apic_timer_interrupt(struct pt_regs *regs)
 	 * interrupt lock, which is the WrongThing (tm) to do.
 	 */
 	irq_enter();
+	start_hz_timer();
 	/**
 	 * smp_local_timer_interruptִÿCPUļʱ
 	 * Ҫǵprofile_tickupdate_process_times
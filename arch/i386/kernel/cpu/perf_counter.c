@@ -0,0 +1,468 @@
+/*
+ * arch/i386/kernel/cpu/perf_counter.c
+ *
+ * Hardware performance counters on x86, see kernel/perf_counter.c.
+ * Also used by x86-64.
+ *
+ * Handles the Intel cpus with architectural performance monitoring and
+ * the P6 family before them, and AMD's K7 and later.  On others, the
+ * Pentium 4 included, only software counters are available.
+ *
+ * The PMU is shared with oprofile and the NMI watchdog.  While there
+ * are hardware counters, it is reserved with reserve_lapic_nmi(),
+ * which stops the watchdog and keeps oprofile out, as oprofile does.
+ *
+ * Counters overflow into an NMI through the local APIC's LVTPC.  The
+ * NMI handler only touches the counters in active_mask; the rest of
+ * the code takes a counter out of active_mask before it updates it,
+ * so the two never update one counter at the same time.  An overflow
+ * in that window, or just before a counter is disabled, still raises
+ * its NMI, which the handler must claim without a counter to show
+ * for it.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/init.h>
+#include <linux/smp.h>
+#include <linux/percpu.h>
+#include <linux/err.h>
+#include <linux/mutex.h>
+#include <linux/perf_counter.h>
+#include <asm/apic.h>
+#include <asm/nmi.h>
+#include <asm/msr.h>
+#include <asm/processor.h>
+#include <asm/local.h>
+
+#define X86_PMC_MAX		8
+
+#define EVENTSEL_USR		(1ULL << 16)
+#define EVENTSEL_OS		(1ULL << 17)
+#define EVENTSEL_INT		(1ULL << 20)
+#define EVENTSEL_ENABLE		(1ULL << 22)
+/* Event, unit mask, edge, invert and counter mask of raw events */
+#define EVENTSEL_RAW_MASK	0xff84ffffULL
+
+/* P6 counters take 32-bit writes, sign-extended */
+#define X86_MAX_PERIOD		((1ULL << 31) - 1)
+/* Shorter sample periods could keep a cpu in the NMI handler */
+#define X86_MIN_PERIOD		1000
+
+struct x86_pmu {
+	const char	*name;
+	int		version;	/* Of architectural perfmon, or 0 */
+	unsigned int	eventsel;	/* MSR of counter 0's event select */
+	unsigned int	perfctr;	/* MSR of counter 0 */
+	int		num_counters;
+	int		counter_bits;
+	const u64	*event_map;
+	int		enable_on_0;	/* Counter 0's enable bit is global */
+};
+
+static struct x86_pmu x86_pmu;
+
+struct cpu_hw_counters {
+	struct perf_counter	*counters[X86_PMC_MAX];
+	unsigned long		used_mask;
+	unsigned long		active_mask;	/* What the NMI handler sees */
+	local_t			stray_nmis;	/* Overflows found outside it */
+
+	/* What oprofile or the watchdog left, for when we are done */
+	u64			saved_eventsel[X86_PMC_MAX];
+	u64			saved_perfctr[X86_PMC_MAX];
+	unsigned long		saved_lvtpc;
+};
+
+static DEFINE_PER_CPU(struct cpu_hw_counters, cpu_hw_counters);
+
+static DEFINE_MUTEX(pmu_reserve_mutex);
+static int nr_hw_counters;
+
+static u64 intel_arch_event_map[PERF_HW_EVENTS_MAX];
+
+static const u64 intel_arch_events[PERF_HW_EVENTS_MAX] = {
+	[PERF_COUNT_CPU_CYCLES]			= 0x003c,
+	[PERF_COUNT_INSTRUCTIONS]		= 0x00c0,
+	[PERF_COUNT_CACHE_REFERENCES]		= 0x4f2e,
+	[PERF_COUNT_CACHE_MISSES]		= 0x412e,
+	[PERF_COUNT_BRANCH_INSTRUCTIONS]	= 0x00c4,
+	[PERF_COUNT_BRANCH_MISSES]		= 0x00c5,
+	[PERF_COUNT_BUS_CYCLES]			= 0x013c,
+};
+
+/* Bits of CPUID 0xa's EBX saying the events above are missing */
+static const int intel_arch_event_bits[PERF_HW_EVENTS_MAX] = {
+	[PERF_COUNT_CPU_CYCLES]			= 0,
+	[PERF_COUNT_INSTRUCTIONS]		= 1,
+	[PERF_COUNT_CACHE_REFERENCES]		= 3,
+	[PERF_COUNT_CACHE_MISSES]		= 4,
+	[PERF_COUNT_BRANCH_INSTRUCTIONS]	= 5,
+	[PERF_COUNT_BRANCH_MISSES]		= 6,
+	[PERF_COUNT_BUS_CYCLES]			= 2,
+};
+
+static const u64 p6_event_map[PERF_HW_EVENTS_MAX] = {
+	[PERF_COUNT_CPU_CYCLES]			= 0x0079,
+	[PERF_COUNT_INSTRUCTIONS]		= 0x00c0,
+	[PERF_COUNT_CACHE_REFERENCES]		= 0x0f2e,
+	[PERF_COUNT_CACHE_MISSES]		= 0x012e,
+	[PERF_COUNT_BRANCH_INSTRUCTIONS]	= 0x00c4,
+	[PERF_COUNT_BRANCH_MISSES]		= 0x00c5,
+	[PERF_COUNT_BUS_CYCLES]			= 0x0062,
+};
+
+static const u64 amd_event_map[PERF_HW_EVENTS_MAX] = {
+	[PERF_COUNT_CPU_CYCLES]			= 0x0076,
+	[PERF_COUNT_INSTRUCTIONS]		= 0x00c0,
+	[PERF_COUNT_CACHE_REFERENCES]		= 0x0080,
+	[PERF_COUNT_CACHE_MISSES]		= 0x0081,
+	[PERF_COUNT_BRANCH_INSTRUCTIONS]	= 0x00c2,
+	[PERF_COUNT_BRANCH_MISSES]		= 0x00c3,
+};
+
+/* What an unused counter's event select holds */
+static inline u64 x86_pmu_idle_config(int idx)
+{
+	return idx == 0 && x86_pmu.enable_on_0 ? EVENTSEL_ENABLE : 0;
+}
+
+/* Add what the counter counted since the last update; returns its value */
+static u64 x86_perf_counter_update(struct perf_counter *counter)
+{
+	struct hw_perf_counter *hwc = &counter->hw;
+	int shift = 64 - x86_pmu.counter_bits;
+	u64 prev = hwc->prev_count, new, delta;
+
+	rdmsrl(x86_pmu.perfctr + hwc->idx, new);
+	hwc->prev_count = new;
+
+	delta = ((new << shift) - (prev << shift)) >> shift;
+	counter->count += delta;
+	hwc->period_left -= delta;
+	return new;
+}
+
+/*
+ * Start the counter at -period_left, so that it overflows when the
+ * sample period is over.  Returns 1 if it was over already.  Counters
+ * without a period still overflow now and then, to be updated before
+ * they wrap.
+ */
+static int x86_perf_counter_set_period(struct perf_counter *counter)
+{
+	struct hw_perf_counter *hwc = &counter->hw;
+	s64 period = counter->hw_event.irq_period;
+	s64 left = hwc->period_left;
+	int ret = 0;
+
+	if (!period)
+		period = X86_MAX_PERIOD;
+	if (unlikely(left <= 0)) {
+		left += period;
+		if (left <= 0)
+			left = period;
+		hwc->period_left = left;
+		ret = 1;
+	}
+	if (left > X86_MAX_PERIOD)
+		left = X86_MAX_PERIOD;
+
+	hwc->prev_count = (u64)-left;
+	wrmsrl(x86_pmu.perfctr + hwc->idx,
+	       (u64)-left & ((1ULL << x86_pmu.counter_bits) - 1));
+	return ret;
+}
+
+static int x86_pmu_enable(struct perf_counter *counter)
+{
+	struct cpu_hw_counters *cpuc = &__get_cpu_var(cpu_hw_counters);
+	struct hw_perf_counter *hwc = &counter->hw;
+	int idx;
+
+	idx = ffz(cpuc->used_mask);
+	if (idx >= x86_pmu.num_counters)
+		return -EAGAIN;
+
+	__set_bit(idx, &cpuc->used_mask);
+	cpuc->counters[idx] = counter;
+	hwc->idx = idx;
+
+	x86_perf_counter_set_period(counter);
+	wrmsrl(x86_pmu.eventsel + idx, hwc->config | EVENTSEL_ENABLE);
+	barrier();
+	__set_bit(idx, &cpuc->active_mask);
+	return 0;
+}
+
+static void x86_pmu_disable(struct perf_counter *counter)
+{
+	struct cpu_hw_counters *cpuc = &__get_cpu_var(cpu_hw_counters);
+	struct hw_perf_counter *hwc = &counter->hw;
+	int idx = hwc->idx;
+
+	__clear_bit(idx, &cpuc->active_mask);
+	barrier();
+	wrmsrl(x86_pmu.eventsel + idx, x86_pmu_idle_config(idx));
+	/* Its NMI may still be on the way, with nobody left to claim it */
+	if (!(x86_perf_counter_update(counter) &
+	      (1ULL << (x86_pmu.counter_bits - 1))))
+		local_inc(&cpuc->stray_nmis);
+
+	cpuc->counters[idx] = NULL;
+	__clear_bit(idx, &cpuc->used_mask);
+	hwc->idx = -1;
+}
+
+/*
+ * An overflow while the counter is out of active_mask goes unnoticed
+ * by the NMI handler, so restart the period here if it is over; that
+ * sample is lost.
+ */
+static void x86_pmu_read(struct perf_counter *counter)
+{
+	struct cpu_hw_counters *cpuc = &__get_cpu_var(cpu_hw_counters);
+	int idx = counter->hw.idx;
+
+	__clear_bit(idx, &cpuc->active_mask);
+	barrier();
+	if (!(x86_perf_counter_update(counter) &
+	      (1ULL << (x86_pmu.counter_bits - 1)))) {
+		local_inc(&cpuc->stray_nmis);
+		x86_perf_counter_set_period(counter);
+	}
+	barrier();
+	__set_bit(idx, &cpuc->active_mask);
+}
+
+static const struct perf_counter_ops x86_perf_counter_ops = {
+	.enable		= x86_pmu_enable,
+	.disable	= x86_pmu_disable,
+	.read		= x86_pmu_read,
+};
+
+/*
+ * A counter has overflowed when its top bit is clear again: they all
+ * start out negative.  Installed only while the PMU is reserved.
+ */
+static int x86_pmu_nmi(struct pt_regs *regs, int cpu)
+{
+	struct cpu_hw_counters *cpuc = &per_cpu(cpu_hw_counters, cpu);
+	u64 sign = 1ULL << (x86_pmu.counter_bits - 1);
+	struct perf_counter *counter;
+	int idx, handled = 0;
+	u64 val;
+
+	for (idx = 0; idx < x86_pmu.num_counters; idx++) {
+		if (!test_bit(idx, &cpuc->used_mask))
+			continue;
+		if (!test_bit(idx, &cpuc->active_mask)) {
+			/* Being read or disabled: that code updates it */
+			rdmsrl(x86_pmu.perfctr + idx, val);
+			if (!(val & sign))
+				handled = 1;
+			continue;
+		}
+		counter = cpuc->counters[idx];
+		if (x86_perf_counter_update(counter) & sign)
+			continue;
+		handled = 1;
+		if (x86_perf_counter_set_period(counter) &&
+		    counter->hw_event.irq_period)
+			perf_counter_output(counter, regs);
+	}
+
+	/* Late NMI of an overflow that x86_pmu_read/disable() found */
+	if (!handled && local_read(&cpuc->stray_nmis)) {
+		local_dec(&cpuc->stray_nmis);
+		handled = 1;
+	}
+
+	/*
+	 * The LVTPC masks itself when it delivers, on P6 and later.
+	 * Unmask it whether or not this NMI was ours, or no sample would
+	 * be taken on this cpu again.
+	 */
+	apic_write(APIC_LVTPC, APIC_DM_NMI);
+	return handled;
+}
+
+static void x86_pmu_setup_cpu(void *info)
+{
+	struct cpu_hw_counters *cpuc = &__get_cpu_var(cpu_hw_counters);
+	int idx;
+
+	for (idx = 0; idx < x86_pmu.num_counters; idx++) {
+		rdmsrl(x86_pmu.eventsel + idx, cpuc->saved_eventsel[idx]);
+		rdmsrl(x86_pmu.perfctr + idx, cpuc->saved_perfctr[idx]);
+		wrmsrl(x86_pmu.eventsel + idx, x86_pmu_idle_config(idx));
+	}
+	if (x86_pmu.version >= 2)
+		wrmsrl(MSR_CORE_PERF_GLOBAL_CTRL,
+		       (1ULL << x86_pmu.num_counters) - 1);
+
+	cpuc->saved_lvtpc = apic_read(APIC_LVTPC);
+	apic_write(APIC_LVTPC, APIC_DM_NMI);
+}
+
+static void x86_pmu_shutdown_cpu(void *info)
+{
+	struct cpu_hw_counters *cpuc = &__get_cpu_var(cpu_hw_counters);
+	unsigned long v;
+	int idx;
+
+	/* See nmi_cpu_shutdown() in oprofile */
+	v = apic_read(APIC_LVTERR);
+	apic_write(APIC_LVTERR, v | APIC_LVT_MASKED);
+	apic_write(APIC_LVTPC, cpuc->saved_lvtpc);
+	apic_write(APIC_LVTERR, v);
+
+	for (idx = 0; idx < x86_pmu.num_counters; idx++) {
+		wrmsrl(x86_pmu.eventsel + idx, cpuc->saved_eventsel[idx]);
+		wrmsrl(x86_pmu.perfctr + idx, cpuc->saved_perfctr[idx]);
+	}
+}
+
+static int x86_pmu_reserve(void)
+{
+	int err = 0;
+
+	mutex_lock(&pmu_reserve_mutex);
+	if (!nr_hw_counters) {
+		err = reserve_lapic_nmi();
+		if (!err) {
+			on_each_cpu(x86_pmu_setup_cpu, NULL, 0, 1);
+			set_nmi_callback(x86_pmu_nmi);
+		}
+	}
+	if (!err)
+		nr_hw_counters++;
+	mutex_unlock(&pmu_reserve_mutex);
+	return err;
+}
+
+static void x86_pmu_release(struct perf_counter *counter)
+{
+	mutex_lock(&pmu_reserve_mutex);
+	if (!--nr_hw_counters) {
+		on_each_cpu(x86_pmu_shutdown_cpu, NULL, 0, 1);
+		unset_nmi_callback();
+		release_lapic_nmi();
+	}
+	mutex_unlock(&pmu_reserve_mutex);
+}
+
+const struct perf_counter_ops *hw_perf_counter_init(struct perf_counter *counter)
+{
+	struct perf_counter_hw_event *hw_event = &counter->hw_event;
+	u64 config;
+	int err;
+
+	if (!x86_pmu.num_counters)
+		return ERR_PTR(-ENODEV);
+	if (hw_event->irq_period && hw_event->irq_period < X86_MIN_PERIOD)
+		return ERR_PTR(-EINVAL);
+
+	if (hw_event->type == PERF_TYPE_RAW) {
+		config = hw_event->config & EVENTSEL_RAW_MASK;
+	} else {
+		if (hw_event->config >= PERF_HW_EVENTS_MAX)
+			return ERR_PTR(-EINVAL);
+		config = x86_pmu.event_map[hw_event->config];
+		if (!config)
+			return ERR_PTR(-EOPNOTSUPP);
+	}
+	config |= EVENTSEL_INT;
+	if (!(hw_event->flags & PERF_FLAG_EXCLUDE_USER))
+		config |= EVENTSEL_USR;
+	if (!(hw_event->flags & PERF_FLAG_EXCLUDE_KERNEL))
+		config |= EVENTSEL_OS;
+
+	err = x86_pmu_reserve();
+	if (err)
+		return ERR_PTR(err);
+	counter->hw.config = config;
+	counter->destroy = x86_pmu_release;
+	return &x86_perf_counter_ops;
+}
+
+static int __init intel_pmu_init(void)
+{
+	unsigned int eax = 0, ebx = 0, ecx, edx;
+	int i, bits;
+
+	if (boot_cpu_data.cpuid_level >= 0xa) {
+		cpuid(0xa, &eax, &ebx, &ecx, &edx);
+		x86_pmu.version = eax & 0xff;
+	}
+
+	if (x86_pmu.version >= 1 && ((eax >> 8) & 0xff) >= 2) {
+		x86_pmu.name = "Intel architectural";
+		x86_pmu.num_counters = min_t(int, (eax >> 8) & 0xff,
+					     X86_PMC_MAX);
+		x86_pmu.counter_bits = (eax >> 16) & 0xff;
+		bits = (eax >> 24) & 0xff;
+		for (i = 0; i < PERF_HW_EVENTS_MAX; i++)
+			if (intel_arch_event_bits[i] < bits &&
+			    !(ebx & (1 << intel_arch_event_bits[i])))
+				intel_arch_event_map[i] = intel_arch_events[i];
+		x86_pmu.event_map = intel_arch_event_map;
+	} else if (boot_cpu_data.x86 == 6) {
+		x86_pmu.version = 0;
+		x86_pmu.name = "P6";
+		x86_pmu.num_counters = 2;
+		x86_pmu.counter_bits = 40;
+		x86_pmu.event_map = p6_event_map;
+		x86_pmu.enable_on_0 = 1;
+	} else
+		return -ENODEV;
+
+	x86_pmu.eventsel = MSR_P6_EVNTSEL0;
+	x86_pmu.perfctr = MSR_P6_PERFCTR0;
+	return 0;
+}
+
+static int __init amd_pmu_init(void)
+{
+	if (boot_cpu_data.x86 < 6)
+		return -ENODEV;
+
+	x86_pmu.name = "AMD";
+	x86_pmu.eventsel = MSR_K7_EVNTSEL0;
+	x86_pmu.perfctr = MSR_K7_PERFCTR0;
+	x86_pmu.num_counters = 4;
+	x86_pmu.counter_bits = 48;
+	x86_pmu.event_map = amd_event_map;
+	return 0;
+}
+
+static int __init x86_pmu_init(void)
+{
+	int err;
+
+	if (!cpu_has_apic)
+		return 0;
+
+	switch (boot_cpu_data.x86_vendor) {
+	case X86_VENDOR_INTEL:
+		err = intel_pmu_init();
+		break;
+	case X86_VENDOR_AMD:
+		err = amd_pmu_init();
+		break;
+	default:
+		err = -ENODEV;
+		break;
+	}
+	if (err) {
+		memset(&x86_pmu, 0, sizeof(x86_pmu));
+		return 0;
+	}
+
+	printk(KERN_INFO "Performance counters: %s PMU, %d counters of %d bits\n",
+	       x86_pmu.name, x86_pmu.num_counters, x86_pmu.counter_bits);
+	return 0;
+}
+
+__initcall(x86_pmu_init);
@@ -0,0 +1,56 @@
+/*
+ * arch/i386/kernel/ftrace.c
+ *
+ * Rewriting of mcount call sites for the function tracer, also used
+ * by x86-64.  The callers make sure that no other cpu runs the code
+ * being rewritten.
+ */
+
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <linux/errno.h>
+#include <linux/ftrace.h>
+
+static unsigned char ftrace_nop[MCOUNT_INSN_SIZE] = FTRACE_NOP5;
+
+static void ftrace_call_insn(unsigned char *insn, unsigned long ip,
+			     unsigned long addr)
+{
+	insn[0] = 0xe8;
+	*(s32 *)(insn + 1) = (s32)(addr - (ip + MCOUNT_INSN_SIZE));
+}
+
+static int ftrace_modify_code(unsigned long ip, unsigned char *old_code,
+			      unsigned char *new_code)
+{
+	if (memcmp((void *)ip, old_code, MCOUNT_INSN_SIZE))
+		return -EINVAL;
+	memcpy((void *)ip, new_code, MCOUNT_INSN_SIZE);
+	return 0;
+}
+
+int ftrace_is_call(unsigned long ip, unsigned long addr)
+{
+	unsigned char call[MCOUNT_INSN_SIZE];
+
+	if (*(unsigned char *)ip != 0xe8)
+		return 0;
+	ftrace_call_insn(call, ip, addr);
+	return !memcmp((void *)ip, call, MCOUNT_INSN_SIZE);
+}
+
+int ftrace_make_nop(unsigned long ip, unsigned long addr)
+{
+	unsigned char call[MCOUNT_INSN_SIZE];
+
+	ftrace_call_insn(call, ip, addr);
+	return ftrace_modify_code(ip, call, ftrace_nop);
+}
+
+int ftrace_make_call(unsigned long ip, unsigned long addr)
+{
+	unsigned char call[MCOUNT_INSN_SIZE];
+
+	ftrace_call_insn(call, ip, addr);
+	return ftrace_modify_code(ip, ftrace_nop, call);
+}
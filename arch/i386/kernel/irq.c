@@ -57,10 +57,14 @@ fastcall unsigned int do_IRQ(struct pt_regs *regs)
 	u32 *isp;
 #endif
 
+	/* Interrupts went off on entry, and go back on with the iret */
+	trace_hardirqs_off();
+
 	/**
 	 * irq_enterжǶ׼
 	 */
 	irq_enter();
+	start_hz_timer();
 #ifdef CONFIG_DEBUG_STACKOVERFLOW
 	/* Debugging check for stack overflow: is there less than 1KB free? */
 	{
@@ -127,6 +131,7 @@ fastcall unsigned int do_IRQ(struct pt_regs *regs)
 	 * ݼжϼǷпӳٺ
 	 */
 	irq_exit();
+	trace_hardirqs_on();
 
 	/**
 	 * ,᷵ret_from_intr. 
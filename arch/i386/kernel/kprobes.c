@@ -30,21 +30,32 @@
 #include <linux/ptrace.h>
 #include <linux/spinlock.h>
 #include <linux/preempt.h>
+#include <linux/percpu.h>
+#include <linux/kallsyms.h>
+#include <linux/module.h>
+#include <linux/stop_machine.h>
+#include <linux/stringify.h>
 #include <asm/kdebug.h>
 #include <asm/desc.h>
+#include <asm/segment.h>
 
 /* kprobe_status settings */
 #define KPROBE_HIT_ACTIVE	0x00000001
 #define KPROBE_HIT_SS		0x00000002
 
-static struct kprobe *current_kprobe;
-static unsigned long kprobe_status, kprobe_old_eflags, kprobe_saved_eflags;
-static struct pt_regs jprobe_saved_regs;
-static long *jprobe_saved_esp;
-/* copy of the kernel stack at the probe fire time */
-static kprobe_opcode_t jprobes_stack[MAX_STACK_SIZE];
+static DEFINE_PER_CPU(struct kprobe_ctlblk, kprobe_ctlblk);
 void jprobe_return_end(void);
 
+#ifdef CONFIG_OPTPROBES
+/* The start of every detour buffer, see below */
+extern kprobe_opcode_t optprobe_template_entry[], optprobe_template_val[],
+		       optprobe_template_call[], optprobe_template_end[];
+
+#define TMPL_VAL_IDX	(optprobe_template_val - optprobe_template_entry)
+#define TMPL_CALL_IDX	(optprobe_template_call - optprobe_template_entry)
+#define TMPL_END_IDX	(optprobe_template_end - optprobe_template_entry)
+#endif
+
 /*
  * returns non-zero if opcode modifies the interrupt flag.
  */
@@ -97,9 +108,11 @@ static int kprobe_handler(struct pt_regs *regs)
 	int ret = 0;
 	kprobe_opcode_t *addr = NULL;
 	unsigned long *lp;
+	struct kprobe_ctlblk *kcb;
 
 	/* We're in an interrupt, but this is clear and BUG()-safe. */
 	preempt_disable();
+	kcb = &__get_cpu_var(kprobe_ctlblk);
 	/* Check if the application is using LDT entry for its code segment and
 	 * calculate the address by reading the base address from the LDT entry.
 	 */
@@ -113,26 +126,23 @@ static int kprobe_handler(struct pt_regs *regs)
 	}
 	/* Check we're not actually recursing */
 	if (kprobe_running()) {
-		/* We *are* holding lock here, so this is safe.
-		   Disarm the probe we just hit, and ignore it. */
+		/* Disarm the probe we just hit, and ignore it. */
 		p = get_kprobe(addr);
 		if (p) {
 			disarm_kprobe(p, regs);
 			ret = 1;
 		} else {
-			p = current_kprobe;
+			p = __get_cpu_var(current_kprobe);
 			if (p->break_handler && p->break_handler(p, regs)) {
 				goto ss_probe;
 			}
 		}
-		/* If it's not ours, can't be delete race, (we hold lock). */
+		/* It's not ours, and unregistering waits for us. */
 		goto no_kprobe;
 	}
 
-	lock_kprobes();
 	p = get_kprobe(addr);
 	if (!p) {
-		unlock_kprobes();
 		if (regs->eflags & VM_MASK) {
 			/* We are in virtual-8086 mode. Return 0 */
 			goto no_kprobe;
@@ -152,21 +162,32 @@ static int kprobe_handler(struct pt_regs *regs)
 		goto no_kprobe;
 	}
 
-	kprobe_status = KPROBE_HIT_ACTIVE;
-	current_kprobe = p;
-	kprobe_saved_eflags = kprobe_old_eflags
+	kcb->kprobe_status = KPROBE_HIT_ACTIVE;
+	__get_cpu_var(current_kprobe) = p;
+	kprobe_count_hit(p);
+	kcb->kprobe_saved_eflags = kcb->kprobe_old_eflags
 	    = (regs->eflags & (TF_MASK | IF_MASK));
 	if (is_IF_modifier(p->opcode))
-		kprobe_saved_eflags &= ~IF_MASK;
+		kcb->kprobe_saved_eflags &= ~IF_MASK;
 
 	if (p->pre_handler(p, regs)) {
 		/* handler has already set things up, so skip ss setup */
 		return 1;
 	}
 
+#ifdef CONFIG_OPTPROBES
+	if (p->ainsn.optsize) {
+		/* Run the instructions from the detour buffer instead */
+		regs->eip = (unsigned long)p->ainsn.optinsn + TMPL_END_IDX;
+		reset_current_kprobe();
+		preempt_enable_no_resched();
+		return 1;
+	}
+#endif
+
       ss_probe:
 	prepare_singlestep(p, regs);
-	kprobe_status = KPROBE_HIT_SS;
+	kcb->kprobe_status = KPROBE_HIT_SS;
 	return 1;
 
       no_kprobe:
@@ -196,7 +217,8 @@ static int kprobe_handler(struct pt_regs *regs)
  * that is atop the stack is the address following the copied instruction.
  * We need to make it the address following the original instruction.
  */
-static void resume_execution(struct kprobe *p, struct pt_regs *regs)
+static void resume_execution(struct kprobe *p, struct pt_regs *regs,
+			     struct kprobe_ctlblk *kcb)
 {
 	unsigned long *tos = (unsigned long *)&regs->esp;
 	unsigned long next_eip = 0;
@@ -206,7 +228,7 @@ static void resume_execution(struct kprobe *p, struct pt_regs *regs)
 	switch (p->ainsn.insn[0]) {
 	case 0x9c:		/* pushfl */
 		*tos &= ~(TF_MASK | IF_MASK);
-		*tos |= kprobe_old_eflags;
+		*tos |= kcb->kprobe_old_eflags;
 		break;
 	case 0xe8:		/* call relative - Fix return addr */
 		*tos = orig_eip + (*tos - copy_eip);
@@ -240,20 +262,23 @@ static void resume_execution(struct kprobe *p, struct pt_regs *regs)
 
 /*
  * Interrupts are disabled on entry as trap1 is an interrupt gate and they
- * remain disabled thoroughout this function.  And we hold kprobe lock.
+ * remain disabled thoroughout this function.
  */
 static inline int post_kprobe_handler(struct pt_regs *regs)
 {
-	if (!kprobe_running())
+	struct kprobe *cur = __get_cpu_var(current_kprobe);
+	struct kprobe_ctlblk *kcb = &__get_cpu_var(kprobe_ctlblk);
+
+	if (!cur)
 		return 0;
 
-	if (current_kprobe->post_handler)
-		current_kprobe->post_handler(current_kprobe, regs, 0);
+	if (cur->post_handler)
+		cur->post_handler(cur, regs, 0);
 
-	resume_execution(current_kprobe, regs);
-	regs->eflags |= kprobe_saved_eflags;
+	resume_execution(cur, regs, kcb);
+	regs->eflags |= kcb->kprobe_saved_eflags;
 
-	unlock_kprobes();
+	reset_current_kprobe();
 	preempt_enable_no_resched();
 
 	/*
@@ -267,18 +292,20 @@ static inline int post_kprobe_handler(struct pt_regs *regs)
 	return 1;
 }
 
-/* Interrupts disabled, kprobe_lock held. */
+/* Interrupts disabled, a probe is being handled on this cpu. */
 static inline int kprobe_fault_handler(struct pt_regs *regs, int trapnr)
 {
-	if (current_kprobe->fault_handler
-	    && current_kprobe->fault_handler(current_kprobe, regs, trapnr))
+	struct kprobe *cur = __get_cpu_var(current_kprobe);
+	struct kprobe_ctlblk *kcb = &__get_cpu_var(kprobe_ctlblk);
+
+	if (cur->fault_handler && cur->fault_handler(cur, regs, trapnr))
 		return 1;
 
-	if (kprobe_status & KPROBE_HIT_SS) {
-		resume_execution(current_kprobe, regs);
-		regs->eflags |= kprobe_old_eflags;
+	if (kcb->kprobe_status & KPROBE_HIT_SS) {
+		resume_execution(cur, regs, kcb);
+		regs->eflags |= kcb->kprobe_old_eflags;
 
-		unlock_kprobes();
+		reset_current_kprobe();
 		preempt_enable_no_resched();
 	}
 	return 0;
@@ -319,11 +346,12 @@ int kprobe_exceptions_notify(struct notifier_block *self, unsigned long val,
 int setjmp_pre_handler(struct kprobe *p, struct pt_regs *regs)
 {
 	struct jprobe *jp = container_of(p, struct jprobe, kp);
+	struct kprobe_ctlblk *kcb = &__get_cpu_var(kprobe_ctlblk);
 	unsigned long addr;
 
-	jprobe_saved_regs = *regs;
-	jprobe_saved_esp = &regs->esp;
-	addr = (unsigned long)jprobe_saved_esp;
+	kcb->jprobe_saved_regs = *regs;
+	kcb->jprobe_saved_esp = &regs->esp;
+	addr = (unsigned long)kcb->jprobe_saved_esp;
 
 	/*
 	 * TBD: As Linus pointed out, gcc assumes that the callee
@@ -332,7 +360,8 @@ int setjmp_pre_handler(struct kprobe *p, struct pt_regs *regs)
 	 * we also save and restore enough stack bytes to cover
 	 * the argument area.
 	 */
-	memcpy(jprobes_stack, (kprobe_opcode_t *) addr, MIN_STACK_SIZE(addr));
+	memcpy(kcb->jprobes_stack, (kprobe_opcode_t *)addr,
+	       MIN_STACK_SIZE(addr));
 	regs->eflags &= ~IF_MASK;
 	regs->eip = (unsigned long)(jp->entry);
 	return 1;
@@ -340,37 +369,475 @@ int setjmp_pre_handler(struct kprobe *p, struct pt_regs *regs)
 
 void jprobe_return(void)
 {
+	struct kprobe_ctlblk *kcb = &__get_cpu_var(kprobe_ctlblk);
+
 	preempt_enable_no_resched();
 	asm volatile ("       xchgl   %%ebx,%%esp     \n"
 		      "       int3			\n"
 		      "       .globl jprobe_return_end	\n"
 		      "       jprobe_return_end:	\n"
 		      "       nop			\n"::"b"
-		      (jprobe_saved_esp):"memory");
+		      (kcb->jprobe_saved_esp):"memory");
 }
 
 int longjmp_break_handler(struct kprobe *p, struct pt_regs *regs)
 {
+	struct kprobe_ctlblk *kcb = &__get_cpu_var(kprobe_ctlblk);
 	u8 *addr = (u8 *) (regs->eip - 1);
-	unsigned long stack_addr = (unsigned long)jprobe_saved_esp;
+	unsigned long stack_addr = (unsigned long)kcb->jprobe_saved_esp;
 	struct jprobe *jp = container_of(p, struct jprobe, kp);
 
 	if ((addr > (u8 *) jprobe_return) && (addr < (u8 *) jprobe_return_end)) {
-		if (&regs->esp != jprobe_saved_esp) {
+		if (&regs->esp != kcb->jprobe_saved_esp) {
 			struct pt_regs *saved_regs =
-			    container_of(jprobe_saved_esp, struct pt_regs, esp);
+			    container_of(kcb->jprobe_saved_esp, struct pt_regs,
+					 esp);
 			printk("current esp %p does not match saved esp %p\n",
-			       &regs->esp, jprobe_saved_esp);
+			       &regs->esp, kcb->jprobe_saved_esp);
 			printk("Saved registers for jprobe %p\n", jp);
 			show_registers(saved_regs);
 			printk("Current registers\n");
 			show_registers(regs);
 			BUG();
 		}
-		*regs = jprobe_saved_regs;
-		memcpy((kprobe_opcode_t *) stack_addr, jprobes_stack,
+		*regs = kcb->jprobe_saved_regs;
+		memcpy((kprobe_opcode_t *) stack_addr, kcb->jprobes_stack,
 		       MIN_STACK_SIZE(stack_addr));
 		return 1;
 	}
 	return 0;
 }
+
+#ifdef CONFIG_OPTPROBES
+/*
+ * Jump optimization.  The breakpoint and the instructions after it are
+ * replaced with a jump to a detour buffer, which calls the pre_handler
+ * and then runs copies of the instructions that the jump covers.  This
+ * is only done when those instructions can run from anywhere, and when
+ * nothing in the function jumps into the middle of the jump.  Finding
+ * that out takes decoding the whole function; instructions that we do
+ * not know about, and indirect jumps, which might go anywhere, make us
+ * give up.
+ */
+
+#define INSN_BRANCH	1	/* Relative jump or call */
+#define INSN_CALL	2
+#define INSN_INDIRECT	4	/* Indirect jump */
+#define INSN_STOP	8	/* Does not fall through */
+
+/* Length of a ModRM byte and what follows it, in 32-bit addressing */
+static int modrm_length(kprobe_opcode_t *insn)
+{
+	int mod = *insn >> 6, rm = *insn & 7, len = 1;
+
+	if (mod == 3)
+		return len;
+	if (rm == 4) {
+		/* SIB byte, and maybe a disp32 instead of a base */
+		len++;
+		if (mod == 0 && (insn[1] & 7) == 5)
+			return len + 4;
+	} else if (mod == 0 && rm == 5)
+		return len + 4;
+	if (mod == 1)
+		return len + 1;
+	if (mod == 2)
+		return len + 4;
+	return len;
+}
+
+/*
+ * Returns the length of the instruction at @insn, which is a copy of the
+ * one at @addr, or 0 if we do not know it.  *flags tells what kind of
+ * instruction it is, and *target where a relative branch goes.
+ */
+static int insn_decode(kprobe_opcode_t *insn, unsigned long addr,
+		       unsigned long *target, int *flags)
+{
+	kprobe_opcode_t *p = insn, op;
+	int opsize = 4, modrm = 0, imm = 0, rel = 0, len;
+
+	*flags = 0;
+	for (;; p++) {
+		switch (*p) {
+		case 0x26: case 0x2e: case 0x36: case 0x3e:	/* segment */
+		case 0x64: case 0x65:
+		case 0xf0: case 0xf2: case 0xf3:		/* lock, rep */
+			continue;
+		case 0x66:					/* operand size */
+			opsize = 2;
+			continue;
+		}
+		break;
+	}
+	if (p - insn > 4)
+		return 0;
+
+	op = *p++;
+	if (op == 0x0f) {
+		op = *p++;
+		switch (op) {
+		case 0x0b:			/* ud2, as in BUG() */
+			*flags = INSN_STOP;
+#ifdef CONFIG_DEBUG_BUGVERBOSE
+			imm = 6;		/* line and file follow */
+#endif
+			break;
+		case 0x06: case 0x08: case 0x09: case 0x30: case 0x31:
+		case 0x32: case 0xa0: case 0xa1: case 0xa2: case 0xa8:
+		case 0xa9: case 0xc8 ... 0xcf:
+			break;
+		case 0x00: case 0x01: case 0x0d: case 0x18: case 0x1f:
+		case 0x20 ... 0x23: case 0x40 ... 0x4f: case 0x90 ... 0x9f:
+		case 0xa3: case 0xa5: case 0xab: case 0xad: case 0xae:
+		case 0xaf: case 0xb0: case 0xb1: case 0xb3: case 0xb6:
+		case 0xb7: case 0xbb ... 0xbf: case 0xc0: case 0xc1:
+		case 0xc7:
+			modrm = 1;
+			break;
+		case 0xa4: case 0xac: case 0xba:
+			modrm = 1;
+			imm = 1;
+			break;
+		case 0x80 ... 0x8f:		/* jcc rel32 */
+			rel = 4;
+			*flags = INSN_BRANCH;
+			break;
+		default:
+			return 0;
+		}
+	} else if (op < 0x40) {
+		switch (op & 7) {
+		case 0: case 1: case 2: case 3:
+			modrm = 1;
+			break;
+		case 4:
+			imm = 1;
+			break;
+		case 5:
+			imm = opsize;
+			break;
+		}
+	} else if (op >= 0x60) {
+		switch (op) {
+		case 0x60: case 0x61: case 0x6c ... 0x6f: case 0x90 ... 0x99:
+		case 0x9b ... 0x9f: case 0xa4 ... 0xa7: case 0xaa ... 0xaf:
+		case 0xc9: case 0xd7: case 0xec ... 0xef: case 0xf4:
+		case 0xf5: case 0xf8 ... 0xfd:
+			break;
+		case 0x68: case 0xa9: case 0xb8 ... 0xbf:
+			imm = opsize;
+			break;
+		case 0x6a: case 0xa8: case 0xb0 ... 0xb7: case 0xd4:
+		case 0xd5: case 0xe4 ... 0xe7:
+			imm = 1;
+			break;
+		case 0x69: case 0x81: case 0xc7:
+			modrm = 1;
+			imm = opsize;
+			break;
+		case 0x6b: case 0x80: case 0x83: case 0xc0: case 0xc1:
+		case 0xc6:
+			modrm = 1;
+			imm = 1;
+			break;
+		case 0x84 ... 0x8f: case 0xc4: case 0xc5: case 0xd0 ... 0xd3:
+		case 0xfe:
+			modrm = 1;
+			break;
+		case 0xa0 ... 0xa3:		/* mov moffs */
+			imm = 4;
+			break;
+		case 0xc8:			/* enter */
+			imm = 3;
+			break;
+		case 0xc2: case 0xca:		/* ret imm16 */
+			imm = 2;
+			*flags = INSN_STOP;
+			break;
+		case 0xc3: case 0xcb: case 0xcf:
+			*flags = INSN_STOP;
+			break;
+		case 0x70 ... 0x7f: case 0xe0 ... 0xe3:
+			rel = 1;
+			*flags = INSN_BRANCH;
+			break;
+		case 0xe8:
+			rel = 4;
+			*flags = INSN_BRANCH | INSN_CALL;
+			break;
+		case 0xe9:
+			rel = 4;
+			*flags = INSN_BRANCH | INSN_STOP;
+			break;
+		case 0xeb:
+			rel = 1;
+			*flags = INSN_BRANCH | INSN_STOP;
+			break;
+		case 0xf6: case 0xf7:
+			/* test has an immediate, the others not */
+			modrm = 1;
+			if (((*p >> 3) & 7) < 2)
+				imm = op == 0xf6 ? 1 : opsize;
+			break;
+		case 0xff:
+			modrm = 1;
+			switch ((*p >> 3) & 7) {
+			case 2: case 3:
+				*flags = INSN_CALL;
+				break;
+			case 4: case 5:
+				*flags = INSN_INDIRECT | INSN_STOP;
+				break;
+			}
+			break;
+		default:
+			return 0;
+		}
+	}
+	/* 0x40-0x5f: inc, dec, push and pop of a register */
+
+	len = p - insn;
+	if (modrm)
+		len += modrm_length(p);
+	len += imm;
+	if (rel == 1)
+		*target = addr + len + 1 + (signed char)insn[len];
+	else if (rel == 4)
+		*target = addr + len + 4 + *(s32 *)(insn + len);
+	return len + rel;
+}
+
+/* The instruction at @addr as it was before @p was armed */
+static void fetch_insn(struct kprobe *p, unsigned long addr, unsigned long end,
+		       kprobe_opcode_t *buf)
+{
+	unsigned long len = min(end - addr, (unsigned long)MAX_INSN_SIZE);
+	unsigned long probe = (unsigned long)p->addr;
+
+	memset(buf, 0, MAX_INSN_SIZE);
+	memcpy(buf, (void *)addr, len);
+	if (addr <= probe && probe < addr + len)
+		buf[probe - addr] = p->opcode;
+}
+
+/*
+ * Returns the number of bytes of instructions the jump at @p would
+ * cover, or 0 if it cannot be put there.  Called with kprobe_mutex held.
+ */
+static int can_optimize(struct kprobe *p)
+{
+	unsigned long addr = (unsigned long)p->addr, start, end, size, offset;
+	unsigned long a, target;
+	kprobe_opcode_t buf[MAX_INSN_SIZE];
+	char namebuf[KSYM_NAME_LEN + 1];
+	int len, flags, found = 0, optsize = 0;
+	char *modname;
+
+	if (!kallsyms_lookup(addr, &size, &offset, &modname, namebuf))
+		return 0;
+	start = addr - offset;
+	end = start + size;
+
+	for (a = start; a < end; a += len) {
+		/* The original bytes are not there: leave those alone */
+		if (a != addr && get_kprobe((void *)a))
+			return 0;
+
+		fetch_insn(p, a, end, buf);
+		len = insn_decode(buf, a, &target, &flags);
+		if (!len || a + len > end || (flags & INSN_INDIRECT))
+			return 0;
+
+		if (a == addr)
+			found = 1;
+		if (a >= addr && a < addr + RELATIVEJUMP_SIZE) {
+			/* Must run as well from the detour buffer */
+			if (flags || search_exception_tables(a))
+				return 0;
+			optsize = a + len - addr;
+		}
+
+		if ((flags & INSN_BRANCH) && !(flags & INSN_CALL) &&
+		    target > addr && target < addr + MAX_OPTIMIZED_LENGTH)
+			return 0;
+	}
+	if (!found || optsize < RELATIVEJUMP_SIZE)
+		return 0;
+	return optsize;
+}
+
+/*
+ * The detour buffer starts with a copy of this.  It builds a pt_regs on
+ * the stack, with &regs->esp at the stack pointer of the probed code as
+ * for a breakpoint, and passes it to optimized_callback().  The copied
+ * instructions and a jump back follow.
+ */
+asm (
+	"	.text\n"
+	"	.globl optprobe_template_entry\n"
+	"optprobe_template_entry:\n"
+	"	pushfl\n"
+	"	pushl $" __stringify(__KERNEL_CS) "\n"
+	"	pushl $0\n"			/* eip, set by the callback */
+	"	pushl $-1\n"			/* orig_eax */
+	"	pushl %es\n"
+	"	pushl %ds\n"
+	"	pushl %eax\n"
+	"	pushl %ebp\n"
+	"	pushl %edi\n"
+	"	pushl %esi\n"
+	"	pushl %edx\n"
+	"	pushl %ecx\n"
+	"	pushl %ebx\n"
+	"	movl %esp, %edx\n"
+	"	.globl optprobe_template_val\n"
+	"optprobe_template_val:\n"
+	"	movl $0, %eax\n"		/* the kprobe */
+	"	.globl optprobe_template_call\n"
+	"optprobe_template_call:\n"
+	"	movl $0, %ecx\n"		/* optimized_callback */
+	"	call *%ecx\n"
+	"	popl %ebx\n"
+	"	popl %ecx\n"
+	"	popl %edx\n"
+	"	popl %esi\n"
+	"	popl %edi\n"
+	"	popl %ebp\n"
+	"	popl %eax\n"
+	"	popl %ds\n"
+	"	popl %es\n"
+	"	addl $12, %esp\n"
+	"	popfl\n"
+	"	.globl optprobe_template_end\n"
+	"optprobe_template_end:\n");
+
+/*
+ * Called from the detour buffer.  The pre_handler's return value, and
+ * any change it makes to regs->eip, are ignored.
+ */
+static void fastcall optimized_callback(struct kprobe *p, struct pt_regs *regs)
+{
+	struct kprobe_ctlblk *kcb;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	/* A probe hit from a probe handler is skipped */
+	if (!kprobe_running()) {
+		preempt_disable();
+		kcb = &__get_cpu_var(kprobe_ctlblk);
+		regs->eip = (unsigned long)p->addr + sizeof(kprobe_opcode_t);
+		__get_cpu_var(current_kprobe) = p;
+		kcb->kprobe_status = KPROBE_HIT_ACTIVE;
+		kprobe_count_hit(p);
+		p->pre_handler(p, regs);
+		reset_current_kprobe();
+		preempt_enable_no_resched();
+	}
+	local_irq_restore(flags);
+}
+
+int arch_prepare_optimized_kprobe(struct kprobe *p)
+{
+	kprobe_opcode_t *buf, *insn;
+	int size;
+
+	if (TMPL_END_IDX + MAX_OPTIMIZED_LENGTH + RELATIVEJUMP_SIZE >
+	    MAX_OPTINSN_SIZE)
+		return -E2BIG;
+	size = can_optimize(p);
+	if (!size)
+		return -EINVAL;
+	buf = get_optinsn_slot();
+	if (!buf)
+		return -ENOMEM;
+
+	memcpy(buf, optprobe_template_entry, TMPL_END_IDX);
+	*(unsigned long *)(buf + TMPL_VAL_IDX + 1) = (unsigned long)p;
+	*(unsigned long *)(buf + TMPL_CALL_IDX + 1) =
+		(unsigned long)optimized_callback;
+
+	insn = buf + TMPL_END_IDX;
+	memcpy(insn, p->addr, size);
+	insn[0] = p->opcode;
+	insn[size] = RELATIVEJUMP_OPCODE;
+	*(long *)(insn + size + 1) = (long)p->addr + size -
+		(long)(insn + size + RELATIVEJUMP_SIZE);
+
+	p->ainsn.optinsn = buf;
+	/* Breakpoint hits may use the buffer from here on */
+	smp_wmb();
+	p->ainsn.optsize = size;
+	return 0;
+}
+
+struct optprobe_patch {
+	kprobe_opcode_t *addr;
+	kprobe_opcode_t insn[RELATIVEJUMP_SIZE];
+};
+
+static int optprobe_write(void *data)
+{
+	struct optprobe_patch *patch = data;
+
+	memcpy(patch->addr, patch->insn, RELATIVEJUMP_SIZE);
+	flush_icache_range((unsigned long)patch->addr,
+			   (unsigned long)patch->addr + RELATIVEJUMP_SIZE);
+	return 0;
+}
+
+/* No cpu may run the five bytes while they are being changed */
+static void optprobe_patch_text(struct optprobe_patch *patch)
+{
+#ifdef CONFIG_SMP
+	stop_machine_run(optprobe_write, patch, NR_CPUS);
+#else
+	unsigned long flags;
+
+	local_irq_save(flags);
+	optprobe_write(patch);
+	local_irq_restore(flags);
+#endif
+}
+
+void arch_optimize_kprobe(struct kprobe *p)
+{
+	struct optprobe_patch patch = { .addr = p->addr };
+
+	patch.insn[0] = RELATIVEJUMP_OPCODE;
+	*(long *)(patch.insn + 1) = (long)p->ainsn.optinsn -
+		((long)p->addr + RELATIVEJUMP_SIZE);
+	optprobe_patch_text(&patch);
+	p->ainsn.optimized = 1;
+}
+
+void arch_unoptimize_kprobe(struct kprobe *p)
+{
+	struct optprobe_patch patch = { .addr = p->addr };
+
+	if (p->ainsn.optimized) {
+		patch.insn[0] = BREAKPOINT_INSTRUCTION;
+		memcpy(patch.insn + 1, p->ainsn.insn + 1,
+		       RELATIVEJUMP_SIZE - 1);
+		optprobe_patch_text(&patch);
+		p->ainsn.optimized = 0;
+	}
+	/* Back to single-stepping */
+	p->ainsn.optsize = 0;
+}
+
+void arch_remove_optimized_kprobe(struct kprobe *p)
+{
+	if (p->ainsn.optinsn) {
+		free_optinsn_slot(p->ainsn.optinsn);
+		p->ainsn.optinsn = NULL;
+	}
+}
+
+/* Does the jump of @p cover @addr? */
+int arch_within_optimized_kprobe(struct kprobe *p, kprobe_opcode_t *addr)
+{
+	return p->ainsn.optimized && addr > p->addr &&
+	       addr < p->addr + p->ainsn.optsize;
+}
+#endif /* CONFIG_OPTPROBES */
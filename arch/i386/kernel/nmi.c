@@ -485,7 +485,12 @@ void nmi_watchdog_tick (struct pt_regs * regs)
 
 	sum = irq_stat[cpu].apic_timer_irqs;
 
-	if (last_irq_sums[cpu] == sum) {
+	/*
+	 * A CPU running tickless takes no local timer interrupts, which
+	 * is not a lockup.
+	 */
+	if (last_irq_sums[cpu] == sum && !cpu_isset(cpu, nohz_cpu_mask) &&
+	    !cpu_isset(cpu, nohz_busy_cpu_mask)) {
 		/*
 		 * Ayiee, looks like this CPU is stuck ...
 		 * wait a few IRQs (5 seconds) before doing the oops ...
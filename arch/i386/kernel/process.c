@@ -161,7 +161,12 @@ void cpu_idle (void)
 				idle = default_idle;
 
 			irq_stat[cpu].idle_timestamp = jiffies;
+			local_irq_disable();
+			if (!need_resched())
+				stop_hz_timer();
+			local_irq_enable();
 			idle();
+			start_hz_timer();
 		}
 		schedule();
 	}
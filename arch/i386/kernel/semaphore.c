@@ -16,6 +16,7 @@
 #include <linux/sched.h>
 #include <linux/err.h>
 #include <linux/init.h>
+#include <linux/lockstat.h>
 #include <asm/semaphore.h>
 
 /*
@@ -63,6 +64,7 @@ fastcall void __sched __down(struct semaphore * sem)
 	struct task_struct *tsk = current;
 	DECLARE_WAITQUEUE(wait, tsk);
 	unsigned long flags;
+	unsigned long long start = lock_stat_clock();
 
 	/**
 	 * ״̬ΪTASK_UNINTERRUPTIBLE
@@ -130,6 +132,7 @@ fastcall void __sched __down(struct semaphore * sem)
 	wake_up_locked(&sem->wait);
 	spin_unlock_irqrestore(&sem->wait.lock, flags);
 	tsk->state = TASK_RUNNING;
+	lock_stat_waited(sem, LOCK_STAT_SEM, start);
 }
 
 /**
@@ -144,6 +147,7 @@ fastcall int __sched __down_interruptible(struct semaphore * sem)
 	struct task_struct *tsk = current;
 	DECLARE_WAITQUEUE(wait, tsk);
 	unsigned long flags;
+	unsigned long long start = lock_stat_clock();
 
 	tsk->state = TASK_INTERRUPTIBLE;
 	spin_lock_irqsave(&sem->wait.lock, flags);
@@ -190,6 +194,8 @@ fastcall int __sched __down_interruptible(struct semaphore * sem)
 	spin_unlock_irqrestore(&sem->wait.lock, flags);
 
 	tsk->state = TASK_RUNNING;
+	if (!retval)
+		lock_stat_waited(sem, LOCK_STAT_SEM, start);
 	return retval;
 }
 
@@ -586,6 +586,7 @@ void smp_send_stop(void)
 fastcall void smp_reschedule_interrupt(struct pt_regs *regs)
 {
 	ack_APIC_irq();
+	start_hz_timer();
 }
 
 fastcall void smp_call_function_interrupt(struct pt_regs *regs)
@@ -605,6 +606,7 @@ fastcall void smp_call_function_interrupt(struct pt_regs *regs)
 	 * At this point the info structure may be out of scope unless wait==1
 	 */
 	irq_enter();
+	start_hz_timer();
 	(*func)(info);
 	irq_exit();
 
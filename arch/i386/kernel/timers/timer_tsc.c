@@ -134,7 +134,7 @@ static unsigned long long monotonic_clock_tsc(void)
 /*
  * Scheduler clock - returns current time in nanosec units.
  */
-unsigned long long sched_clock(void)
+unsigned long long notrace sched_clock(void)
 {
 	unsigned long long this_offset;
 
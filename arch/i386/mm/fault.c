@@ -21,6 +21,7 @@
 #include <linux/vt_kern.h>		/* For unblank_screen() */
 #include <linux/highmem.h>
 #include <linux/module.h>
+#include <linux/perf_counter.h>
 
 #include <asm/system.h>
 #include <asm/uaccess.h>
@@ -238,6 +239,7 @@ fastcall void do_page_fault(struct pt_regs *regs, unsigned long error_code)
 	if (notify_die(DIE_PAGE_FAULT, "page fault", regs, error_code, 14,
 					SIGSEGV) == NOTIFY_STOP)
 		return;
+	perf_swcounter_event(PERF_COUNT_PAGE_FAULTS, 1, regs);
 	/* It's safe to allow irq's after cr2 has been saved */
 	/**
 	 * ֻڱcr2ͿԴжˡ
@@ -473,6 +475,7 @@ good_area:
 		 */
 		case VM_FAULT_MINOR:
 			tsk->min_flt++;
+			perf_swcounter_event(PERF_COUNT_PAGE_FAULTS_MIN, 1, regs);
 			break;
 		/**
 		 * VM_FAULT_MAJORʾ˵ǰ̣ȱҳ
@@ -480,6 +483,7 @@ good_area:
 		 */			
 		case VM_FAULT_MAJOR:
 			tsk->maj_flt++;
+			perf_swcounter_event(PERF_COUNT_PAGE_FAULTS_MAJ, 1, regs);
 			break;
 		/**
 		 * VM_FAULT_SIGBUSʾ
@@ -12,15 +12,26 @@
 #include <linux/sched.h>
 #include <linux/mm.h>
 #include <asm/ptrace.h>
+#include <asm/uaccess.h>
 
 struct frame_head {
 	struct frame_head * ebp;
 	unsigned long ret;
 } __attribute__((packed));
 
+#ifdef CONFIG_X86_64
+#define regs_fp(regs)		((regs)->rbp)
+#define regs_pc(regs)		((regs)->rip)
+#define stack_top(tsk)		((tsk)->thread.rsp0)
+#else
+#define regs_fp(regs)		((regs)->ebp)
+#define regs_pc(regs)		((regs)->eip)
+#define stack_top(tsk)		((tsk)->thread.esp0)
+#endif
+
 
 static struct frame_head *
-dump_backtrace(struct frame_head * head)
+dump_kernel_backtrace(struct frame_head * head)
 {
 	oprofile_add_trace(head->ret);
 
@@ -33,27 +44,55 @@ dump_backtrace(struct frame_head * head)
 }
 
 
-#ifdef CONFIG_X86_4G
-/* With a 4G kernel/user split, user pages are not directly
- * accessible from the kernel, so don't try
+/* User frames are read with __copy_from_user_inatomic(), which
+ * gives up rather than sleeps when a page is not there: we can be
+ * in NMI context, where neither mmap_sem nor page_table_lock can
+ * be taken.
  */
-static int pages_present(struct frame_head * head)
+static struct frame_head *
+dump_user_backtrace(struct frame_head * head)
 {
-	return 0;
+	struct frame_head bufhead;
+
+	if (!access_ok(VERIFY_READ, head, sizeof(bufhead)))
+		return 0;
+	if (__copy_from_user_inatomic(&bufhead, head, sizeof(bufhead)))
+		return 0;
+
+	oprofile_add_trace(bufhead.ret);
+
+	if (head >= bufhead.ebp)
+		return 0;
+
+	return bufhead.ebp;
 }
-#else
-/* check that the page(s) containing the frame head are present */
-static int pages_present(struct frame_head * head)
+
+
+#ifdef CONFIG_IA32_EMULATION
+/* the same for a 32-bit process */
+struct frame_head32 {
+	u32 ebp;
+	u32 ret;
+} __attribute__((packed));
+
+static u32 dump_user_backtrace32(u32 head)
 {
-	struct mm_struct * mm = current->mm;
+	struct frame_head32 bufhead;
+	void __user * p = (void __user *)(unsigned long)head;
+
+	if (!access_ok(VERIFY_READ, p, sizeof(bufhead)))
+		return 0;
+	if (__copy_from_user_inatomic(&bufhead, p, sizeof(bufhead)))
+		return 0;
+
+	oprofile_add_trace(bufhead.ret);
 
-	/* FIXME: only necessary once per page */
-	if (!check_user_page_readable(mm, (unsigned long)head))
+	if (head >= bufhead.ebp)
 		return 0;
 
-	return check_user_page_readable(mm, (unsigned long)(head + 1));
+	return bufhead.ebp;
 }
-#endif /* CONFIG_X86_4G */
+#endif
 
 
 /*
@@ -93,32 +132,84 @@ static int valid_kernel_stack(struct frame_head * head, struct pt_regs * regs)
 #endif
 
 
-void
-x86_backtrace(struct pt_regs * const regs, unsigned int depth)
+/*
+ * The user registers saved at the top of the kernel stack when the
+ * current task entered the kernel, or NULL if it is a kernel thread
+ * or was not in user mode then.
+ */
+static struct pt_regs * user_regs(void)
 {
-	struct frame_head *head;
-
-#ifdef CONFIG_X86_64
-	head = (struct frame_head *)regs->rbp;
-#else
-	head = (struct frame_head *)regs->ebp;
+	struct pt_regs * regs;
+
+	if (!current->mm)
+		return NULL;
+
+	regs = (struct pt_regs *)stack_top(current) - 1;
+	if (!user_mode(regs))
+		return NULL;
+#ifndef CONFIG_X86_64
+	/* vm86 frames are segment:offset, and these are not our regs */
+	if (regs->eflags & VM_MASK)
+		return NULL;
 #endif
+	return regs;
+}
+
 
-	if (!user_mode(regs)) {
-		while (depth-- && valid_kernel_stack(head, regs))
-			head = dump_backtrace(head);
+static void
+user_backtrace(struct pt_regs * const regs, unsigned int depth)
+{
+#ifdef CONFIG_IA32_EMULATION
+	if (test_thread_flag(TIF_IA32)) {
+		u32 head = regs_fp(regs);
+
+		while (depth-- && head)
+			head = dump_user_backtrace32(head);
 		return;
 	}
+#endif
+	{
+		struct frame_head * head = (struct frame_head *)regs_fp(regs);
+
+		while (depth-- && head)
+			head = dump_user_backtrace(head);
+	}
+}
 
-#ifdef CONFIG_SMP
-	if (!spin_trylock(&current->mm->page_table_lock))
+
+void
+x86_backtrace(struct pt_regs * const regs, unsigned int depth)
+{
+	struct frame_head *head = (struct frame_head *)regs_fp(regs);
+	struct pt_regs *uregs;
+
+	if (user_mode(regs)) {
+		user_backtrace(regs, depth);
 		return;
-#endif
+	}
+
+	while (depth && valid_kernel_stack(head, regs)) {
+		head = dump_kernel_backtrace(head);
+		depth--;
+	}
 
-	while (depth-- && head && pages_present(head))
-		head = dump_backtrace(head);
+	/* carry on from where the task entered the kernel, the pc of the
+	 * system call or fault counting as the first user frame */
+	if (!depth)
+		return;
+	uregs = user_regs();
+	if (!uregs)
+		return;
 
-#ifdef CONFIG_SMP
-	spin_unlock(&current->mm->page_table_lock);
+	oprofile_trace_user();
+	oprofile_add_trace(regs_pc(uregs));
+#ifndef CONFIG_X86_64
+	user_backtrace(uregs, depth - 1);
+#else
+	/*
+	 * Only the fault entries save rbp in the pt_regs: system_call, the
+	 * ia32 entries and interrupts leave a stale value there, and we
+	 * cannot tell which one we came through.  Stop at the user pc.
+	 */
 #endif
 }
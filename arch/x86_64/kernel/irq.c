@@ -97,11 +97,15 @@ asmlinkage unsigned int do_IRQ(struct pt_regs *regs)
 	/* high bits used in ret_from_ code  */
 	unsigned irq = regs->orig_rax & 0xff;
 
+	/* Interrupts went off on entry, and go back on with the iret */
+	trace_hardirqs_off();
 	irq_enter();
+	start_hz_timer();
 	BUG_ON(irq > 256);
 
 	__do_IRQ(irq, regs);
 	irq_exit();
+	trace_hardirqs_on();
 
 	return 1;
 }
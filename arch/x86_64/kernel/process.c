@@ -162,7 +162,12 @@ void cpu_idle (void)
 			idle = pm_idle;
 			if (!idle)
 				idle = default_idle;
+			local_irq_disable();
+			if (!need_resched())
+				stop_hz_timer();
+			local_irq_enable();
 			idle();
+			start_hz_timer();
 		}
 		schedule();
 	}
@@ -15,6 +15,7 @@
 #include <linux/config.h>
 #include <linux/sched.h>
 #include <linux/init.h>
+#include <linux/lockstat.h>
 #include <asm/errno.h>
 
 #include <asm/semaphore.h>
@@ -60,6 +61,7 @@ void __sched __down(struct semaphore * sem)
 	struct task_struct *tsk = current;
 	DECLARE_WAITQUEUE(wait, tsk);
 	unsigned long flags;
+	unsigned long long start = lock_stat_clock();
 
 	tsk->state = TASK_UNINTERRUPTIBLE;
 	spin_lock_irqsave(&sem->wait.lock, flags);
@@ -90,6 +92,7 @@ void __sched __down(struct semaphore * sem)
 	wake_up_locked(&sem->wait);
 	spin_unlock_irqrestore(&sem->wait.lock, flags);
 	tsk->state = TASK_RUNNING;
+	lock_stat_waited(sem, LOCK_STAT_SEM, start);
 }
 
 int __sched __down_interruptible(struct semaphore * sem)
@@ -98,6 +101,7 @@ int __sched __down_interruptible(struct semaphore * sem)
 	struct task_struct *tsk = current;
 	DECLARE_WAITQUEUE(wait, tsk);
 	unsigned long flags;
+	unsigned long long start = lock_stat_clock();
 
 	tsk->state = TASK_INTERRUPTIBLE;
 	spin_lock_irqsave(&sem->wait.lock, flags);
@@ -144,6 +148,8 @@ int __sched __down_interruptible(struct semaphore * sem)
 	spin_unlock_irqrestore(&sem->wait.lock, flags);
 
 	tsk->state = TASK_RUNNING;
+	if (!retval)
+		lock_stat_waited(sem, LOCK_STAT_SEM, start);
 	return retval;
 }
 
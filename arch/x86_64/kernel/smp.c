@@ -383,6 +383,7 @@ void smp_send_stop(void)
 asmlinkage void smp_reschedule_interrupt(void)
 {
 	ack_APIC_irq();
+	start_hz_timer();
 }
 
 asmlinkage void smp_call_function_interrupt(void)
@@ -402,6 +403,7 @@ asmlinkage void smp_call_function_interrupt(void)
 	 * At this point the info structure may be out of scope unless wait==1
 	 */
 	irq_enter();
+	start_hz_timer();
 	(*func)(info);
 	irq_exit();
 	if (wait) {
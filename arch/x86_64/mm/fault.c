@@ -24,6 +24,7 @@
 #include <linux/compiler.h>
 #include <linux/module.h>
 #include <linux/kprobes.h>
+#include <linux/perf_counter.h>
 
 #include <asm/system.h>
 #include <asm/uaccess.h>
@@ -321,6 +322,7 @@ asmlinkage void do_page_fault(struct pt_regs *regs, unsigned long error_code)
 	if (notify_die(DIE_PAGE_FAULT, "page fault", regs, error_code, 14,
 					SIGSEGV) == NOTIFY_STOP)
 		return;
+	perf_swcounter_event(PERF_COUNT_PAGE_FAULTS, 1, regs);
 
 	if (likely(regs->eflags & X86_EFLAGS_IF))
 		local_irq_enable();
@@ -437,9 +439,11 @@ good_area:
 	switch (handle_mm_fault(mm, vma, address, write)) {
 	case 1:
 		tsk->min_flt++;
+		perf_swcounter_event(PERF_COUNT_PAGE_FAULTS_MIN, 1, regs);
 		break;
 	case 2:
 		tsk->maj_flt++;
+		perf_swcounter_event(PERF_COUNT_PAGE_FAULTS_MAJ, 1, regs);
 		break;
 	case 0:
 		goto do_sigbus;
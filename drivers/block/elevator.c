@@ -34,6 +34,7 @@
 #include <linux/slab.h>
 #include <linux/init.h>
 #include <linux/compiler.h>
+#include <trace/block.h>
 
 #include <asm/uaccess.h>
 
@@ -294,6 +295,7 @@ void __elv_add_request(request_queue_t *q, struct request *rq, int where,
 		blk_plug_device(q);
 
 	rq->q = q;
+	trace_block_rq_insert(q, rq);
 
 	if (!test_bit(QUEUE_FLAG_DRAIN, &q->queue_flags)) {
 		/* 㷨˵صdeadline_add_request */
@@ -344,6 +346,9 @@ struct request *elv_next_request(request_queue_t *q)
 	int ret;
 
 	while ((rq = __elv_next_request(q)) != NULL) {/* ӵݶȡһд */
+		if (!(rq->flags & REQ_STARTED))
+			trace_block_rq_issue(q, rq);
+
 		/*
 		 * just mark as started even if we don't start it, a request
 		 * that has been delayed should not be passed by new incoming
@@ -28,6 +28,8 @@
 #include <linux/slab.h>
 #include <linux/swap.h>
 #include <linux/writeback.h>
+#include <linux/task_io_accounting_ops.h>
+#include <trace/block.h>
 
 /*
  * for max sense size
@@ -1948,6 +1950,8 @@ EXPORT_SYMBOL(blk_get_request);
  */
 void blk_requeue_request(request_queue_t *q, struct request *rq)
 {
+	trace_block_rq_requeue(q, rq);
+
 	if (blk_rq_tagged(rq))
 		blk_queue_end_tag(q, rq);
 
@@ -2487,6 +2491,8 @@ static int __make_request(request_queue_t *q, struct bio *bio)
 	int el_ret, rw, nr_sectors, cur_nr_sectors, barrier, err;
 	sector_t sector;
 
+	trace_block_bio_queue(q, bio);
+
 	sector = bio->bi_sector;
 	nr_sectors = bio_sectors(bio);
 	cur_nr_sectors = bio_cur_sectors(bio);
@@ -2542,6 +2548,8 @@ again:
 			if (!q->back_merge_fn(q, req, bio))
 				break;
 
+			trace_block_bio_backmerge(q, bio);
+
 			/**
 			 * ϲbioĩβ
 			 */
@@ -2565,6 +2573,8 @@ again:
 			if (!q->front_merge_fn(q, req, bio))
 				break;
 
+			trace_block_bio_frontmerge(q, bio);
+
 			/**
 			 * ϲbioǰ
 			 */
@@ -2612,6 +2622,7 @@ get_rq:
 	if (freereq) {/* п */
 		req = freereq;
 		freereq = NULL;
+		trace_block_getrq(q, bio);
 	} else {
 		spin_unlock_irq(q->queue_lock);
 		/**
@@ -2628,6 +2639,7 @@ get_rq:
 			/**
 			 * ֱӷһôȴڴãһų 
 			 */
+			trace_block_sleeprq(q, bio);
 			freereq = get_request_wait(q, rw);
 		}
 		goto again;
@@ -2963,10 +2975,12 @@ void submit_bio(int rw, struct bio *bio)
 	BIO_BUG_ON(!bio->bi_size);
 	BIO_BUG_ON(!bio->bi_io_vec);
 	bio->bi_rw = rw;/* ¼дʽ */
-	if (rw & WRITE)/* ͳƶд */
+	if (rw & WRITE) {/* ͳƶд */
 		mod_page_state(pgpgout, count);
-	else
+	} else {
+		task_io_account_read(bio->bi_size);
 		mod_page_state(pgpgin, count);
+	}
 
 	if (unlikely(block_dump)) {
 		char b[BDEVNAME_SIZE];
@@ -3067,6 +3081,8 @@ static int __end_that_request_first(struct request *req, int uptodate,
 	if (end_io_error(uptodate))
 		error = !uptodate ? -EIO : uptodate;
 
+	trace_block_rq_complete(req->q, req, nr_bytes, error);
+
 	/*
 	 * for a REQ_BLOCK_PC request, we want to carry any eventual
 	 * sense key with us all the way through
@@ -3612,12 +3628,41 @@ static struct queue_sysfs_entry queue_iosched_entry = {
 	.store = elv_iosched_store,
 };
 
+#ifdef CONFIG_TRACEPOINTS
+static ssize_t queue_trace_show(struct request_queue *q, char *page)
+{
+	return queue_var_show(blk_queue_traced(q), page);
+}
+
+static ssize_t
+queue_trace_store(struct request_queue *q, const char *page, size_t count)
+{
+	unsigned long on;
+	ssize_t ret = queue_var_store(&on, page, count);
+
+	if (on)
+		set_bit(QUEUE_FLAG_TRACE, &q->queue_flags);
+	else
+		clear_bit(QUEUE_FLAG_TRACE, &q->queue_flags);
+	return ret;
+}
+
+static struct queue_sysfs_entry queue_trace_entry = {
+	.attr = {.name = "trace", .mode = S_IRUGO | S_IWUSR },
+	.show = queue_trace_show,
+	.store = queue_trace_store,
+};
+#endif
+
 static struct attribute *default_attrs[] = {
 	&queue_requests_entry.attr,
 	&queue_ra_entry.attr,
 	&queue_max_hw_sectors_entry.attr,
 	&queue_max_sectors_entry.attr,
 	&queue_iosched_entry.attr,
+#ifdef CONFIG_TRACEPOINTS
+	&queue_trace_entry.attr,
+#endif
 	NULL,
 };
 
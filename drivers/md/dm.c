@@ -864,9 +864,9 @@ static void __set_size(struct gendisk *disk, sector_t size)
 	set_capacity(disk, size);
 	bdev = bdget_disk(disk, 0);
 	if (bdev) {
-		down(&bdev->bd_inode->i_sem);
+		mutex_lock(&bdev->bd_inode->i_mutex);
 		i_size_write(bdev->bd_inode, (loff_t)size << SECTOR_SHIFT);
-		up(&bdev->bd_inode->i_sem);
+		mutex_unlock(&bdev->bd_inode->i_mutex);
 		bdput(bdev);
 	}
 }
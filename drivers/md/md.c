@@ -2421,9 +2421,9 @@ static int update_array_info(mddev_t *mddev, mdu_array_info_t *info)
 
 			bdev = bdget_disk(mddev->gendisk, 0);
 			if (bdev) {
-				down(&bdev->bd_inode->i_sem);
+				mutex_lock(&bdev->bd_inode->i_mutex);
 				i_size_write(bdev->bd_inode, mddev->array_size << 10);
-				up(&bdev->bd_inode->i_sem);
+				mutex_unlock(&bdev->bd_inode->i_mutex);
 				bdput(bdev);
 			}
 		}
@@ -2443,9 +2443,9 @@ static int update_array_info(mddev_t *mddev, mdu_array_info_t *info)
 
 			bdev = bdget_disk(mddev->gendisk, 0);
 			if (bdev) {
-				down(&bdev->bd_inode->i_sem);
+				mutex_lock(&bdev->bd_inode->i_mutex);
 				i_size_write(bdev->bd_inode, mddev->array_size << 10);
-				up(&bdev->bd_inode->i_sem);
+				mutex_unlock(&bdev->bd_inode->i_mutex);
 				bdput(bdev);
 			}
 		}
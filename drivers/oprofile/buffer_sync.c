@@ -350,6 +350,21 @@ add_sample(struct mm_struct * mm, struct op_sample * s, int in_kernel)
 	}
 	return 0;
 }
+
+
+/* Add the one or two backtrace entries of a CPU buffer slot */
+static int
+add_trace_pair(struct mm_struct * mm, struct op_sample * s, int in_kernel)
+{
+	struct op_sample entry = { s->eip, 0 };
+
+	if (!add_sample(mm, &entry, in_kernel))
+		return 0;
+	if (!s->event)
+		return 1;
+	entry.eip = s->event;
+	return add_sample(mm, &entry, in_kernel);
+}
  
 
 static void release_mm(struct mm_struct * mm)
@@ -466,10 +481,6 @@ static void mark_done(int cpu)
 }
 
 
-/* FIXME: this is not sufficient if we implement syscall barrier backtrace
- * traversal, the code switch to sb_sample_start at first kernel enter/exit
- * switch so we need a fifth state and some special handling in sync_buffer()
- */
 typedef enum {
 	sb_bt_ignore = -2,
 	sb_buffer_start,
@@ -477,6 +488,18 @@ typedef enum {
 	sb_sample_start,
 } sync_buffer_state;
 
+/* Where we are in a backtrace: its entries are packed two to a slot,
+ * so they must be told apart from the sample they follow. A backtrace
+ * that crosses into user space carries a CPU_TRACE_USER note, which
+ * is not a kernel/user switch of the sample stream: it must not end
+ * the backtrace nor get us out of sb_buffer_start.
+ */
+typedef enum {
+	bt_none,
+	bt_sample,		/* CPU_TRACE_BEGIN seen, the sample is next */
+	bt_entries,
+} sync_bt_state;
+
 /* Sync one of the CPU's buffers into the global event buffer.
  * Here we need to go through each batch of samples punctuated
  * by context switch notes, taking the task's mmap_sem and doing
@@ -492,6 +515,7 @@ void sync_buffer(int cpu)
 	int in_kernel = 1;
 	unsigned int i;
 	sync_buffer_state state = sb_buffer_start;
+	sync_bt_state bt = bt_none;
 	unsigned long available;
 
 	down(&buffer_sem);
@@ -509,15 +533,26 @@ void sync_buffer(int cpu)
 			if (s->event <= CPU_IS_KERNEL) {
 				/* kernel/userspace switch */
 				in_kernel = s->event;
-				if (state == sb_buffer_start)
+				if (state == sb_buffer_start ||
+				    state == sb_bt_ignore)
 					state = sb_sample_start;
+				if (bt == bt_entries)
+					bt = bt_none;
 				add_kernel_ctx_switch(s->event);
 			} else if (s->event == CPU_TRACE_BEGIN) {
 				state = sb_bt_start;
+				bt = bt_sample;
 				add_trace_begin();
+			} else if (s->event == CPU_TRACE_USER) {
+				/* backtrace goes on into userspace */
+				in_kernel = 0;
+				add_kernel_ctx_switch(0);
 			} else {
 				struct mm_struct * oldmm = mm;
 
+				if (bt == bt_entries)
+					bt = bt_none;
+
 				/* userspace context switch */
 				new = (struct task_struct *)s->event;
 
@@ -527,6 +562,12 @@ void sync_buffer(int cpu)
 					cookie = get_exec_dcookie(mm);
 				add_user_ctx_switch(new, cookie);
 			}
+		} else if (bt == bt_entries) {
+			if (state == sb_bt_start &&
+			    !add_trace_pair(mm, s, in_kernel)) {
+				state = sb_bt_ignore;
+				atomic_inc(&oprofile_stats.bt_lost_no_mapping);
+			}
 		} else {
 			if (state >= sb_bt_start &&
 			    !add_sample(mm, s, in_kernel)) {
@@ -535,6 +576,8 @@ void sync_buffer(int cpu)
 					atomic_inc(&oprofile_stats.bt_lost_no_mapping);
 				}
 			}
+			if (bt == bt_sample)
+				bt = bt_entries;
 		}
 
 		increment_tail(cpu_buf);
@@ -60,6 +60,8 @@ int alloc_cpu_buffers(void)
 		b->last_task = NULL;
 		b->last_is_kernel = -1;
 		b->tracing = 0;
+		b->traced = 0;
+		b->trace_pc = 0;
 		b->buffer_size = buffer_size;
 		b->tail_pos = 0;
 		b->head_pos = 0;
@@ -195,6 +197,14 @@ static int log_sample(struct oprofile_cpu_buffer * cpu_buf, unsigned long pc,
 
 	task = current;
 
+	/* no backtrace right after one: make sure there is a switch
+	 * note in between, which is where sync_buffer() sees the end
+	 * of a backtrace */
+	if (cpu_buf->traced && !cpu_buf->tracing) {
+		cpu_buf->traced = 0;
+		cpu_buf->last_is_kernel = -1;
+	}
+
 	/* notice a switch from user->kernel or vice versa */
 	if (cpu_buf->last_is_kernel != is_kernel) {
 		cpu_buf->last_is_kernel = is_kernel;
@@ -220,12 +230,27 @@ static int oprofile_begin_trace(struct oprofile_cpu_buffer * cpu_buf)
 
 	add_code(cpu_buf, CPU_TRACE_BEGIN);
 	cpu_buf->tracing = 1;
+	cpu_buf->traced = 1;
+	cpu_buf->trace_pc = 0;
 	return 1;
 }
 
 
+/* store a backtrace entry left without a pair; the slot for it
+ * was there when it was put aside */
+static void flush_trace_pc(struct oprofile_cpu_buffer * cpu_buf)
+{
+	if (cpu_buf->trace_pc) {
+		add_sample(cpu_buf, cpu_buf->trace_pc, 0);
+		cpu_buf->trace_pc = 0;
+	}
+}
+
+
 static void oprofile_end_trace(struct oprofile_cpu_buffer * cpu_buf)
 {
+	if (cpu_buf->tracing)
+		flush_trace_pc(cpu_buf);
 	cpu_buf->tracing = 0;
 }
 
@@ -268,19 +293,48 @@ void oprofile_add_trace(unsigned long pc)
 
 	if (nr_available_slots(cpu_buf) < 1) {
 		cpu_buf->tracing = 0;
+		cpu_buf->trace_pc = 0;
 		cpu_buf->sample_lost_overflow++;
 		return;
 	}
 
 	/* broken frame can give an eip with the same value as an escape code,
-	 * abort the trace if we get it */
-	if (pc == ESCAPE_CODE) {
+	 * or 0 which marks the end of a pair, abort the trace if we get it */
+	if (pc == ESCAPE_CODE || !pc) {
+		flush_trace_pc(cpu_buf);
 		cpu_buf->tracing = 0;
 		cpu_buf->backtrace_aborted++;
 		return;
 	}
 
-	add_sample(cpu_buf, pc, 0);
+	if (!cpu_buf->trace_pc) {
+		cpu_buf->trace_pc = pc;
+		return;
+	}
+	add_sample(cpu_buf, cpu_buf->trace_pc, pc);
+	cpu_buf->trace_pc = 0;
+}
+
+
+void oprofile_trace_user(void)
+{
+	struct oprofile_cpu_buffer * cpu_buf = &cpu_buffer[smp_processor_id()];
+
+	if (!cpu_buf->tracing)
+		return;
+
+	if (nr_available_slots(cpu_buf) < 2) {
+		cpu_buf->tracing = 0;
+		cpu_buf->trace_pc = 0;
+		cpu_buf->sample_lost_overflow++;
+		return;
+	}
+
+	flush_trace_pc(cpu_buf);
+	add_code(cpu_buf, CPU_TRACE_USER);
+	/* sync_buffer() is in user mode from here on, as is the
+	 * next sample unless it says otherwise */
+	cpu_buf->last_is_kernel = 0;
 }
 
 
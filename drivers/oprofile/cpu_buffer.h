@@ -38,6 +38,8 @@ struct oprofile_cpu_buffer {
 	struct task_struct * last_task;
 	int last_is_kernel;
 	int tracing;
+	int traced;			/* last sample had a backtrace */
+	unsigned long trace_pc;		/* backtrace entry waiting for a pair */
 	struct op_sample * buffer;
 	unsigned long sample_received;
 	unsigned long sample_lost_overflow;
@@ -53,5 +55,11 @@ void cpu_buffer_reset(struct oprofile_cpu_buffer * cpu_buf);
 /* transient events for the CPU buffer -> event buffer */
 #define CPU_IS_KERNEL 1
 #define CPU_TRACE_BEGIN 2
+#define CPU_TRACE_USER 3
+
+/* Backtrace entries are stored two to a slot, as the eip and event
+ * of an op_sample; an event of 0 means there is no second entry.
+ * A backtrace ends at the next kernel/user or task switch note.
+ */
 
 #endif /* OPROFILE_CPU_BUFFER_H */
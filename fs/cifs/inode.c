@@ -762,10 +762,10 @@ cifs_revalidate(struct dentry *direntry)
 	}
 
 	/* can not grab this sem since kernel filesys locking
-		documentation indicates i_sem may be taken by the kernel 
+		documentation indicates i_mutex may be taken by the kernel 
 		on lookup and rename which could deadlock if we grab
-		the i_sem here as well */
-/*	down(&direntry->d_inode->i_sem);*/
+		the i_mutex here as well */
+/*	mutex_lock(&direntry->d_inode->i_mutex);*/
 	/* need to write out dirty pages here  */
 	if(direntry->d_inode->i_mapping) {
 		/* do we need to lock inode until after invalidate completes below? */
@@ -780,7 +780,7 @@ cifs_revalidate(struct dentry *direntry)
 			invalidate_remote_inode(direntry->d_inode);
 		}
 	}
-/*	up(&direntry->d_inode->i_sem);*/
+/*	mutex_unlock(&direntry->d_inode->i_mutex);*/
 	
 	if (full_path)
 		kfree(full_path);
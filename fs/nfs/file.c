@@ -330,9 +330,9 @@ static int do_unlk(struct file *filp, int cmd, struct file_lock *fl)
 	 * with locks..
 	 */
 	filemap_fdatawrite(filp->f_mapping);
-	down(&inode->i_sem);
+	mutex_lock(&inode->i_mutex);
 	nfs_wb_all(inode);
-	up(&inode->i_sem);
+	mutex_unlock(&inode->i_mutex);
 	filemap_fdatawait(filp->f_mapping);
 
 	/* NOTE: special case
@@ -363,9 +363,9 @@ static int do_setlk(struct file *filp, int cmd, struct file_lock *fl)
 	 */
 	status = filemap_fdatawrite(filp->f_mapping);
 	if (status == 0) {
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		status = nfs_wb_all(inode);
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 		if (status == 0)
 			status = filemap_fdatawait(filp->f_mapping);
 	}
@@ -394,9 +394,9 @@ static int do_setlk(struct file *filp, int cmd, struct file_lock *fl)
 	 * This makes locking act as a cache coherency point.
 	 */
 	filemap_fdatawrite(filp->f_mapping);
-	down(&inode->i_sem);
+	mutex_lock(&inode->i_mutex);
 	nfs_wb_all(inode);	/* we may have slept */
-	up(&inode->i_sem);
+	mutex_unlock(&inode->i_mutex);
 	filemap_fdatawait(filp->f_mapping);
 	nfs_zap_caches(inode);
 out:
@@ -396,12 +396,12 @@ set_nfsv4_acl_one(struct dentry *dentry, struct posix_acl *pacl, char *key)
 
 	error = -EOPNOTSUPP;
 	if (inode->i_op && inode->i_op->setxattr) {
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		security_inode_setxattr(dentry, key, buf, len, 0);
 		error = inode->i_op->setxattr(dentry, key, buf, len, 0);
 		if (!error)
 			security_inode_post_setxattr(dentry, key, buf, len, 0);
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 	}
 out:
 	kfree(buf);
@@ -738,9 +738,9 @@ nfsd_sync(struct file *filp)
 {
 	struct inode *inode = filp->f_dentry->d_inode;
 	dprintk("nfsd: sync file %s\n", filp->f_dentry->d_name.name);
-	down(&inode->i_sem);
+	mutex_lock(&inode->i_mutex);
 	nfsd_dosync(filp, filp->f_dentry, filp->f_op);
-	up(&inode->i_sem);
+	mutex_unlock(&inode->i_mutex);
 }
 
 void
@@ -956,9 +956,9 @@ nfsd_write(struct svc_rqst *rqstp, struct svc_fh *fhp, loff_t offset,
 		struct iattr	ia;
 		ia.ia_valid = ATTR_KILL_SUID | ATTR_KILL_SGID;
 
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		notify_change(dentry, &ia);
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 	}
 
 	if (err >= 0 && stable) {
@@ -1774,7 +1774,7 @@ err_out:
 /**
  * ntfs_prepare_write - prepare a page for receiving data
  *
- * This is called from generic_file_write() with i_sem held on the inode
+ * This is called from generic_file_write() with i_mutex held on the inode
  * (@page->mapping->host).  The @page is locked but not kmap()ped.  The source
  * data has not yet been copied into the @page.
  *
@@ -2061,7 +2061,7 @@ static int ntfs_commit_nonresident_write(struct page *page,
 /**
  * ntfs_commit_write - commit the received data
  *
- * This is called from generic_file_write() with i_sem held on the inode
+ * This is called from generic_file_write() with i_mutex held on the inode
  * (@page->mapping->host).  The @page is locked but not kmap()ped.  The source
  * data has already been copied into the @page.  ntfs_prepare_write() has been
  * called before the data copied and it returned success so we can take the
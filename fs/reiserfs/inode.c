@@ -35,18 +35,18 @@ void reiserfs_delete_inode (struct inode * inode)
 
     /* The = 0 happens when we abort creating a new inode for some reason like lack of space.. */
     if (!(inode->i_state & I_NEW) && INODE_PKEY(inode)->k_objectid != 0) { /* also handles bad_inode case */
-	down (&inode->i_sem); 
+	mutex_lock (&inode->i_mutex); 
 
 	reiserfs_delete_xattrs (inode);
 
 	if (journal_begin(&th, inode->i_sb, jbegin_count)) {
-	    up (&inode->i_sem);
+	    mutex_unlock (&inode->i_mutex);
 	    goto out;
 	}
 	reiserfs_update_inode_transaction(inode) ;
 
 	if (reiserfs_delete_object (&th, inode)) {
-	    up (&inode->i_sem);
+	    mutex_unlock (&inode->i_mutex);
 	    goto out;
 	}
 
@@ -56,11 +56,11 @@ void reiserfs_delete_inode (struct inode * inode)
 	DQUOT_FREE_INODE(inode);
 
 	if (journal_end(&th, inode->i_sb, jbegin_count)) {
-	    up (&inode->i_sem);
+	    mutex_unlock (&inode->i_mutex);
 	    goto out;
 	}
 
-        up (&inode->i_sem);
+        mutex_unlock (&inode->i_mutex);
 
         /* all items of file are deleted, so we can remove "save" link */
 	remove_save_link (inode, 0/* not truncate */); /* we can't do anything
@@ -529,7 +529,7 @@ static int convert_tail_for_hole(struct inode *inode,
 
     /* we don't have to make sure the conversion did not happen while
     ** we were locking the page because anyone that could convert
-    ** must first take i_sem.
+    ** must first take i_mutex.
     **
     ** We must fix the tail page for writing because it might have buffers
     ** that are mapped, but have a block number of 0.  This indicates tail
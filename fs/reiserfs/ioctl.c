@@ -111,7 +111,7 @@ static int reiserfs_unpack (struct inode * inode, struct file * filp)
     /* we need to make sure nobody is changing the file size beneath
     ** us
     */
-    down(&inode->i_sem) ;
+    mutex_lock(&inode->i_mutex) ;
 
     write_from = inode->i_size & (blocksize - 1) ;
     /* if we are on a block boundary, we are already unpacked.  */
@@ -145,7 +145,7 @@ out_unlock:
     page_cache_release(page) ;
 
 out:
-    up(&inode->i_sem) ;
+    mutex_unlock(&inode->i_mutex) ;
     reiserfs_write_unlock(inode->i_sb);
     return retval;
 }
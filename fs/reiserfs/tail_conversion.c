@@ -203,7 +203,7 @@ int indirect2direct (struct reiserfs_transaction_handle *th,
     pos = le_ih_k_offset (&s_ih) - 1 + (ih_item_len(&s_ih) / UNFM_P_SIZE - 1) * p_s_sb->s_blocksize;
     pos1 = pos;
 
-    // we are protected by i_sem. The tail can not disapper, not
+    // we are protected by i_mutex. The tail can not disapper, not
     // append can be done either
     // we are in truncate or packing tail in file_release
 
@@ -68,9 +68,9 @@ create_xa_root (struct super_block *sb)
         goto out;
     } else if (!xaroot->d_inode) {
         int err;
-        down (&privroot->d_inode->i_sem);
+        mutex_lock (&privroot->d_inode->i_mutex);
         err = privroot->d_inode->i_op->mkdir (privroot->d_inode, xaroot, 0700);
-        up (&privroot->d_inode->i_sem);
+        mutex_unlock (&privroot->d_inode->i_mutex);
 
         if (err) {
             dput (xaroot);
@@ -221,7 +221,7 @@ get_xa_file_dentry (const struct inode *inode, const char *name, int flags)
     } else if (flags & XATTR_REPLACE || flags & FL_READONLY) {
         goto out;
     } else {
-        /* inode->i_sem is down, so nothing else can try to create
+        /* inode->i_mutex is down, so nothing else can try to create
          * the same xattr */
         err = xadir->d_inode->i_op->create (xadir->d_inode, xafile,
                                             0700|S_IFREG, NULL);
@@ -274,7 +274,7 @@ open_xa_file (const struct inode *inode, const char *name, int flags)
  * and don't mess with f->f_pos, but the idea is the same.  Do some
  * action on each and every entry in the directory.
  *
- * we're called with i_sem held, so there are no worries about the directory
+ * we're called with i_mutex held, so there are no worries about the directory
  * changing underneath us.
  */
 static int __xattr_readdir(struct file * filp, void * dirent, filldir_t filldir)
@@ -425,7 +425,7 @@ int xattr_readdir(struct file *file, filldir_t filler, void *buf)
         int res = -ENOTDIR;
         if (!file->f_op || !file->f_op->readdir)
                 goto out;
-        down(&inode->i_sem);
+        mutex_lock(&inode->i_mutex);
 //        down(&inode->i_zombie);
         res = -ENOENT;
         if (!IS_DEADDIR(inode)) {
@@ -434,7 +434,7 @@ int xattr_readdir(struct file *file, filldir_t filler, void *buf)
                 unlock_kernel();
         }
 //        up(&inode->i_zombie);
-        up(&inode->i_sem);
+        mutex_unlock(&inode->i_mutex);
 out:
         return res;
 }
@@ -483,7 +483,7 @@ xattr_hash (const char *msg, int len)
 /* Generic extended attribute operations that can be used by xa plugins */
 
 /*
- * inode->i_sem: down
+ * inode->i_mutex: down
  */
 int
 reiserfs_xattr_set (struct inode *inode, const char *name, const void *buffer,
@@ -538,7 +538,7 @@ open_file:
     /* Resize it so we're ok to write there */
     newattrs.ia_size = buffer_size;
     newattrs.ia_valid = ATTR_SIZE | ATTR_CTIME;
-    down (&xinode->i_sem);
+    mutex_lock (&xinode->i_mutex);
     err = notify_change(fp->f_dentry, &newattrs);
     if (err)
         goto out_filp;
@@ -599,7 +599,7 @@ open_file:
     }
 
 out_filp:
-    up (&xinode->i_sem);
+    mutex_unlock (&xinode->i_mutex);
     fput(fp);
 
 out:
@@ -607,7 +607,7 @@ out:
 }
 
 /*
- * inode->i_sem: down
+ * inode->i_mutex: down
  */
 int
 reiserfs_xattr_get (const struct inode *inode, const char *name, void *buffer,
@@ -790,7 +790,7 @@ reiserfs_delete_xattrs_filler (void *buf, const char *name, int namelen,
 
 }
 
-/* This is called w/ inode->i_sem downed */
+/* This is called w/ inode->i_mutex downed */
 int
 reiserfs_delete_xattrs (struct inode *inode)
 {
@@ -947,7 +947,7 @@ out:
 
 /*
  * Inode operation getxattr()
- * Preliminary locking: we down dentry->d_inode->i_sem
+ * Preliminary locking: we down dentry->d_inode->i_mutex
  */
 ssize_t
 reiserfs_getxattr (struct dentry *dentry, const char *name, void *buffer,
@@ -972,7 +972,7 @@ reiserfs_getxattr (struct dentry *dentry, const char *name, void *buffer,
 /*
  * Inode operation setxattr()
  *
- * dentry->d_inode->i_sem down
+ * dentry->d_inode->i_mutex down
  */
 int
 reiserfs_setxattr (struct dentry *dentry, const char *name, const void *value,
@@ -1010,7 +1010,7 @@ reiserfs_setxattr (struct dentry *dentry, const char *name, const void *value,
 /*
  * Inode operation removexattr()
  *
- * dentry->d_inode->i_sem down
+ * dentry->d_inode->i_mutex down
  */
 int
 reiserfs_removexattr (struct dentry *dentry, const char *name)
@@ -1091,7 +1091,7 @@ reiserfs_listxattr_filler (void *buf, const char *name, int namelen,
 /*
  * Inode operation listxattr()
  *
- * Preliminary locking: we down dentry->d_inode->i_sem
+ * Preliminary locking: we down dentry->d_inode->i_mutex
  */
 ssize_t
 reiserfs_listxattr (struct dentry *dentry, char *buffer, size_t size)
@@ -1295,9 +1295,9 @@ reiserfs_xattr_init (struct super_block *s, int mount_flags)
       if (!IS_ERR (dentry)) {
         if (!(mount_flags & MS_RDONLY) && !dentry->d_inode) {
             struct inode *inode = dentry->d_parent->d_inode;
-            down (&inode->i_sem);
+            mutex_lock (&inode->i_mutex);
             err = inode->i_op->mkdir (inode, dentry, 0700);
-            up (&inode->i_sem);
+            mutex_unlock (&inode->i_mutex);
             if (err) {
                 dput (dentry);
                 dentry = NULL;
@@ -52,7 +52,7 @@ setxattr(struct dentry *d, char __user *name, void __user *value,
 
 	error = -EOPNOTSUPP;
 	if (d->d_inode->i_op && d->d_inode->i_op->setxattr) {
-		down(&d->d_inode->i_sem);
+		mutex_lock(&d->d_inode->i_mutex);
 		error = security_inode_setxattr(d, kname, kvalue, size, flags);
 		if (error)
 			goto out;
@@ -60,7 +60,7 @@ setxattr(struct dentry *d, char __user *name, void __user *value,
 		if (!error)
 			security_inode_post_setxattr(d, kname, kvalue, size, flags);
 out:
-		up(&d->d_inode->i_sem);
+		mutex_unlock(&d->d_inode->i_mutex);
 	}
 	if (kvalue)
 		kfree(kvalue);
@@ -301,9 +301,9 @@ removexattr(struct dentry *d, char __user *name)
 		error = security_inode_removexattr(d, kname);
 		if (error)
 			goto out;
-		down(&d->d_inode->i_sem);
+		mutex_lock(&d->d_inode->i_mutex);
 		error = d->d_inode->i_op->removexattr(d, kname);
-		up(&d->d_inode->i_sem);
+		mutex_unlock(&d->d_inode->i_mutex);
 	}
 out:
 	return error;
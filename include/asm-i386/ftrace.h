@@ -0,0 +1,20 @@
+#ifndef _ASM_I386_FTRACE_H
+#define _ASM_I386_FTRACE_H
+
+/* A call to mcount: e8 followed by a 32-bit displacement */
+#define MCOUNT_INSN_SIZE	5
+
+/*
+ * What mcount calls are replaced with when not traced.  It has to be a
+ * single instruction, as a task may be interrupted in the middle of a
+ * multi-instruction nop and resume into the call we put back.  This is
+ * "ds; leal 0(%esi,%eiz,1),%esi", which works on any 386.
+ */
+#define FTRACE_NOP5		{ 0x3e, 0x8d, 0x74, 0x26, 0x00 }
+
+#ifndef __ASSEMBLY__
+extern void mcount(void);
+extern void ftrace_caller(void);
+#endif
+
+#endif /* _ASM_I386_FTRACE_H */
@@ -0,0 +1,48 @@
+#ifndef _ASM_FUTEX_H
+#define _ASM_FUTEX_H
+
+#ifdef __KERNEL__
+
+#include <linux/config.h>
+#include <linux/futex.h>
+#include <asm/errno.h>
+#include <asm/uaccess.h>
+
+/*
+ * Atomically compare and exchange the user-space futex word at @uaddr.
+ * Returns the value found at @uaddr (equal to @oldval on success), or
+ * -EFAULT if the access faulted. Must be called with page faults
+ * disabled (inc_preempt_count()), the caller handles the fault.
+ */
+static inline int
+futex_atomic_cmpxchg_inatomic(int __user *uaddr, int oldval, int newval)
+{
+#ifndef CONFIG_X86_CMPXCHG
+	/* Real i386 machines have no cmpxchg instruction */
+	return -ENOSYS;
+#else
+	if (!access_ok(VERIFY_WRITE, uaddr, sizeof(int)))
+		return -EFAULT;
+
+	__asm__ __volatile__(
+		"1:	lock; cmpxchgl %3, %1			\n"
+		"2:						\n"
+		".section .fixup, \"ax\"			\n"
+		"3:	mov	%2, %0				\n"
+		"	jmp	2b				\n"
+		".previous					\n"
+		".section __ex_table,\"a\"			\n"
+		"	.align	4				\n"
+		"	.long	1b,3b				\n"
+		".previous					\n"
+		: "=a" (oldval), "+m" (*uaddr)
+		: "i" (-EFAULT), "r" (newval), "0" (oldval)
+		: "memory"
+	);
+
+	return oldval;
+#endif
+}
+
+#endif
+#endif
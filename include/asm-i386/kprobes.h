@@ -40,10 +40,37 @@ typedef u8 kprobe_opcode_t;
 
 #define JPROBE_ENTRY(pentry)	(kprobe_opcode_t *)pentry
 
+/* Jump optimization: a relative jump replaces the breakpoint */
+#define RELATIVEJUMP_OPCODE	0xe9
+#define RELATIVEJUMP_SIZE	5
+/* Most bytes of instructions a jump may cover */
+#define MAX_OPTIMIZED_LENGTH	(MAX_INSN_SIZE + RELATIVEJUMP_SIZE)
+/* Detour buffer: template, copied instructions, jump back */
+#define MAX_OPTINSN_SIZE	128
+
 /* Architecture specific copy of original instruction*/
 struct arch_specific_insn {
 	/* copy of the original instruction */
 	kprobe_opcode_t insn[MAX_INSN_SIZE];
+#ifdef CONFIG_OPTPROBES
+	/* detour buffer of an optimized probe, or NULL */
+	kprobe_opcode_t *optinsn;
+	/* bytes of instructions copied to it */
+	int optsize;
+	/* the jump to it is in place */
+	int optimized;
+#endif
+};
+
+/* per-cpu state of the probe being handled */
+struct kprobe_ctlblk {
+	unsigned long kprobe_status;
+	unsigned long kprobe_old_eflags;
+	unsigned long kprobe_saved_eflags;
+	long *jprobe_saved_esp;
+	struct pt_regs jprobe_saved_regs;
+	/* copy of the kernel stack at the probe fire time */
+	kprobe_opcode_t jprobes_stack[MAX_STACK_SIZE];
 };
 
 
@@ -92,6 +92,9 @@ static inline void wrmsrl (unsigned long msr, unsigned long long val)
 #define MSR_P6_EVNTSEL0			0x186
 #define MSR_P6_EVNTSEL1			0x187
 
+/* Architectural performance monitoring, version 2 and later */
+#define MSR_CORE_PERF_GLOBAL_CTRL	0x38f
+
 #define MSR_IA32_PERF_STATUS		0x198
 #define MSR_IA32_PERF_CTL		0x199
 
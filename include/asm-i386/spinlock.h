@@ -6,6 +6,7 @@
 #include <asm/page.h>
 #include <linux/config.h>
 #include <linux/compiler.h>
+#include <linux/lockstat.h>
 
 asmlinkage int printk(const char * fmt, ...)
 	__attribute__ ((format (printf, 1, 2)));
@@ -29,6 +30,9 @@ typedef struct {
 	 */
 	unsigned int break_lock;
 #endif
+#ifdef CONFIG_LOCK_STAT
+	struct lock_stat_map stat_map;
+#endif
 } spinlock_t;
 
 #define SPINLOCK_MAGIC	0xdead4ead
@@ -39,18 +43,124 @@ typedef struct {
 #define SPINLOCK_MAGIC_INIT	/* */
 #endif
 
-#define SPIN_LOCK_UNLOCKED (spinlock_t) { 1 SPINLOCK_MAGIC_INIT }
+#ifdef CONFIG_X86_XADD
+#define SPINLOCK_UNLOCKED_VALUE	0	/* Ticket lock: owner == next */
+#else
+#define SPINLOCK_UNLOCKED_VALUE	1
+#endif
+
+#define SPIN_LOCK_UNLOCKED (spinlock_t) { SPINLOCK_UNLOCKED_VALUE SPINLOCK_MAGIC_INIT }
 
 /**
  * Ϊ1δ
  */
-#define spin_lock_init(x)	do { *(x) = SPIN_LOCK_UNLOCKED; } while(0)
+#define spin_lock_init(x)					\
+	do {							\
+		*(x) = SPIN_LOCK_UNLOCKED;			\
+		lock_stat_init_map(&(x)->stat_map, #x);		\
+	} while(0)
 
 /*
  * Simple spin lock operations.  There are two variants, one clears IRQ's
  * on the local processor, one does not.
- *
- * We make no fairness assumptions. They have a cost.
+ */
+
+#ifdef CONFIG_X86_XADD
+
+/*
+ * Ticket spinlocks.  The low byte of slock is the ticket being served,
+ * the high byte the next ticket to hand out.  A locker takes a ticket
+ * with a single xadd and then only reads the lock word until its
+ * number comes up, so the lock is handed out in FIFO order and a
+ * release causes one cacheline transfer per waiter rather than a storm
+ * of failed locked decrements.  A byte per ticket is enough as long as
+ * NR_CPUS stays below 256.
+ */
+
+static inline int spin_is_locked(spinlock_t *lock)
+{
+	unsigned int tmp = *(volatile unsigned int *)&lock->slock;
+
+	return ((tmp >> 8) ^ tmp) & 0xff;
+}
+
+#define spin_unlock_wait(x)	do { barrier(); } while(spin_is_locked(x))
+
+static inline void _raw_spin_lock(spinlock_t *lock)
+{
+	short inc = 0x0100;
+
+#ifdef CONFIG_DEBUG_SPINLOCK
+	if (unlikely(lock->magic != SPINLOCK_MAGIC)) {
+		printk("eip: %p\n", __builtin_return_address(0));
+		BUG();
+	}
+#endif
+	__asm__ __volatile__(
+		"lock ; xaddw %w0, %1\n"
+		"1:\t"
+		"cmpb %h0, %b0\n\t"
+		"je 2f\n\t"
+		"rep ; nop\n\t"
+		"movb %1, %b0\n\t"
+		"jmp 1b\n"
+		"2:"
+		:"+Q" (inc), "+m" (lock->slock) : : "memory", "cc");
+}
+
+/*
+ * The old lock re-enabled interrupts while spinning.  A ticket holder
+ * must not: an interrupt handler taking the same lock would queue
+ * behind our ticket and never let us be served.
+ */
+#define _raw_spin_lock_flags(lock, flags)	_raw_spin_lock(lock)
+
+static inline int _raw_spin_trylock(spinlock_t *lock)
+{
+	int tmp;
+	short new;
+
+	__asm__ __volatile__(
+		"movw %2, %w0\n\t"
+		"cmpb %h0, %b0\n\t"
+		"jne 1f\n\t"
+		"movw %w0, %w1\n\t"
+		"incb %h1\n\t"
+		"lock ; cmpxchgw %w1, %2\n"
+		"1:\t"
+		"sete %b1\n\t"
+		"movzbl %b1, %0"
+		:"=&a" (tmp), "=Q" (new), "+m" (lock->slock) : : "memory", "cc");
+	return tmp;
+}
+
+/*
+ * Only the owner writes the low byte, so the release needs no lock
+ * prefix, except where stores may pass earlier loads (PPro errata
+ * 66, 92, and OOSTORE).
+ */
+#if !defined(CONFIG_X86_OOSTORE) && !defined(CONFIG_X86_PPRO_FENCE)
+#define spin_unlock_prefix	""
+#else
+#define spin_unlock_prefix	"lock ; "
+#endif
+
+static inline void _raw_spin_unlock(spinlock_t *lock)
+{
+#ifdef CONFIG_DEBUG_SPINLOCK
+	BUG_ON(lock->magic != SPINLOCK_MAGIC);
+	BUG_ON(!spin_is_locked(lock));
+#endif
+	__asm__ __volatile__(
+		spin_unlock_prefix "incb %0"
+		:"+m" (lock->slock) : : "memory", "cc");
+}
+
+#else /* !CONFIG_X86_XADD */
+
+/*
+ * The 386 has no xadd; it gets the test-and-decrement lock, which makes
+ * no fairness assumptions.
  */
 
 /**
@@ -187,6 +297,8 @@ static inline void _raw_spin_lock_flags (spinlock_t *lock, unsigned long flags)
 		:"=m" (lock->slock) : "r" (flags) : "memory");
 }
 
+#endif /* CONFIG_X86_XADD */
+
 /*
  * Read-write spinlocks, allowing multiple readers
  * but only one writer.
@@ -221,6 +333,9 @@ typedef struct {
 	 */
 	unsigned int break_lock;
 #endif
+#ifdef CONFIG_LOCK_STAT
+	struct lock_stat_map stat_map;
+#endif
 } rwlock_t;
 
 #define RWLOCK_MAGIC	0xdeaf1eed
@@ -236,7 +351,11 @@ typedef struct {
  */
 #define RW_LOCK_UNLOCKED (rwlock_t) { RW_LOCK_BIAS RWLOCK_MAGIC_INIT }
 
-#define rwlock_init(x)	do { *(x) = RW_LOCK_UNLOCKED; } while(0)
+#define rwlock_init(x)						\
+	do {							\
+		*(x) = RW_LOCK_UNLOCKED;			\
+		lock_stat_init_map(&(x)->stat_map, #x);		\
+	} while(0)
 
 /**
  * read_can_lock - would read_trylock() succeed?
@@ -499,17 +499,17 @@ struct alt_instr {
 /**
  * ָeflagsֵ
  */
-#define local_irq_restore(x) 	do { typecheck(unsigned long,x); __asm__ __volatile__("pushl %0 ; popfl": /* no output */ :"g" (x):"memory", "cc"); } while (0)
+#define raw_local_irq_restore(x) 	do { typecheck(unsigned long,x); __asm__ __volatile__("pushl %0 ; popfl": /* no output */ :"g" (x):"memory", "cc"); } while (0)
 /**
  * ñжϡ
  */
-#define local_irq_disable() 	__asm__ __volatile__("cli": : :"memory")
+#define raw_local_irq_disable() 	__asm__ __volatile__("cli": : :"memory")
 /**
  * 򿪱رյжϡ
  */
-#define local_irq_enable()	__asm__ __volatile__("sti": : :"memory")
+#define raw_local_irq_enable()	__asm__ __volatile__("sti": : :"memory")
 /* used in the idle loop; sti takes one instruction cycle to complete */
-#define safe_halt()		__asm__ __volatile__("sti; hlt": : :"memory")
+#define raw_safe_halt()		__asm__ __volatile__("sti; hlt": : :"memory")
 
 #define irqs_disabled()			\
 ({					\
@@ -522,7 +522,59 @@ struct alt_instr {
 /**
  * eflagsֵرжϡ
  */
-#define local_irq_save(x)	__asm__ __volatile__("pushfl ; popl %0 ; cli":"=g" (x): /* no input */ :"memory")
+#define raw_local_irq_save(x)	__asm__ __volatile__("pushfl ; popl %0 ; cli":"=g" (x): /* no input */ :"memory")
+
+#define irqs_disabled_flags(flags)	(!((flags) & (1<<9)))
+
+#ifdef CONFIG_IRQSOFF_TRACER
+/*
+ * Tell the irqsoff latency tracer when interrupts go off and back on.
+ * Only actual transitions are reported.  The tracer itself, and code
+ * that must not be traced, use the raw_ versions.
+ */
+extern void trace_hardirqs_on(void);
+extern void trace_hardirqs_off(void);
+
+#define local_irq_disable()						\
+	do {								\
+		unsigned long __flags;					\
+		local_save_flags(__flags);				\
+		raw_local_irq_disable();				\
+		if (!irqs_disabled_flags(__flags))			\
+			trace_hardirqs_off();				\
+	} while (0)
+#define local_irq_enable()						\
+	do {								\
+		if (irqs_disabled())					\
+			trace_hardirqs_on();				\
+		raw_local_irq_enable();					\
+	} while (0)
+#define local_irq_save(x)						\
+	do {								\
+		raw_local_irq_save(x);					\
+		if (!irqs_disabled_flags(x))				\
+			trace_hardirqs_off();				\
+	} while (0)
+#define local_irq_restore(x)						\
+	do {								\
+		if (!irqs_disabled_flags(x) && irqs_disabled())		\
+			trace_hardirqs_on();				\
+		raw_local_irq_restore(x);				\
+	} while (0)
+#define safe_halt()							\
+	do {								\
+		trace_hardirqs_on();					\
+		raw_safe_halt();					\
+	} while (0)
+#else
+#define trace_hardirqs_on()		do { } while (0)
+#define trace_hardirqs_off()		do { } while (0)
+#define local_irq_disable()		raw_local_irq_disable()
+#define local_irq_enable()		raw_local_irq_enable()
+#define local_irq_save(x)		raw_local_irq_save(x)
+#define local_irq_restore(x)		raw_local_irq_restore(x)
+#define safe_halt()			raw_safe_halt()
+#endif /* CONFIG_IRQSOFF_TRACER */
 
 /*
  * disable hlt during certain critical i/o operations
@@ -294,8 +294,13 @@
 #define __NR_add_key		286
 #define __NR_request_key	287
 #define __NR_keyctl		288
+#define __NR_set_robust_list	289
+#define __NR_get_robust_list	290
+#define __NR_sched_setattr	291
+#define __NR_sched_getattr	292
+#define __NR_perf_counter_open	293
 
-#define NR_syscalls 289
+#define NR_syscalls 294
 
 /*
  * user-visible error numbers are in the range -1 - -128: see
@@ -0,0 +1,20 @@
+#ifndef _ASM_X86_64_FTRACE_H
+#define _ASM_X86_64_FTRACE_H
+
+/* A call to mcount: e8 followed by a 32-bit displacement */
+#define MCOUNT_INSN_SIZE	5
+
+/*
+ * What mcount calls are replaced with when not traced: a single
+ * instruction, as a task may be interrupted in the middle of a
+ * multi-instruction nop and resume into the call we put back.  This is
+ * "nopl 0(%rax,%rax,1)", which all x86-64 cpus have.
+ */
+#define FTRACE_NOP5		{ 0x0f, 0x1f, 0x44, 0x00, 0x00 }
+
+#ifndef __ASSEMBLY__
+extern void mcount(void);
+extern void ftrace_caller(void);
+#endif
+
+#endif /* _ASM_X86_64_FTRACE_H */
@@ -45,6 +45,17 @@ struct arch_specific_insn {
 	kprobe_opcode_t *insn;
 };
 
+/* per-cpu state of the probe being handled */
+struct kprobe_ctlblk {
+	unsigned long kprobe_status;
+	unsigned long kprobe_old_rflags;
+	unsigned long kprobe_saved_rflags;
+	long *jprobe_saved_rsp;
+	struct pt_regs jprobe_saved_regs;
+	/* copy of the kernel stack at the probe fire time */
+	kprobe_opcode_t jprobes_stack[MAX_STACK_SIZE];
+};
+
 /* trap3/1 are intr gates for kprobes.  So, restore the status of IF,
  * if necessary, before executing the original int3/1 (trap) handler.
  */
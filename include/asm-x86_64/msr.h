@@ -267,6 +267,9 @@ extern inline unsigned int cpuid_edx(unsigned int op)
 #define MSR_P6_EVNTSEL0			0x186
 #define MSR_P6_EVNTSEL1			0x187
 
+/* Architectural performance monitoring, version 2 and later */
+#define MSR_CORE_PERF_GLOBAL_CTRL	0x38f
+
 #define MSR_IA32_PERF_STATUS		0x198
 #define MSR_IA32_PERF_CTL		0x199
 
@@ -5,6 +5,7 @@
 #include <asm/rwlock.h>
 #include <asm/page.h>
 #include <linux/config.h>
+#include <linux/lockstat.h>
 
 extern int printk(const char * fmt, ...)
 	__attribute__ ((format (printf, 1, 2)));
@@ -21,6 +22,9 @@ typedef struct {
 #ifdef CONFIG_PREEMPT
 	unsigned int break_lock;
 #endif
+#ifdef CONFIG_LOCK_STAT
+	struct lock_stat_map stat_map;
+#endif
 } spinlock_t;
 
 #define SPINLOCK_MAGIC	0xdead4ead
@@ -33,7 +37,11 @@ typedef struct {
 
 #define SPIN_LOCK_UNLOCKED (spinlock_t) { 1 SPINLOCK_MAGIC_INIT }
 
-#define spin_lock_init(x)	do { *(x) = SPIN_LOCK_UNLOCKED; } while(0)
+#define spin_lock_init(x)					\
+	do {							\
+		*(x) = SPIN_LOCK_UNLOCKED;			\
+		lock_stat_init_map(&(x)->stat_map, #x);		\
+	} while(0)
 
 /*
  * Simple spin lock operations.  There are two variants, one clears IRQ's
@@ -145,6 +153,9 @@ typedef struct {
 #ifdef CONFIG_PREEMPT
 	unsigned int break_lock;
 #endif
+#ifdef CONFIG_LOCK_STAT
+	struct lock_stat_map stat_map;
+#endif
 } rwlock_t;
 
 #define RWLOCK_MAGIC	0xdeaf1eed
@@ -157,7 +168,11 @@ typedef struct {
 
 #define RW_LOCK_UNLOCKED (rwlock_t) { RW_LOCK_BIAS RWLOCK_MAGIC_INIT }
 
-#define rwlock_init(x)	do { *(x) = RW_LOCK_UNLOCKED; } while(0)
+#define rwlock_init(x)						\
+	do {							\
+		*(x) = RW_LOCK_UNLOCKED;			\
+		lock_stat_init_map(&(x)->stat_map, #x);		\
+	} while(0)
 
 #define read_can_lock(x)	((int)(x)->lock > 0)
 #define write_can_lock(x)	((x)->lock == RW_LOCK_BIAS)
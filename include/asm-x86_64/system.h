@@ -310,11 +310,11 @@ static inline unsigned long __cmpxchg(volatile void *ptr, unsigned long old,
 
 /* interrupt control.. */
 #define local_save_flags(x)	do { warn_if_not_ulong(x); __asm__ __volatile__("# save_flags \n\t pushfq ; popq %q0":"=g" (x): /* no input */ :"memory"); } while (0)
-#define local_irq_restore(x) 	__asm__ __volatile__("# restore_flags \n\t pushq %0 ; popfq": /* no output */ :"g" (x):"memory", "cc")
-#define local_irq_disable() 	__asm__ __volatile__("cli": : :"memory")
-#define local_irq_enable()	__asm__ __volatile__("sti": : :"memory")
+#define raw_local_irq_restore(x) 	__asm__ __volatile__("# restore_flags \n\t pushq %0 ; popfq": /* no output */ :"g" (x):"memory", "cc")
+#define raw_local_irq_disable() 	__asm__ __volatile__("cli": : :"memory")
+#define raw_local_irq_enable()	__asm__ __volatile__("sti": : :"memory")
 /* used in the idle loop; sti takes one instruction cycle to complete */
-#define safe_halt()		__asm__ __volatile__("sti; hlt": : :"memory")
+#define raw_safe_halt()		__asm__ __volatile__("sti; hlt": : :"memory")
 
 #define irqs_disabled()			\
 ({					\
@@ -324,10 +324,62 @@ static inline unsigned long __cmpxchg(volatile void *ptr, unsigned long old,
 })
 
 /* For spinlocks etc */
-#define local_irq_save(x) 	do { warn_if_not_ulong(x); __asm__ __volatile__("# local_irq_save \n\t pushfq ; popq %0 ; cli":"=g" (x): /* no input */ :"memory"); } while (0)
+#define raw_local_irq_save(x) 	do { warn_if_not_ulong(x); __asm__ __volatile__("# local_irq_save \n\t pushfq ; popq %0 ; cli":"=g" (x): /* no input */ :"memory"); } while (0)
 
 void cpu_idle_wait(void);
 
+#define irqs_disabled_flags(flags)	(!((flags) & (1<<9)))
+
+#ifdef CONFIG_IRQSOFF_TRACER
+/*
+ * Tell the irqsoff latency tracer when interrupts go off and back on.
+ * Only actual transitions are reported.  The tracer itself, and code
+ * that must not be traced, use the raw_ versions.
+ */
+extern void trace_hardirqs_on(void);
+extern void trace_hardirqs_off(void);
+
+#define local_irq_disable()						\
+	do {								\
+		unsigned long __flags;					\
+		local_save_flags(__flags);				\
+		raw_local_irq_disable();				\
+		if (!irqs_disabled_flags(__flags))			\
+			trace_hardirqs_off();				\
+	} while (0)
+#define local_irq_enable()						\
+	do {								\
+		if (irqs_disabled())					\
+			trace_hardirqs_on();				\
+		raw_local_irq_enable();					\
+	} while (0)
+#define local_irq_save(x)						\
+	do {								\
+		raw_local_irq_save(x);					\
+		if (!irqs_disabled_flags(x))				\
+			trace_hardirqs_off();				\
+	} while (0)
+#define local_irq_restore(x)						\
+	do {								\
+		if (!irqs_disabled_flags(x) && irqs_disabled())		\
+			trace_hardirqs_on();				\
+		raw_local_irq_restore(x);				\
+	} while (0)
+#define safe_halt()							\
+	do {								\
+		trace_hardirqs_on();					\
+		raw_safe_halt();					\
+	} while (0)
+#else
+#define trace_hardirqs_on()		do { } while (0)
+#define trace_hardirqs_off()		do { } while (0)
+#define local_irq_disable()		raw_local_irq_disable()
+#define local_irq_enable()		raw_local_irq_enable()
+#define local_irq_save(x)		raw_local_irq_save(x)
+#define local_irq_restore(x)		raw_local_irq_restore(x)
+#define safe_halt()			raw_safe_halt()
+#endif /* CONFIG_IRQSOFF_TRACER */
+
 /*
  * disable hlt during certain critical i/o operations
  */
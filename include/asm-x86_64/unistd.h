@@ -563,8 +563,18 @@ __SYSCALL(__NR_add_key, sys_add_key)
 __SYSCALL(__NR_request_key, sys_request_key)
 #define __NR_keyctl		250
 __SYSCALL(__NR_keyctl, sys_keyctl)
-
-#define __NR_syscall_max __NR_keyctl
+#define __NR_set_robust_list	251
+__SYSCALL(__NR_set_robust_list, sys_set_robust_list)
+#define __NR_get_robust_list	252
+__SYSCALL(__NR_get_robust_list, sys_get_robust_list)
+#define __NR_sched_setattr	253
+__SYSCALL(__NR_sched_setattr, sys_sched_setattr)
+#define __NR_sched_getattr	254
+__SYSCALL(__NR_sched_getattr, sys_sched_getattr)
+#define __NR_perf_counter_open	255
+__SYSCALL(__NR_perf_counter_open, sys_perf_counter_open)
+
+#define __NR_syscall_max __NR_perf_counter_open
 #ifndef __NO_STUBS
 
 /* user-visible error numbers are in the range -1 - -4095 */
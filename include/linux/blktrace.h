@@ -0,0 +1,54 @@
+#ifndef _LINUX_BLKTRACE_H
+#define _LINUX_BLKTRACE_H
+
+/*
+ * Block I/O tracing: what happens to the I/O of a request queue, from
+ * the bio being queued to the request completing.
+ *
+ * Each block_* event of the tracing directory in debugfs records a
+ * struct blk_io_trace into the trace buffer.  Its time stamp and cpu
+ * are those of the buffer (see linux/ring_buffer.h), so the binary
+ * stream of a cpu is read from per_cpu/cpuN/trace_pipe_raw.
+ *
+ * Events are only recorded for the queues whose queue/trace attribute
+ * in sysfs has been set to 1.
+ */
+
+#include <linux/types.h>
+
+#define BLK_IO_TRACE_MAGIC	0x65617400
+#define BLK_IO_TRACE_VERSION	1
+
+/* What happened, see blk_io_trace.action */
+enum {
+	BLK_TA_QUEUE = 1,	/* A bio is queued */
+	BLK_TA_BACKMERGE,	/* It was merged at the back of a request */
+	BLK_TA_FRONTMERGE,	/* It was merged at the front of a request */
+	BLK_TA_GETRQ,		/* A request was allocated for it */
+	BLK_TA_SLEEPRQ,		/* No request was free, it waits for one */
+	BLK_TA_INSERT,		/* A request is given to the io scheduler */
+	BLK_TA_ISSUE,		/* It is handed to the driver */
+	BLK_TA_COMPLETE,	/* Some or all of it completed */
+	BLK_TA_REQUEUE,		/* The driver gave it back */
+};
+
+/* blk_io_trace.rw */
+#define BLK_TC_WRITE		(1 << 0)	/* Otherwise a read */
+#define BLK_TC_SYNC		(1 << 1)
+#define BLK_TC_BARRIER		(1 << 2)
+#define BLK_TC_AHEAD		(1 << 3)	/* Read-ahead, or failfast */
+#define BLK_TC_PC		(1 << 4)	/* Not a filesystem request */
+
+struct blk_io_trace {
+	__u32	magic;		/* BLK_IO_TRACE_MAGIC | BLK_IO_TRACE_VERSION */
+	__u16	action;		/* BLK_TA_* */
+	__u16	rw;		/* BLK_TC_* */
+	__u64	sector;
+	__u32	bytes;
+	__s32	error;		/* Of completions */
+	__u32	device;		/* Of the queue: major << 20 | minor */
+	__u32	pid;		/* Current when the event happened */
+	char	comm[16];
+};
+
+#endif /* _LINUX_BLKTRACE_H */
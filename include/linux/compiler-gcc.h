@@ -15,3 +15,6 @@
   ({ unsigned long __ptr;					\
     __asm__ ("" : "=g"(__ptr) : "0"(ptr));		\
     (typeof(ptr)) (__ptr + (off)); })
+
+/* No mcount call for the function tracer, which relies on gcc -pg */
+#define notrace __attribute__((no_instrument_function))
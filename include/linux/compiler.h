@@ -148,4 +148,8 @@ extern void __chk_io_ptr(void __iomem *);
 #define __always_inline inline
 #endif
 
+#ifndef notrace
+#define notrace
+#endif
+
 #endif /* __LINUX_COMPILER_H */
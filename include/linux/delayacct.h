@@ -0,0 +1,38 @@
+#ifndef _LINUX_DELAYACCT_H
+#define _LINUX_DELAYACCT_H
+
+/*
+ * Per-task delay accounting: how long tasks wait for block I/O and
+ * for swap-in, see kernel/delayacct.c.  Waiting for a cpu is counted
+ * by the scheduler's sched_info.
+ */
+
+#include <linux/config.h>
+#include <linux/sched.h>
+
+/* task_delay_info.flags: what the current block I/O wait is for */
+#define DELAYACCT_PF_SWAPIN	0x00000001
+
+#ifdef CONFIG_TASK_DELAY_ACCT
+extern void delayacct_init(struct task_delay_info *d);
+/* Bracket the sleep of an io_schedule() */
+extern void delayacct_blkio_start(void);
+extern void delayacct_blkio_end(void);
+
+static inline void delayacct_set_flag(int flag)
+{
+	current->delays.flags |= flag;
+}
+
+static inline void delayacct_clear_flag(int flag)
+{
+	current->delays.flags &= ~flag;
+}
+#else
+static inline void delayacct_set_flag(int flag)		{ }
+static inline void delayacct_clear_flag(int flag)	{ }
+static inline void delayacct_blkio_start(void)		{ }
+static inline void delayacct_blkio_end(void)		{ }
+#endif
+
+#endif /* _LINUX_DELAYACCT_H */
@@ -266,6 +266,7 @@ extern int dir_notify_enable;
 #include <linux/prio_tree.h>
 #include <linux/audit.h>
 #include <linux/init.h>
+#include <linux/mutex.h>
 
 #include <asm/atomic.h>
 #include <asm/semaphore.h>
@@ -746,7 +747,7 @@ struct inode {
 	/**
 	 * ڵź
 	 */
-	struct semaphore	i_sem;
+	struct mutex		i_mutex;
 	/**
 	 * ֱIOļб־Ķдź
 	 */
@@ -2040,7 +2041,7 @@ int sync_inode(struct inode *inode, struct writeback_control *wbc);
  *    The name should be stored in the @name (with the understanding that it is already
  *    pointing to a a %NAME_MAX+1 sized buffer.   get_name() should return %0 on success,
  *    a negative error code or error.
- *    @get_name will be called without @parent->i_sem held.
+ *    @get_name will be called without @parent->i_mutex held.
  *
  * get_parent:
  *    @get_parent should find the parent directory for the given @child which is also
@@ -2061,7 +2062,7 @@ int sync_inode(struct inode *inode, struct writeback_control *wbc);
  *    @obj or @parent parameters.
  *
  * Locking rules:
- *  get_parent is called with child->d_inode->i_sem down
+ *  get_parent is called with child->d_inode->i_mutex down
  *  get_name is not (which is possibly inconsistent)
  */
 
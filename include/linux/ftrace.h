@@ -0,0 +1,63 @@
+#ifndef _LINUX_FTRACE_H
+#define _LINUX_FTRACE_H
+
+/*
+ * Function tracer (CONFIG_FUNCTION_TRACER), see kernel/trace/ftrace.c,
+ * and the scheduler's hooks for the wakeup latency tracer.
+ */
+
+#include <linux/config.h>
+#include <linux/linkage.h>
+
+typedef void (fastcall *ftrace_func_t)(unsigned long ip,
+				       unsigned long parent_ip);
+
+#ifdef CONFIG_FUNCTION_TRACER
+
+#include <asm/ftrace.h>
+
+/*
+ * Called from ftrace_caller with the address of the mcount call in the
+ * traced function and the address the function will return to.
+ */
+extern ftrace_func_t ftrace_trace_function;
+extern void fastcall ftrace_stub(unsigned long ip, unsigned long parent_ip);
+
+/*
+ * Arch code: does @ip hold a call to @addr, and rewrite such a call
+ * into a nop and back.  The rewriting verifies the old instruction and
+ * fails with -EINVAL if it is not what is expected.
+ */
+extern int ftrace_is_call(unsigned long ip, unsigned long addr);
+extern int ftrace_make_nop(unsigned long ip, unsigned long addr);
+extern int ftrace_make_call(unsigned long ip, unsigned long addr);
+
+extern void ftrace_init(void);
+
+#else
+
+static inline void ftrace_init(void)
+{
+}
+
+#endif /* CONFIG_FUNCTION_TRACER */
+
+struct task_struct;
+
+/* Wakeup latency tracer hooks in the scheduler, with the rq lock held */
+#ifdef CONFIG_SCHED_TRACER
+extern void trace_latency_wakeup(struct task_struct *p);
+extern void trace_latency_switch(struct task_struct *prev,
+				 struct task_struct *next);
+#else
+static inline void trace_latency_wakeup(struct task_struct *p)
+{
+}
+
+static inline void trace_latency_switch(struct task_struct *prev,
+					struct task_struct *next)
+{
+}
+#endif
+
+#endif /* _LINUX_FTRACE_H */
@@ -1,6 +1,8 @@
 #ifndef _LINUX_FUTEX_H
 #define _LINUX_FUTEX_H
 
+struct task_struct;
+
 /* Second argument to futex syscall */
 
 
@@ -9,9 +11,92 @@
 #define FUTEX_FD (2)
 #define FUTEX_REQUEUE (3)
 #define FUTEX_CMP_REQUEUE (4)
+#define FUTEX_LOCK_PI (6)
+#define FUTEX_UNLOCK_PI (7)
+#define FUTEX_TRYLOCK_PI (8)
+
+/*
+ * Or'ed into the op: the futex is only used by threads of one process,
+ * so the kernel keys it on (mm, address) and skips mmap_sem, the VMA
+ * lookup and the page lookup for shared mappings.
+ */
+#define FUTEX_PRIVATE_FLAG	128
+#define FUTEX_CMD_MASK		~FUTEX_PRIVATE_FLAG
+
+#define FUTEX_WAIT_PRIVATE	(FUTEX_WAIT | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAKE_PRIVATE	(FUTEX_WAKE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_REQUEUE_PRIVATE	(FUTEX_REQUEUE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_CMP_REQUEUE_PRIVATE (FUTEX_CMP_REQUEUE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_LOCK_PI_PRIVATE	(FUTEX_LOCK_PI | FUTEX_PRIVATE_FLAG)
+#define FUTEX_UNLOCK_PI_PRIVATE	(FUTEX_UNLOCK_PI | FUTEX_PRIVATE_FLAG)
+#define FUTEX_TRYLOCK_PI_PRIVATE (FUTEX_TRYLOCK_PI | FUTEX_PRIVATE_FLAG)
+
+/*
+ * Support for robust futexes: the kernel cleans up held futexes at
+ * thread exit time.
+ */
+
+/*
+ * Per-lock list entry - embedded in user-space locks, somewhere close
+ * to the futex field. (Note: user-space uses a double-linked list to
+ * achieve O(1) list add and remove, but the kernel only needs to know
+ * about the forward link)
+ */
+struct robust_list {
+	struct robust_list __user *next;
+};
+
+/*
+ * Per-thread list head, registered with sys_set_robust_list():
+ */
+struct robust_list_head {
+	/*
+	 * The head of the list. Points back to itself if empty:
+	 */
+	struct robust_list list;
+
+	/*
+	 * Relative offset from a list entry to the futex field:
+	 */
+	long futex_offset;
+
+	/*
+	 * The lock userspace is about to acquire or release. It is not
+	 * on the list yet (or any more), but must still be cleaned up if
+	 * the thread dies in between.
+	 */
+	struct robust_list __user *list_op_pending;
+};
+
+/*
+ * Layout of the futex word for PI and robust futexes: the TID of the
+ * owner in the low bits, plus two flags.
+ */
+
+/* Set when there are waiters in the kernel: unlock must enter the kernel */
+#define FUTEX_WAITERS		0x80000000
+
+/* Set by the kernel when the owner died without unlocking */
+#define FUTEX_OWNER_DIED	0x40000000
+
+#define FUTEX_TID_MASK		0x3fffffff
+
+/*
+ * Bound on the number of robust list entries walked at exit, to
+ * protect against circular lists constructed by userspace.
+ */
+#define ROBUST_LIST_LIMIT	2048
 
 long do_futex(unsigned long uaddr, int op, int val,
 		unsigned long timeout, unsigned long uaddr2, int val2,
 		int val3);
 
+#ifdef CONFIG_FUTEX
+extern void exit_robust_list(struct task_struct *curr);
+extern void exit_pi_state_list(struct task_struct *curr);
+#else
+static inline void exit_robust_list(struct task_struct *curr) { }
+static inline void exit_pi_state_list(struct task_struct *curr) { }
+#endif
+
 #endif
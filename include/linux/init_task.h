@@ -62,6 +62,14 @@
 
 extern struct group_info init_groups;
 
+#ifdef CONFIG_FUTEX
+#define INIT_FUTEX(tsk)							\
+	.robust_list	= NULL,						\
+	.pi_state_list	= LIST_HEAD_INIT(tsk.pi_state_list),
+#else
+#define INIT_FUTEX(tsk)
+#endif
+
 /*
  *  INIT_TASK is used to set up the first task table, touch at
  * your own risk!. Base=0, limit=0x1fffff (=2MB)
@@ -115,6 +123,9 @@ extern struct group_info init_groups;
 	.proc_lock	= SPIN_LOCK_UNLOCKED,				\
 	.switch_lock	= SPIN_LOCK_UNLOCKED,				\
 	.journal_info	= NULL,						\
+	.pi_waiters	= LIST_HEAD_INIT(tsk.pi_waiters),		\
+	.pi_prio	= MAX_PRIO,					\
+	INIT_FUTEX(tsk)							\
 }
 
 
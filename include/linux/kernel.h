@@ -104,6 +104,7 @@ extern int session_of_pgrp(int pgrp);
 asmlinkage int vprintk(const char *fmt, va_list args);
 asmlinkage int printk(const char * fmt, ...)
 	__attribute__ ((format (printf, 1, 2)));
+extern void printk_tick(void);
 
 unsigned long int_sqrt(unsigned long);
 
@@ -30,6 +30,7 @@
 #include <linux/list.h>
 #include <linux/notifier.h>
 #include <linux/smp.h>
+#include <linux/percpu.h>
 #include <asm/kprobes.h>
 
 struct kprobe;
@@ -65,6 +66,9 @@ struct kprobe {
 
 	/* copy of the original instruction */
 	struct arch_specific_insn ainsn;
+
+	/* Per-cpu hit counts, see kprobe_hits() */
+	unsigned long *nhit;
 };
 
 /*
@@ -83,15 +87,23 @@ struct jprobe {
 };
 
 #ifdef CONFIG_KPROBES
-/* Locks kprobe: irq must be disabled */
-void lock_kprobes(void);
-void unlock_kprobes(void);
+DECLARE_PER_CPU(struct kprobe *, current_kprobe);
 
 /* kprobe running now on this CPU? */
 static inline int kprobe_running(void)
 {
-	extern unsigned int kprobe_cpu;
-	return kprobe_cpu == smp_processor_id();
+	return __get_cpu_var(current_kprobe) != NULL;
+}
+
+static inline void reset_current_kprobe(void)
+{
+	__get_cpu_var(current_kprobe) = NULL;
+}
+
+/* Called by the handlers, with preemption disabled */
+static inline void kprobe_count_hit(struct kprobe *p)
+{
+	(*per_cpu_ptr(p->nhit, smp_processor_id()))++;
 }
 
 extern int arch_prepare_kprobe(struct kprobe *p);
@@ -99,11 +111,38 @@ extern void arch_copy_kprobe(struct kprobe *p);
 extern void arch_remove_kprobe(struct kprobe *p);
 extern void show_registers(struct pt_regs *regs);
 
-/* Get the kprobe at this addr (if any).  Must have called lock_kprobes */
+extern kprobe_opcode_t *get_insn_slot(void);
+extern void free_insn_slot(kprobe_opcode_t *slot);
+
+#ifdef CONFIG_OPTPROBES
+/*
+ * Jump optimization.  arch_prepare_optimized_kprobe() sets up a detour
+ * buffer, returning nonzero if the probed instructions cannot be moved
+ * there; from then on breakpoint hits resume in the detour buffer.
+ * arch_optimize_kprobe() replaces the breakpoint with a jump to it, and
+ * arch_unoptimize_kprobe() puts the breakpoint back, after which the
+ * buffer may still be in use until a synchronize_kernel().
+ */
+extern int arch_prepare_optimized_kprobe(struct kprobe *p);
+extern void arch_optimize_kprobe(struct kprobe *p);
+extern void arch_unoptimize_kprobe(struct kprobe *p);
+extern void arch_remove_optimized_kprobe(struct kprobe *p);
+extern int arch_within_optimized_kprobe(struct kprobe *p,
+					kprobe_opcode_t *addr);
+
+extern kprobe_opcode_t *get_optinsn_slot(void);
+extern void free_optinsn_slot(kprobe_opcode_t *slot);
+#endif
+
+/*
+ * Get the kprobe at this addr (if any).  Lockless: the caller must
+ * keep the probe from going away, see kernel/kprobes.c.
+ */
 struct kprobe *get_kprobe(void *addr);
 
 int register_kprobe(struct kprobe *p);
 void unregister_kprobe(struct kprobe *p);
+unsigned long kprobe_hits(struct kprobe *p);
 int setjmp_pre_handler(struct kprobe *, struct pt_regs *);
 int longjmp_break_handler(struct kprobe *, struct pt_regs *);
 int register_jprobe(struct jprobe *p);
@@ -122,6 +161,10 @@ static inline int register_kprobe(struct kprobe *p)
 static inline void unregister_kprobe(struct kprobe *p)
 {
 }
+static inline unsigned long kprobe_hits(struct kprobe *p)
+{
+	return 0;
+}
 static inline int register_jprobe(struct jprobe *p)
 {
 	return -ENOSYS;
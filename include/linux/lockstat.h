@@ -0,0 +1,73 @@
+#ifndef __LINUX_LOCKSTAT_H
+#define __LINUX_LOCKSTAT_H
+
+/*
+ * Lock statistics (CONFIG_LOCK_STAT), reported in /proc/lock_stat.
+ *
+ * Statistics are kept per lock class.  A spinlock or rwlock set up with
+ * spin_lock_init()/rwlock_init() belongs to the class of that call site,
+ * so e.g. the i_lock of all inodes is counted together.  A statically
+ * initialized lock is a class of its own and is named after its symbol.
+ * Semaphores, rw_semaphores and mutexes are counted per instance, and
+ * only when they have to sleep.
+ *
+ * Included from <asm/spinlock.h>, so it must not pull in anything that
+ * needs spinlock_t.
+ */
+
+#include <linux/config.h>
+
+#define LOCK_STAT_SPIN		0
+#define LOCK_STAT_READ		1
+#define LOCK_STAT_WRITE		2
+#define LOCK_STAT_SEM		3
+#define LOCK_STAT_RWSEM_READ	4
+#define LOCK_STAT_RWSEM_WRITE	5
+#define LOCK_STAT_MUTEX		6
+
+#ifdef CONFIG_LOCK_STAT
+
+struct lock_class;
+
+struct lock_class_key {
+	const char *name;
+};
+
+/* Embedded in spinlock_t and rwlock_t */
+struct lock_stat_map {
+	struct lock_class_key *key;	/* NULL: keyed by the lock's address */
+	struct lock_class *class;	/* Looked up on first acquisition */
+	unsigned long long acquired;	/* When the lock was taken for writing */
+};
+
+#define lock_stat_init_map(map, lockname)				\
+	do {								\
+		static struct lock_class_key __key = { lockname };	\
+		(map)->key = &__key;					\
+	} while (0)
+
+extern unsigned long long lock_stat_clock(void);
+extern void lock_stat_acquired(struct lock_stat_map *map, void *lock,
+			       int type, unsigned long long wait_start,
+			       unsigned long ip);
+extern void lock_stat_released(struct lock_stat_map *map);
+extern void lock_stat_waited(void *lock, int type,
+			     unsigned long long wait_start);
+
+#else
+
+#define lock_stat_init_map(map, lockname)	do { } while (0)
+
+static inline unsigned long long lock_stat_clock(void)
+{
+	return 0;
+}
+
+static inline void lock_stat_waited(void *lock, int type,
+				    unsigned long long wait_start)
+{
+}
+
+#endif /* CONFIG_LOCK_STAT */
+
+#endif /* __LINUX_LOCKSTAT_H */
@@ -0,0 +1,67 @@
+#ifndef __LINUX_MUTEX_H
+#define __LINUX_MUTEX_H
+
+/*
+ * Mutexes: sleeping locks with stricter rules than semaphores.
+ *
+ * Only the task that locked a mutex may unlock it, it may not be
+ * locked recursively, and it may not be used from interrupt context.
+ * In return, a task that finds the mutex held by a task running on
+ * another cpu spins until it is released instead of going to sleep,
+ * on the bet that the owner will be done within a few microseconds.
+ */
+
+#include <linux/config.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/linkage.h>
+#include <asm/atomic.h>
+#include <asm/system.h>
+
+struct thread_info;
+
+struct mutex {
+	/* 1: unlocked, 0: locked, negative: locked, possible waiters */
+	atomic_t		count;
+	spinlock_t		wait_lock;
+	struct list_head	wait_list;
+#ifdef CONFIG_SMP
+	struct thread_info	*owner;		/* For spinning, may be stale */
+#endif
+};
+
+#define __MUTEX_INITIALIZER(lockname)					\
+	{ .count = ATOMIC_INIT(1),					\
+	  .wait_lock = SPIN_LOCK_UNLOCKED,				\
+	  .wait_list = LIST_HEAD_INIT(lockname.wait_list) }
+
+#define DEFINE_MUTEX(mutexname) \
+	struct mutex mutexname = __MUTEX_INITIALIZER(mutexname)
+
+extern void mutex_init(struct mutex *lock);
+
+/**
+ * mutex_is_locked - is the mutex locked
+ * @lock: the mutex to be queried
+ */
+static inline int mutex_is_locked(struct mutex *lock)
+{
+	return atomic_read(&lock->count) != 1;
+}
+
+extern void fastcall mutex_lock(struct mutex *lock);
+extern int fastcall mutex_lock_interruptible(struct mutex *lock);
+extern int fastcall mutex_trylock(struct mutex *lock);
+extern void fastcall mutex_unlock(struct mutex *lock);
+
+/*
+ * Spinning needs cmpxchg, and reads the owner's thread_info, which may
+ * have been freed and, with DEBUG_PAGEALLOC, unmapped under us.
+ */
+#if defined(CONFIG_SMP) && defined(__HAVE_ARCH_CMPXCHG) && \
+    !defined(CONFIG_DEBUG_PAGEALLOC)
+#define MUTEX_SPIN_ON_OWNER
+extern int mutex_spin_on_owner(struct mutex *lock, struct thread_info *owner);
+#endif
+
+#endif /* __LINUX_MUTEX_H */
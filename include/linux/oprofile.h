@@ -68,6 +68,10 @@ void oprofile_add_pc(unsigned long pc, int is_kernel, unsigned long event);
 /* add a backtrace entry, to be called from the ->backtrace callback */
 void oprofile_add_trace(unsigned long eip);
 
+/* the backtrace of a kernel sample goes on into user space: the
+ * following entries are user addresses of the current task */
+void oprofile_trace_user(void);
+
 
 /**
  * Create a file of the given name as a child of the given root, with
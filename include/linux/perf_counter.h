@@ -0,0 +1,235 @@
+#ifndef _LINUX_PERF_COUNTER_H
+#define _LINUX_PERF_COUNTER_H
+
+/*
+ * Performance counters, see kernel/perf_counter.c.
+ *
+ * A counter counts one hardware or software event, either for one task
+ * wherever it runs, or for one cpu whatever runs on it.  It is created
+ * with sys_perf_counter_open(), which returns a file descriptor:
+ * read() returns the count, ioctl() enables, disables and resets it.
+ *
+ * A counter with an irq_period also takes a sample every irq_period
+ * events.  The samples go to a ring buffer that is mmap()ed from the
+ * counter's file: one control page, a struct perf_counter_mmap_page,
+ * followed by a power of 2 number of data pages.  The kernel writes
+ * records at data_head; the reader consumes them up to there and then
+ * moves data_tail along.  Samples that find no room are counted and
+ * reported by a PERF_EVENT_LOST record once there is room again.
+ */
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+enum perf_counter_type {
+	PERF_TYPE_HARDWARE	= 0,	/* config is an enum perf_hw_id */
+	PERF_TYPE_SOFTWARE	= 1,	/* config is an enum perf_sw_id */
+	PERF_TYPE_RAW		= 2,	/* config is the cpu's event select */
+};
+
+enum perf_hw_id {
+	PERF_COUNT_CPU_CYCLES		= 0,
+	PERF_COUNT_INSTRUCTIONS		= 1,
+	PERF_COUNT_CACHE_REFERENCES	= 2,
+	PERF_COUNT_CACHE_MISSES		= 3,
+	PERF_COUNT_BRANCH_INSTRUCTIONS	= 4,
+	PERF_COUNT_BRANCH_MISSES	= 5,
+	PERF_COUNT_BUS_CYCLES		= 6,
+
+	PERF_HW_EVENTS_MAX
+};
+
+enum perf_sw_id {
+	PERF_COUNT_CPU_CLOCK		= 0,	/* ns the counter was running */
+	PERF_COUNT_PAGE_FAULTS		= 1,
+	PERF_COUNT_PAGE_FAULTS_MIN	= 2,
+	PERF_COUNT_PAGE_FAULTS_MAJ	= 3,
+	PERF_COUNT_CONTEXT_SWITCHES	= 4,
+	PERF_COUNT_CPU_MIGRATIONS	= 5,
+
+	PERF_SW_EVENTS_MAX
+};
+
+/* hw_event.flags */
+#define PERF_FLAG_DISABLED		(1 << 0)	/* Created disabled */
+#define PERF_FLAG_EXCLUDE_USER		(1 << 1)
+#define PERF_FLAG_EXCLUDE_KERNEL	(1 << 2)
+
+/* hw_event.sample_type: the fields of a sample record, in this order */
+#define PERF_SAMPLE_IP			(1 << 0)	/* u64 ip */
+#define PERF_SAMPLE_TID			(1 << 1)	/* u32 pid, tid */
+#define PERF_SAMPLE_TIME		(1 << 2)	/* u64 ns */
+#define PERF_SAMPLE_CPU			(1 << 3)	/* u32 cpu, reserved */
+
+/* hw_event.read_format: what read() returns after the u64 count */
+#define PERF_FORMAT_TIME_ENABLED	(1 << 0)	/* u64 ns */
+#define PERF_FORMAT_TIME_RUNNING	(1 << 1)	/* u64 ns */
+
+struct perf_counter_hw_event {
+	__u32	type;		/* enum perf_counter_type */
+	__u32	flags;
+	__u64	config;
+	__u64	irq_period;	/* Events per sample, 0 to only count */
+	__u32	sample_type;
+	__u32	read_format;
+	__u32	wakeup_events;	/* Wake up poll() every so many samples */
+	__u32	__reserved;
+};
+
+#define PERF_COUNTER_IOC_ENABLE		_IO('$', 0)
+#define PERF_COUNTER_IOC_DISABLE	_IO('$', 1)
+#define PERF_COUNTER_IOC_RESET		_IO('$', 2)
+
+#define PERF_COUNTER_MMAP_VERSION	1
+
+struct perf_counter_mmap_page {
+	__u32	version;
+	__u32	compat_version;
+	__u64	data_head;	/* Written by the kernel, rmb() after reading */
+	__u64	data_tail;	/* Written by the reader, mb() before writing */
+};
+
+struct perf_event_header {
+	__u32	type;
+	__u16	misc;
+	__u16	size;		/* Including the header, a multiple of 8 */
+};
+
+enum perf_event_type {
+	PERF_EVENT_SAMPLE	= 1,	/* The hw_event.sample_type fields */
+	PERF_EVENT_LOST		= 2,	/* u64 number of samples dropped */
+};
+
+/* perf_event_header.misc */
+#define PERF_EVENT_MISC_KERNEL		(1 << 0)
+#define PERF_EVENT_MISC_USER		(1 << 1)
+
+#ifdef __KERNEL__
+
+#include <linux/config.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/mutex.h>
+#include <asm/atomic.h>
+
+struct task_struct;
+struct pt_regs;
+
+#ifdef CONFIG_PERF_COUNTERS
+
+enum perf_counter_state {
+	PERF_COUNTER_STATE_OFF		= -1,	/* Disabled */
+	PERF_COUNTER_STATE_INACTIVE	= 0,	/* Enabled, not counting now */
+	PERF_COUNTER_STATE_ACTIVE	= 1,	/* Counting on ->oncpu */
+};
+
+struct hw_perf_counter {
+	u64		config;		/* Event select of hardware counters */
+	int		idx;		/* Hardware counter, -1 if none */
+	u64		prev_count;	/* Raw value at the last update */
+	s64		period_left;	/* Events until the next sample */
+};
+
+struct perf_counter;
+
+/*
+ * enable() puts an INACTIVE counter on the current cpu and may fail
+ * with -EAGAIN if there is no room for it; disable() takes it off
+ * again.  read() brings ->count up to date.  All three are called with
+ * interrupts disabled, on the cpu where the counter runs.
+ */
+struct perf_counter_ops {
+	int	(*enable)(struct perf_counter *counter);
+	void	(*disable)(struct perf_counter *counter);
+	void	(*read)(struct perf_counter *counter);
+};
+
+struct perf_mmap_data {
+	int		nr_pages;	/* Data pages, a power of 2 */
+	unsigned long	head;		/* Where the next record goes */
+	unsigned long	lost;		/* Samples dropped since the last record */
+	unsigned int	events;		/* Samples since the last wakeup */
+	int		wakeup;		/* poll() should be woken up */
+	struct perf_counter_mmap_page *user_page;
+	void		*data_pages[0];
+};
+
+struct perf_counter {
+	struct list_head		list_entry;	/* In ctx->counter_list */
+	struct perf_counter_hw_event	hw_event;
+	const struct perf_counter_ops	*ops;
+	void				(*destroy)(struct perf_counter *);
+	struct hw_perf_counter		hw;
+	struct perf_counter_context	*ctx;
+
+	enum perf_counter_state		state;
+	int				oncpu;
+	u64				count;
+
+	/* Time enabled and time on a cpu, while the context is in */
+	u64				time_enabled;
+	u64				time_running;
+	u64				tstamp;
+
+	wait_queue_head_t		waitq;
+	struct mutex			mmap_mutex;
+	struct perf_mmap_data		*data;
+};
+
+/*
+ * The counters of one task, or of one cpu.  A task's context is
+ * scheduled in on the cpu the task runs on, a cpu's is always in.
+ */
+struct perf_counter_context {
+	spinlock_t		lock;
+	struct list_head	counter_list;
+	int			nr_counters;
+	int			nr_active;
+	int			is_active;
+	int			cpu;		/* Where it is in */
+	struct task_struct	*task;		/* NULL for a cpu's counters */
+};
+
+extern atomic_t perf_swcounter_users;
+
+extern void perf_counter_task_sched_in(struct task_struct *task, int cpu);
+extern void perf_counter_task_sched_out(struct task_struct *task, int cpu);
+extern void perf_counter_task_free(struct task_struct *task);
+extern void perf_counter_tick(struct pt_regs *regs);
+extern void perf_counter_output(struct perf_counter *counter,
+				struct pt_regs *regs);
+
+extern void __perf_swcounter_event(u32 event, u64 nr, struct pt_regs *regs);
+
+/*
+ * Count nr software events; regs, if any, are those of the event,
+ * for exclude_user/kernel and for samples.
+ */
+static inline void perf_swcounter_event(u32 event, u64 nr,
+					struct pt_regs *regs)
+{
+	if (unlikely(atomic_read(&perf_swcounter_users)))
+		__perf_swcounter_event(event, nr, regs);
+}
+
+/* Provided by the architecture: ops for a PERF_TYPE_HARDWARE/RAW counter */
+extern const struct perf_counter_ops *
+hw_perf_counter_init(struct perf_counter *counter);
+
+#else
+
+static inline void
+perf_counter_task_sched_in(struct task_struct *task, int cpu)		{ }
+static inline void
+perf_counter_task_sched_out(struct task_struct *task, int cpu)		{ }
+static inline void perf_counter_task_free(struct task_struct *task)	{ }
+static inline void perf_counter_tick(struct pt_regs *regs)		{ }
+static inline void
+perf_swcounter_event(u32 event, u64 nr, struct pt_regs *regs)		{ }
+
+#endif /* CONFIG_PERF_COUNTERS */
+
+#endif /* __KERNEL__ */
+
+#endif /* _LINUX_PERF_COUNTER_H */
@@ -9,7 +9,7 @@
 #include <linux/config.h>
 #include <linux/linkage.h>
 
-#ifdef CONFIG_DEBUG_PREEMPT
+#if defined(CONFIG_DEBUG_PREEMPT) || defined(CONFIG_PREEMPT_TRACER)
   extern void fastcall add_preempt_count(int val);
   extern void fastcall sub_preempt_count(int val);
 #else
@@ -17,6 +17,12 @@
 # define sub_preempt_count(val)	do { preempt_count() -= (val); } while (0)
 #endif
 
+#ifdef CONFIG_PREEMPT_TRACER
+/* Preemption goes off at @ip and back on, for the preemptoff tracer */
+extern void trace_preempt_off(unsigned long ip);
+extern void trace_preempt_on(unsigned long ip);
+#endif
+
 #define inc_preempt_count() add_preempt_count(1)
 #define dec_preempt_count() sub_preempt_count(1)
 
@@ -0,0 +1,26 @@
+#ifndef _LINUX_PSI_H
+#define _LINUX_PSI_H
+
+/*
+ * Pressure stall information, see kernel/psi.c.
+ */
+
+#include <linux/config.h>
+
+#ifdef CONFIG_PSI
+/* Called by scheduler_tick() with the state of this cpu's runqueue */
+extern void psi_tick(unsigned long nr_running, int nr_iowait);
+
+/*
+ * Bracket a stretch the current task spends reclaiming memory it
+ * needs; pass psi_memstall_enter()'s return to psi_memstall_leave().
+ */
+extern int psi_memstall_enter(void);
+extern void psi_memstall_leave(int cookie);
+#else
+static inline void psi_tick(unsigned long nr_running, int nr_iowait) { }
+static inline int psi_memstall_enter(void) { return 0; }
+static inline void psi_memstall_leave(int cookie) { }
+#endif
+
+#endif /* _LINUX_PSI_H */
@@ -65,6 +65,7 @@ struct rcu_ctrlblk {
 	long	cur;		/* Current batch number.                      */
 	long	completed;	/* Number of the last completed batch         */
 	int	next_pending;	/* Is the next batch already waiting?         */
+	int	wait_readers;	/* All cpus quiet, preempted readers remain   */
 } ____cacheline_maxaligned_in_smp;
 
 /* Is batch a before batch b ? */
@@ -144,14 +145,49 @@ static inline int __rcu_pending(struct rcu_ctrlblk *rcp,
 	if (rdp->quiescbatch != rcp->cur || rdp->qs_pending)
 		return 1;
 
+	/* The batch only waits for preempted readers, poll them */
+	if (rcp->wait_readers)
+		return 1;
+
 	/* nothing to do */
 	return 0;
 }
 
+#ifdef CONFIG_NO_HZ_FULL
+extern int rcu_offload_queued;
+extern int rcu_housekeeping_cpu(int cpu);
+extern void rcu_offload_callbacks(int cpu);
+
+/* Callbacks offloaded by a nohz_full cpu wait for this cpu to adopt them */
+static inline int rcu_offload_pending(int cpu)
+{
+	return unlikely(rcu_offload_queued) && rcu_housekeeping_cpu(cpu);
+}
+#else
+static inline int rcu_offload_pending(int cpu)
+{
+	return 0;
+}
+#endif
+
 static inline int rcu_pending(int cpu)
 {
 	return __rcu_pending(&rcu_ctrlblk, &per_cpu(rcu_data, cpu)) ||
-		__rcu_pending(&rcu_bh_ctrlblk, &per_cpu(rcu_bh_data, cpu));
+		__rcu_pending(&rcu_bh_ctrlblk, &per_cpu(rcu_bh_data, cpu)) ||
+		rcu_offload_pending(cpu);
+}
+
+/*
+ * A cpu with callbacks queued must keep its tick: nobody else would
+ * notice the end of their grace period and invoke them.
+ */
+static inline int rcu_needs_cpu(int cpu)
+{
+	struct rcu_data *rdp = &per_cpu(rcu_data, cpu);
+	struct rcu_data *rdp_bh = &per_cpu(rcu_bh_data, cpu);
+
+	return rdp->curlist || rdp->nxtlist || rdp->donelist ||
+		rdp_bh->curlist || rdp_bh->nxtlist || rdp_bh->donelist;
 }
 
 /**
@@ -182,7 +218,15 @@ static inline int rcu_pending(int cpu)
  * completes.
  *
  * It is illegal to block while in an RCU read-side critical section.
+ * With CONFIG_PREEMPT_RCU the section may be preempted, though; the
+ * grace period then also waits for the preempted reader.
  */
+#ifdef CONFIG_PREEMPT_RCU
+extern void __rcu_read_lock(void);
+extern void __rcu_read_unlock(void);
+#define rcu_read_lock()		__rcu_read_lock()
+#define rcu_read_unlock()	__rcu_read_unlock()
+#else
 /**
  * rcuĶ򵥵Ľռɡ
  */
@@ -197,6 +241,7 @@ static inline int rcu_pending(int cpu)
  * ͷrcuĶ򵥵Ĵռɡ
  */
 #define rcu_read_unlock()	preempt_enable()
+#endif /* CONFIG_PREEMPT_RCU */
 
 /*
  * So where is rcu_write_lock()?  It does not exist, as there is no
@@ -1921,7 +1921,7 @@ void padd_item (char * item, int total_length, int length);
 #define GET_BLOCK_CREATE 1    /* add anything you need to find block */
 #define GET_BLOCK_NO_HOLE 2   /* return -ENOENT for file holes */
 #define GET_BLOCK_READ_DIRECT 4  /* read the tail if indirect item not found */
-#define GET_BLOCK_NO_ISEM     8 /* i_sem is not held, don't preallocate */
+#define GET_BLOCK_NO_ISEM     8 /* i_mutex is not held, don't preallocate */
 #define GET_BLOCK_NO_DANGLE   16 /* don't leave any transactions running */
 
 int restart_transaction(struct reiserfs_transaction_handle *th, struct inode *inode, struct path *path);
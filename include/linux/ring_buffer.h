@@ -0,0 +1,81 @@
+#ifndef _LINUX_RING_BUFFER_H
+#define _LINUX_RING_BUFFER_H
+
+/*
+ * Per-cpu binary ring buffer for tracing, see kernel/trace/ring_buffer.c.
+ *
+ * Each cpu has a ring of pages.  Every page starts with a buffer_page
+ * header giving the absolute time of its first event; the events that
+ * follow carry the nanoseconds since then.  The pages can be mmap()ed
+ * and read by userspace directly, using the same protocol as the
+ * in-kernel reader: read seq, read commit, copy the events, and throw
+ * the copy away if seq has changed meanwhile.
+ */
+
+#include <linux/types.h>
+#include <linux/stddef.h>
+#include <linux/mm.h>
+
+struct ring_buffer;
+
+struct buffer_page {
+	u64		time_stamp;	/* Time of the first event on the page */
+	unsigned long	seq;		/* Bumped whenever the page is reused */
+	unsigned long	commit;		/* Bytes of complete events in data */
+	unsigned long	entries;	/* Number of events in data */
+	unsigned char	data[0];
+};
+
+#define BUF_PAGE_SIZE	(PAGE_SIZE - offsetof(struct buffer_page, data))
+
+struct ring_buffer_event {
+	u16		type;		/* 0 is never used */
+	u16		len;		/* Payload bytes, including padding */
+	u32		time_delta;	/* ns since the page's time_stamp */
+	unsigned char	data[0];
+};
+
+#define RB_EVENT_ALIGN		4
+#define RB_MAX_EVENT_LEN	(BUF_PAGE_SIZE - sizeof(struct ring_buffer_event))
+
+static inline void *ring_buffer_event_data(struct ring_buffer_event *event)
+{
+	return event->data;
+}
+
+/* Overwrite the oldest events when full, instead of dropping new ones */
+#define RB_FL_OVERWRITE		1
+
+struct ring_buffer *ring_buffer_alloc(unsigned long pages, unsigned flags);
+void ring_buffer_free(struct ring_buffer *buffer);
+
+void ring_buffer_record_on(struct ring_buffer *buffer);
+void ring_buffer_record_off(struct ring_buffer *buffer);
+int ring_buffer_record_is_on(struct ring_buffer *buffer);
+unsigned long ring_buffer_size(struct ring_buffer *buffer);
+
+struct ring_buffer_event *
+ring_buffer_lock_reserve(struct ring_buffer *buffer, unsigned type,
+			 unsigned long len, unsigned long *flags);
+void ring_buffer_unlock_commit(struct ring_buffer *buffer,
+			       struct ring_buffer_event *event,
+			       unsigned long flags);
+
+/* Consuming reads, one reader per cpu at a time */
+int ring_buffer_read_page(struct ring_buffer *buffer, int cpu,
+			  struct buffer_page *dst);
+
+/* Non-consuming copy of the current cpu's recent events */
+int ring_buffer_snapshot_cpu(struct ring_buffer *buffer, u64 since,
+			     struct buffer_page **pages, int nr_pages);
+struct ring_buffer_event *
+ring_buffer_peek(struct ring_buffer *buffer, int cpu, u64 *ts);
+void ring_buffer_consume(struct ring_buffer *buffer, int cpu);
+
+unsigned long ring_buffer_entries(struct ring_buffer *buffer, int cpu);
+unsigned long ring_buffer_overruns(struct ring_buffer *buffer, int cpu);
+
+struct page *ring_buffer_page(struct ring_buffer *buffer, int cpu,
+			      unsigned long index);
+
+#endif /* _LINUX_RING_BUFFER_H */
@@ -0,0 +1,61 @@
+#ifndef _LINUX_RTMUTEX_H
+#define _LINUX_RTMUTEX_H
+
+/*
+ * RT-mutexes: sleeping locks with priority inheritance.
+ *
+ * A task blocking on an rt_mutex lends its priority to the owner of
+ * the lock (and transitively along the chain of owners it is blocked
+ * on), so a low priority owner cannot be starved by medium priority
+ * tasks while a high priority task waits for it.
+ *
+ * Currently the only user is the PI-futex code, which needs to hand
+ * ownership of a lock to a task other than current.
+ */
+
+#include <linux/list.h>
+#include <linux/sched.h>
+
+struct rt_mutex {
+	struct list_head	wait_list;	/* waiters, sorted by prio */
+	struct task_struct	*owner;
+};
+
+/*
+ * A waiter lives on the stack of the blocked task.  list_entry links
+ * it into lock->wait_list; if it is the top waiter of the lock it is
+ * also linked into owner->pi_waiters through pi_list_entry.
+ */
+struct rt_mutex_waiter {
+	struct list_head	list_entry;
+	struct list_head	pi_list_entry;
+	struct task_struct	*task;
+	struct rt_mutex		*lock;
+	int			prio;
+};
+
+#define __RT_MUTEX_INITIALIZER(name) \
+	{ .wait_list = LIST_HEAD_INIT(name.wait_list), .owner = NULL }
+
+#define DEFINE_RT_MUTEX(name) \
+	struct rt_mutex name = __RT_MUTEX_INITIALIZER(name)
+
+static inline int rt_mutex_is_locked(struct rt_mutex *lock)
+{
+	return lock->owner != NULL;
+}
+
+extern void rt_mutex_init(struct rt_mutex *lock);
+extern void rt_mutex_lock(struct rt_mutex *lock);
+extern int rt_mutex_timed_lock(struct rt_mutex *lock, long timeout);
+extern int rt_mutex_trylock(struct rt_mutex *lock);
+extern void rt_mutex_unlock(struct rt_mutex *lock);
+
+/* Used by the futex code to manage locks on behalf of other tasks: */
+extern void rt_mutex_init_proxy_locked(struct rt_mutex *lock,
+				       struct task_struct *proxy_owner);
+extern void rt_mutex_proxy_unlock(struct rt_mutex *lock,
+				  struct task_struct *proxy_owner);
+extern struct task_struct *rt_mutex_next_owner(struct rt_mutex *lock);
+
+#endif
@@ -32,6 +32,8 @@
 #include <linux/pid.h>
 #include <linux/percpu.h>
 #include <linux/topology.h>
+#include <linux/task_io_accounting.h>
+#include <linux/taskstats.h>
 
 struct exec_domain;
 
@@ -236,11 +238,32 @@ extern unsigned long nr_iowait(void);
 #define SCHED_NORMAL		0
 #define SCHED_FIFO		1
 #define SCHED_RR		2
+#define SCHED_FAIR		3
+#define SCHED_DEADLINE		6
 
 struct sched_param {
 	int sched_priority;
 };
 
+/*
+ * Extended parameters for sched_setattr()/sched_getattr().  The
+ * SCHED_DEADLINE times are in nanoseconds: the task gets sched_runtime
+ * of CPU time within sched_deadline of the start of every
+ * sched_period (0: same as sched_deadline).
+ */
+struct sched_attr {
+	__u32 size;		/* sizeof(struct sched_attr) */
+	__u32 sched_policy;
+	__u64 sched_flags;	/* must be 0 */
+	__s32 sched_nice;	/* SCHED_NORMAL, SCHED_FAIR */
+	__u32 sched_priority;	/* SCHED_FIFO, SCHED_RR */
+	__u64 sched_runtime;	/* SCHED_DEADLINE */
+	__u64 sched_deadline;
+	__u64 sched_period;
+};
+
+#define SCHED_ATTR_SIZE_VER0	48
+
 #ifdef __KERNEL__
 
 #include <linux/spinlock.h>
@@ -264,6 +287,14 @@ extern void sched_init_smp(void);
 extern void init_idle(task_t *idle, int cpu);
 
 extern cpumask_t nohz_cpu_mask;
+extern cpumask_t nohz_busy_cpu_mask;
+#ifdef CONFIG_NO_HZ_FULL
+extern cpumask_t nohz_full_mask;
+extern int sched_can_stop_tick(void);
+extern void nohz_full_kick_task(task_t *p);
+#else
+static inline void nohz_full_kick_task(task_t *p) { }
+#endif
 
 extern void show_state(void);
 extern void show_regs(struct pt_regs *);
@@ -600,6 +631,9 @@ struct signal_struct {
 	cputime_t utime, stime, cutime, cstime;
 	unsigned long nvcsw, nivcsw, cnvcsw, cnivcsw;
 	unsigned long min_flt, maj_flt, cmin_flt, cmaj_flt;
+#ifdef CONFIG_TASKSTATS
+	struct taskstats stats;		/* of dead threads but the leader */
+#endif
 
 	/*
 	 * We don't bother to synchronize most readers of this at all,
@@ -645,6 +679,17 @@ struct signal_struct {
 
 #define rt_task(p)		(unlikely((p)->prio < MAX_RT_PRIO))
 
+/*
+ * SCHED_DEADLINE tasks run at prio MAX_DL_PRIO-1, above every RT
+ * priority, and are ordered among themselves by deadline.  They count
+ * as rt_task() for everything that only wants to know whether the O(1)
+ * heuristics apply.
+ */
+#define MAX_DL_PRIO		0
+
+#define dl_prio(prio)		(unlikely((prio) < MAX_DL_PRIO))
+#define dl_task(p)		dl_prio((p)->prio)
+
 /*
  * Some day this will be a full-fledged user tracking system..
  */
@@ -676,7 +721,7 @@ typedef struct prio_array prio_array_t;
 struct backing_dev_info;
 struct reclaim_state;
 
-#ifdef CONFIG_SCHEDSTATS
+#if defined(CONFIG_SCHEDSTATS) || defined(CONFIG_TASK_DELAY_ACCT)
 struct sched_info {
 	/* cumulative counters */
 	unsigned long	cpu_time,	/* time spent on the cpu */
@@ -687,10 +732,69 @@ struct sched_info {
 	unsigned long	last_arrival,	/* when we last ran on a cpu */
 			last_queued;	/* when we were last queued to run */
 };
+#endif
 
+#ifdef CONFIG_SCHEDSTATS
 extern struct file_operations proc_schedstat_operations;
 #endif
 
+#ifdef CONFIG_TASK_DELAY_ACCT
+/* See linux/delayacct.h.  The lock is for readers on other cpus. */
+struct task_delay_info {
+	spinlock_t	lock;
+	unsigned int	flags;		/* DELAYACCT_PF_* */
+
+	u64	blkio_start;		/* ns, of the current wait */
+	u64	blkio_delay;		/* ns waiting for block I/O */
+	u64	swapin_delay;		/* ns waiting for swap-in */
+	u32	blkio_count;
+	u32	swapin_count;
+};
+#endif
+
+/*
+ * Per-task state of the SCHED_FAIR policy (kernel/sched_fair.c).
+ * Runnable entities are kept in a per-runqueue rbtree ordered by
+ * vruntime, the nanoseconds they ran scaled by NICE_0_LOAD/load_weight.
+ */
+struct cfs_rq;
+struct task_group;
+struct worker;
+
+struct sched_entity {
+	struct rb_node		run_node;
+	unsigned long		load_weight;
+	unsigned long long	vruntime;
+	unsigned long long	exec_start;
+	unsigned long long	sum_exec_runtime;
+	unsigned long long	prev_sum_exec_runtime;
+	int			on_rq;
+	struct cfs_rq		*cfs_rq;	/* the queue we are (to be) queued on */
+#ifdef CONFIG_FAIR_GROUP_SCHED
+	struct cfs_rq		*my_q;		/* group entity: the queue it owns */
+#endif
+};
+
+/*
+ * Per-task state of the SCHED_DEADLINE policy (kernel/sched_dl.c).
+ * All times in ns, deadline in the sched_clock() timebase of the
+ * runqueue the task is on.
+ */
+struct sched_dl_entity {
+	struct rb_node		rb_node;	/* in rq->dl, by deadline */
+	unsigned long long	dl_runtime;	/* budget per period */
+	unsigned long long	dl_deadline;	/* relative deadline */
+	unsigned long long	dl_period;
+	unsigned long		dl_bw;		/* dl_runtime/dl_period << 20 */
+
+	long long		runtime;	/* budget left */
+	unsigned long long	deadline;	/* absolute deadline */
+	unsigned long long	exec_start;
+	int			on_rq;		/* in the rbtree */
+	int			dl_throttled;	/* out of budget */
+	struct timer_list	dl_timer;	/* replenishes the budget */
+};
+
 enum idle_type
 {
 	SCHED_IDLE,
@@ -712,6 +816,7 @@ enum idle_type
 #define SD_WAKE_AFFINE		16	/* Wake task to waking CPU */
 #define SD_WAKE_BALANCE		32	/* Perform balancing at task wakeup */
 #define SD_SHARE_CPUPOWER	64	/* Domain members share cpu power */
+#define SD_SHARE_PKG_RESOURCES	128	/* Domain members share the last level cache */
 
 /**
  * 
@@ -821,6 +926,9 @@ int set_current_groups(struct group_info *group_info);
 
 struct audit_context;		/* See audit.c */
 struct mempolicy;
+struct rt_mutex_waiter;		/* See rtmutex.h */
+struct robust_list_head;	/* See futex.h */
+struct perf_counter_context;	/* See perf_counter.h */
 
 /**
  * Linux ϵͳͬ
@@ -892,10 +1000,35 @@ struct task_struct {
 	 *                         Ķ̬ӽʱӽ̻˳ʱƬֽ̲ƽ
 	 */
 	unsigned int time_slice, first_time_slice;
+	struct sched_entity se;
+	struct sched_dl_entity dl;
+#ifdef CONFIG_FAIR_GROUP_SCHED
+	struct task_group *sched_group;	/* NULL: the root group */
+#endif
+#ifdef CONFIG_SMP
+	/*
+	 * How often this task switches between the tasks it wakes up,
+	 * decayed every second; see wake_wide().  last_wakee is only
+	 * compared, never dereferenced.
+	 */
+	struct task_struct *last_wakee;
+	unsigned int wakee_flips;
+	unsigned long wakee_flip_decay_ts;
+#endif
+#ifdef CONFIG_PREEMPT_RCU
+	/* Nesting of rcu_read_lock(), and the reader counter it bumped */
+	int rcu_read_lock_nesting;
+	int rcu_flipctr_idx;
+#endif
+	/* Our worker, if PF_WQ_WORKER is set */
+	struct worker *wq_worker;
 
-#ifdef CONFIG_SCHEDSTATS
+#if defined(CONFIG_SCHEDSTATS) || defined(CONFIG_TASK_DELAY_ACCT)
 	struct sched_info sched_info;
 #endif
+#ifdef CONFIG_TASK_DELAY_ACCT
+	struct task_delay_info delays;
+#endif
 
 	/**
 	 * ͨнӵһ˫С
@@ -1115,6 +1248,19 @@ struct task_struct {
 /* context-switch lock */
 	spinlock_t switch_lock;
 
+/* Priority inheritance: locks held and blocked on, see kernel/rtmutex.c */
+	struct list_head pi_waiters;	/* top waiters of locks we own */
+	struct rt_mutex_waiter *pi_blocked_on;
+	int pi_prio;			/* inherited prio, MAX_PRIO if none */
+#ifdef CONFIG_FUTEX
+	struct robust_list_head __user *robust_list;
+	struct list_head pi_state_list;	/* PI futexes we own */
+#endif
+#ifdef CONFIG_PERF_COUNTERS
+	struct perf_counter_context *perf_counter_ctxp;
+	int perf_counter_cpu;		/* Where it last ran with counters on */
+#endif
+
 /* journalling filesystem info */
 	/**
 	 * ǰ־ĵַ
@@ -1141,6 +1287,9 @@ struct task_struct {
 	wait_queue_t *io_wait;
 /* i/o counters(bytes read/written, #syscalls */
 	u64 rchar, wchar, syscr, syscw;
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+	struct task_io_accounting ioac;	/* bytes read/written from storage */
+#endif
 #if defined(CONFIG_BSD_PROCESS_ACCT)
 	u64 acct_rss_mem1;	/* accumulated rss usage */
 	u64 acct_vm_mem1;	/* accumulated virtual memory usage */
@@ -1212,6 +1361,8 @@ do { if (atomic_dec_and_test(&(tsk)->usage)) __put_task_struct(tsk); } while(0)
 #define PF_LESS_THROTTLE 0x00100000	/* Throttle me less: I clean memory */
 #define PF_SYNCWRITE	0x00200000	/* I am doing a sync write */
 #define PF_BORROWED_MM	0x00400000	/* I am a kthread doing use_mm */
+#define PF_WQ_WORKER	0x00800000	/* I am a workqueue pool worker */
+#define PF_MEMSTALL	0x01000000	/* stalled in memory reclaim, see psi */
 
 /*
  * Only the _current_ task can read/write to tsk->flags, but other
@@ -1271,6 +1422,35 @@ extern int task_nice(const task_t *p);
 extern int task_curr(const task_t *p);
 extern int idle_cpu(int cpu);
 extern int sched_setscheduler(struct task_struct *, int, struct sched_param *);
+extern void rt_mutex_setprio(task_t *p, int prio);
+extern int sched_setattr(struct task_struct *, struct sched_attr *);
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+/*
+ * Task groups of the SCHED_FAIR policy, managed through the cpugroup
+ * filesystem (kernel/cpugroup.c).
+ */
+#define RUNTIME_INF		(~0ULL)	/* no bandwidth limit */
+
+extern struct task_group root_task_group;
+extern struct task_group *sched_create_group(struct task_group *parent);
+extern int sched_destroy_group(struct task_group *tg);
+extern int sched_move_task(task_t *p, struct task_group *tg);
+extern struct task_group *sched_task_group(task_t *p);
+extern int sched_group_set_shares(struct task_group *tg, unsigned long shares);
+extern unsigned long sched_group_shares(struct task_group *tg);
+extern int sched_group_set_bandwidth(struct task_group *tg,
+				     unsigned long long quota,
+				     unsigned long long period);
+extern void sched_group_bandwidth(struct task_group *tg,
+				  unsigned long long *quota,
+				  unsigned long long *period);
+extern void sched_group_fork(task_t *p);
+extern void sched_group_free(task_t *p);
+#else
+static inline void sched_group_fork(task_t *p) { }
+static inline void sched_group_free(task_t *p) { }
+#endif
 extern task_t *idle_task(int cpu);
 
 void yield(void);
@@ -28,11 +28,14 @@ struct msghdr;
 struct msqid_ds;
 struct new_utsname;
 struct nfsctl_arg;
+struct perf_counter_hw_event;
 struct __old_kernel_stat;
 struct pollfd;
 struct rlimit;
+struct robust_list_head;
 struct rusage;
 struct sched_param;
+struct sched_attr;
 struct semaphore;
 struct sembuf;
 struct shmid_ds;
@@ -143,6 +146,10 @@ asmlinkage long sys_sched_setparam(pid_t pid,
 asmlinkage long sys_sched_getscheduler(pid_t pid);
 asmlinkage long sys_sched_getparam(pid_t pid,
 					struct sched_param __user *param);
+asmlinkage long sys_sched_setattr(pid_t pid, struct sched_attr __user *attr,
+					unsigned int flags);
+asmlinkage long sys_sched_getattr(pid_t pid, struct sched_attr __user *attr,
+					unsigned int size, unsigned int flags);
 asmlinkage long sys_sched_setaffinity(pid_t pid, unsigned int len,
 					unsigned long __user *user_mask_ptr);
 asmlinkage long sys_sched_getaffinity(pid_t pid, unsigned int len,
@@ -174,6 +181,11 @@ asmlinkage long sys_set_tid_address(int __user *tidptr);
 asmlinkage long sys_futex(u32 __user *uaddr, int op, int val,
 			struct timespec __user *utime, u32 __user *uaddr2,
 			int val3);
+asmlinkage long sys_set_robust_list(struct robust_list_head __user *head,
+				    size_t len);
+asmlinkage long sys_get_robust_list(int pid,
+				    struct robust_list_head __user **head_ptr,
+				    size_t __user *len_ptr);
 
 asmlinkage long sys_init_module(void __user *umod, unsigned long len,
 				const char __user *uargs);
@@ -506,4 +518,7 @@ asmlinkage long sys_request_key(const char __user *_type,
 asmlinkage long sys_keyctl(int cmd, unsigned long arg2, unsigned long arg3,
 			   unsigned long arg4, unsigned long arg5);
 
+asmlinkage long sys_perf_counter_open(struct perf_counter_hw_event __user *hw_event_uptr,
+				      pid_t pid, int cpu, unsigned long flags);
+
 #endif
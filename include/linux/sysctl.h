@@ -135,6 +135,10 @@ enum
 	KERN_HZ_TIMER=65,	/* int: hz timer on or off */
 	KERN_UNKNOWN_NMI_PANIC=66, /* int: unknown nmi panic flag */
 	KERN_BOOTLOADER_TYPE=67, /* int: boot loader type */
+	KERN_SCHED_LATENCY=68,	/* int: SCHED_FAIR latency target (ns) */
+	KERN_SCHED_MIN_GRANULARITY=69, /* int: SCHED_FAIR minimal slice (ns) */
+	KERN_SCHED_WAKEUP_GRANULARITY=70, /* int: SCHED_FAIR wakeup preemption (ns) */
+	KERN_SCHED_DL_BANDWIDTH=71, /* int: % of each CPU SCHED_DEADLINE may reserve */
 };
 
 
@@ -0,0 +1,27 @@
+#ifndef _LINUX_TASK_IO_ACCOUNTING_H
+#define _LINUX_TASK_IO_ACCOUNTING_H
+
+/*
+ * Per-task storage I/O accounting, shown in /proc/<pid>/io next to
+ * the rchar/wchar counters of task_struct, which count what read()
+ * and write() transferred whether or not it touched storage.
+ *
+ * read_bytes counts what the task made the block layer read for it.
+ * write_bytes counts the pages it dirtied in the page cache, plus
+ * direct I/O writes: writeback happens later, from whatever context,
+ * so a write is charged to the task that caused it.  Dirty pages
+ * truncated before they are written back go to cancelled_write_bytes.
+ */
+
+#include <linux/config.h>
+#include <linux/types.h>
+
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+struct task_io_accounting {
+	u64 read_bytes;
+	u64 write_bytes;
+	u64 cancelled_write_bytes;
+};
+#endif
+
+#endif /* _LINUX_TASK_IO_ACCOUNTING_H */
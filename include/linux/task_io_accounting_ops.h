@@ -0,0 +1,39 @@
+#ifndef _LINUX_TASK_IO_ACCOUNTING_OPS_H
+#define _LINUX_TASK_IO_ACCOUNTING_OPS_H
+
+/*
+ * Charging I/O to the current task, see task_io_accounting.h.
+ * Only the task itself updates its counters, so no locking.
+ */
+
+#include <linux/config.h>
+#include <linux/sched.h>
+#include <linux/string.h>
+
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+static inline void task_io_account_read(size_t bytes)
+{
+	current->ioac.read_bytes += bytes;
+}
+
+static inline void task_io_account_write(size_t bytes)
+{
+	current->ioac.write_bytes += bytes;
+}
+
+static inline void task_io_account_cancelled_write(size_t bytes)
+{
+	current->ioac.cancelled_write_bytes += bytes;
+}
+
+static inline void task_io_accounting_init(struct task_io_accounting *ioac)
+{
+	memset(ioac, 0, sizeof(*ioac));
+}
+#else
+static inline void task_io_account_read(size_t bytes)			{ }
+static inline void task_io_account_write(size_t bytes)			{ }
+static inline void task_io_account_cancelled_write(size_t bytes)	{ }
+#endif
+
+#endif /* _LINUX_TASK_IO_ACCOUNTING_OPS_H */
@@ -0,0 +1,88 @@
+#ifndef _LINUX_TASKSTATS_H
+#define _LINUX_TASKSTATS_H
+
+/*
+ * Task statistics, exported on the NETLINK_TASKSTATS netlink socket
+ * (see kernel/taskstats.c).
+ *
+ * Send a TASKSTATS_MSG_GET_PID or TASKSTATS_MSG_GET_TGID message whose
+ * payload is a __u32 pid to get a TASKSTATS_MSG_STATS reply with the
+ * struct taskstats of that task, or the sum over a thread group.
+ *
+ * Sockets bound to the TASKSTATS_GRP_EXIT group (root only) also get
+ * a TASKSTATS_MSG_EXIT message for every task that exits, with its
+ * final statistics.  Thread group totals are the sum of those.
+ *
+ * Fields that need a config option the kernel was built without are 0.
+ * New fields are only ever added at the end, with a new version.
+ */
+
+#include <linux/types.h>
+
+#define TASKSTATS_VERSION	1
+
+#define TS_COMM_LEN		16
+
+struct taskstats {
+	__u16	version;
+	__u16	__pad;
+	__u32	ac_exitcode;		/* Exit code, in exit records only */
+	__u32	ac_pid;			/* 0 in thread group totals */
+	__u32	ac_tgid;
+	__u32	ac_uid;
+	__u32	ac_gid;
+	char	ac_comm[TS_COMM_LEN];
+
+	/*
+	 * Delay accounting (CONFIG_TASK_DELAY_ACCT), times in ns.  The
+	 * counts are how many delays the totals add up.  cpu_* times
+	 * are measured with jiffies resolution.
+	 */
+	__u64	cpu_count;		/* Times the task got a cpu */
+	__u64	cpu_delay_total;	/* Waiting on a runqueue */
+	__u64	cpu_run_total;		/* Running */
+	__u64	blkio_count;
+	__u64	blkio_delay_total;	/* Waiting for block I/O */
+	__u64	swapin_count;
+	__u64	swapin_delay_total;	/* Waiting for swap-in */
+
+	/* I/O accounting */
+	__u64	read_char;		/* Through read() and friends */
+	__u64	write_char;		/* Through write() and friends */
+	__u64	read_syscalls;
+	__u64	write_syscalls;
+	/* Storage I/O (CONFIG_TASK_IO_ACCOUNTING), in bytes */
+	__u64	read_bytes;		/* Read from storage */
+	__u64	write_bytes;		/* Dirtied for storage */
+	__u64	cancelled_write_bytes;	/* Dirtied, then truncated */
+};
+
+/* Message types, on top of the NLMSG_* ones */
+#define TASKSTATS_MSG_GET_PID	0x10	/* __u32 pid */
+#define TASKSTATS_MSG_GET_TGID	0x11	/* __u32 tgid */
+#define TASKSTATS_MSG_STATS	0x12	/* struct taskstats */
+#define TASKSTATS_MSG_EXIT	0x13	/* struct taskstats */
+
+/* Multicast groups */
+#define TASKSTATS_GRP_EXIT	1
+
+#ifdef __KERNEL__
+
+#include <linux/config.h>
+
+struct task_struct;
+struct signal_struct;
+
+#ifdef CONFIG_TASKSTATS
+extern void taskstats_exit(struct task_struct *tsk, long code);
+extern void taskstats_exit_thread(struct signal_struct *sig,
+				  struct task_struct *tsk);
+#else
+static inline void taskstats_exit(struct task_struct *tsk, long code) { }
+static inline void taskstats_exit_thread(struct signal_struct *sig,
+					 struct task_struct *tsk) { }
+#endif
+
+#endif /* __KERNEL__ */
+
+#endif /* _LINUX_TASKSTATS_H */
@@ -89,6 +89,19 @@ extern int __mod_timer(struct timer_list *timer, unsigned long expires);
 extern int mod_timer(struct timer_list *timer, unsigned long expires);
 
 extern unsigned long next_timer_interrupt(void);
+extern int sysctl_hz_timer;
+
+/*
+ * Provided by the architecture: stop the local tick on an idle (or,
+ * with CONFIG_NO_HZ_FULL, single-task) cpu, and restart it.
+ */
+#ifdef CONFIG_NO_IDLE_HZ
+extern void stop_hz_timer(void);
+extern void start_hz_timer(void);
+#else
+static inline void stop_hz_timer(void) { }
+static inline void start_hz_timer(void) { }
+#endif
 
 /***
  * add_timer - start a timer
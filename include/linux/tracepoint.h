@@ -0,0 +1,66 @@
+#ifndef _LINUX_TRACEPOINT_H
+#define _LINUX_TRACEPOINT_H
+
+/*
+ * Static tracepoints (CONFIG_TRACEPOINTS), see kernel/trace/.
+ *
+ * A tracepoint is declared in a header under include/trace/ with
+ *
+ *	DECLARE_TRACE(sched_wakeup,
+ *		TP_PROTO(struct task_struct *p, int success),
+ *		TP_ARGS(p, success));
+ *
+ * and called as trace_sched_wakeup(p, success).  While the tracepoint is
+ * disabled the call only tests a flag.  When enabled it calls
+ * __trace_sched_wakeup(), which records an event into the trace ring
+ * buffer.  The recorder and the tracepoint itself are defined with
+ * DEFINE_TRACE() in kernel/trace/trace_events.c.
+ */
+
+#include <linux/config.h>
+#include <linux/list.h>
+#include <linux/compiler.h>
+
+struct tracepoint {
+	const char		*name;
+	int			enabled;
+	unsigned short		type;		/* Of its ring buffer events */
+	int			(*print)(char *buf, int len, void *data);
+	int			(*enable)(struct tracepoint *tp, int enable);
+	struct list_head	list;
+};
+
+#define TP_PROTO(args...)	args
+#define TP_ARGS(args...)	args
+
+#ifdef CONFIG_TRACEPOINTS
+
+#define DECLARE_TRACE(name, proto, args)				\
+	extern struct tracepoint __tracepoint_##name;			\
+	extern void __trace_##name(proto);				\
+	static inline void trace_##name(proto)				\
+	{								\
+		if (unlikely(__tracepoint_##name.enabled))		\
+			__trace_##name(args);				\
+	}
+
+#define DEFINE_TRACE(name, printfn)					\
+	struct tracepoint __tracepoint_##name = {			\
+		.name	= #name,					\
+		.print	= printfn,					\
+	}
+
+#else
+
+#define DECLARE_TRACE(name, proto, args)				\
+	static inline void trace_##name(proto)				\
+	{								\
+	}
+
+#endif /* CONFIG_TRACEPOINTS */
+
+#ifdef CONFIG_TRACING
+extern int register_trace_event(struct tracepoint *tp);
+#endif
+
+#endif /* _LINUX_TRACEPOINT_H */
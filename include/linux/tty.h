@@ -365,6 +365,7 @@ extern struct termios tty_std_termios;
 extern int fg_console, last_console, want_console;
 
 extern int kmsg_redirect;
+extern struct file_operations kmsg_fops;	/* /dev/kmsg, in kernel/printk.c */
 
 extern void console_init(void);
 extern int vcs_init(void);
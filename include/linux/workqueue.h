@@ -71,18 +71,32 @@ struct work_struct {
 		init_timer(&(_work)->timer);			\
 	} while (0)
 
+/*
+ * Default and upper limit of the works of one workqueue that may be
+ * queued to or run by one cpu's worker pool at a time.
+ */
+#define WQ_DFL_ACTIVE		256
+#define WQ_MAX_ACTIVE		512
+
 extern struct workqueue_struct *__create_workqueue(const char *name,
-						    int singlethread);
+						    int singlethread,
+						    int max_active);
 
 /**
  * һַΪ´еĵַún̡߳
  * ݴݸַΪ߳
  */
-#define create_workqueue(name) __create_workqueue((name), 0)
+#define create_workqueue(name) __create_workqueue((name), 0, WQ_DFL_ACTIVE)
+/*
+ * Like create_workqueue(), but at most max_active of its works run at a
+ * time on each cpu.
+ */
+#define create_workqueue_max(name, max_active)			\
+	__create_workqueue((name), 0, (max_active))
 /**
  * create_workqueueƣǲϵͳжٸCPUֻһ̡߳
  */
-#define create_singlethread_workqueue(name) __create_workqueue((name), 1)
+#define create_singlethread_workqueue(name) __create_workqueue((name), 1, 1)
 
 extern void destroy_workqueue(struct workqueue_struct *wq);
 
@@ -100,6 +114,12 @@ extern int keventd_up(void);
 
 extern void init_workqueues(void);
 
+/* Scheduler hooks for the shared worker pools, see kernel/workqueue.c */
+struct task_struct;
+extern struct task_struct *wq_worker_sleeping(struct task_struct *task,
+					      int cpu);
+extern void wq_worker_waking_up(struct task_struct *task, int cpu);
+
 /*
  * Kill off a pending schedule_delayed_work().  Note that the work callback
  * function may still be running on return from cancel_delayed_work().  Run
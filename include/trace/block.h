@@ -0,0 +1,49 @@
+#ifndef _TRACE_BLOCK_H
+#define _TRACE_BLOCK_H
+
+#include <linux/tracepoint.h>
+
+/* The events of a request's life, see linux/blktrace.h */
+
+struct request_queue;
+struct request;
+struct bio;
+
+DECLARE_TRACE(block_bio_queue,
+	TP_PROTO(struct request_queue *q, struct bio *bio),
+	TP_ARGS(q, bio));
+
+DECLARE_TRACE(block_bio_backmerge,
+	TP_PROTO(struct request_queue *q, struct bio *bio),
+	TP_ARGS(q, bio));
+
+DECLARE_TRACE(block_bio_frontmerge,
+	TP_PROTO(struct request_queue *q, struct bio *bio),
+	TP_ARGS(q, bio));
+
+DECLARE_TRACE(block_getrq,
+	TP_PROTO(struct request_queue *q, struct bio *bio),
+	TP_ARGS(q, bio));
+
+DECLARE_TRACE(block_sleeprq,
+	TP_PROTO(struct request_queue *q, struct bio *bio),
+	TP_ARGS(q, bio));
+
+DECLARE_TRACE(block_rq_insert,
+	TP_PROTO(struct request_queue *q, struct request *rq),
+	TP_ARGS(q, rq));
+
+DECLARE_TRACE(block_rq_issue,
+	TP_PROTO(struct request_queue *q, struct request *rq),
+	TP_ARGS(q, rq));
+
+DECLARE_TRACE(block_rq_complete,
+	TP_PROTO(struct request_queue *q, struct request *rq, int bytes,
+		 int error),
+	TP_ARGS(q, rq, bytes, error));
+
+DECLARE_TRACE(block_rq_requeue,
+	TP_PROTO(struct request_queue *q, struct request *rq),
+	TP_ARGS(q, rq));
+
+#endif /* _TRACE_BLOCK_H */
@@ -0,0 +1,12 @@
+#ifndef _TRACE_NET_H
+#define _TRACE_NET_H
+
+#include <linux/tracepoint.h>
+
+struct sk_buff;
+
+DECLARE_TRACE(net_receive_skb,
+	TP_PROTO(struct sk_buff *skb),
+	TP_ARGS(skb));
+
+#endif /* _TRACE_NET_H */
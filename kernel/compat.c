@@ -248,13 +248,14 @@ asmlinkage long compat_sys_futex(u32 __user *uaddr, int op, int val,
 	struct timespec t;
 	unsigned long timeout = MAX_SCHEDULE_TIMEOUT;
 	int val2 = 0;
+	int cmd = op & FUTEX_CMD_MASK;
 
-	if ((op == FUTEX_WAIT) && utime) {
+	if ((cmd == FUTEX_WAIT || cmd == FUTEX_LOCK_PI) && utime) {
 		if (get_compat_timespec(&t, utime))
 			return -EFAULT;
 		timeout = timespec_to_jiffies(&t) + 1;
 	}
-	if (op >= FUTEX_REQUEUE)
+	if (cmd == FUTEX_REQUEUE || cmd == FUTEX_CMP_REQUEUE)
 		val2 = (int) (unsigned long) utime;
 
 	return do_futex((unsigned long)uaddr, op, val, timeout,
@@ -0,0 +1,579 @@
+/*
+ *  kernel/cpugroup.c
+ *
+ *  The cpugroup filesystem: a directory tree mirroring the task groups
+ *  of the SCHED_FAIR policy.
+ *
+ *	mount -t cpugroup none /dev/cpugroup
+ *	mkdir /dev/cpugroup/batch
+ *	echo 512 > /dev/cpugroup/batch/cpu.shares
+ *	echo $$ > /dev/cpugroup/batch/tasks
+ *
+ *  Every directory is a group and holds the files:
+ *
+ *	tasks		 the pids in the group; write a pid to move it here
+ *	cpu.shares	 the weight of the group on each CPU
+ *	cpu.cfs_quota_us runtime the group may use per period on each CPU,
+ *			 -1 for no limit
+ *	cpu.cfs_period_us the length of the period
+ *
+ *  The root directory is the root group and only has "tasks".  Groups
+ *  are not torn down on unmount; a directory can only be removed while
+ *  the group has no tasks and no subgroups.  Files still open after
+ *  that return -ENODEV.
+ *
+ *  Based on fs/ramfs/inode.c.
+ */
+
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/namei.h>
+#include <linux/err.h>
+
+#include <asm/uaccess.h>
+#include <asm/semaphore.h>
+#include <asm/div64.h>
+
+#define CPUGROUP_MAGIC	0x43505547
+
+/* Serializes mkdir, rmdir and every use of a group through its files. */
+static DECLARE_MUTEX(cpugroup_sem);
+
+/*
+ * What the inodes of a directory point to.  The task group goes away
+ * with rmdir, but files may still be open then; each inode holds a
+ * reference, dropped when the inode is deleted.
+ */
+struct cpugroup {
+	struct task_group *tg;		/* NULL once removed, cpugroup_sem */
+	atomic_t count;
+};
+
+static struct cpugroup root_cpugroup = {
+	.tg	= &root_task_group,
+	.count	= ATOMIC_INIT(1),	/* never freed */
+};
+
+static struct super_operations cpugroup_ops;
+static struct inode_operations cpugroup_dir_inode_operations;
+
+static void cpugroup_put(struct cpugroup *cg)
+{
+	if (atomic_dec_and_test(&cg->count))
+		kfree(cg);
+}
+
+static struct inode *cpugroup_get_inode(struct super_block *sb, int mode,
+					struct cpugroup *cg)
+{
+	struct inode *inode = new_inode(sb);
+
+	if (inode) {
+		atomic_inc(&cg->count);
+		inode->i_mode = mode;
+		inode->i_uid = current->fsuid;
+		inode->i_gid = current->fsgid;
+		inode->i_blksize = PAGE_CACHE_SIZE;
+		inode->i_blocks = 0;
+		inode->i_atime = inode->i_mtime = inode->i_ctime = CURRENT_TIME;
+		inode->u.generic_ip = cg;
+		if (S_ISDIR(mode)) {
+			inode->i_op = &cpugroup_dir_inode_operations;
+			inode->i_fop = &simple_dir_operations;
+			inode->i_nlink++;
+		}
+	}
+	return inode;
+}
+
+static void cpugroup_delete_inode(struct inode *inode)
+{
+	cpugroup_put(inode->u.generic_ip);
+	clear_inode(inode);
+}
+
+/* The group of a file, NULL if it was removed.  Needs cpugroup_sem. */
+static inline struct task_group *inode_group(struct inode *inode)
+{
+	struct cpugroup *cg = inode->u.generic_ip;
+
+	return cg->tg;
+}
+
+static inline struct task_group *file_group(struct file *file)
+{
+	return inode_group(file->f_dentry->d_inode);
+}
+
+/*
+ * Copy a number written by the user, with a trailing newline allowed.
+ */
+static int cpugroup_get_user(const char __user *buf, size_t count,
+			     char *kbuf, size_t size)
+{
+	if (count >= size)
+		return -EINVAL;
+	if (copy_from_user(kbuf, buf, count))
+		return -EFAULT;
+	kbuf[count] = '\0';
+	if (count && kbuf[count - 1] == '\n')
+		kbuf[count - 1] = '\0';
+	return 0;
+}
+
+/*
+ * "tasks": the pid list is taken when the file is opened, so a reader
+ * sees one consistent snapshot however small its reads are.
+ */
+struct pid_list {
+	size_t len;
+	char buf[0];
+};
+
+static int tasks_open(struct inode *inode, struct file *file)
+{
+	struct task_group *tg;
+	struct pid_list *list;
+	task_t *g, *p;
+	size_t size;
+	int n = 0;
+
+	file->private_data = NULL;
+	if (!(file->f_mode & FMODE_READ))
+		return 0;
+
+	down(&cpugroup_sem);
+	tg = inode_group(inode);
+	if (!tg) {
+		up(&cpugroup_sem);
+		return -ENODEV;
+	}
+
+	read_lock(&tasklist_lock);
+	do_each_thread(g, p) {
+		if (sched_task_group(p) == tg)
+			n++;
+	} while_each_thread(g, p);
+	read_unlock(&tasklist_lock);
+
+	/* Leave room for tasks forked in the meantime: */
+	size = (n + 16) * 12;
+	list = kmalloc(sizeof(*list) + size, GFP_KERNEL);
+	if (!list) {
+		up(&cpugroup_sem);
+		return -ENOMEM;
+	}
+	list->len = 0;
+
+	read_lock(&tasklist_lock);
+	do_each_thread(g, p) {
+		if (sched_task_group(p) != tg)
+			continue;
+		if (size - list->len < 12)
+			goto out;
+		list->len += sprintf(list->buf + list->len, "%d\n", p->pid);
+	} while_each_thread(g, p);
+out:
+	read_unlock(&tasklist_lock);
+	up(&cpugroup_sem);
+
+	file->private_data = list;
+	return 0;
+}
+
+static ssize_t tasks_read(struct file *file, char __user *buf,
+			  size_t count, loff_t *ppos)
+{
+	struct pid_list *list = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, list->buf, list->len);
+}
+
+static ssize_t tasks_write(struct file *file, const char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	struct task_group *tg;
+	char kbuf[16], *end;
+	task_t *p;
+	pid_t pid;
+	int retval;
+
+	retval = cpugroup_get_user(buf, count, kbuf, sizeof(kbuf));
+	if (retval)
+		return retval;
+	pid = simple_strtoul(kbuf, &end, 10);
+	if (*end || pid <= 0)
+		return -EINVAL;
+
+	read_lock(&tasklist_lock);
+	p = find_task_by_pid(pid);
+	if (!p) {
+		read_unlock(&tasklist_lock);
+		return -ESRCH;
+	}
+	get_task_struct(p);
+	read_unlock(&tasklist_lock);
+
+	/* Same rule as sched_setaffinity(): */
+	retval = -EPERM;
+	if ((current->euid != p->euid) && (current->euid != p->uid) &&
+			!capable(CAP_SYS_NICE))
+		goto out;
+
+	down(&cpugroup_sem);
+	tg = file_group(file);
+	retval = tg ? sched_move_task(p, tg) : -ENODEV;
+	up(&cpugroup_sem);
+out:
+	put_task_struct(p);
+	return retval ? retval : count;
+}
+
+static int tasks_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+static struct file_operations tasks_fops = {
+	.open		= tasks_open,
+	.read		= tasks_read,
+	.write		= tasks_write,
+	.release	= tasks_release,
+};
+
+static ssize_t shares_read(struct file *file, char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	struct task_group *tg;
+	unsigned long shares = 0;
+	char kbuf[24];
+	int len;
+
+	down(&cpugroup_sem);
+	tg = file_group(file);
+	if (tg)
+		shares = sched_group_shares(tg);
+	up(&cpugroup_sem);
+	if (!tg)
+		return -ENODEV;
+
+	len = sprintf(kbuf, "%lu\n", shares);
+	return simple_read_from_buffer(buf, count, ppos, kbuf, len);
+}
+
+static ssize_t shares_write(struct file *file, const char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	struct task_group *tg;
+	char kbuf[24], *end;
+	unsigned long shares;
+	int retval;
+
+	retval = cpugroup_get_user(buf, count, kbuf, sizeof(kbuf));
+	if (retval)
+		return retval;
+	shares = simple_strtoul(kbuf, &end, 10);
+	if (*end)
+		return -EINVAL;
+
+	down(&cpugroup_sem);
+	tg = file_group(file);
+	retval = tg ? sched_group_set_shares(tg, shares) : -ENODEV;
+	up(&cpugroup_sem);
+	return retval ? retval : count;
+}
+
+static struct file_operations shares_fops = {
+	.read		= shares_read,
+	.write		= shares_write,
+};
+
+/*
+ * cpu.cfs_quota_us and cpu.cfs_period_us: microseconds to the user,
+ * nanoseconds to the scheduler.
+ */
+static ssize_t bandwidth_read(struct file *file, char __user *buf,
+			      size_t count, loff_t *ppos, int want_quota)
+{
+	unsigned long long quota, period, val;
+	struct task_group *tg;
+	char kbuf[24];
+	int len;
+
+	down(&cpugroup_sem);
+	tg = file_group(file);
+	if (tg)
+		sched_group_bandwidth(tg, &quota, &period);
+	up(&cpugroup_sem);
+	if (!tg)
+		return -ENODEV;
+
+	val = want_quota ? quota : period;
+	if (val == RUNTIME_INF)
+		len = sprintf(kbuf, "-1\n");
+	else {
+		do_div(val, 1000);
+		len = sprintf(kbuf, "%llu\n", val);
+	}
+	return simple_read_from_buffer(buf, count, ppos, kbuf, len);
+}
+
+static ssize_t bandwidth_write(struct file *file, const char __user *buf,
+			       size_t count, loff_t *ppos, int want_quota)
+{
+	struct task_group *tg;
+	unsigned long long quota, period;
+	char kbuf[24], *end;
+	long val;
+	int retval;
+
+	retval = cpugroup_get_user(buf, count, kbuf, sizeof(kbuf));
+	if (retval)
+		return retval;
+	val = simple_strtol(kbuf, &end, 10);
+	if (*end)
+		return -EINVAL;
+	if (!want_quota && val <= 0)
+		return -EINVAL;
+
+	down(&cpugroup_sem);
+	tg = file_group(file);
+	retval = -ENODEV;
+	if (tg) {
+		sched_group_bandwidth(tg, &quota, &period);
+		if (!want_quota)
+			period = val * 1000ULL;
+		else if (val < 0)
+			quota = RUNTIME_INF;
+		else
+			quota = val * 1000ULL;
+		retval = sched_group_set_bandwidth(tg, quota, period);
+	}
+	up(&cpugroup_sem);
+	return retval ? retval : count;
+}
+
+static ssize_t quota_read(struct file *file, char __user *buf,
+			  size_t count, loff_t *ppos)
+{
+	return bandwidth_read(file, buf, count, ppos, 1);
+}
+
+static ssize_t quota_write(struct file *file, const char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	return bandwidth_write(file, buf, count, ppos, 1);
+}
+
+static ssize_t period_read(struct file *file, char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	return bandwidth_read(file, buf, count, ppos, 0);
+}
+
+static ssize_t period_write(struct file *file, const char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	return bandwidth_write(file, buf, count, ppos, 0);
+}
+
+static struct file_operations quota_fops = {
+	.read		= quota_read,
+	.write		= quota_write,
+};
+
+static struct file_operations period_fops = {
+	.read		= period_read,
+	.write		= period_write,
+};
+
+static struct cpugroup_file {
+	const char *name;
+	struct file_operations *fops;
+} cpugroup_files[] = {
+	{ "tasks",		&tasks_fops },
+	{ "cpu.shares",		&shares_fops },
+	{ "cpu.cfs_quota_us",	&quota_fops },
+	{ "cpu.cfs_period_us",	&period_fops },
+};
+
+/*
+ * Create the first @nr files of cpugroup_files in @dir.  The dentries
+ * keep the reference from d_alloc() until cpugroup_depopulate().
+ */
+static int cpugroup_populate(struct dentry *dir, struct cpugroup *cg,
+			     int nr)
+{
+	struct dentry *dentry;
+	struct inode *inode;
+	struct qstr name;
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		name.name = cpugroup_files[i].name;
+		name.len = strlen(name.name);
+		name.hash = full_name_hash(name.name, name.len);
+
+		dentry = d_alloc(dir, &name);
+		if (!dentry)
+			return -ENOMEM;
+		inode = cpugroup_get_inode(dir->d_sb, S_IFREG | 0644, cg);
+		if (!inode) {
+			dput(dentry);
+			return -ENOMEM;
+		}
+		inode->i_fop = cpugroup_files[i].fops;
+		d_add(dentry, inode);
+	}
+	return 0;
+}
+
+/* Called with dir->d_inode->i_mutex held. */
+static void cpugroup_depopulate(struct dentry *dir)
+{
+	struct dentry *dentry;
+	const char *name;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cpugroup_files); i++) {
+		name = cpugroup_files[i].name;
+		dentry = lookup_one_len(name, dir, strlen(name));
+		if (IS_ERR(dentry))
+			continue;
+		if (dentry->d_inode) {
+			simple_unlink(dir->d_inode, dentry);
+			d_delete(dentry);
+		}
+		dput(dentry);
+	}
+}
+
+static int cpugroup_mkdir(struct inode *dir, struct dentry *dentry, int mode)
+{
+	struct task_group *parent, *tg;
+	struct cpugroup *cg;
+	struct inode *inode;
+	int retval;
+
+	down(&cpugroup_sem);
+	retval = -ENODEV;
+	parent = inode_group(dir);
+	if (!parent)
+		goto out;
+	retval = -ENOMEM;
+	cg = kmalloc(sizeof(*cg), GFP_KERNEL);
+	if (!cg)
+		goto out;
+	tg = sched_create_group(parent);
+	retval = PTR_ERR(tg);
+	if (IS_ERR(tg)) {
+		kfree(cg);
+		goto out;
+	}
+	cg->tg = tg;
+	atomic_set(&cg->count, 1);	/* dropped below */
+
+	retval = -ENOMEM;
+	inode = cpugroup_get_inode(dir->i_sb, S_IFDIR | mode, cg);
+	if (!inode) {
+		sched_destroy_group(tg);
+		cpugroup_put(cg);
+		goto out;
+	}
+	d_instantiate(dentry, inode);
+	dget(dentry);	/* pin it, as ramfs does */
+	dir->i_nlink++;
+
+	retval = cpugroup_populate(dentry, cg, ARRAY_SIZE(cpugroup_files));
+	if (retval) {
+		mutex_lock(&inode->i_mutex);
+		cpugroup_depopulate(dentry);
+		mutex_unlock(&inode->i_mutex);
+		simple_rmdir(dir, dentry);
+		d_delete(dentry);
+		sched_destroy_group(tg);
+		cg->tg = NULL;
+	}
+	cpugroup_put(cg);
+out:
+	up(&cpugroup_sem);
+	return retval;
+}
+
+static int cpugroup_rmdir(struct inode *dir, struct dentry *dentry)
+{
+	struct cpugroup *cg = dentry->d_inode->u.generic_ip;
+	int retval;
+
+	down(&cpugroup_sem);
+	retval = cg->tg ? sched_destroy_group(cg->tg) : -ENOENT;
+	if (!retval) {
+		/* Open files see NULL from now on, see file_group() */
+		cg->tg = NULL;
+		cpugroup_depopulate(dentry);
+		retval = simple_rmdir(dir, dentry);
+	}
+	up(&cpugroup_sem);
+	return retval;
+}
+
+static struct inode_operations cpugroup_dir_inode_operations = {
+	.lookup		= simple_lookup,
+	.mkdir		= cpugroup_mkdir,
+	.rmdir		= cpugroup_rmdir,
+};
+
+static struct super_operations cpugroup_ops = {
+	.statfs		= simple_statfs,
+	.drop_inode	= generic_delete_inode,
+	.delete_inode	= cpugroup_delete_inode,
+};
+
+static int cpugroup_fill_super(struct super_block *sb, void *data, int silent)
+{
+	struct inode *inode;
+	struct dentry *root;
+
+	sb->s_blocksize = PAGE_CACHE_SIZE;
+	sb->s_blocksize_bits = PAGE_CACHE_SHIFT;
+	sb->s_magic = CPUGROUP_MAGIC;
+	sb->s_op = &cpugroup_ops;
+	sb->s_time_gran = 1;
+	inode = cpugroup_get_inode(sb, S_IFDIR | 0755, &root_cpugroup);
+	if (!inode)
+		return -ENOMEM;
+
+	root = d_alloc_root(inode);
+	if (!root) {
+		iput(inode);
+		return -ENOMEM;
+	}
+	sb->s_root = root;
+
+	/* The root group has no shares or quota to set: only "tasks". */
+	return cpugroup_populate(root, &root_cpugroup, 1);
+}
+
+static struct super_block *cpugroup_get_sb(struct file_system_type *fs_type,
+	int flags, const char *dev_name, void *data)
+{
+	return get_sb_single(fs_type, flags, data, cpugroup_fill_super);
+}
+
+static struct file_system_type cpugroup_fs_type = {
+	.name		= "cpugroup",
+	.get_sb		= cpugroup_get_sb,
+	.kill_sb	= kill_litter_super,
+};
+
+static int __init init_cpugroup_fs(void)
+{
+	return register_filesystem(&cpugroup_fs_type);
+}
+
+__initcall(init_cpugroup_fs);
@@ -0,0 +1,57 @@
+/*
+ * kernel/delayacct.c
+ *
+ * Per-task delay accounting: the time a task spends sleeping in
+ * io_schedule(), charged to swap-in if it is faulting a page in from
+ * swap and to block I/O otherwise.  The totals are exported through
+ * taskstats, together with the runqueue delay kept by sched_info.
+ *
+ * Only the task itself updates its counters; the lock is there so
+ * that the 64-bit values can be read from elsewhere.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/time.h>
+#include <linux/delayacct.h>
+
+/* Monotonic, and the same on all cpus: a task may wake up elsewhere */
+static inline u64 delayacct_now(void)
+{
+	struct timespec ts;
+
+	do_posix_clock_monotonic_gettime(&ts);
+	return (u64)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void delayacct_init(struct task_delay_info *d)
+{
+	memset(d, 0, sizeof(*d));
+	spin_lock_init(&d->lock);
+}
+
+void delayacct_blkio_start(void)
+{
+	current->delays.blkio_start = delayacct_now();
+}
+
+void delayacct_blkio_end(void)
+{
+	struct task_delay_info *d = &current->delays;
+	u64 now = delayacct_now();
+	s64 delta = now - d->blkio_start;
+
+	if (delta < 0)
+		delta = 0;
+
+	spin_lock(&d->lock);
+	if (d->flags & DELAYACCT_PF_SWAPIN) {
+		d->swapin_delay += delta;
+		d->swapin_count++;
+	} else {
+		d->blkio_delay += delta;
+		d->blkio_count++;
+	}
+	spin_unlock(&d->lock);
+}
@@ -26,6 +26,8 @@
 #include <linux/proc_fs.h>
 #include <linux/mempolicy.h>
 #include <linux/syscalls.h>
+#include <linux/futex.h>
+#include <linux/taskstats.h>
 
 #include <asm/uaccess.h>
 #include <asm/unistd.h>
@@ -941,6 +943,10 @@ fastcall NORET_TYPE void do_exit(long code)
 	 * exit_mmӽзҳص
 	 * û̹ЩݽṹɾЩݽṹ
 	 */
+	/* Release robust and PI futexes while the mm is still around: */
+	exit_robust_list(tsk);
+	exit_pi_state_list(tsk);
+
 	exit_mm(tsk);
 
 	/**
@@ -964,6 +970,7 @@ fastcall NORET_TYPE void do_exit(long code)
 	 */		
 	exit_thread();
 	exit_keys(tsk);
+	taskstats_exit(tsk, code);
 
 	if (group_dead && tsk->signal->leader)
 		disassociate_ctty(1);
@@ -40,6 +40,9 @@
 #include <linux/profile.h>
 #include <linux/rmap.h>
 #include <linux/acct.h>
+#include <linux/perf_counter.h>
+#include <linux/delayacct.h>
+#include <linux/task_io_accounting_ops.h>
 
 #include <asm/pgtable.h>
 #include <asm/pgalloc.h>
@@ -85,6 +88,8 @@ static kmem_cache_t *task_struct_cachep;
 
 void free_task(struct task_struct *tsk)
 {
+	sched_group_free(tsk);
+	perf_counter_task_free(tsk);
 	free_thread_info(tsk->thread_info);
 	free_task_struct(tsk);
 }
@@ -176,6 +181,7 @@ static struct task_struct *dup_task_struct(struct task_struct *orig)
 	*tsk = *orig;
 	tsk->thread_info = ti;
 	ti->task = tsk;
+	sched_group_fork(tsk);
 
 	/* One for us, one for whoever does the "release_task()" (usually parent) */
 	/**
@@ -840,6 +846,9 @@ static inline int copy_signal(unsigned long clone_flags, struct task_struct * ts
 	sig->utime = sig->stime = sig->cutime = sig->cstime = cputime_zero;
 	sig->nvcsw = sig->nivcsw = sig->cnvcsw = sig->cnivcsw = 0;
 	sig->min_flt = sig->maj_flt = sig->cmin_flt = sig->cmaj_flt = 0;
+#ifdef CONFIG_TASKSTATS
+	memset(&sig->stats, 0, sizeof(sig->stats));
+#endif
 
 	task_lock(current->group_leader);
 	memcpy(sig->rlim, current->signal->rlim, sizeof sig->rlim);
@@ -852,7 +861,7 @@ static inline void copy_flags(unsigned long clone_flags, struct task_struct *p)
 {
 	unsigned long new_flags = p->flags;
 
-	new_flags &= ~PF_SUPERPRIV;
+	new_flags &= ~(PF_SUPERPRIV | PF_WQ_WORKER);
 	new_flags |= PF_FORKNOEXEC;
 	if (!(clone_flags & CLONE_PTRACE))
 		p->ptrace = 0;
@@ -1129,6 +1138,20 @@ static task_t *copy_process(unsigned long clone_flags,
 	 * Clear TID on mm_release()?
 	 */
 	p->clear_child_tid = (clone_flags & CLONE_CHILD_CLEARTID) ? child_tidptr: NULL;
+#ifdef CONFIG_FUTEX
+	p->robust_list = NULL;
+	INIT_LIST_HEAD(&p->pi_state_list);
+#endif
+#ifdef CONFIG_TASK_DELAY_ACCT
+	delayacct_init(&p->delays);
+#endif
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+	task_io_accounting_init(&p->ioac);
+#endif
+#ifdef CONFIG_PERF_COUNTERS
+	p->perf_counter_ctxp = NULL;
+	p->perf_counter_cpu = -1;
+#endif
 
 	/*
 	 * Syscall tracing should be turned off in the child regardless
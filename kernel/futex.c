@@ -8,6 +8,8 @@
  *  Removed page pinning, fix privately mapped COW pages and other cleanups
  *  (C) Copyright 2003, 2004 Jamie Lokier
  *
+ *  Robust futex support and PI-futex support on top of rt_mutexes
+ *
  *  Thanks to Ben LaHaise for yelling "hashed waitqueues" loudly
  *  enough at me, Linus for the original (flawed) idea, Matthew
  *  Kirkwood for proof-of-concept implementation.
@@ -39,8 +41,10 @@
 #include <linux/mount.h>
 #include <linux/pagemap.h>
 #include <linux/syscalls.h>
+#include <linux/rtmutex.h>
+#include <linux/bootmem.h>
 
-#define FUTEX_HASHBITS 8
+#include <asm/futex.h>
 
 /*
  * Futexes are matched on equal values of this key.
@@ -68,6 +72,27 @@ union futex_key {
 	} both;
 };
 
+/*
+ * Priority Inheritance state of a PI futex. Allocated when the first
+ * waiter blocks in the kernel, freed when the last one leaves. The
+ * rt_mutex is owned (possibly by proxy) by the task whose TID is in
+ * the futex word.
+ */
+struct futex_pi_state {
+	/*
+	 * list of 'owned' pi_state instances - these have to be
+	 * cleaned up in do_exit() if the task exits prematurely:
+	 */
+	struct list_head list;
+
+	struct rt_mutex pi_mutex;
+
+	struct task_struct *owner;
+	atomic_t refcount;
+
+	union futex_key key;
+};
+
 /*
  * We use this hashed waitqueue instead of a normal wait_queue_t, so
  * we can wake only the relevant ones (hashed queues may be shared).
@@ -90,18 +115,34 @@ struct futex_q {
 	/* For fd, sigio sent using these. */
 	int fd;
 	struct file *filp;
+
+	/* PI futexes: the waiter sleeps on pi_state->pi_mutex instead. */
+	struct futex_pi_state *pi_state;
 };
 
 /*
  * Split the global futex_lock into every hash list lock.
+ * Each bucket gets its own cacheline, so that CPUs hammering on
+ * different futexes don't bounce each other's locks.
  */
 struct futex_hash_bucket {
        spinlock_t              lock;
        unsigned int	    nqueued;
        struct list_head       chain;
-};
+} ____cacheline_aligned_in_smp;
+
+/*
+ * The hash table is sized at boot, by the number of possible CPUs.
+ * With hashdist (the NUMA default) it is spread over all nodes.
+ */
+static struct futex_hash_bucket *futex_queues;
+static unsigned int futex_hashmask;
 
-static struct futex_hash_bucket futex_queues[1<<FUTEX_HASHBITS];
+/*
+ * Protects the pi_state_list of every task and pi_state->owner.
+ * Nests inside the hash bucket locks.
+ */
+static DEFINE_SPINLOCK(pi_state_lock);
 
 /* Futex-fs vfsmount entry: */
 static struct vfsmount *futex_mnt;
@@ -114,7 +155,7 @@ static struct futex_hash_bucket *hash_futex(union futex_key *key)
 	u32 hash = jhash2((u32*)&key->both.word,
 			  (sizeof(key->both.word)+sizeof(key->both.ptr))/4,
 			  key->both.offset);
-	return &futex_queues[hash & ((1 << FUTEX_HASHBITS)-1)];
+	return &futex_queues[hash & futex_hashmask];
 }
 
 /*
@@ -137,9 +178,13 @@ static inline int match_futex(union futex_key *key1, union futex_key *key2)
  * Returns: 0, or negative error code.
  * The key words are stored in *key on success.
  *
- * Should be called with &current->mm->mmap_sem but NOT any spinlocks.
+ * For shared futexes, fshared is &current->mm->mmap_sem, and it must be
+ * held by the caller (but NOT any spinlocks). Process-private futexes
+ * pass a NULL fshared: they are keyed on (current->mm, uaddr) without
+ * looking at the VMA, so no mmap_sem is needed.
  */
-static int get_futex_key(unsigned long uaddr, union futex_key *key)
+static int get_futex_key(unsigned long uaddr, struct rw_semaphore *fshared,
+			 union futex_key *key)
 {
 	struct mm_struct *mm = current->mm;
 	struct vm_area_struct *vma;
@@ -154,6 +199,23 @@ static int get_futex_key(unsigned long uaddr, union futex_key *key)
 		return -EINVAL;
 	uaddr -= key->both.offset;
 
+	/*
+	 * PROCESS_PRIVATE futexes are fast.
+	 * As the mm cannot disappear under us and the 'key' only needs
+	 * the virtual address, we don't even have to find the underlying
+	 * vma. The key is the same one a private mapping gets below, so
+	 * private and shared operations on the same futex still match.
+	 * We do have to check that 'uaddr' is a valid user address, but
+	 * access_ok() is much cheaper than find_vma().
+	 */
+	if (!fshared) {
+		if (unlikely(!access_ok(VERIFY_WRITE, uaddr, sizeof(u32))))
+			return -EFAULT;
+		key->private.mm = mm;
+		key->private.uaddr = uaddr;
+		return 0;
+	}
+
 	/*
 	 * The futex is hashed differently depending on whether
 	 * it's in a shared or private mapping.  So check vma first.
@@ -258,6 +320,21 @@ static void drop_key_refs(union futex_key *key)
 	}
 }
 
+/*
+ * mmap_sem is only taken for shared futexes, see get_futex_key().
+ */
+static inline void futex_lock_mm(struct rw_semaphore *fshared)
+{
+	if (fshared)
+		down_read(fshared);
+}
+
+static inline void futex_unlock_mm(struct rw_semaphore *fshared)
+{
+	if (fshared)
+		up_read(fshared);
+}
+
 static inline int get_futex_value_locked(int *dest, int __user *from)
 {
 	int ret;
@@ -270,6 +347,129 @@ static inline int get_futex_value_locked(int *dest, int __user *from)
 	return ret ? -EFAULT : 0;
 }
 
+/*
+ * Returns the value found at @uaddr, which equals @uval if the
+ * exchange happened, or -EFAULT, or -ENOSYS where the cpu has no
+ * cmpxchg. Neither error is a possible futex value: no TID is that
+ * large. Safe to call with spinlocks held.
+ */
+static inline int cmpxchg_futex_value_locked(u32 __user *uaddr,
+					     u32 uval, u32 newval)
+{
+	int curval;
+
+	inc_preempt_count();
+	curval = futex_atomic_cmpxchg_inatomic((int __user *)uaddr,
+					       uval, newval);
+	dec_preempt_count();
+
+	return curval;
+}
+
+/*
+ * Fault in the futex word for writing, so that a subsequent atomic
+ * cmpxchg on it succeeds. mmap_sem must be held for shared futexes,
+ * it is taken here for private ones.
+ */
+static int futex_handle_fault(unsigned long address,
+			      struct rw_semaphore *fshared)
+{
+	struct mm_struct *mm = current->mm;
+	int ret;
+
+	if (!fshared)
+		down_read(&mm->mmap_sem);
+	ret = get_user_pages(current, mm, address, 1, 1, 0, NULL, NULL);
+	if (!fshared)
+		up_read(&mm->mmap_sem);
+
+	return ret < 0 ? ret : 0;
+}
+
+/*
+ * Find the pi_state attached to the waiters of @key, if any.
+ * The hash bucket lock must be held.
+ */
+static struct futex_pi_state *
+lookup_pi_state(struct futex_hash_bucket *bh, union futex_key *key)
+{
+	struct futex_q *this;
+
+	list_for_each_entry(this, &bh->chain, list) {
+		if (this->pi_state && match_futex(&this->key, key))
+			return this->pi_state;
+	}
+	return NULL;
+}
+
+/*
+ * Create the pi_state for the first kernel-side waiter of a PI futex
+ * owned by the task with TID @pid. The rt_mutex is proxy-locked on
+ * behalf of the owner, so the owner gets boosted by the waiters.
+ * The hash bucket lock must be held.
+ */
+static int attach_pi_state(pid_t pid, union futex_key *key,
+			   struct futex_pi_state **prealloc,
+			   struct futex_pi_state **ps)
+{
+	struct futex_pi_state *pi_state;
+	struct task_struct *p;
+
+	read_lock(&tasklist_lock);
+	p = find_task_by_pid(pid);
+	if (!p) {
+		read_unlock(&tasklist_lock);
+		return -ESRCH;
+	}
+	spin_lock(&pi_state_lock);
+	/*
+	 * Pairs with the pi_state_lock taken by exit_pi_state_list(): if
+	 * we don't see PF_EXITING here, the exiting owner will see our
+	 * pi_state on its list.
+	 */
+	if (unlikely(p->flags & PF_EXITING)) {
+		spin_unlock(&pi_state_lock);
+		read_unlock(&tasklist_lock);
+		return -EAGAIN;
+	}
+
+	pi_state = *prealloc;
+	*prealloc = NULL;
+	rt_mutex_init_proxy_locked(&pi_state->pi_mutex, p);
+	atomic_set(&pi_state->refcount, 1);
+	pi_state->key = *key;
+	pi_state->owner = p;
+	list_add(&pi_state->list, &p->pi_state_list);
+
+	spin_unlock(&pi_state_lock);
+	read_unlock(&tasklist_lock);
+
+	*ps = pi_state;
+	return 0;
+}
+
+/*
+ * Drop a reference to a pi_state. The last reference releases the
+ * proxy-locked rt_mutex and frees it. The hash bucket lock must be held.
+ */
+static void free_pi_state(struct futex_pi_state *pi_state)
+{
+	struct task_struct *owner;
+
+	if (!atomic_dec_and_test(&pi_state->refcount))
+		return;
+
+	spin_lock(&pi_state_lock);
+	owner = pi_state->owner;
+	if (owner)
+		list_del_init(&pi_state->list);
+	spin_unlock(&pi_state_lock);
+
+	if (owner)
+		rt_mutex_proxy_unlock(&pi_state->pi_mutex, owner);
+	kfree(pi_state);
+}
+
 /*
  * The hash bucket lock must be held when this is called.
  * Afterwards, the futex_q must not be accessed.
@@ -295,7 +495,8 @@ static void wake_futex(struct futex_q *q)
  * Wake up all waiters hashed on the physical page that is mapped
  * to this virtual address:
  */
-static int futex_wake(unsigned long uaddr, int nr_wake)
+static int futex_wake(unsigned long uaddr, struct rw_semaphore *fshared,
+		      int nr_wake)
 {
 	union futex_key key;
 	struct futex_hash_bucket *bh;
@@ -303,9 +504,9 @@ static int futex_wake(unsigned long uaddr, int nr_wake)
 	struct futex_q *this, *next;
 	int ret;
 
-	down_read(&current->mm->mmap_sem);
+	futex_lock_mm(fshared);
 
-	ret = get_futex_key(uaddr, &key);
+	ret = get_futex_key(uaddr, fshared, &key);
 	if (unlikely(ret != 0))
 		goto out;
 
@@ -315,6 +516,10 @@ static int futex_wake(unsigned long uaddr, int nr_wake)
 
 	list_for_each_entry_safe(this, next, head, list) {
 		if (match_futex (&this->key, &key)) {
+			if (this->pi_state) {
+				ret = -EINVAL;
+				break;
+			}
 			wake_futex(this);
 			if (++ret >= nr_wake)
 				break;
@@ -323,7 +528,7 @@ static int futex_wake(unsigned long uaddr, int nr_wake)
 
 	spin_unlock(&bh->lock);
 out:
-	up_read(&current->mm->mmap_sem);
+	futex_unlock_mm(fshared);
 	return ret;
 }
 
@@ -331,8 +536,9 @@ out:
  * Requeue all waiters hashed on one physical page to another
  * physical page.
  */
-static int futex_requeue(unsigned long uaddr1, unsigned long uaddr2,
-			 int nr_wake, int nr_requeue, int *valp)
+static int futex_requeue(unsigned long uaddr1, struct rw_semaphore *fshared,
+			 unsigned long uaddr2, int nr_wake, int nr_requeue,
+			 int *valp)
 {
 	union futex_key key1, key2;
 	struct futex_hash_bucket *bh1, *bh2;
@@ -342,12 +548,12 @@ static int futex_requeue(unsigned long uaddr1, unsigned long uaddr2,
 	unsigned int nqueued;
 
  retry:
-	down_read(&current->mm->mmap_sem);
+	futex_lock_mm(fshared);
 
-	ret = get_futex_key(uaddr1, &key1);
+	ret = get_futex_key(uaddr1, fshared, &key1);
 	if (unlikely(ret != 0))
 		goto out;
-	ret = get_futex_key(uaddr2, &key2);
+	ret = get_futex_key(uaddr2, fshared, &key2);
 	if (unlikely(ret != 0))
 		goto out;
 
@@ -374,7 +580,7 @@ static int futex_requeue(unsigned long uaddr1, unsigned long uaddr2,
 			/* If we would have faulted, release mmap_sem, fault
 			 * it in and start all over again.
 			 */
-			up_read(&current->mm->mmap_sem);
+			futex_unlock_mm(fshared);
 
 			ret = get_user(curval, (int __user *)uaddr1);
 
@@ -404,6 +610,10 @@ static int futex_requeue(unsigned long uaddr1, unsigned long uaddr2,
 	list_for_each_entry_safe(this, next, head1, list) {
 		if (!match_futex (&this->key, &key1))
 			continue;
+		if (this->pi_state) {
+			ret = -EINVAL;
+			break;
+		}
 		if (++ret <= nr_wake) {
 			wake_futex(this);
 		} else {
@@ -431,7 +641,7 @@ out_unlock:
 		drop_key_refs(&key1);
 
 out:
-	up_read(&current->mm->mmap_sem);
+	futex_unlock_mm(fshared);
 	return ret;
 }
 
@@ -447,6 +657,7 @@ static void queue_me(struct futex_q *q, int fd, struct file *filp)
 
 	q->fd = fd;
 	q->filp = filp;
+	q->pi_state = NULL;
 
 	init_waitqueue_head(&q->waiters);
 
@@ -498,16 +709,17 @@ static int unqueue_me(struct futex_q *q)
 	return ret;
 }
 
-static int futex_wait(unsigned long uaddr, int val, unsigned long time)
+static int futex_wait(unsigned long uaddr, struct rw_semaphore *fshared,
+		      int val, unsigned long time)
 {
 	DECLARE_WAITQUEUE(wait, current);
 	int ret, curval;
 	struct futex_q q;
 
  retry:
-	down_read(&current->mm->mmap_sem);
+	futex_lock_mm(fshared);
 
-	ret = get_futex_key(uaddr, &q.key);
+	ret = get_futex_key(uaddr, fshared, &q.key);
 	if (unlikely(ret != 0))
 		goto out_release_sem;
 
@@ -540,7 +752,7 @@ static int futex_wait(unsigned long uaddr, int val, unsigned long time)
 		/* If we would have faulted, release mmap_sem, fault it in and
 		 * start all over again.
 		 */
-		up_read(&current->mm->mmap_sem);
+		futex_unlock_mm(fshared);
 
 		if (!unqueue_me(&q)) /* There's a chance we got woken already */
 			return 0;
@@ -560,7 +772,7 @@ static int futex_wait(unsigned long uaddr, int val, unsigned long time)
 	 * Now the futex is queued and we have checked the data, we
 	 * don't want to hold mmap_sem while we sleep.
 	 */	
-	up_read(&current->mm->mmap_sem);
+	futex_unlock_mm(fshared);
 
 	/*
 	 * There might have been scheduling since the queue_me(), as we
@@ -601,7 +813,7 @@ static int futex_wait(unsigned long uaddr, int val, unsigned long time)
 	if (!unqueue_me(&q))
 		ret = 0;
  out_release_sem:
-	up_read(&current->mm->mmap_sem);
+	futex_unlock_mm(fshared);
 	return ret;
 }
 
@@ -687,7 +899,7 @@ static int futex_fd(unsigned long uaddr, int signal)
 	}
 
 	down_read(&current->mm->mmap_sem);
-	err = get_futex_key(uaddr, &q->key);
+	err = get_futex_key(uaddr, &current->mm->mmap_sem, &q->key);
 
 	if (unlikely(err != 0)) {
 		up_read(&current->mm->mmap_sem);
@@ -712,27 +924,599 @@ out:
 	return ret;
 }
 
+/*
+ * Make current the owner of the futex word at @uaddr after it acquired
+ * the rt_mutex of a PI futex. Preserves FUTEX_OWNER_DIED and keeps
+ * FUTEX_WAITERS set, so the next unlock goes through the kernel.
+ * Called without any locks held, so faults can be handled.
+ */
+static int fixup_pi_owner(u32 __user *uaddr)
+{
+	u32 uval, newval;
+	int curval, ret;
+
+	if (get_user(uval, uaddr))
+		return -EFAULT;
+
+	for (;;) {
+		newval = (uval & FUTEX_OWNER_DIED) | current->pid |
+			 FUTEX_WAITERS;
+		if (uval == newval)
+			return 0;
+
+		curval = cmpxchg_futex_value_locked(uaddr, uval, newval);
+		if (curval == -ENOSYS)
+			return -ENOSYS;
+		if (curval == -EFAULT) {
+			ret = futex_handle_fault((unsigned long)uaddr, NULL);
+			if (ret)
+				return ret;
+			if (get_user(uval, uaddr))
+				return -EFAULT;
+			continue;
+		}
+		if (curval == uval)
+			return 0;
+		uval = curval;
+	}
+}
+
+/*
+ * Userspace tried a 0 -> TID atomic transition of the futex value
+ * and failed. The kernel side here does the whole locking operation:
+ * if there are waiters then it will block, it does PI, etc. (Due to
+ * races the kernel might see a 0 value of the futex too.)
+ */
+static int futex_lock_pi(unsigned long uaddr, struct rw_semaphore *fshared,
+			 unsigned long time, int trylock)
+{
+	struct futex_pi_state *pi_state, *prealloc;
+	struct futex_hash_bucket *bh;
+	u32 uval, newval;
+	int ret, curval, attempt = 0;
+	struct futex_q q;
+
+	prealloc = kmalloc(sizeof(*prealloc), GFP_KERNEL);
+	if (!prealloc)
+		return -ENOMEM;
+
+ retry:
+	pi_state = NULL;
+	futex_lock_mm(fshared);
+
+	ret = get_futex_key(uaddr, fshared, &q.key);
+	if (unlikely(ret != 0))
+		goto out_release_sem;
+
+	init_waitqueue_head(&q.waiters);
+	q.fd = -1;
+	q.filp = NULL;
+	q.pi_state = NULL;
+	get_key_refs(&q.key);
+	bh = hash_futex(&q.key);
+	q.lock_ptr = &bh->lock;
+	spin_lock(&bh->lock);
+
+ retry_locked:
+	/*
+	 * To avoid races, we attempt to take the lock here again
+	 * (by doing a 0 -> TID atomic cmpxchg), while holding all
+	 * the locks. It will most likely not succeed.
+	 */
+	newval = current->pid;
+	curval = cmpxchg_futex_value_locked((u32 __user *)uaddr, 0, newval);
+	if (unlikely(curval == -EFAULT))
+		goto uaddr_faulted;
+	ret = -ENOSYS;
+	if (unlikely(curval == -ENOSYS))
+		goto out_unlock;
+
+	/* We got the lock. */
+	ret = 0;
+	if (curval == 0)
+		goto out_unlock;
+
+	/* Detect deadlocks on ourselves: */
+	ret = -EDEADLK;
+	if ((curval & FUTEX_TID_MASK) == current->pid)
+		goto out_unlock;
+
+	pi_state = lookup_pi_state(bh, &q.key);
+
+	/*
+	 * No owner and nobody waiting in the kernel: the previous owner
+	 * died (and the robust list cleanup released the word), so we
+	 * take over and tell userspace via FUTEX_OWNER_DIED.
+	 */
+	if (!pi_state && !(curval & FUTEX_TID_MASK)) {
+		uval = curval;
+		newval = current->pid | (uval & FUTEX_OWNER_DIED);
+		curval = cmpxchg_futex_value_locked((u32 __user *)uaddr,
+						    uval, newval);
+		if (unlikely(curval == -EFAULT))
+			goto uaddr_faulted;
+		if (curval != uval)
+			goto retry_locked;
+		ret = 0;
+		goto out_unlock;
+	}
+
+	ret = -EWOULDBLOCK;
+	if (trylock)
+		goto out_unlock;
+
+	/*
+	 * Set the waiters bit, so the owner has to enter the kernel
+	 * to release the lock:
+	 */
+	if (!(curval & FUTEX_WAITERS)) {
+		uval = curval;
+		curval = cmpxchg_futex_value_locked((u32 __user *)uaddr,
+						    uval, uval | FUTEX_WAITERS);
+		if (unlikely(curval == -EFAULT))
+			goto uaddr_faulted;
+		if (curval != uval)
+			goto retry_locked;
+	}
+
+	if (pi_state)
+		atomic_inc(&pi_state->refcount);
+	else {
+		ret = attach_pi_state(curval & FUTEX_TID_MASK, &q.key,
+				      &prealloc, &pi_state);
+		if (unlikely(ret)) {
+			if (ret != -EAGAIN)
+				goto out_unlock;
+			/*
+			 * The owner is exiting and will release the word
+			 * through its robust list, or vanish. Retry.
+			 */
+			spin_unlock(&bh->lock);
+			futex_unlock_mm(fshared);
+			drop_key_refs(&q.key);
+			yield();
+			goto retry;
+		}
+	}
+
+	/* Queue ourselves, so that the unlocker finds the pi_state: */
+	q.pi_state = pi_state;
+	bh->nqueued++;
+	list_add_tail(&q.list, &bh->chain);
+	spin_unlock(&bh->lock);
+
+	futex_unlock_mm(fshared);
+
+	/* Block on the rt_mutex, boosting the owner meanwhile: */
+	ret = rt_mutex_timed_lock(&pi_state->pi_mutex, time);
+
+	/* We own the rt_mutex: make the futex word say so as well. */
+	if (!ret) {
+		ret = fixup_pi_owner((u32 __user *)uaddr);
+		if (ret)
+			rt_mutex_unlock(&pi_state->pi_mutex);
+	}
+
+	spin_lock(q.lock_ptr);
+	if (!ret && pi_state->owner != current) {
+		spin_lock(&pi_state_lock);
+		if (pi_state->owner)
+			list_del_init(&pi_state->list);
+		list_add(&pi_state->list, &current->pi_state_list);
+		pi_state->owner = current;
+		spin_unlock(&pi_state_lock);
+	}
+	list_del(&q.list);
+	free_pi_state(pi_state);
+	spin_unlock(q.lock_ptr);
+
+	drop_key_refs(&q.key);
+	kfree(prealloc);
+
+	return ret;
+
+ out_unlock:
+	spin_unlock(&bh->lock);
+	drop_key_refs(&q.key);
+ out_release_sem:
+	futex_unlock_mm(fshared);
+	kfree(prealloc);
+	return ret;
+
+ uaddr_faulted:
+	/*
+	 * We have to r/w *(int __user *)uaddr, but we can't modify it
+	 * non-atomically. Therefore, if get_user below is not
+	 * enough, we need to handle the fault ourselves, while
+	 * still holding the mmap_sem.
+	 */
+	spin_unlock(&bh->lock);
+	drop_key_refs(&q.key);
+	if (attempt++) {
+		ret = futex_handle_fault(uaddr, fshared);
+		futex_unlock_mm(fshared);
+		if (ret || attempt > 2) {
+			kfree(prealloc);
+			return ret ? ret : -EFAULT;
+		}
+		goto retry;
+	}
+	futex_unlock_mm(fshared);
+
+	ret = get_user(uval, (u32 __user *)uaddr);
+	if (!ret)
+		goto retry;
+
+	kfree(prealloc);
+	return ret;
+}
+
+/*
+ * Userspace attempted a TID -> 0 atomic transition, and failed.
+ * This is the in-kernel slowpath: we look up the PI state (if any),
+ * and hand ownership over to the top waiter.
+ */
+static int futex_unlock_pi(unsigned long uaddr, struct rw_semaphore *fshared)
+{
+	struct futex_pi_state *pi_state;
+	struct futex_hash_bucket *bh;
+	struct task_struct *new_owner;
+	union futex_key key;
+	u32 uval, newval;
+	int ret, curval, attempt = 0;
+
+ retry:
+	if (get_user(uval, (u32 __user *)uaddr))
+		return -EFAULT;
+	/*
+	 * We release only a lock we actually own:
+	 */
+	if ((uval & FUTEX_TID_MASK) != current->pid)
+		return -EPERM;
+
+	futex_lock_mm(fshared);
+
+	ret = get_futex_key(uaddr, fshared, &key);
+	if (unlikely(ret != 0))
+		goto out;
+
+	bh = hash_futex(&key);
+	spin_lock(&bh->lock);
+
+	pi_state = lookup_pi_state(bh, &key);
+	if (!pi_state) {
+		/*
+		 * Nobody blocks in the kernel (any more): just release
+		 * the word, dropping a stale FUTEX_WAITERS bit as well.
+		 */
+		curval = cmpxchg_futex_value_locked((u32 __user *)uaddr,
+						    uval, 0);
+		if (unlikely(curval == -EFAULT))
+			goto pi_faulted;
+		if (unlikely(curval == -ENOSYS)) {
+			ret = -ENOSYS;
+			goto out_unlock;
+		}
+		if (curval != uval) {
+			spin_unlock(&bh->lock);
+			futex_unlock_mm(fshared);
+			goto retry;
+		}
+		goto out_unlock;
+	}
+
+	ret = -EINVAL;
+	if (pi_state->pi_mutex.owner != current)
+		goto out_unlock;
+
+	/*
+	 * Hand the rt_mutex to the top waiter. It cannot leave before
+	 * we drop the hash bucket lock, so the new owner is stable.
+	 */
+	rt_mutex_unlock(&pi_state->pi_mutex);
+	new_owner = pi_state->pi_mutex.owner;
+
+	spin_lock(&pi_state_lock);
+	list_del_init(&pi_state->list);
+	if (new_owner)
+		list_add(&pi_state->list, &new_owner->pi_state_list);
+	pi_state->owner = new_owner;
+	spin_unlock(&pi_state_lock);
+
+	/*
+	 * Best effort: if this fails the new owner fixes up the word
+	 * itself (see fixup_pi_owner()) before it returns to userspace.
+	 */
+	newval = new_owner ? (new_owner->pid | FUTEX_WAITERS) : 0;
+	cmpxchg_futex_value_locked((u32 __user *)uaddr, uval, newval);
+	ret = 0;
+
+ out_unlock:
+	spin_unlock(&bh->lock);
+ out:
+	futex_unlock_mm(fshared);
+
+	return ret;
+
+ pi_faulted:
+	spin_unlock(&bh->lock);
+	if (attempt++) {
+		ret = futex_handle_fault(uaddr, fshared);
+		futex_unlock_mm(fshared);
+		if (ret || attempt > 2)
+			return ret ? ret : -EFAULT;
+		goto retry;
+	}
+	futex_unlock_mm(fshared);
+
+	goto retry;
+}
+
+/*
+ * Support for robust futexes: the kernel cleans up held futexes at
+ * thread exit time.
+ *
+ * Implementation: user-space maintains a per-thread list of locks it
+ * is holding. Upon do_exit(), the kernel carefully walks this list,
+ * and marks all locks that are owned by this thread with the
+ * FUTEX_OWNER_DIED bit, and wakes up a waiter (if any). The list is
+ * always manipulated with the lock held, so the list is private and
+ * per-thread. Userspace also maintains a per-thread 'list_op_pending'
+ * field, to allow the kernel to clean up if the thread dies after
+ * acquiring the lock, but just before it could have added itself to
+ * the list. There can only be one such pending lock.
+ */
+
+/**
+ * sys_set_robust_list - set the robust-futex list head of a task
+ * @head: pointer to the list-head
+ * @len: length of the list-head, as userspace expects
+ */
+asmlinkage long
+sys_set_robust_list(struct robust_list_head __user *head, size_t len)
+{
+	/*
+	 * The kernel knows only one size for now:
+	 */
+	if (unlikely(len != sizeof(*head)))
+		return -EINVAL;
+
+	current->robust_list = head;
+
+	return 0;
+}
+
+/**
+ * sys_get_robust_list - get the robust-futex list head of a task
+ * @pid: pid of the process [zero for current task]
+ * @head_ptr: pointer to a list-head pointer, the kernel fills it in
+ * @len_ptr: pointer to a length field, the kernel fills in the header size
+ */
+asmlinkage long
+sys_get_robust_list(int pid, struct robust_list_head __user **head_ptr,
+		    size_t __user *len_ptr)
+{
+	struct robust_list_head __user *head;
+	struct task_struct *p;
+	long ret;
+
+	if (!pid)
+		head = current->robust_list;
+	else {
+		ret = -ESRCH;
+		read_lock(&tasklist_lock);
+		p = find_task_by_pid(pid);
+		if (!p)
+			goto err_unlock;
+		ret = -EPERM;
+		if ((current->euid != p->euid) && (current->euid != p->uid) &&
+				!capable(CAP_SYS_PTRACE))
+			goto err_unlock;
+		head = p->robust_list;
+		read_unlock(&tasklist_lock);
+	}
+
+	if (put_user(sizeof(*head), len_ptr))
+		return -EFAULT;
+	return put_user(head, head_ptr);
+
+err_unlock:
+	read_unlock(&tasklist_lock);
+
+	return ret;
+}
+
+/*
+ * Process a futex-list entry, check whether it's owned by the
+ * dying task, and do notification if so:
+ */
+static int handle_futex_death(u32 __user *uaddr, struct task_struct *curr)
+{
+	u32 uval, mval;
+	int nval;
+
+ retry:
+	if (get_user(uval, uaddr))
+		return -1;
+
+	if ((uval & FUTEX_TID_MASK) == curr->pid) {
+		/*
+		 * Ok, this dying thread is truly holding a futex
+		 * of interest. Set the OWNER_DIED bit atomically
+		 * via cmpxchg, and if the value had FUTEX_WAITERS
+		 * set, wake up a waiter (if any). (We have to do a
+		 * futex_wake() even if OWNER_DIED is already set -
+		 * to handle the rare but possible case of recursive
+		 * thread-death.) The rest of the cleanup is done in
+		 * userspace.
+		 */
+		mval = (uval & FUTEX_WAITERS) | FUTEX_OWNER_DIED;
+		nval = cmpxchg_futex_value_locked(uaddr, uval, mval);
+		if (nval == -EFAULT || nval == -ENOSYS)
+			return -1;
+		if (nval != uval)
+			goto retry;
+
+		/*
+		 * Wake robust non-PI futexes here. The wakeup of
+		 * PI futexes happens in exit_pi_state_list():
+		 */
+		if (uval & FUTEX_WAITERS)
+			futex_wake((unsigned long)uaddr,
+				   &curr->mm->mmap_sem, 1);
+	}
+	return 0;
+}
+
+/*
+ * Walk curr->robust_list (very carefully, it's a userspace list!)
+ * and mark any locks found there dead, and notify any waiters.
+ *
+ * We silently return on any sign of list-walking problem.
+ */
+void exit_robust_list(struct task_struct *curr)
+{
+	struct robust_list_head __user *head = curr->robust_list;
+	struct robust_list __user *entry, *next, *pending;
+	unsigned int limit = ROBUST_LIST_LIMIT;
+	long futex_offset;
+
+	if (likely(!head))
+		return;
+
+	/*
+	 * Fetch the list head (which was registered earlier, via
+	 * sys_set_robust_list()):
+	 */
+	if (get_user(entry, &head->list.next))
+		return;
+	/*
+	 * Fetch the relative futex offset:
+	 */
+	if (get_user(futex_offset, &head->futex_offset))
+		return;
+	/*
+	 * Fetch any possibly pending lock-add first, and handle it
+	 * if it exists:
+	 */
+	if (get_user(pending, &head->list_op_pending))
+		return;
+	if (pending)
+		handle_futex_death((void __user *)pending + futex_offset, curr);
+
+	while (entry != &head->list) {
+		/*
+		 * Fetch the next entry in the list before the lock
+		 * is released, a waiter may reuse the memory:
+		 */
+		if (get_user(next, &entry->next))
+			return;
+		/*
+		 * A pending lock might already be on the list, so
+		 * don't process it twice:
+		 */
+		if (entry != pending)
+			if (handle_futex_death((void __user *)entry +
+					       futex_offset, curr))
+				return;
+		entry = next;
+		/*
+		 * Avoid excessively long or circular lists:
+		 */
+		if (!--limit)
+			break;
+
+		cond_resched();
+	}
+}
+
+/*
+ * This task is holding PI mutexes at exit time => bad.
+ * Kernel cleans up PI-state, but userspace is likely hosed.
+ * (Robust-futex cleanup is separate and might save the day for userspace.)
+ */
+void exit_pi_state_list(struct task_struct *curr)
+{
+	struct list_head *next, *head = &curr->pi_state_list;
+	struct futex_pi_state *pi_state;
+	struct futex_hash_bucket *bh;
+	union futex_key key;
+
+	/*
+	 * We are a ZOMBIE and nobody can enqueue itself on
+	 * pi_state_list anymore, but we have to be careful
+	 * versus waiters unqueueing themselves:
+	 */
+	spin_lock(&pi_state_lock);
+	while (!list_empty(head)) {
+		next = head->next;
+		pi_state = list_entry(next, struct futex_pi_state, list);
+		key = pi_state->key;
+		spin_unlock(&pi_state_lock);
+
+		bh = hash_futex(&key);
+		spin_lock(&bh->lock);
+		spin_lock(&pi_state_lock);
+
+		/*
+		 * The pi_state might have been freed (or handed over)
+		 * while we did not hold the lock. The hash bucket lock
+		 * keeps it alive from here on:
+		 */
+		if (head->next != next || !match_futex(&pi_state->key, &key)) {
+			spin_unlock(&bh->lock);
+			continue;
+		}
+
+		list_del_init(&pi_state->list);
+		pi_state->owner = NULL;
+		spin_unlock(&pi_state_lock);
+
+		/* Hand the lock to the top waiter, it fixes up the rest: */
+		rt_mutex_proxy_unlock(&pi_state->pi_mutex, curr);
+
+		spin_unlock(&bh->lock);
+
+		spin_lock(&pi_state_lock);
+	}
+	spin_unlock(&pi_state_lock);
+}
+
 long do_futex(unsigned long uaddr, int op, int val, unsigned long timeout,
 		unsigned long uaddr2, int val2, int val3)
 {
+	struct rw_semaphore *fshared = NULL;
+	int cmd = op & FUTEX_CMD_MASK;
 	int ret;
 
-	switch (op) {
+	if (!(op & FUTEX_PRIVATE_FLAG))
+		fshared = &current->mm->mmap_sem;
+
+	switch (cmd) {
 	case FUTEX_WAIT:
-		ret = futex_wait(uaddr, val, timeout);
+		ret = futex_wait(uaddr, fshared, val, timeout);
 		break;
 	case FUTEX_WAKE:
-		ret = futex_wake(uaddr, val);
+		ret = futex_wake(uaddr, fshared, val);
 		break;
 	case FUTEX_FD:
 		/* non-zero val means F_SETOWN(getpid()) & F_SETSIG(val) */
 		ret = futex_fd(uaddr, val);
 		break;
 	case FUTEX_REQUEUE:
-		ret = futex_requeue(uaddr, uaddr2, val, val2, NULL);
+		ret = futex_requeue(uaddr, fshared, uaddr2, val, val2, NULL);
 		break;
 	case FUTEX_CMP_REQUEUE:
-		ret = futex_requeue(uaddr, uaddr2, val, val2, &val3);
+		ret = futex_requeue(uaddr, fshared, uaddr2, val, val2, &val3);
+		break;
+	case FUTEX_LOCK_PI:
+		ret = futex_lock_pi(uaddr, fshared, timeout, 0);
+		break;
+	case FUTEX_UNLOCK_PI:
+		ret = futex_unlock_pi(uaddr, fshared);
+		break;
+	case FUTEX_TRYLOCK_PI:
+		ret = futex_lock_pi(uaddr, fshared, 0, 1);
 		break;
 	default:
 		ret = -ENOSYS;
@@ -748,8 +1532,9 @@ asmlinkage long sys_futex(u32 __user *uaddr, int op, int val,
 	struct timespec t;
 	unsigned long timeout = MAX_SCHEDULE_TIMEOUT;
 	int val2 = 0;
+	int cmd = op & FUTEX_CMD_MASK;
 
-	if ((op == FUTEX_WAIT) && utime) {
+	if ((cmd == FUTEX_WAIT || cmd == FUTEX_LOCK_PI) && utime) {
 		if (copy_from_user(&t, utime, sizeof(t)) != 0)
 			return -EFAULT;
 		timeout = timespec_to_jiffies(&t) + 1;
@@ -757,7 +1542,7 @@ asmlinkage long sys_futex(u32 __user *uaddr, int op, int val,
 	/*
 	 * requeue parameter in 'utime' if op == FUTEX_REQUEUE.
 	 */
-	if (op >= FUTEX_REQUEUE)
+	if (cmd == FUTEX_REQUEUE || cmd == FUTEX_CMP_REQUEUE)
 		val2 = (int) (unsigned long) utime;
 
 	return do_futex((unsigned long)uaddr, op, val, timeout,
@@ -781,10 +1566,16 @@ static int __init init(void)
 {
 	unsigned int i;
 
+	/* At least 256 buckets per CPU: */
+	futex_queues = alloc_large_system_hash("futex",
+					       sizeof(struct futex_hash_bucket),
+					       256 * num_possible_cpus(),
+					       0, 0, NULL, &futex_hashmask, 0);
+
 	register_filesystem(&futex_fs_type);
 	futex_mnt = kern_mount(&futex_fs_type);
 
-	for (i = 0; i < ARRAY_SIZE(futex_queues); i++) {
+	for (i = 0; i <= futex_hashmask; i++) {
 		INIT_LIST_HEAD(&futex_queues[i].chain);
 		spin_lock_init(&futex_queues[i].lock);
 	}
@@ -112,6 +112,7 @@ int do_setitimer(int which, struct itimerval *value, struct itimerval *ovalue)
 			current->it_virt_value = cputime;
 			cputime = timeval_to_cputime(&value->it_interval);
 			current->it_virt_incr = cputime;
+			nohz_full_kick_task(current);
 			break;
 		case ITIMER_PROF:
 			cputime = timeval_to_cputime(&value->it_value);
@@ -121,6 +122,7 @@ int do_setitimer(int which, struct itimerval *value, struct itimerval *ovalue)
 			current->it_prof_value = cputime;
 			cputime = timeval_to_cputime(&value->it_interval);
 			current->it_prof_incr = cputime;
+			nohz_full_kick_task(current);
 			break;
 		default:
 			return -EINVAL;
@@ -33,6 +33,11 @@
 #include <linux/hash.h>
 #include <linux/init.h>
 #include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/percpu.h>
+#include <linux/rcupdate.h>
+#include <linux/mutex.h>
 #include <asm/cacheflush.h>
 #include <asm/errno.h>
 #include <asm/kdebug.h>
@@ -40,32 +45,152 @@
 #define KPROBE_HASH_BITS 6
 #define KPROBE_TABLE_SIZE (1 << KPROBE_HASH_BITS)
 
+/*
+ * The table is only changed under kprobe_mutex.  The breakpoint handlers
+ * look probes up without any lock, with interrupts disabled, so a probe
+ * is only let go of after a synchronize_kernel().
+ */
 static struct hlist_head kprobe_table[KPROBE_TABLE_SIZE];
+static DEFINE_MUTEX(kprobe_mutex);
+
+/* The probe being handled on this cpu, if any */
+DEFINE_PER_CPU(struct kprobe *, current_kprobe);
+
+/*
+ * Copies of probed instructions must be executable, which kmalloc()ed
+ * memory need not be.  So we hand out slots from pages that are mapped
+ * executable, allocating more pages as needed.
+ */
+struct kprobe_insn_page {
+	struct hlist_node hlist;
+	kprobe_opcode_t *insns;		/* page of instruction slots */
+	int nused;
+	char slot_used[0];
+};
+
+struct kprobe_insn_cache {
+	struct hlist_head pages;
+	size_t insn_size;		/* bytes per slot */
+};
+
+#define INSNS_PER_PAGE(c) (PAGE_SIZE / ((c)->insn_size * sizeof(kprobe_opcode_t)))
+
+/* Called with kprobe_mutex held */
+static kprobe_opcode_t *__get_insn_slot(struct kprobe_insn_cache *c)
+{
+	struct kprobe_insn_page *kip;
+	struct hlist_node *pos;
+	int i;
+
+	hlist_for_each(pos, &c->pages) {
+		kip = hlist_entry(pos, struct kprobe_insn_page, hlist);
+		if (kip->nused < INSNS_PER_PAGE(c)) {
+			for (i = 0; i < INSNS_PER_PAGE(c); i++) {
+				if (!kip->slot_used[i]) {
+					kip->slot_used[i] = 1;
+					kip->nused++;
+					return kip->insns + (i * c->insn_size);
+				}
+			}
+			/* Surprise!  No unused slots.  Fix kip->nused. */
+			kip->nused = INSNS_PER_PAGE(c);
+		}
+	}
+
+	/* All out of space.  Need to allocate a new page. Use slot 0.*/
+	kip = kmalloc(sizeof(*kip) + INSNS_PER_PAGE(c), GFP_KERNEL);
+	if (!kip)
+		return NULL;
+	kip->insns = (kprobe_opcode_t *)__vmalloc(PAGE_SIZE,
+			GFP_KERNEL|__GFP_HIGHMEM, PAGE_KERNEL_EXEC);
+	if (!kip->insns) {
+		kfree(kip);
+		return NULL;
+	}
+	INIT_HLIST_NODE(&kip->hlist);
+	hlist_add_head(&kip->hlist, &c->pages);
+	memset(kip->slot_used, 0, INSNS_PER_PAGE(c));
+	kip->slot_used[0] = 1;
+	kip->nused = 1;
+	return kip->insns;
+}
+
+static void __free_insn_slot(struct kprobe_insn_cache *c, kprobe_opcode_t *slot)
+{
+	struct kprobe_insn_page *kip;
+	struct hlist_node *pos;
+
+	hlist_for_each(pos, &c->pages) {
+		kip = hlist_entry(pos, struct kprobe_insn_page, hlist);
+		if (kip->insns <= slot &&
+		    slot < kip->insns + INSNS_PER_PAGE(c) * c->insn_size) {
+			int i = (slot - kip->insns) / c->insn_size;
+			kip->slot_used[i] = 0;
+			kip->nused--;
+			if (kip->nused == 0) {
+				/*
+				 * Page is no longer in use.  Free it unless
+				 * it's the last one.  We keep the last one
+				 * so as not to have to set it up again the
+				 * next time somebody inserts a probe.
+				 */
+				hlist_del(&kip->hlist);
+				if (hlist_empty(&c->pages)) {
+					INIT_HLIST_NODE(&kip->hlist);
+					hlist_add_head(&kip->hlist, &c->pages);
+				} else {
+					vfree(kip->insns);
+					kfree(kip);
+				}
+			}
+			return;
+		}
+	}
+}
+
+static struct kprobe_insn_cache kprobe_insn_slots = {
+	.insn_size = MAX_INSN_SIZE,
+};
+
+/* Slots of MAX_INSN_SIZE, for arch_prepare_kprobe() */
+kprobe_opcode_t *get_insn_slot(void)
+{
+	return __get_insn_slot(&kprobe_insn_slots);
+}
 
-unsigned int kprobe_cpu = NR_CPUS;
-static DEFINE_SPINLOCK(kprobe_lock);
+void free_insn_slot(kprobe_opcode_t *slot)
+{
+	__free_insn_slot(&kprobe_insn_slots, slot);
+}
 
-/* Locks kprobe: irqs must be disabled */
-void lock_kprobes(void)
+#ifdef CONFIG_OPTPROBES
+static struct kprobe_insn_cache kprobe_optinsn_slots = {
+	.insn_size = MAX_OPTINSN_SIZE,
+};
+
+/* Slots of MAX_OPTINSN_SIZE, for the detour buffers of optimized probes */
+kprobe_opcode_t *get_optinsn_slot(void)
 {
-	spin_lock(&kprobe_lock);
-	kprobe_cpu = smp_processor_id();
+	return __get_insn_slot(&kprobe_optinsn_slots);
 }
 
-void unlock_kprobes(void)
+void free_optinsn_slot(kprobe_opcode_t *slot)
 {
-	kprobe_cpu = NR_CPUS;
-	spin_unlock(&kprobe_lock);
+	__free_insn_slot(&kprobe_optinsn_slots, slot);
 }
+#endif
 
-/* You have to be holding the kprobe_lock */
+/*
+ * Get the kprobe at this addr (if any).  Must be called with kprobe_mutex
+ * held, or from a breakpoint handler with interrupts disabled.
+ */
 struct kprobe *get_kprobe(void *addr)
 {
 	struct hlist_head *head;
 	struct hlist_node *node;
 
 	head = &kprobe_table[hash_ptr(addr, KPROBE_HASH_BITS)];
-	hlist_for_each(node, head) {
+	hlist_for_each_rcu(node, head) {
 		struct kprobe *p = hlist_entry(node, struct kprobe, hlist);
 		if (p->addr == addr)
 			return p;
@@ -73,46 +198,129 @@ struct kprobe *get_kprobe(void *addr)
 	return NULL;
 }
 
+/* Times the probe was hit, summed over all cpus */
+unsigned long kprobe_hits(struct kprobe *p)
+{
+	unsigned long hits = 0;
+	int cpu;
+
+	for_each_cpu(cpu)
+		hits += *per_cpu_ptr(p->nhit, cpu);
+	return hits;
+}
+
+#ifdef CONFIG_OPTPROBES
+/*
+ * Turn the breakpoint into a jump to a detour buffer that calls the
+ * pre_handler and then runs the instructions the jump covers.  This
+ * cannot be done for probes that want to see the instruction single-
+ * stepped, nor where the arch code finds the instructions unfit.
+ */
+static void optimize_kprobe(struct kprobe *p)
+{
+	if (p->post_handler || p->break_handler)
+		return;
+	if (arch_prepare_optimized_kprobe(p))
+		return;
+	/*
+	 * Breakpoint hits now resume in the detour buffer.  Wait for the
+	 * cpus that resumed in the original instructions to leave them.
+	 */
+	synchronize_kernel();
+	arch_optimize_kprobe(p);
+}
+
+/* Back to a breakpoint, and let go of the detour buffer */
+static void unoptimize_kprobe(struct kprobe *p)
+{
+	arch_unoptimize_kprobe(p);
+	synchronize_kernel();
+	arch_remove_optimized_kprobe(p);
+}
+
+/* A new probe at @addr must not be jumped over by an optimized one */
+static void unoptimize_covering_kprobe(kprobe_opcode_t *addr)
+{
+	struct kprobe *q;
+	int i;
+
+	for (i = 1; i < MAX_OPTIMIZED_LENGTH; i++) {
+		q = get_kprobe(addr - i);
+		if (q && arch_within_optimized_kprobe(q, addr)) {
+			unoptimize_kprobe(q);
+			return;
+		}
+	}
+}
+#else
+static inline void optimize_kprobe(struct kprobe *p)
+{
+}
+
+static inline void unoptimize_covering_kprobe(kprobe_opcode_t *addr)
+{
+}
+
+static inline void arch_unoptimize_kprobe(struct kprobe *p)
+{
+}
+
+static inline void arch_remove_optimized_kprobe(struct kprobe *p)
+{
+}
+#endif
+
 int register_kprobe(struct kprobe *p)
 {
 	int ret = 0;
-	unsigned long flags = 0;
 
-	if ((ret = arch_prepare_kprobe(p)) != 0) {
-		goto out;
-	}
-	spin_lock_irqsave(&kprobe_lock, flags);
-	INIT_HLIST_NODE(&p->hlist);
+	p->nhit = alloc_percpu(unsigned long);
+	if (!p->nhit)
+		return -ENOMEM;
+
+	mutex_lock(&kprobe_mutex);
 	if (get_kprobe(p->addr)) {
 		ret = -EEXIST;
 		goto out;
 	}
+	if ((ret = arch_prepare_kprobe(p)) != 0)
+		goto out;
+	unoptimize_covering_kprobe(p->addr);
 	arch_copy_kprobe(p);
 
-	hlist_add_head(&p->hlist,
-		       &kprobe_table[hash_ptr(p->addr, KPROBE_HASH_BITS)]);
+	INIT_HLIST_NODE(&p->hlist);
+	hlist_add_head_rcu(&p->hlist,
+			   &kprobe_table[hash_ptr(p->addr, KPROBE_HASH_BITS)]);
 
 	p->opcode = *p->addr;
 	*p->addr = BREAKPOINT_INSTRUCTION;
 	flush_icache_range((unsigned long) p->addr,
 			   (unsigned long) p->addr + sizeof(kprobe_opcode_t));
-      out:
-	spin_unlock_irqrestore(&kprobe_lock, flags);
-	if (ret == -EEXIST)
-		arch_remove_kprobe(p);
+
+	optimize_kprobe(p);
+out:
+	mutex_unlock(&kprobe_mutex);
+	if (ret)
+		free_percpu(p->nhit);
 	return ret;
 }
 
 void unregister_kprobe(struct kprobe *p)
 {
-	unsigned long flags;
-	arch_remove_kprobe(p);
-	spin_lock_irqsave(&kprobe_lock, flags);
+	mutex_lock(&kprobe_mutex);
+	arch_unoptimize_kprobe(p);
 	*p->addr = p->opcode;
-	hlist_del(&p->hlist);
 	flush_icache_range((unsigned long) p->addr,
 			   (unsigned long) p->addr + sizeof(kprobe_opcode_t));
-	spin_unlock_irqrestore(&kprobe_lock, flags);
+	hlist_del_rcu(&p->hlist);
+
+	/* Wait for the handlers that found it to finish */
+	synchronize_kernel();
+	arch_remove_optimized_kprobe(p);
+	arch_remove_kprobe(p);
+	mutex_unlock(&kprobe_mutex);
+
+	free_percpu(p->nhit);
 }
 
 static struct notifier_block kprobe_exceptions_nb = {
@@ -154,3 +362,4 @@ EXPORT_SYMBOL_GPL(unregister_kprobe);
 EXPORT_SYMBOL_GPL(register_jprobe);
 EXPORT_SYMBOL_GPL(unregister_jprobe);
 EXPORT_SYMBOL_GPL(jprobe_return);
+EXPORT_SYMBOL_GPL(kprobe_hits);
@@ -0,0 +1,488 @@
+/*
+ * kernel/lockstat.c
+ *
+ * Lock statistics, see include/linux/lockstat.h.
+ *
+ * Classes live in a fixed, open-addressed table that is only ever added
+ * to; a lock caches its class in its lock_stat_map.  The counters are
+ * per cpu and updated without atomics, either under the lock being
+ * counted or with preemption disabled, so the cost of an acquisition is
+ * a clock read and a couple of cache lines of the local cpu.
+ */
+
+#include <linux/config.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/vmalloc.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/kallsyms.h>
+#include <linux/hash.h>
+#include <linux/lockstat.h>
+#include <asm/div64.h>
+
+#define LOCK_CLASS_HASH_BITS	9
+#define LOCK_CLASSES		(1 << LOCK_CLASS_HASH_BITS)
+#define LOCK_CLASS_NAME_LEN	32
+
+/* Contention call sites remembered per class */
+#define LOCK_STAT_POINTS	4
+
+/*
+ * Time histograms have power-of-4 buckets starting at 256ns:
+ * <256ns, <1us, <4us, ..., <256ms, and everything above.
+ */
+#define LOCK_STAT_BUCKETS	12
+
+struct lock_class {
+	void *key;			/* Class key, or the lock itself */
+	int type;
+	char name[LOCK_CLASS_NAME_LEN];	/* Empty: look the key up in kallsyms */
+	unsigned long points[LOCK_STAT_POINTS];
+};
+
+struct lock_class_stats {
+	unsigned long acquisitions;
+	unsigned long contentions;
+	unsigned long points[LOCK_STAT_POINTS];
+	unsigned long long wait_total, wait_max;
+	unsigned long long hold_total, hold_max;
+	unsigned long wait_hist[LOCK_STAT_BUCKETS];
+	unsigned long hold_hist[LOCK_STAT_BUCKETS];
+};
+
+/*
+ * The extra last slot collects the locks that found the table full,
+ * so that they need not search it again on every acquisition.
+ */
+static struct lock_class lock_classes[LOCK_CLASSES + 1] = {
+	[LOCK_CLASSES] = { .name = "(other)" },
+};
+#define LOCK_STATS_SIZE	((LOCK_CLASSES + 1) * sizeof(struct lock_class_stats))
+
+static struct lock_class_stats *lock_stats[NR_CPUS];
+static unsigned long lock_classes_lost;
+
+/* Only ever taken with the raw primitives: we are called from them */
+static spinlock_t lock_class_lock = SPIN_LOCK_UNLOCKED;
+
+static const char *lock_type_names[] = {
+	[LOCK_STAT_SPIN]	= "spin",
+	[LOCK_STAT_READ]	= "rwlock",
+	[LOCK_STAT_WRITE]	= "rwlock",
+	[LOCK_STAT_SEM]		= "sem",
+	[LOCK_STAT_RWSEM_READ]	= "rwsem",
+	[LOCK_STAT_RWSEM_WRITE]	= "rwsem",
+	[LOCK_STAT_MUTEX]	= "mutex",
+};
+
+static const char *lock_bucket_names[LOCK_STAT_BUCKETS] = {
+	"<256ns", "<1us", "<4us", "<16us", "<64us", "<256us",
+	"<1ms", "<4ms", "<16ms", "<64ms", "<256ms", "more",
+};
+
+unsigned long long lock_stat_clock(void)
+{
+	return sched_clock();
+}
+
+static struct lock_class *lock_class_find(void *key)
+{
+	unsigned long i = hash_ptr(key, LOCK_CLASS_HASH_BITS);
+	int n;
+
+	for (n = 0; n < LOCK_CLASSES; n++) {
+		void *k = lock_classes[i].key;
+
+		if (k == key)
+			return lock_classes + i;
+		if (!k)
+			break;
+		i = (i + 1) & (LOCK_CLASSES - 1);
+	}
+	return NULL;
+}
+
+static struct lock_class *lock_class_register(void *key, const char *name,
+					      int type)
+{
+	struct lock_class *class;
+	unsigned long flags, i;
+	int n;
+
+	local_irq_save(flags);
+	_raw_spin_lock(&lock_class_lock);
+
+	class = lock_class_find(key);
+	if (class)
+		goto out;
+
+	i = hash_ptr(key, LOCK_CLASS_HASH_BITS);
+	for (n = 0; n < LOCK_CLASSES; n++) {
+		class = lock_classes + i;
+		if (!class->key) {
+			class->type = type;
+			if (name)
+				strlcpy(class->name, name, LOCK_CLASS_NAME_LEN);
+			/* lock_class_find() looks at the key without the lock */
+			smp_wmb();
+			class->key = key;
+			goto out;
+		}
+		i = (i + 1) & (LOCK_CLASSES - 1);
+	}
+	class = lock_classes + LOCK_CLASSES;
+	lock_classes_lost++;
+out:
+	_raw_spin_unlock(&lock_class_lock);
+	local_irq_restore(flags);
+	return class;
+}
+
+/* Must be called with preemption disabled */
+static inline struct lock_class_stats *lock_class_stats(struct lock_class *class)
+{
+	struct lock_class_stats *stats = lock_stats[smp_processor_id()];
+
+	return stats ? stats + (class - lock_classes) : NULL;
+}
+
+static inline int lock_stat_bucket(unsigned long long ns)
+{
+	int i = 0;
+
+	ns >>= 8;
+	while (ns && i < LOCK_STAT_BUCKETS - 1) {
+		ns >>= 2;
+		i++;
+	}
+	return i;
+}
+
+static inline void lock_stat_account(unsigned long long *total,
+				     unsigned long long *max,
+				     unsigned long *hist,
+				     unsigned long long start,
+				     unsigned long long now)
+{
+	unsigned long long delta;
+
+	/* The clock is per cpu, and sleepers may wake up elsewhere */
+	if (now < start)
+		return;
+	delta = now - start;
+	*total += delta;
+	if (delta > *max)
+		*max = delta;
+	hist[lock_stat_bucket(delta)]++;
+}
+
+/*
+ * Count a contention against its call site.  Claiming a free slot is
+ * racy: at worst two sites end up counted in one slot.
+ */
+static void lock_stat_point(struct lock_class *class,
+			    struct lock_class_stats *stats, unsigned long ip)
+{
+	int i;
+
+	for (i = 0; i < LOCK_STAT_POINTS; i++) {
+		if (!class->points[i])
+			class->points[i] = ip;
+		if (class->points[i] == ip) {
+			stats->points[i]++;
+			break;
+		}
+	}
+}
+
+/*
+ * A spinlock or rwlock has been taken.  wait_start is when we started
+ * spinning for it, or 0 if we got it right away.
+ */
+void lock_stat_acquired(struct lock_stat_map *map, void *lock, int type,
+			unsigned long long wait_start, unsigned long ip)
+{
+	struct lock_class *class = map->class;
+	struct lock_class_stats *stats;
+	unsigned long long now = 0;
+	unsigned long flags;
+
+	if (unlikely(!class)) {
+		void *key = map->key ? (void *)map->key : lock;
+
+		class = lock_class_find(key);
+		if (!class)
+			class = lock_class_register(key,
+				map->key ? map->key->name : NULL, type);
+		map->class = class;
+	}
+
+	if (wait_start || type != LOCK_STAT_READ)
+		now = lock_stat_clock();
+
+	/*
+	 * Plain spin_lock() leaves interrupts on, and an interrupt taking
+	 * a lock of this class would race with us for the per-cpu stats.
+	 */
+	local_irq_save(flags);
+	stats = lock_class_stats(class);
+	if (stats) {
+		stats->acquisitions++;
+		if (wait_start) {
+			stats->contentions++;
+			lock_stat_account(&stats->wait_total, &stats->wait_max,
+					  stats->wait_hist, wait_start, now);
+			lock_stat_point(class, stats, ip);
+		}
+	}
+	local_irq_restore(flags);
+
+	/* Hold times only make sense for exclusive holders */
+	if (type != LOCK_STAT_READ)
+		map->acquired = now;
+}
+
+/*
+ * A spinlock or write lock is about to be released.  Locks taken with
+ * the _raw_ primitives have no start time and are not counted.
+ */
+void lock_stat_released(struct lock_stat_map *map)
+{
+	struct lock_class_stats *stats;
+	unsigned long long acquired = map->acquired;
+	unsigned long flags;
+
+	if (!acquired || !map->class)
+		return;
+	map->acquired = 0;
+
+	local_irq_save(flags);
+	stats = lock_class_stats(map->class);
+	if (stats)
+		lock_stat_account(&stats->hold_total, &stats->hold_max,
+				  stats->hold_hist, acquired, lock_stat_clock());
+	local_irq_restore(flags);
+}
+
+/*
+ * A semaphore or mutex was acquired after sleeping since wait_start.
+ * These are keyed by instance and have no call sites: the semaphore
+ * slow paths are entered from out-of-line stubs, not from the caller.
+ */
+void lock_stat_waited(void *lock, int type, unsigned long long wait_start)
+{
+	struct lock_class *class;
+	struct lock_class_stats *stats;
+	unsigned long long now = lock_stat_clock();
+
+	class = lock_class_find(lock);
+	if (!class)
+		class = lock_class_register(lock, NULL, type);
+
+	preempt_disable();
+	stats = lock_class_stats(class);
+	if (stats) {
+		stats->acquisitions++;
+		stats->contentions++;
+		lock_stat_account(&stats->wait_total, &stats->wait_max,
+				  stats->wait_hist, wait_start, now);
+	}
+	preempt_enable();
+}
+
+/*
+ * /proc/lock_stat
+ */
+
+static unsigned long long ns_to_us(unsigned long long ns)
+{
+	do_div(ns, 1000);
+	return ns;
+}
+
+static void lock_stat_sym(char *buf, int len, unsigned long addr)
+{
+	char namebuf[KSYM_NAME_LEN + 1];
+	unsigned long size, offset;
+	char *modname;
+	const char *name;
+
+	name = kallsyms_lookup(addr, &size, &offset, &modname, namebuf);
+	if (!name)
+		snprintf(buf, len, "%p", (void *)addr);
+	else if (offset)
+		snprintf(buf, len, "%s+%#lx", name, offset);
+	else
+		snprintf(buf, len, "%s", name);
+}
+
+static struct lock_class *lock_stat_class_at(loff_t *pos)
+{
+	loff_t i;
+
+	for (i = *pos - 1; i < LOCK_CLASSES; i++)
+		if (lock_classes[i].key)
+			break;
+	if (i == LOCK_CLASSES && !lock_classes_lost)
+		return NULL;
+	if (i > LOCK_CLASSES)
+		return NULL;
+	*pos = i + 1;
+	return lock_classes + i;
+}
+
+static void *lock_stat_start(struct seq_file *m, loff_t *pos)
+{
+	if (!*pos)
+		return SEQ_START_TOKEN;
+	return lock_stat_class_at(pos);
+}
+
+static void *lock_stat_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	++*pos;
+	return lock_stat_class_at(pos);
+}
+
+static void lock_stat_stop(struct seq_file *m, void *v)
+{
+}
+
+static void lock_stat_hist(struct seq_file *m, const char *what,
+			   unsigned long *hist)
+{
+	int i;
+
+	seq_printf(m, "  %s:", what);
+	for (i = 0; i < LOCK_STAT_BUCKETS; i++)
+		seq_printf(m, " %lu", hist[i]);
+	seq_putc(m, '\n');
+}
+
+static int lock_stat_show(struct seq_file *m, void *v)
+{
+	struct lock_class *class = v;
+	struct lock_class_stats sum;
+	char name[KSYM_NAME_LEN + 32];
+	int cpu, i;
+
+	if (v == SEQ_START_TOKEN) {
+		seq_printf(m, "lock_stat version 1, times in us, "
+			   "%lu classes lost\n", lock_classes_lost);
+		seq_puts(m, "histogram buckets:");
+		for (i = 0; i < LOCK_STAT_BUCKETS; i++)
+			seq_printf(m, " %s", lock_bucket_names[i]);
+		seq_printf(m, "\n\n%-40s %-6s %10s %10s %9s %11s %9s %11s\n",
+			   "class", "type", "acquired", "contended",
+			   "wait-max", "wait-total", "hold-max", "hold-total");
+		return 0;
+	}
+
+	memset(&sum, 0, sizeof(sum));
+	for_each_cpu(cpu) {
+		struct lock_class_stats *stats = lock_stats[cpu];
+
+		if (!stats)
+			continue;
+		stats += class - lock_classes;
+		sum.acquisitions += stats->acquisitions;
+		sum.contentions += stats->contentions;
+		for (i = 0; i < LOCK_STAT_POINTS; i++)
+			sum.points[i] += stats->points[i];
+		sum.wait_total += stats->wait_total;
+		if (stats->wait_max > sum.wait_max)
+			sum.wait_max = stats->wait_max;
+		sum.hold_total += stats->hold_total;
+		if (stats->hold_max > sum.hold_max)
+			sum.hold_max = stats->hold_max;
+		for (i = 0; i < LOCK_STAT_BUCKETS; i++) {
+			sum.wait_hist[i] += stats->wait_hist[i];
+			sum.hold_hist[i] += stats->hold_hist[i];
+		}
+	}
+	if (!sum.acquisitions)
+		return 0;
+
+	if (class->name[0])
+		strlcpy(name, class->name, sizeof(name));
+	else
+		lock_stat_sym(name, sizeof(name), (unsigned long)class->key);
+
+	seq_printf(m, "%-40s %-6s %10lu %10lu %9llu %11llu %9llu %11llu\n",
+		   name, lock_type_names[class->type],
+		   sum.acquisitions, sum.contentions,
+		   ns_to_us(sum.wait_max), ns_to_us(sum.wait_total),
+		   ns_to_us(sum.hold_max), ns_to_us(sum.hold_total));
+	if (sum.contentions)
+		lock_stat_hist(m, "wait", sum.wait_hist);
+	if (sum.hold_total)
+		lock_stat_hist(m, "hold", sum.hold_hist);
+	for (i = 0; i < LOCK_STAT_POINTS; i++) {
+		if (!sum.points[i])
+			continue;
+		lock_stat_sym(name, sizeof(name), class->points[i]);
+		seq_printf(m, "  %10lu %s\n", sum.points[i], name);
+	}
+	return 0;
+}
+
+static struct seq_operations lock_stat_op = {
+	.start	= lock_stat_start,
+	.next	= lock_stat_next,
+	.stop	= lock_stat_stop,
+	.show	= lock_stat_show,
+};
+
+static int lock_stat_open(struct inode *inode, struct file *file)
+{
+	return seq_open(file, &lock_stat_op);
+}
+
+/* Any write clears the statistics; the classes stay */
+static ssize_t lock_stat_write(struct file *file, const char __user *buf,
+			       size_t count, loff_t *ppos)
+{
+	int cpu;
+
+	for_each_cpu(cpu)
+		if (lock_stats[cpu])
+			memset(lock_stats[cpu], 0, LOCK_STATS_SIZE);
+	return count;
+}
+
+static struct file_operations lock_stat_operations = {
+	.open		= lock_stat_open,
+	.read		= seq_read,
+	.write		= lock_stat_write,
+	.llseek		= seq_lseek,
+	.release	= seq_release,
+};
+
+static int __init lock_stat_init(void)
+{
+	struct proc_dir_entry *entry;
+	int cpu;
+
+	for_each_cpu(cpu) {
+		struct lock_class_stats *stats = vmalloc(LOCK_STATS_SIZE);
+
+		if (!stats) {
+			printk(KERN_WARNING "lock_stat: no memory for cpu %d\n",
+			       cpu);
+			continue;
+		}
+		memset(stats, 0, LOCK_STATS_SIZE);
+		smp_wmb();
+		lock_stats[cpu] = stats;
+	}
+
+	entry = create_proc_entry("lock_stat", S_IRUSR | S_IWUSR, NULL);
+	if (entry)
+		entry->proc_fops = &lock_stat_operations;
+	return 0;
+}
+__initcall(lock_stat_init);
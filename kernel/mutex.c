@@ -0,0 +1,249 @@
+/*
+ * kernel/mutex.c
+ *
+ * Mutexes: blocking mutual exclusion locks, see include/linux/mutex.h.
+ *
+ * The lock word is 1 when unlocked, 0 when locked and negative when
+ * locked with possible waiters.  Locking and unlocking without
+ * contention is one atomic operation; the slow paths serialize on
+ * wait_lock.  A contended locker first spins for as long as the owner
+ * is running on another cpu, and only then queues up and sleeps.
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/sched.h>
+#include <linux/spinlock.h>
+#include <linux/interrupt.h>
+#include <linux/lockstat.h>
+#include <linux/mutex.h>
+
+struct mutex_waiter {
+	struct list_head	list;
+	struct task_struct	*task;
+};
+
+#define mutex_xchg(lock, v)	xchg(&(lock)->count.counter, (v))
+
+#ifdef CONFIG_SMP
+static inline void mutex_set_owner(struct mutex *lock)
+{
+	lock->owner = current_thread_info();
+}
+
+static inline void mutex_clear_owner(struct mutex *lock)
+{
+	lock->owner = NULL;
+}
+#else
+static inline void mutex_set_owner(struct mutex *lock)
+{
+}
+
+static inline void mutex_clear_owner(struct mutex *lock)
+{
+}
+#endif
+
+void mutex_init(struct mutex *lock)
+{
+	atomic_set(&lock->count, 1);
+	spin_lock_init(&lock->wait_lock);
+	INIT_LIST_HEAD(&lock->wait_list);
+	mutex_clear_owner(lock);
+}
+
+EXPORT_SYMBOL(mutex_init);
+
+#ifdef MUTEX_SPIN_ON_OWNER
+/*
+ * Spin while the owner is running: it is likely to release the lock
+ * before we could even get to sleep.  Stop when the owner sleeps or
+ * when we should reschedule.  Returns 1 if we got the lock.
+ */
+static int mutex_optimistic_spin(struct mutex *lock)
+{
+	preempt_disable();
+	for (;;) {
+		struct thread_info *owner = lock->owner;
+
+		if (owner && !mutex_spin_on_owner(lock, owner))
+			break;
+
+		if (atomic_read(&lock->count) == 1 &&
+		    cmpxchg(&lock->count.counter, 1, 0) == 1) {
+			mutex_set_owner(lock);
+			preempt_enable();
+			return 1;
+		}
+
+		/*
+		 * With no owner recorded we may have preempted the owner
+		 * between taking the lock and setting the owner; an RT
+		 * task spinning here would never let it continue.
+		 */
+		if (!owner && (need_resched() || rt_task(current)))
+			break;
+
+		cpu_relax();
+	}
+	preempt_enable();
+	return 0;
+}
+#else
+static inline int mutex_optimistic_spin(struct mutex *lock)
+{
+	return 0;
+}
+#endif
+
+static inline int __sched
+__mutex_lock_common(struct mutex *lock, long state)
+{
+	struct task_struct *task = current;
+	struct mutex_waiter waiter;
+	unsigned long long start;
+
+	if (mutex_optimistic_spin(lock))
+		return 0;
+
+	start = lock_stat_clock();
+	spin_lock(&lock->wait_lock);
+	list_add_tail(&waiter.list, &lock->wait_list);
+	waiter.task = task;
+
+	for (;;) {
+		/*
+		 * Mark the lock as contended while trying to take it, so
+		 * that the unlock of whoever holds it comes to wake us.
+		 */
+		if (mutex_xchg(lock, -1) == 1)
+			break;
+
+		if (state == TASK_INTERRUPTIBLE && signal_pending(task)) {
+			list_del(&waiter.list);
+			spin_unlock(&lock->wait_lock);
+			return -EINTR;
+		}
+		__set_task_state(task, state);
+		spin_unlock(&lock->wait_lock);
+		schedule();
+		spin_lock(&lock->wait_lock);
+	}
+	__set_task_state(task, TASK_RUNNING);
+
+	list_del(&waiter.list);
+	mutex_set_owner(lock);
+
+	/* Nobody left to wake: let the next unlock take the fast path */
+	if (list_empty(&lock->wait_list))
+		atomic_set(&lock->count, 0);
+	spin_unlock(&lock->wait_lock);
+
+	lock_stat_waited(lock, LOCK_STAT_MUTEX, start);
+	return 0;
+}
+
+static void fastcall noinline __sched
+__mutex_lock_slowpath(struct mutex *lock)
+{
+	__mutex_lock_common(lock, TASK_UNINTERRUPTIBLE);
+}
+
+static int fastcall noinline __sched
+__mutex_lock_interruptible_slowpath(struct mutex *lock)
+{
+	return __mutex_lock_common(lock, TASK_INTERRUPTIBLE);
+}
+
+/**
+ * mutex_lock - acquire the mutex
+ * @lock: the mutex to be acquired
+ *
+ * Lock the mutex exclusively for this task.  If the mutex is not
+ * available right now, spin while its owner runs, then sleep until it
+ * can be had.
+ */
+void fastcall __sched mutex_lock(struct mutex *lock)
+{
+	might_sleep();
+	if (unlikely(atomic_dec_return(&lock->count) < 0))
+		__mutex_lock_slowpath(lock);
+	else
+		mutex_set_owner(lock);
+}
+
+EXPORT_SYMBOL(mutex_lock);
+
+/**
+ * mutex_lock_interruptible - acquire the mutex, interruptible
+ * @lock: the mutex to be acquired
+ *
+ * Like mutex_lock(), but returns -EINTR without the lock if a signal
+ * arrives while sleeping, and 0 once the lock is held.
+ */
+int fastcall __sched mutex_lock_interruptible(struct mutex *lock)
+{
+	might_sleep();
+	if (unlikely(atomic_dec_return(&lock->count) < 0))
+		return __mutex_lock_interruptible_slowpath(lock);
+	mutex_set_owner(lock);
+	return 0;
+}
+
+EXPORT_SYMBOL(mutex_lock_interruptible);
+
+/**
+ * mutex_trylock - try to acquire the mutex, without waiting
+ * @lock: the mutex to be acquired
+ *
+ * Returns 1 if the mutex has been acquired, 0 otherwise.  Note that
+ * this is the opposite of down_trylock()'s return value.
+ */
+int fastcall mutex_trylock(struct mutex *lock)
+{
+	int prev;
+
+	spin_lock(&lock->wait_lock);
+	prev = mutex_xchg(lock, -1);
+	if (likely(prev == 1))
+		mutex_set_owner(lock);
+	/* Undo the contended marking if nobody is waiting */
+	if (list_empty(&lock->wait_list))
+		atomic_set(&lock->count, 0);
+	spin_unlock(&lock->wait_lock);
+
+	return prev == 1;
+}
+
+EXPORT_SYMBOL(mutex_trylock);
+
+static void fastcall noinline __mutex_unlock_slowpath(struct mutex *lock)
+{
+	spin_lock(&lock->wait_lock);
+	atomic_set(&lock->count, 1);
+	if (!list_empty(&lock->wait_list)) {
+		struct mutex_waiter *waiter =
+			list_entry(lock->wait_list.next, struct mutex_waiter,
+				   list);
+
+		wake_up_process(waiter->task);
+	}
+	spin_unlock(&lock->wait_lock);
+}
+
+/**
+ * mutex_unlock - release the mutex
+ * @lock: the mutex to be released
+ *
+ * Must be called by the task that locked the mutex, and not from
+ * interrupt context.
+ */
+void fastcall __sched mutex_unlock(struct mutex *lock)
+{
+	mutex_clear_owner(lock);
+	if (unlikely(atomic_inc_return(&lock->count) <= 0))
+		__mutex_unlock_slowpath(lock);
+}
+
+EXPORT_SYMBOL(mutex_unlock);
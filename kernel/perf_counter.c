@@ -0,0 +1,1081 @@
+/*
+ * kernel/perf_counter.c
+ *
+ * Performance counters, see include/linux/perf_counter.h.
+ *
+ * Counters live in contexts: one per cpu, and one per task that has
+ * counters attached.  A cpu's context is always in.  A task's context
+ * is scheduled in on the task's cpu when it is switched to, and out
+ * again when it is switched away from, which is what makes hardware
+ * counters count per task.
+ *
+ * The counters of a context that is in are only changed on its cpu,
+ * with interrupts disabled and ctx->lock held; other cpus get there
+ * with an IPI.  A context that is out is changed under ctx->lock by
+ * whoever needs to.  The architecture's PMU interrupt updates hardware
+ * counters too; it is an NMI, and the architecture code keeps it apart
+ * from the other updates.  The scheduler and interrupts walk the lists
+ * of contexts that are in without the lock, so counters are only freed
+ * after synchronize_kernel().
+ *
+ * Counters that find no room on the PMU when their context comes in
+ * stay INACTIVE: their time_enabled grows but their time_running does
+ * not, so that userspace can scale their count.
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/fs.h>
+#include <linux/file.h>
+#include <linux/mount.h>
+#include <linux/poll.h>
+#include <linux/smp.h>
+#include <linux/percpu.h>
+#include <linux/rcupdate.h>
+#include <linux/err.h>
+#include <linux/syscalls.h>
+#include <linux/ptrace.h>
+#include <linux/perf_counter.h>
+#include <asm/uaccess.h>
+#include <asm/ptrace.h>
+
+/* Data pages a counter may mmap() without CAP_IPC_LOCK */
+#define PERF_MMAP_MAX_PAGES	128
+
+struct perf_cpu_context {
+	struct perf_counter_context	ctx;
+	struct perf_counter_context	*task_ctx;	/* current's, if any */
+	struct task_struct		*wakeup_task;	/* Left with samples */
+};
+
+static DEFINE_PER_CPU(struct perf_cpu_context, perf_cpu_context);
+
+atomic_t perf_swcounter_users = ATOMIC_INIT(0);
+
+static struct vfsmount *perf_mnt;
+
+static void perf_counter_context_init(struct perf_counter_context *ctx,
+				      struct task_struct *task)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	spin_lock_init(&ctx->lock);
+	INIT_LIST_HEAD(&ctx->counter_list);
+	ctx->cpu = -1;
+	ctx->task = task;
+}
+
+/*
+ * An NMI may update a hardware counter's count between the two halves
+ * of a 32-bit read: read it until two reads agree.
+ */
+static u64 perf_counter_count(struct perf_counter *counter)
+{
+	volatile u64 *count = &counter->count;
+	u64 val;
+
+	do {
+		val = *count;
+	} while (val != *count);
+	return val;
+}
+
+/* Only while the counter's context is in, on its cpu */
+static void update_counter_times(struct perf_counter *counter, u64 now)
+{
+	u64 delta;
+
+	if (counter->state < PERF_COUNTER_STATE_INACTIVE)
+		return;
+	delta = now - counter->tstamp;
+	counter->time_enabled += delta;
+	if (counter->state == PERF_COUNTER_STATE_ACTIVE)
+		counter->time_running += delta;
+	counter->tstamp = now;
+}
+
+static int counter_sched_in(struct perf_counter *counter,
+			    struct perf_counter_context *ctx, int cpu)
+{
+	if (counter->state != PERF_COUNTER_STATE_INACTIVE)
+		return 0;
+
+	counter->oncpu = cpu;
+	if (counter->ops->enable(counter)) {
+		counter->oncpu = -1;
+		return -EAGAIN;
+	}
+	counter->state = PERF_COUNTER_STATE_ACTIVE;
+	ctx->nr_active++;
+	return 0;
+}
+
+static void counter_sched_out(struct perf_counter *counter,
+			      struct perf_counter_context *ctx)
+{
+	if (counter->state != PERF_COUNTER_STATE_ACTIVE)
+		return;
+
+	counter->ops->disable(counter);
+	counter->state = PERF_COUNTER_STATE_INACTIVE;
+	counter->oncpu = -1;
+	ctx->nr_active--;
+}
+
+/* Bring the context in, or retry the counters that did not fit */
+static void ctx_sched_in(struct perf_counter_context *ctx, int cpu)
+{
+	struct perf_counter *counter;
+	u64 now = sched_clock();
+
+	spin_lock(&ctx->lock);
+	list_for_each_entry(counter, &ctx->counter_list, list_entry) {
+		if (counter->state != PERF_COUNTER_STATE_INACTIVE)
+			continue;
+		if (ctx->is_active)
+			update_counter_times(counter, now);
+		else
+			counter->tstamp = now;
+		counter_sched_in(counter, ctx, cpu);
+	}
+	ctx->is_active = 1;
+	ctx->cpu = cpu;
+	spin_unlock(&ctx->lock);
+}
+
+/* Returns 1 if some counter has samples that poll() should hear of */
+static int ctx_sched_out(struct perf_counter_context *ctx)
+{
+	struct perf_counter *counter;
+	u64 now = sched_clock();
+	int wakeup = 0;
+
+	spin_lock(&ctx->lock);
+	if (ctx->is_active) {
+		list_for_each_entry(counter, &ctx->counter_list, list_entry) {
+			update_counter_times(counter, now);
+			counter_sched_out(counter, ctx);
+			if (counter->data && counter->data->wakeup)
+				wakeup = 1;
+		}
+		ctx->is_active = 0;
+	}
+	spin_unlock(&ctx->lock);
+	return wakeup;
+}
+
+static void perf_counter_wakeup(struct perf_counter_context *ctx)
+{
+	struct perf_counter *counter;
+	struct perf_mmap_data *data;
+
+	rcu_read_lock();
+	list_for_each_entry_rcu(counter, &ctx->counter_list, list_entry) {
+		data = rcu_dereference(counter->data);
+		if (data && data->wakeup) {
+			data->wakeup = 0;
+			wake_up_all(&counter->waitq);
+		}
+	}
+	rcu_read_unlock();
+}
+
+/*
+ * Called by the scheduler before switching away from @task, with the
+ * runqueue locked and interrupts disabled.  Nobody can be woken up
+ * from here: a task whose counters have samples to report is kept for
+ * perf_counter_task_sched_in() to do that.
+ */
+void perf_counter_task_sched_out(struct task_struct *task, int cpu)
+{
+	struct perf_cpu_context *cpuctx = &per_cpu(perf_cpu_context, cpu);
+	struct perf_counter_context *ctx = cpuctx->task_ctx;
+
+	perf_swcounter_event(PERF_COUNT_CONTEXT_SWITCHES, 1, NULL);
+
+	if (!ctx)
+		return;
+	if (ctx_sched_out(ctx) && !cpuctx->wakeup_task) {
+		get_task_struct(task);
+		cpuctx->wakeup_task = task;
+	}
+	cpuctx->task_ctx = NULL;
+}
+
+/*
+ * Called by the scheduler after switching to @task, with the runqueue
+ * unlocked.  The cpu's own counters go first, so they also get what
+ * they could not have before.
+ */
+void perf_counter_task_sched_in(struct task_struct *task, int cpu)
+{
+	struct perf_cpu_context *cpuctx = &per_cpu(perf_cpu_context, cpu);
+	struct perf_counter_context *ctx = task->perf_counter_ctxp;
+	struct task_struct *wakeup;
+	unsigned long flags;
+	int migrated;
+
+	local_irq_save(flags);
+	migrated = task->perf_counter_cpu >= 0 && task->perf_counter_cpu != cpu;
+	task->perf_counter_cpu = cpu;
+
+	if (cpuctx->ctx.nr_active < cpuctx->ctx.nr_counters)
+		ctx_sched_in(&cpuctx->ctx, cpu);
+	if (ctx) {
+		ctx_sched_in(ctx, cpu);
+		cpuctx->task_ctx = ctx;
+	}
+	if (migrated)
+		perf_swcounter_event(PERF_COUNT_CPU_MIGRATIONS, 1, NULL);
+
+	wakeup = cpuctx->wakeup_task;
+	cpuctx->wakeup_task = NULL;
+	local_irq_restore(flags);
+
+	if (wakeup) {
+		perf_counter_wakeup(wakeup->perf_counter_ctxp);
+		put_task_struct(wakeup);
+	}
+}
+
+/* Called from free_task(), once all of the task's counters are gone */
+void perf_counter_task_free(struct task_struct *task)
+{
+	kfree(task->perf_counter_ctxp);
+}
+
+/*
+ * A context made for current while it runs would only come in at the
+ * next switch; bring it in right away.
+ */
+static void perf_counter_activate_current(struct perf_counter_context *ctx)
+{
+	struct perf_cpu_context *cpuctx;
+	int cpu;
+
+	local_irq_disable();
+	cpu = smp_processor_id();
+	cpuctx = &per_cpu(perf_cpu_context, cpu);
+	if (!cpuctx->task_ctx) {
+		ctx_sched_in(ctx, cpu);
+		cpuctx->task_ctx = ctx;
+	}
+	local_irq_enable();
+}
+
+struct perf_ctx_call {
+	struct perf_counter	*counter;
+	void			(*func)(struct perf_counter *, void *);
+	void			*arg;
+	int			done;
+};
+
+static void __perf_ctx_call(void *info)
+{
+	struct perf_ctx_call *call = info;
+	struct perf_counter_context *ctx = call->counter->ctx;
+	unsigned long flags;
+
+	if (ctx->cpu != smp_processor_id())
+		return;
+
+	spin_lock_irqsave(&ctx->lock, flags);
+	if (ctx->is_active && ctx->cpu == smp_processor_id()) {
+		call->func(call->counter, call->arg);
+		call->done = 1;
+	}
+	spin_unlock_irqrestore(&ctx->lock, flags);
+}
+
+/*
+ * Run func(counter, arg) with the counter's context locked and
+ * interrupts disabled: on the cpu where the context is in, or right
+ * here if it is out.  A task's context may move on before the IPI gets
+ * there, in which case we try again.
+ */
+static void perf_ctx_call(struct perf_counter *counter,
+			  void (*func)(struct perf_counter *, void *),
+			  void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+	struct perf_ctx_call call = { counter, func, arg, 0 };
+
+	for (;;) {
+		spin_lock_irq(&ctx->lock);
+		if (!ctx->is_active) {
+			func(counter, arg);
+			spin_unlock_irq(&ctx->lock);
+			return;
+		}
+		spin_unlock_irq(&ctx->lock);
+
+		on_each_cpu(__perf_ctx_call, &call, 1, 1);
+		if (call.done)
+			return;
+	}
+}
+
+static void __perf_counter_install(struct perf_counter *counter, void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+
+	list_add_tail_rcu(&counter->list_entry, &ctx->counter_list);
+	ctx->nr_counters++;
+	if (ctx->is_active && counter->state == PERF_COUNTER_STATE_INACTIVE) {
+		counter->tstamp = sched_clock();
+		counter_sched_in(counter, ctx, smp_processor_id());
+	}
+}
+
+static void __perf_counter_remove(struct perf_counter *counter, void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+
+	if (ctx->is_active)
+		update_counter_times(counter, sched_clock());
+	counter_sched_out(counter, ctx);
+	list_del_rcu(&counter->list_entry);
+	ctx->nr_counters--;
+}
+
+static void __perf_counter_enable(struct perf_counter *counter, void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+
+	if (counter->state != PERF_COUNTER_STATE_OFF)
+		return;
+	counter->state = PERF_COUNTER_STATE_INACTIVE;
+	if (ctx->is_active) {
+		counter->tstamp = sched_clock();
+		counter_sched_in(counter, ctx, smp_processor_id());
+	}
+}
+
+static void __perf_counter_disable(struct perf_counter *counter, void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+
+	if (counter->state == PERF_COUNTER_STATE_OFF)
+		return;
+	if (ctx->is_active)
+		update_counter_times(counter, sched_clock());
+	counter_sched_out(counter, ctx);
+	counter->state = PERF_COUNTER_STATE_OFF;
+}
+
+/* The PMU's NMI must not add to the count while it is cleared */
+static void __perf_counter_reset(struct perf_counter *counter, void *arg)
+{
+	struct perf_counter_context *ctx = counter->ctx;
+	int active = counter->state == PERF_COUNTER_STATE_ACTIVE;
+
+	if (ctx->is_active)
+		update_counter_times(counter, sched_clock());
+	counter_sched_out(counter, ctx);
+	counter->count = 0;
+	if (active)
+		counter_sched_in(counter, ctx, smp_processor_id());
+}
+
+struct perf_read_values {
+	u64	count;
+	u64	time_enabled;
+	u64	time_running;
+};
+
+static void __perf_counter_read(struct perf_counter *counter, void *arg)
+{
+	struct perf_read_values *values = arg;
+
+	if (counter->state == PERF_COUNTER_STATE_ACTIVE)
+		counter->ops->read(counter);
+	if (counter->ctx->is_active)
+		update_counter_times(counter, sched_clock());
+	values->count = perf_counter_count(counter);
+	values->time_enabled = counter->time_enabled;
+	values->time_running = counter->time_running;
+}
+
+/*
+ * Samples go to the buffer mmap()ed from the counter's file.  Only the
+ * cpu the counter runs on writes to it, from the PMU's NMI or with
+ * interrupts disabled, so the writer needs no locking.
+ */
+static void perf_mmap_copy(struct perf_mmap_data *data, unsigned long *head,
+			   const void *buf, int len)
+{
+	unsigned long mask = ((unsigned long)data->nr_pages << PAGE_SHIFT) - 1;
+	unsigned long offset;
+	int size;
+
+	while (len) {
+		offset = *head & mask;
+		size = min_t(int, len, PAGE_SIZE - (offset & ~PAGE_MASK));
+		memcpy(data->data_pages[offset >> PAGE_SHIFT] +
+		       (offset & ~PAGE_MASK), buf, size);
+		*head += size;
+		buf += size;
+		len -= size;
+	}
+}
+
+static void perf_mmap_output(struct perf_counter *counter,
+			     struct perf_mmap_data *data,
+			     const void *record, int size)
+{
+	unsigned long buf_size = (unsigned long)data->nr_pages << PAGE_SHIFT;
+	unsigned long head = data->head, tail;
+	unsigned int wakeup_events;
+	struct {
+		struct perf_event_header	header;
+		u64				lost;
+	} lost;
+	int need = size;
+
+	if (data->lost)
+		need += sizeof(lost);
+
+	tail = (unsigned long)data->user_page->data_tail;
+	/* Read the tail before writing over what the reader has let go */
+	smp_mb();
+	if (head - tail > buf_size || buf_size - (head - tail) < need) {
+		data->lost++;
+		return;
+	}
+
+	if (data->lost) {
+		lost.header.type = PERF_EVENT_LOST;
+		lost.header.misc = 0;
+		lost.header.size = sizeof(lost);
+		lost.lost = data->lost;
+		perf_mmap_copy(data, &head, &lost, sizeof(lost));
+		data->lost = 0;
+	}
+	perf_mmap_copy(data, &head, record, size);
+
+	/* The records before the head that covers them */
+	smp_wmb();
+	data->user_page->data_head = head;
+	data->head = head;
+
+	wakeup_events = counter->hw_event.wakeup_events ? : 1;
+	if (++data->events >= wakeup_events) {
+		data->events = 0;
+		data->wakeup = 1;
+	}
+}
+
+/**
+ * perf_counter_output - record a sample of a counter
+ * @counter: the counter whose period is over
+ * @regs: registers at the event, or NULL if there are none
+ *
+ * Called on the counter's cpu, from the PMU's NMI or with interrupts
+ * disabled.  poll() hears of the sample at the next tick or switch.
+ */
+void perf_counter_output(struct perf_counter *counter, struct pt_regs *regs)
+{
+	struct perf_mmap_data *data = rcu_dereference(counter->data);
+	u32 type = counter->hw_event.sample_type;
+	struct perf_event_header *header;
+	u64 record[5];
+	int n = 1;
+
+	if (!data)
+		return;
+
+	header = (struct perf_event_header *)record;
+	header->type = PERF_EVENT_SAMPLE;
+	header->misc = regs && user_mode(regs) ?
+		PERF_EVENT_MISC_USER : PERF_EVENT_MISC_KERNEL;
+	if (type & PERF_SAMPLE_IP)
+		record[n++] = regs ? instruction_pointer(regs) : 0;
+	if (type & PERF_SAMPLE_TID)
+		record[n++] = (u32)current->tgid | ((u64)current->pid << 32);
+	if (type & PERF_SAMPLE_TIME)
+		record[n++] = sched_clock();
+	if (type & PERF_SAMPLE_CPU)
+		record[n++] = smp_processor_id();
+	header->size = n * sizeof(u64);
+
+	perf_mmap_output(counter, data, record, header->size);
+}
+
+/*
+ * Software counters.  They never run out of room, and are counted with
+ * interrupts disabled on the cpu where they are in.
+ */
+static int perf_swcounter_match(struct perf_counter *counter, u32 event,
+				struct pt_regs *regs)
+{
+	u32 flags = counter->hw_event.flags;
+
+	if (counter->state != PERF_COUNTER_STATE_ACTIVE)
+		return 0;
+	if (counter->hw_event.type != PERF_TYPE_SOFTWARE ||
+	    counter->hw_event.config != event)
+		return 0;
+	if (regs && (user_mode(regs) ? flags & PERF_FLAG_EXCLUDE_USER :
+				       flags & PERF_FLAG_EXCLUDE_KERNEL))
+		return 0;
+	return 1;
+}
+
+/* Take nr events off the sample period, and sample if it is over */
+static void perf_swcounter_period(struct perf_counter *counter, u64 nr,
+				  struct pt_regs *regs)
+{
+	struct hw_perf_counter *hwc = &counter->hw;
+	s64 period = counter->hw_event.irq_period;
+
+	if (!period)
+		return;
+	hwc->period_left -= nr;
+	if (hwc->period_left > 0)
+		return;
+	hwc->period_left += period;
+	if (hwc->period_left <= 0)
+		hwc->period_left = period;
+	perf_counter_output(counter, regs);
+}
+
+static void perf_swcounter_ctx_event(struct perf_counter_context *ctx,
+				     u32 event, u64 nr, struct pt_regs *regs)
+{
+	struct perf_counter *counter;
+
+	list_for_each_entry(counter, &ctx->counter_list, list_entry) {
+		if (!perf_swcounter_match(counter, event, regs))
+			continue;
+		counter->count += nr;
+		perf_swcounter_period(counter, nr, regs);
+	}
+}
+
+void __perf_swcounter_event(u32 event, u64 nr, struct pt_regs *regs)
+{
+	struct perf_cpu_context *cpuctx;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	cpuctx = &__get_cpu_var(perf_cpu_context);
+	if (cpuctx->ctx.nr_active)
+		perf_swcounter_ctx_event(&cpuctx->ctx, event, nr, regs);
+	if (cpuctx->task_ctx)
+		perf_swcounter_ctx_event(cpuctx->task_ctx, event, nr, regs);
+	local_irq_restore(flags);
+}
+
+static int perf_swcounter_enable(struct perf_counter *counter)
+{
+	return 0;
+}
+
+static void perf_swcounter_disable(struct perf_counter *counter)
+{
+}
+
+static void perf_swcounter_read(struct perf_counter *counter)
+{
+}
+
+static const struct perf_counter_ops perf_ops_generic = {
+	.enable		= perf_swcounter_enable,
+	.disable	= perf_swcounter_disable,
+	.read		= perf_swcounter_read,
+};
+
+/*
+ * The cpu clock counts the nanoseconds a counter is in.  Its samples
+ * are taken from the tick, so no more than one per tick.
+ */
+static void cpu_clock_update(struct perf_counter *counter)
+{
+	u64 now = sched_clock();
+	s64 delta = now - counter->hw.prev_count;
+
+	counter->hw.prev_count = now;
+	if (delta > 0) {
+		counter->count += delta;
+		counter->hw.period_left -= delta;
+	}
+}
+
+static int cpu_clock_enable(struct perf_counter *counter)
+{
+	counter->hw.prev_count = sched_clock();
+	return 0;
+}
+
+static const struct perf_counter_ops perf_ops_cpu_clock = {
+	.enable		= cpu_clock_enable,
+	.disable	= cpu_clock_update,
+	.read		= cpu_clock_update,
+};
+
+static void perf_ctx_tick(struct perf_counter_context *ctx,
+			  struct pt_regs *regs)
+{
+	struct perf_counter *counter;
+	struct perf_mmap_data *data;
+
+	list_for_each_entry(counter, &ctx->counter_list, list_entry) {
+		if (counter->state != PERF_COUNTER_STATE_ACTIVE)
+			continue;
+		if (counter->ops == &perf_ops_cpu_clock) {
+			cpu_clock_update(counter);
+			perf_swcounter_period(counter, 0, regs);
+		}
+		data = counter->data;
+		if (data && data->wakeup) {
+			data->wakeup = 0;
+			wake_up_all(&counter->waitq);
+		}
+	}
+}
+
+/* Called from profile_tick(), every tick on every cpu */
+void perf_counter_tick(struct pt_regs *regs)
+{
+	struct perf_cpu_context *cpuctx = &__get_cpu_var(perf_cpu_context);
+
+	if (cpuctx->ctx.nr_active)
+		perf_ctx_tick(&cpuctx->ctx, regs);
+	if (cpuctx->task_ctx)
+		perf_ctx_tick(cpuctx->task_ctx, regs);
+}
+
+static void sw_perf_counter_destroy(struct perf_counter *counter)
+{
+	atomic_dec(&perf_swcounter_users);
+}
+
+static const struct perf_counter_ops *
+sw_perf_counter_init(struct perf_counter *counter)
+{
+	switch (counter->hw_event.config) {
+	case PERF_COUNT_CPU_CLOCK:
+		return &perf_ops_cpu_clock;
+	case PERF_COUNT_PAGE_FAULTS:
+	case PERF_COUNT_PAGE_FAULTS_MIN:
+	case PERF_COUNT_PAGE_FAULTS_MAJ:
+	case PERF_COUNT_CONTEXT_SWITCHES:
+	case PERF_COUNT_CPU_MIGRATIONS:
+		atomic_inc(&perf_swcounter_users);
+		counter->destroy = sw_perf_counter_destroy;
+		return &perf_ops_generic;
+	}
+	return ERR_PTR(-EINVAL);
+}
+
+static void perf_mmap_data_free(struct perf_mmap_data *data)
+{
+	int i;
+
+	free_page((unsigned long)data->user_page);
+	for (i = 0; i < data->nr_pages; i++)
+		free_page((unsigned long)data->data_pages[i]);
+	kfree(data);
+}
+
+static struct perf_mmap_data *perf_mmap_data_alloc(int nr_pages)
+{
+	struct perf_mmap_data *data;
+	int size, i;
+
+	size = sizeof(*data) + nr_pages * sizeof(void *);
+	data = kmalloc(size, GFP_KERNEL);
+	if (!data)
+		return NULL;
+	memset(data, 0, size);
+	data->nr_pages = nr_pages;
+
+	data->user_page = (void *)get_zeroed_page(GFP_KERNEL);
+	if (!data->user_page)
+		goto fail;
+	for (i = 0; i < nr_pages; i++) {
+		data->data_pages[i] = (void *)get_zeroed_page(GFP_KERNEL);
+		if (!data->data_pages[i])
+			goto fail;
+	}
+	data->user_page->version = PERF_COUNTER_MMAP_VERSION;
+	data->user_page->compat_version = PERF_COUNTER_MMAP_VERSION;
+	return data;
+
+fail:
+	perf_mmap_data_free(data);
+	return NULL;
+}
+
+/*
+ * Checked when a counter is created for another task: the same rules
+ * as for ptrace, dumpable and security hook included.
+ */
+static int perf_may_attach(struct task_struct *task)
+{
+	if (task == current)
+		return 1;
+	return may_ptrace_attach(task);
+}
+
+/*
+ * The context for a counter of task @pid (0 for current) or of @cpu.
+ * Holds a reference on the task, which the counter keeps until it is
+ * freed: the context goes away with the task.
+ */
+static struct perf_counter_context *find_get_context(pid_t pid, int cpu)
+{
+	struct perf_counter_context *ctx, *new;
+	struct task_struct *task;
+
+	if (pid == -1) {
+		if (cpu < 0 || cpu >= NR_CPUS || !cpu_online(cpu))
+			return ERR_PTR(-EINVAL);
+		if (!capable(CAP_SYS_ADMIN))
+			return ERR_PTR(-EACCES);
+		return &per_cpu(perf_cpu_context, cpu).ctx;
+	}
+	if (cpu != -1)
+		return ERR_PTR(-EINVAL);
+
+	read_lock(&tasklist_lock);
+	task = pid ? find_task_by_pid(pid) : current;
+	if (task)
+		get_task_struct(task);
+	read_unlock(&tasklist_lock);
+	if (!task)
+		return ERR_PTR(-ESRCH);
+
+	if (!perf_may_attach(task)) {
+		put_task_struct(task);
+		return ERR_PTR(-EACCES);
+	}
+
+	ctx = task->perf_counter_ctxp;
+	if (!ctx) {
+		new = kmalloc(sizeof(*new), GFP_KERNEL);
+		if (!new) {
+			put_task_struct(task);
+			return ERR_PTR(-ENOMEM);
+		}
+		perf_counter_context_init(new, task);
+
+		task_lock(task);
+		if (!task->perf_counter_ctxp)
+			task->perf_counter_ctxp = new;
+		else
+			kfree(new);
+		ctx = task->perf_counter_ctxp;
+		task_unlock(task);
+	}
+	return ctx;
+}
+
+static void put_context(struct perf_counter_context *ctx)
+{
+	if (ctx->task)
+		put_task_struct(ctx->task);
+}
+
+static struct perf_counter *
+perf_counter_alloc(struct perf_counter_hw_event *hw_event,
+		   struct perf_counter_context *ctx)
+{
+	const struct perf_counter_ops *ops;
+	struct perf_counter *counter;
+
+	counter = kmalloc(sizeof(*counter), GFP_KERNEL);
+	if (!counter)
+		return ERR_PTR(-ENOMEM);
+	memset(counter, 0, sizeof(*counter));
+
+	INIT_LIST_HEAD(&counter->list_entry);
+	counter->hw_event = *hw_event;
+	counter->ctx = ctx;
+	counter->oncpu = -1;
+	counter->hw.idx = -1;
+	counter->hw.period_left = hw_event->irq_period;
+	if (hw_event->flags & PERF_FLAG_DISABLED)
+		counter->state = PERF_COUNTER_STATE_OFF;
+	else
+		counter->state = PERF_COUNTER_STATE_INACTIVE;
+	init_waitqueue_head(&counter->waitq);
+	mutex_init(&counter->mmap_mutex);
+
+	switch (hw_event->type) {
+	case PERF_TYPE_HARDWARE:
+	case PERF_TYPE_RAW:
+		ops = hw_perf_counter_init(counter);
+		break;
+	case PERF_TYPE_SOFTWARE:
+		ops = sw_perf_counter_init(counter);
+		break;
+	default:
+		ops = ERR_PTR(-EINVAL);
+		break;
+	}
+	if (IS_ERR(ops)) {
+		kfree(counter);
+		return ERR_PTR(PTR_ERR(ops));
+	}
+	counter->ops = ops;
+	return counter;
+}
+
+static void perf_counter_free(struct perf_counter *counter)
+{
+	if (counter->destroy)
+		counter->destroy(counter);
+	if (counter->data)
+		perf_mmap_data_free(counter->data);
+	put_context(counter->ctx);
+	kfree(counter);
+}
+
+static int perf_release(struct inode *inode, struct file *file)
+{
+	struct perf_counter *counter = file->private_data;
+
+	perf_ctx_call(counter, __perf_counter_remove, NULL);
+	/* Let the walkers of the list and the PMU's NMI be done with it */
+	synchronize_kernel();
+	perf_counter_free(counter);
+	return 0;
+}
+
+static ssize_t perf_read(struct file *file, char __user *buf,
+			 size_t count, loff_t *ppos)
+{
+	struct perf_counter *counter = file->private_data;
+	u32 format = counter->hw_event.read_format;
+	struct perf_read_values values;
+	u64 out[3];
+	int n = 1;
+
+	if (format & PERF_FORMAT_TIME_ENABLED)
+		n++;
+	if (format & PERF_FORMAT_TIME_RUNNING)
+		n++;
+	if (count < n * sizeof(u64))
+		return -ENOSPC;
+
+	perf_ctx_call(counter, __perf_counter_read, &values);
+	n = 0;
+	out[n++] = values.count;
+	if (format & PERF_FORMAT_TIME_ENABLED)
+		out[n++] = values.time_enabled;
+	if (format & PERF_FORMAT_TIME_RUNNING)
+		out[n++] = values.time_running;
+
+	if (copy_to_user(buf, out, n * sizeof(u64)))
+		return -EFAULT;
+	return n * sizeof(u64);
+}
+
+static unsigned int perf_poll(struct file *file, poll_table *wait)
+{
+	struct perf_counter *counter = file->private_data;
+	struct perf_mmap_data *data = counter->data;
+	unsigned int mask = 0;
+
+	poll_wait(file, &counter->waitq, wait);
+	if (data && data->head != (unsigned long)data->user_page->data_tail)
+		mask |= POLLIN | POLLRDNORM;
+	return mask;
+}
+
+static long perf_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct perf_counter *counter = file->private_data;
+
+	switch (cmd) {
+	case PERF_COUNTER_IOC_ENABLE:
+		perf_ctx_call(counter, __perf_counter_enable, NULL);
+		break;
+	case PERF_COUNTER_IOC_DISABLE:
+		perf_ctx_call(counter, __perf_counter_disable, NULL);
+		break;
+	case PERF_COUNTER_IOC_RESET:
+		perf_ctx_call(counter, __perf_counter_reset, NULL);
+		break;
+	default:
+		return -ENOTTY;
+	}
+	return 0;
+}
+
+static struct page *perf_mmap_nopage(struct vm_area_struct *vma,
+				     unsigned long address, int *type)
+{
+	struct perf_counter *counter = vma->vm_file->private_data;
+	struct perf_mmap_data *data = counter->data;
+	unsigned long index;
+	struct page *page;
+
+	index = ((address - vma->vm_start) >> PAGE_SHIFT) + vma->vm_pgoff;
+	if (!data || index > data->nr_pages)
+		return NOPAGE_SIGBUS;
+	if (index)
+		page = virt_to_page(data->data_pages[index - 1]);
+	else
+		page = virt_to_page(data->user_page);
+	get_page(page);
+	if (type)
+		*type = VM_FAULT_MINOR;
+	return page;
+}
+
+static struct vm_operations_struct perf_mmap_vm_ops = {
+	.nopage		= perf_mmap_nopage,
+};
+
+/*
+ * The control page and the data pages, all at once.  The buffer stays
+ * until the counter is freed, which cannot happen while it is mapped.
+ */
+static int perf_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct perf_counter *counter = file->private_data;
+	struct perf_mmap_data *data;
+	unsigned long nr_pages;
+	int ret = 0;
+
+	if (!(vma->vm_flags & VM_SHARED) || vma->vm_pgoff)
+		return -EINVAL;
+	nr_pages = ((vma->vm_end - vma->vm_start) >> PAGE_SHIFT) - 1;
+	if (!nr_pages || (nr_pages & (nr_pages - 1)))
+		return -EINVAL;
+	if (nr_pages > PERF_MMAP_MAX_PAGES && !capable(CAP_IPC_LOCK))
+		return -EPERM;
+
+	mutex_lock(&counter->mmap_mutex);
+	if (counter->data) {
+		if (counter->data->nr_pages != nr_pages)
+			ret = -EINVAL;
+	} else {
+		data = perf_mmap_data_alloc(nr_pages);
+		if (data)
+			rcu_assign_pointer(counter->data, data);
+		else
+			ret = -ENOMEM;
+	}
+	mutex_unlock(&counter->mmap_mutex);
+	if (ret)
+		return ret;
+
+	vma->vm_flags |= VM_RESERVED;
+	vma->vm_ops = &perf_mmap_vm_ops;
+	return 0;
+}
+
+static struct file_operations perf_fops = {
+	.release	= perf_release,
+	.read		= perf_read,
+	.poll		= perf_poll,
+	.unlocked_ioctl	= perf_ioctl,
+	.mmap		= perf_mmap,
+};
+
+/**
+ * sys_perf_counter_open - create a performance counter
+ * @hw_event_uptr: what to count, and how
+ * @pid: the task to count, 0 for current, or -1 to count a cpu
+ * @cpu: the cpu to count if @pid is -1, otherwise -1
+ * @flags: must be 0
+ *
+ * Returns the counter's file descriptor.  Counting another task takes
+ * the right to ptrace it, counting a cpu takes CAP_SYS_ADMIN.  A task's
+ * counter only follows that one thread; it is not inherited by the
+ * task's children.
+ */
+asmlinkage long
+sys_perf_counter_open(struct perf_counter_hw_event __user *hw_event_uptr,
+		      pid_t pid, int cpu, unsigned long flags)
+{
+	struct perf_counter_hw_event hw_event;
+	struct perf_counter_context *ctx;
+	struct perf_counter *counter;
+	struct file *file;
+	int fd, ret;
+
+	if (flags)
+		return -EINVAL;
+	if (copy_from_user(&hw_event, hw_event_uptr, sizeof(hw_event)))
+		return -EFAULT;
+	if ((s64)hw_event.irq_period < 0)
+		return -EINVAL;
+
+	ctx = find_get_context(pid, cpu);
+	if (IS_ERR(ctx))
+		return PTR_ERR(ctx);
+
+	counter = perf_counter_alloc(&hw_event, ctx);
+	if (IS_ERR(counter)) {
+		put_context(ctx);
+		return PTR_ERR(counter);
+	}
+
+	ret = fd = get_unused_fd();
+	if (fd < 0)
+		goto err_free;
+	file = get_empty_filp();
+	ret = -ENFILE;
+	if (!file)
+		goto err_put_fd;
+
+	file->f_op = &perf_fops;
+	file->f_vfsmnt = mntget(perf_mnt);
+	file->f_dentry = dget(perf_mnt->mnt_root);
+	file->f_mapping = file->f_dentry->d_inode->i_mapping;
+	file->f_mode = FMODE_READ | FMODE_WRITE;
+	file->f_flags = O_RDWR;
+	file->private_data = counter;
+
+	perf_ctx_call(counter, __perf_counter_install, NULL);
+	if (ctx->task == current)
+		perf_counter_activate_current(ctx);
+
+	fd_install(fd, file);
+	return fd;
+
+err_put_fd:
+	put_unused_fd(fd);
+err_free:
+	perf_counter_free(counter);
+	return ret;
+}
+
+static struct super_block *
+perfcounterfs_get_sb(struct file_system_type *fs_type,
+		     int flags, const char *dev_name, void *data)
+{
+	return get_sb_pseudo(fs_type, "perf_counter:", NULL, 0x50455246);
+}
+
+static struct file_system_type perf_fs_type = {
+	.name		= "perfcounterfs",
+	.get_sb		= perfcounterfs_get_sb,
+	.kill_sb	= kill_anon_super,
+};
+
+static int __init perf_counter_init(void)
+{
+	struct perf_cpu_context *cpuctx;
+	int cpu;
+
+	for_each_cpu(cpu) {
+		cpuctx = &per_cpu(perf_cpu_context, cpu);
+		perf_counter_context_init(&cpuctx->ctx, NULL);
+		cpuctx->ctx.is_active = 1;
+		cpuctx->ctx.cpu = cpu;
+	}
+
+	register_filesystem(&perf_fs_type);
+	perf_mnt = kern_mount(&perf_fs_type);
+	return 0;
+}
+
+__initcall(perf_counter_init);
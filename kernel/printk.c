@@ -14,6 +14,8 @@
  *     manfreds@colorfullife.com
  * Rewrote bits to get rid of console_lock
  *	01Mar01 Andrew Morton <andrewm@uow.edu.au>
+ * Per-cpu log buffers written without logbuf_lock, console output from
+ * the printk thread, and the records of /dev/kmsg.
  */
 
 #include <linux/kernel.h>
@@ -31,8 +33,15 @@
 #include <linux/security.h>
 #include <linux/bootmem.h>
 #include <linux/syscalls.h>
+#include <linux/sched.h>
+#include <linux/percpu.h>
+#include <linux/slab.h>
+#include <linux/kthread.h>
+#include <linux/kallsyms.h>
+#include <linux/poll.h>
 
 #include <asm/uaccess.h>
+#include <asm/div64.h>
 
 #define __LOG_BUF_LEN	(1 << CONFIG_LOG_BUF_SHIFT)
 
@@ -96,6 +105,79 @@ static unsigned long con_start;	/* Index into log_buf: next char to be sent to c
 static unsigned long log_end;	/* Index into log_buf: most-recently-written-char + 1 */
 static unsigned long logged_chars; /* Number of chars produced since last read+clear operation */
 
+/* Whether the next char of log_buf starts a line, which needs a <N> tag */
+static int log_level_unknown = 1;
+
+/*
+ * Besides its text in log_buf, every message is kept as a record in a
+ * buffer of its own: a struct log_rec followed by the text, which is
+ * what /dev/kmsg reads.  Records are numbered in the order they arrive;
+ * when the buffer is full the oldest ones are overwritten.
+ */
+struct log_rec {
+	u16	size;		/* Of the record, header and padding included */
+	u8	flags;		/* LOG_* */
+	u8	level;		/* Of the <N> the text starts with, or default */
+	u16	text_len;
+	u16	cpu;
+	u64	ts_nsec;	/* sched_clock() when printk() was called */
+	unsigned long	seq;	/* Set when it reaches the record log */
+	unsigned long	caller;	/* Where printk() was called from */
+};
+
+#define LOG_COMMITTED	0x01	/* Completely written */
+#define LOG_PAD		0x02	/* Covers the end of the buffer, skip it */
+#define LOG_CONT	0x04	/* Continues the line of the previous message */
+#define LOG_NEWLINE	0x08	/* The text ends with a newline */
+
+#define LOG_ALIGN	8
+#define LOG_REC_SIZE(len) \
+	((sizeof(struct log_rec) + (len) + LOG_ALIGN - 1) & ~(LOG_ALIGN - 1))
+
+/* The longest text a printk() leaves */
+#define LOG_LINE_MAX	1024
+
+static char __log_rec_buf[__LOG_BUF_LEN] __attribute__((aligned(LOG_ALIGN)));
+
+/* Under logbuf_lock, the positions in __log_rec_buf are not masked */
+static unsigned long log_rec_first;	/* Of the oldest record */
+static unsigned long log_rec_next;	/* Where the next one goes */
+static unsigned long log_first_seq;	/* Number of the oldest record */
+static unsigned long log_next_seq;	/* Number of the next one */
+
+/*
+ * Once the system is up, printk() does not take logbuf_lock: it writes
+ * a record into a buffer of its cpu, and the printk thread moves the
+ * records of all cpus over to log_buf and the record log, and from
+ * there to the consoles.
+ *
+ * head is where the next record is reserved, with cmpxchg so that
+ * interrupts and NMIs nesting into a printk() of the same cpu reserve
+ * theirs behind it.  tail is only moved by the reader, under
+ * logbuf_lock, once it has cleared what it read.  The reader stops at
+ * a record without LOG_COMMITTED.  A printk() that finds no room is
+ * dropped and counted.
+ */
+struct printk_cpu {
+	char		*buf;
+	unsigned long	head;
+	unsigned long	tail;
+	atomic_t	dropped;
+	int		cont;		/* The last message ended mid-line */
+};
+
+#define LOG_CPU_BUF_LEN	(1 << CONFIG_LOG_CPU_BUF_SHIFT)
+
+static DEFINE_PER_CPU(struct printk_cpu, printk_cpu);
+
+/* Set once the per-cpu buffers and the printk thread are there */
+static int printk_async;
+static int printk_sync __initdata;
+
+/* Records are waiting for the printk thread */
+static int printk_pending;
+static DECLARE_WAIT_QUEUE_HEAD(printk_wait);
+
 /*
  *	Array of consoles built from command line options (console=)
  */
@@ -231,6 +313,15 @@ out:
 
 __setup("log_buf_len=", log_buf_len_setup);
 
+/* Keep printing to the consoles from printk() itself */
+static int __init printk_sync_setup(char *str)
+{
+	printk_sync = 1;
+	return 1;
+}
+
+__setup("printk_sync", printk_sync_setup);
+
 /*
  * Commands to do_syslog:
  *
@@ -478,6 +569,265 @@ static void emit_log_char(char c)
 		logged_chars++;
 }
 
+/*
+ * Copy the text of a message into log_buf.  If the caller didn't provide
+ * appropriate log level tags, we insert them here
+ */
+static void emit_log_text(const char *text, int len)
+{
+	const char *p;
+
+	for (p = text; p < text + len; p++) {
+		if (log_level_unknown) {
+			if (p + 2 >= text + len || p[0] != '<' ||
+			    p[1] < '0' || p[1] > '7' || p[2] != '>') {
+				emit_log_char('<');
+				emit_log_char(default_message_loglevel + '0');
+				emit_log_char('>');
+			}
+			log_level_unknown = 0;
+		}
+		emit_log_char(*p);
+		if (*p == '\n')
+			log_level_unknown = 1;
+	}
+}
+
+/*
+ * The record at *pos of a buffer of len bytes, or NULL if it is not
+ * committed yet.  Records do not wrap: the end of the buffer is skipped
+ * if it is too short for a header, or else covered by a LOG_PAD record.
+ * *pos is moved past what was skipped.
+ */
+static struct log_rec *log_rec_at(char *buf, unsigned long len,
+				  unsigned long *pos)
+{
+	struct log_rec *r;
+	unsigned long room;
+
+	for (;;) {
+		room = len - (*pos & (len - 1));
+		if (room < sizeof(struct log_rec)) {
+			*pos += room;
+			continue;
+		}
+		r = (struct log_rec *)(buf + (*pos & (len - 1)));
+		if (!(r->flags & LOG_COMMITTED))
+			return NULL;
+		smp_rmb();
+		if (!(r->flags & LOG_PAD))
+			return r;
+		*pos += r->size;
+	}
+}
+
+/* Fill in a record of text but for size, ts_nsec and flags; return these */
+static int log_rec_fill(struct log_rec *r, const char *text, int len,
+			int cont, unsigned long caller)
+{
+	int flags = cont ? LOG_CONT : 0;
+
+	r->level = default_message_loglevel;
+	if (len >= 3 && text[0] == '<' && text[1] >= '0' && text[1] <= '7' &&
+	    text[2] == '>')
+		r->level = text[1] - '0';
+	if (len && text[len - 1] == '\n')
+		flags |= LOG_NEWLINE;
+	r->text_len = len;
+	r->cpu = smp_processor_id();
+	r->caller = caller;
+	return flags;
+}
+
+/*
+ * Append a message to log_buf and to the record log, overwriting the
+ * oldest records if there is no room.  Called with logbuf_lock held.
+ */
+static void log_store(const struct log_rec *r, const char *text)
+{
+	unsigned long size = LOG_REC_SIZE(r->text_len);
+	unsigned long room, pos = log_rec_next, first;
+	struct log_rec *dst;
+
+	emit_log_text(text, r->text_len);
+
+	room = __LOG_BUF_LEN - (pos & (__LOG_BUF_LEN - 1));
+	if (room < size)
+		pos += room;
+	while (log_first_seq != log_next_seq &&
+	       pos + size - log_rec_first > __LOG_BUF_LEN) {
+		first = log_rec_first;
+		dst = log_rec_at(__log_rec_buf, __LOG_BUF_LEN, &first);
+		log_rec_first = first + dst->size;
+		log_first_seq++;
+	}
+	if (log_first_seq == log_next_seq)
+		log_rec_first = pos;
+
+	if (pos != log_rec_next && room >= sizeof(struct log_rec)) {
+		dst = (struct log_rec *)(__log_rec_buf +
+					 (log_rec_next & (__LOG_BUF_LEN - 1)));
+		dst->size = room;
+		dst->flags = LOG_PAD | LOG_COMMITTED;
+	}
+	dst = (struct log_rec *)(__log_rec_buf + (pos & (__LOG_BUF_LEN - 1)));
+	*dst = *r;
+	dst->size = size;
+	dst->flags |= LOG_COMMITTED;
+	dst->seq = log_next_seq++;
+	memcpy(dst + 1, text, r->text_len);
+	log_rec_next = pos + size;
+}
+
+static inline int printk_cmpxchg(unsigned long *p, unsigned long old,
+				 unsigned long new)
+{
+#ifdef __HAVE_ARCH_CMPXCHG
+	return cmpxchg(p, old, new) == old;
+#else
+	/* A 386 has no cmpxchg, and no NMI watchdog to printk() either */
+	unsigned long flags;
+	int ret = 0;
+
+	local_irq_save(flags);
+	if (*p == old) {
+		*p = new;
+		ret = 1;
+	}
+	local_irq_restore(flags);
+	return ret;
+#endif
+}
+
+/*
+ * Format a message straight into a record of this cpu's buffer.  The
+ * longest possible record is reserved; what the text leaves of it is
+ * given back if nobody nested in meanwhile, else it stays padding.
+ * Called with preemption off.
+ */
+static int log_cpu_store(unsigned long caller, const char *fmt, va_list args)
+{
+	struct printk_cpu *pc = &__get_cpu_var(printk_cpu);
+	unsigned long head, end, start, size, pad;
+	unsigned long long ts = sched_clock();
+	struct log_rec *r;
+	char *text;
+	int len, flags;
+
+	do {
+		head = pc->head;
+		smp_mb();
+		pad = LOG_CPU_BUF_LEN - (head & (LOG_CPU_BUF_LEN - 1));
+		if (pad >= LOG_REC_SIZE(LOG_LINE_MAX))
+			pad = 0;
+		end = head + pad + LOG_REC_SIZE(LOG_LINE_MAX);
+		if (end - pc->tail > LOG_CPU_BUF_LEN) {
+			atomic_inc(&pc->dropped);
+			return 0;
+		}
+	} while (!printk_cmpxchg(&pc->head, head, end));
+
+	if (pad >= sizeof(struct log_rec)) {
+		r = (struct log_rec *)(pc->buf + (head & (LOG_CPU_BUF_LEN - 1)));
+		r->size = pad;
+		smp_wmb();
+		r->flags = LOG_PAD | LOG_COMMITTED;
+	}
+
+	start = head + pad;
+	r = (struct log_rec *)(pc->buf + (start & (LOG_CPU_BUF_LEN - 1)));
+	text = (char *)(r + 1);
+	len = vscnprintf(text, LOG_LINE_MAX, fmt, args);
+
+	size = LOG_REC_SIZE(len);
+	if (!printk_cmpxchg(&pc->head, end, start + size))
+		size = end - start;
+
+	flags = log_rec_fill(r, text, len, pc->cont, caller);
+	pc->cont = !(flags & LOG_NEWLINE);
+	r->size = size;
+	r->ts_nsec = ts;
+	smp_wmb();
+	r->flags = flags | LOG_COMMITTED;
+	return len;
+}
+
+/* Report the messages a cpu had to drop.  Called with logbuf_lock held. */
+static void log_cpu_dropped(int cpu)
+{
+	struct printk_cpu *pc = &per_cpu(printk_cpu, cpu);
+	struct log_rec r;
+	char text[64];
+	int n = atomic_read(&pc->dropped);
+	int len;
+
+	if (!n)
+		return;
+	atomic_sub(n, &pc->dropped);
+	len = scnprintf(text, sizeof(text),
+			KERN_WARNING "printk: %d messages dropped on cpu %d\n",
+			n, cpu);
+	r.flags = log_rec_fill(&r, text, len, !log_level_unknown, 0);
+	r.cpu = cpu;
+	r.ts_nsec = sched_clock();
+	log_store(&r, text);
+}
+
+/*
+ * Move the committed records of the per-cpu buffers over to log_buf and
+ * the record log, the oldest of all cpus first.  Returns the number
+ * moved.  Called with logbuf_lock held.
+ */
+static int log_drain(void)
+{
+	struct printk_cpu *pc;
+	struct log_rec *r, *next;
+	unsigned long pos, next_pos = 0;
+	int cpu, next_cpu = 0, n = 0;
+
+	if (!printk_async)
+		return 0;
+
+	for_each_cpu(cpu)
+		log_cpu_dropped(cpu);
+
+	for (;;) {
+		next = NULL;
+		for_each_cpu(cpu) {
+			pc = &per_cpu(printk_cpu, cpu);
+			if (pc->tail == pc->head)
+				continue;
+			pos = pc->tail;
+			r = log_rec_at(pc->buf, LOG_CPU_BUF_LEN, &pos);
+			if (r && (!next || (s64)(r->ts_nsec - next->ts_nsec) < 0)) {
+				next = r;
+				next_pos = pos;
+				next_cpu = cpu;
+			}
+		}
+		if (!next)
+			break;
+
+		log_store(next, (char *)(next + 1));
+
+		/* Clear it before the writer gets it back */
+		pc = &per_cpu(printk_cpu, next_cpu);
+		next_pos += next->size;
+		for (pos = pc->tail; pos != next_pos; ) {
+			unsigned long off = pos & (LOG_CPU_BUF_LEN - 1);
+			unsigned long len = min(LOG_CPU_BUF_LEN - off,
+						next_pos - pos);
+
+			memset(pc->buf + off, 0, len);
+			pos += len;
+		}
+		smp_mb();
+		pc->tail = next_pos;
+		n++;
+	}
+	return n;
+}
+
 /*
  * Zap console related locks when oopsing. Only zap at most once
  * every 10 seconds, to leave time for slow consoles to print a
@@ -511,53 +861,71 @@ static void zap_locks(void)
  * One effect of this deferred printing is that code which calls printk() and
  * then changes console_loglevel may break. This is because console_loglevel
  * is inspected when the actual printing occurs.
+ *
+ * Once the system runs, all of this is left to the printk thread: printk()
+ * only puts the message into the buffer of its cpu and wakes the thread.
+ * When oopsing, during boot and shutdown, or with "printk_sync" on the
+ * command line, printk() goes to the consoles itself as described above.
  */
+static int __vprintk(unsigned long caller, const char *fmt, va_list args);
+
 asmlinkage int printk(const char *fmt, ...)
 {
 	va_list args;
 	int r;
 
 	va_start(args, fmt);
-	r = vprintk(fmt, args);
+	r = __vprintk((unsigned long)__builtin_return_address(0), fmt, args);
 	va_end(args);
 
 	return r;
 }
 
 asmlinkage int vprintk(const char *fmt, va_list args)
+{
+	return __vprintk((unsigned long)__builtin_return_address(0), fmt, args);
+}
+
+static int __vprintk(unsigned long caller, const char *fmt, va_list args)
 {
 	unsigned long flags;
 	int printed_len;
-	char *p;
-	static char printk_buf[1024];
-	static int log_level_unknown = 1;
+	static char printk_buf[LOG_LINE_MAX];
+	static struct log_rec printk_rec;
 
 	if (unlikely(oops_in_progress))
 		zap_locks();
 
+	if (printk_async && !oops_in_progress &&
+	    system_state == SYSTEM_RUNNING) {
+		preempt_disable();
+		printed_len = log_cpu_store(caller, fmt, args);
+		preempt_enable();
+		smp_wmb();
+		if (!printk_pending)
+			printk_pending = 1;
+		/*
+		 * With interrupts off we may be holding a runqueue lock,
+		 * printk_tick() does the wakeup then.
+		 */
+		if (!irqs_disabled() && waitqueue_active(&printk_wait))
+			wake_up_interruptible(&printk_wait);
+		return printed_len;
+	}
+
 	/* This stops the holder of console_sem just where we want him */
 	spin_lock_irqsave(&logbuf_lock, flags);
 
+	/* What is still in the per-cpu buffers was printed before */
+	log_drain();
+
 	/* Emit the output into the temporary buffer */
 	printed_len = vscnprintf(printk_buf, sizeof(printk_buf), fmt, args);
 
-	/*
-	 * Copy the output into log_buf.  If the caller didn't provide
-	 * appropriate log level tags, we insert them here
-	 */
-	for (p = printk_buf; *p; p++) {
-		if (log_level_unknown) {
-			if (p[0] != '<' || p[1] < '0' || p[1] > '7' || p[2] != '>') {
-				emit_log_char('<');
-				emit_log_char(default_message_loglevel + '0');
-				emit_log_char('>');
-			}
-			log_level_unknown = 0;
-		}
-		emit_log_char(*p);
-		if (*p == '\n')
-			log_level_unknown = 1;
-	}
+	printk_rec.flags = log_rec_fill(&printk_rec, printk_buf, printed_len,
+					!log_level_unknown, caller);
+	printk_rec.ts_nsec = sched_clock();
+	log_store(&printk_rec, printk_buf);
 
 	if (!cpu_online(smp_processor_id()) &&
 	    system_state != SYSTEM_RUNNING) {
@@ -649,6 +1017,7 @@ void release_console_sem(void)
 
 	for ( ; ; ) {
 		spin_lock_irqsave(&logbuf_lock, flags);
+		wake_klogd |= log_drain();
 		wake_klogd |= log_start - log_end;
 		if (con_start == log_end)
 			break;			/* Nothing to print */
@@ -668,6 +1037,58 @@ void release_console_sem(void)
 }
 EXPORT_SYMBOL(release_console_sem);
 
+/*
+ * The printk thread sends what printk() left in the per-cpu buffers on
+ * to the consoles.  It may sleep in the console drivers, and nobody
+ * waits for it.
+ */
+static int printk_thread(void *unused)
+{
+	current->flags |= PF_NOFREEZE;
+	for (;;) {
+		wait_event_interruptible(printk_wait, printk_pending);
+		printk_pending = 0;
+		smp_mb();
+		acquire_console_sem();
+		release_console_sem();
+	}
+	return 0;
+}
+
+/*
+ * Called by every timer tick: wake the printk thread for what was
+ * printed with interrupts off.
+ */
+void printk_tick(void)
+{
+	if (printk_pending && waitqueue_active(&printk_wait))
+		wake_up_interruptible(&printk_wait);
+}
+
+static int __init printk_init(void)
+{
+	struct task_struct *p;
+	int cpu;
+
+	if (printk_sync)
+		return 0;
+	for_each_cpu(cpu) {
+		char *buf = kmalloc(LOG_CPU_BUF_LEN, GFP_KERNEL);
+
+		if (!buf)
+			return -ENOMEM;
+		memset(buf, 0, LOG_CPU_BUF_LEN);
+		per_cpu(printk_cpu, cpu).buf = buf;
+	}
+	p = kthread_run(printk_thread, NULL, "printk");
+	if (IS_ERR(p))
+		return PTR_ERR(p);
+	printk_async = 1;
+	return 0;
+}
+
+__initcall(printk_init);
+
 /** console_conditional_schedule - yield the CPU if required
  *
  * If the console code is currently allowed to sleep, and
@@ -924,3 +1345,229 @@ int printk_ratelimit(void)
 				printk_ratelimit_burst);
 }
 EXPORT_SYMBOL(printk_ratelimit);
+
+/*
+ * /dev/kmsg: writing to it printk()s, reading from it gives the records
+ * of the record log, one per read(), as
+ *
+ *	level,seq,usec,flag;text
+ *	 CALLER=symbol+offset
+ *
+ * where the level is that of the <N> tag, usec the time since boot, the
+ * flag 'c' if the message continues the line of the previous one or '-'
+ * otherwise, and the text has no tag, no trailing newline and its
+ * unprintable chars escaped as \xNN.  A reader that fell behind the
+ * oldest record gets -EPIPE once and then goes on from there.
+ * lseek(fd, 0, SEEK_SET) goes back to the oldest record, and
+ * lseek(fd, 0, SEEK_END) past the newest.
+ */
+struct devkmsg_user {
+	unsigned long		seq;
+	unsigned long		pos;
+	struct semaphore	sem;
+	char			buf[2 * LOG_LINE_MAX];
+};
+
+/* Called with logbuf_lock held */
+static int devkmsg_format(struct devkmsg_user *user, struct log_rec *r)
+{
+	char *buf = user->buf, *text = (char *)(r + 1);
+	int size = sizeof(user->buf), len, i, n = r->text_len;
+	unsigned long long usec = r->ts_nsec;
+	unsigned long symsize, offset;
+	char namebuf[KSYM_NAME_LEN + 1];
+	const char *name;
+	char *modname;
+
+	do_div(usec, 1000);
+	len = scnprintf(buf, size, "%u,%lu,%llu,%c;", r->level, r->seq, usec,
+			r->flags & LOG_CONT ? 'c' : '-');
+
+	if (n >= 3 && text[0] == '<' && text[1] >= '0' && text[1] <= '7' &&
+	    text[2] == '>') {
+		text += 3;
+		n -= 3;
+	}
+	if (r->flags & LOG_NEWLINE)
+		n--;
+	/* Leave room for the CALLER line */
+	for (i = 0; i < n && len < size - KSYM_NAME_LEN - 64; i++) {
+		unsigned char c = text[i];
+
+		if (c < ' ' || c >= 127 || c == '\\')
+			len += scnprintf(buf + len, size - len, "\\x%02x", c);
+		else
+			buf[len++] = c;
+	}
+	buf[len++] = '\n';
+
+	name = kallsyms_lookup(r->caller, &symsize, &offset, &modname,
+			       namebuf);
+	if (name)
+		len += scnprintf(buf + len, size - len, " CALLER=%s+0x%lx\n",
+				 name, offset);
+	else
+		len += scnprintf(buf + len, size - len, " CALLER=%p\n",
+				 (void *)r->caller);
+	return len;
+}
+
+static ssize_t devkmsg_read(struct file *file, char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	struct devkmsg_user *user = file->private_data;
+	struct log_rec *r;
+	unsigned long pos;
+	ssize_t ret;
+	int len;
+
+	if (down_interruptible(&user->sem))
+		return -ERESTARTSYS;
+
+	spin_lock_irq(&logbuf_lock);
+	while (user->seq == log_next_seq) {
+		spin_unlock_irq(&logbuf_lock);
+		ret = -EAGAIN;
+		if (file->f_flags & O_NONBLOCK)
+			goto out;
+		ret = wait_event_interruptible(log_wait,
+					       user->seq != log_next_seq);
+		if (ret)
+			goto out;
+		spin_lock_irq(&logbuf_lock);
+	}
+
+	if ((long)(user->seq - log_first_seq) < 0) {
+		/* Overwritten before we got to it */
+		user->seq = log_first_seq;
+		user->pos = log_rec_first;
+		spin_unlock_irq(&logbuf_lock);
+		ret = -EPIPE;
+		goto out;
+	}
+
+	pos = user->pos;
+	r = log_rec_at(__log_rec_buf, __LOG_BUF_LEN, &pos);
+	len = devkmsg_format(user, r);
+	if (len > count) {
+		spin_unlock_irq(&logbuf_lock);
+		ret = -EINVAL;
+		goto out;
+	}
+	user->pos = pos + r->size;
+	user->seq++;
+	spin_unlock_irq(&logbuf_lock);
+
+	ret = len;
+	if (copy_to_user(buf, user->buf, len))
+		ret = -EFAULT;
+out:
+	up(&user->sem);
+	return ret;
+}
+
+static ssize_t devkmsg_write(struct file *file, const char __user *buf,
+			     size_t count, loff_t *ppos)
+{
+	char *tmp;
+	int ret;
+
+	tmp = kmalloc(count + 1, GFP_KERNEL);
+	if (tmp == NULL)
+		return -ENOMEM;
+	ret = -EFAULT;
+	if (!copy_from_user(tmp, buf, count)) {
+		tmp[count] = 0;
+		ret = printk("%s", tmp);
+	}
+	kfree(tmp);
+	return ret;
+}
+
+static loff_t devkmsg_llseek(struct file *file, loff_t offset, int origin)
+{
+	struct devkmsg_user *user = file->private_data;
+	loff_t ret = 0;
+
+	if (!user || offset)
+		return -ESPIPE;
+
+	down(&user->sem);
+	spin_lock_irq(&logbuf_lock);
+	switch (origin) {
+	case 0:		/* SEEK_SET: the oldest record */
+		user->seq = log_first_seq;
+		user->pos = log_rec_first;
+		break;
+	case 2:		/* SEEK_END: after the newest */
+		user->seq = log_next_seq;
+		user->pos = log_rec_next;
+		break;
+	default:
+		ret = -EINVAL;
+	}
+	spin_unlock_irq(&logbuf_lock);
+	up(&user->sem);
+	return ret;
+}
+
+static unsigned int devkmsg_poll(struct file *file, poll_table *wait)
+{
+	struct devkmsg_user *user = file->private_data;
+	unsigned int ret = 0;
+
+	if (!user)
+		return POLLERR | POLLNVAL;
+
+	poll_wait(file, &log_wait, wait);
+	spin_lock_irq(&logbuf_lock);
+	if (user->seq != log_next_seq) {
+		ret = POLLIN | POLLRDNORM;
+		if ((long)(user->seq - log_first_seq) < 0)
+			ret |= POLLERR | POLLPRI;
+	}
+	spin_unlock_irq(&logbuf_lock);
+	return ret;
+}
+
+static int devkmsg_open(struct inode *inode, struct file *file)
+{
+	struct devkmsg_user *user;
+	int err;
+
+	/* Writing is printk(), for everyone allowed to open the device */
+	if ((file->f_flags & O_ACCMODE) == O_WRONLY)
+		return 0;
+
+	err = security_syslog(3);
+	if (err)
+		return err;
+
+	user = kmalloc(sizeof(*user), GFP_KERNEL);
+	if (!user)
+		return -ENOMEM;
+	init_MUTEX(&user->sem);
+
+	spin_lock_irq(&logbuf_lock);
+	user->seq = log_first_seq;
+	user->pos = log_rec_first;
+	spin_unlock_irq(&logbuf_lock);
+
+	file->private_data = user;
+	return 0;
+}
+
+static int devkmsg_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+struct file_operations kmsg_fops = {
+	.open		= devkmsg_open,
+	.read		= devkmsg_read,
+	.write		= devkmsg_write,
+	.llseek		= devkmsg_llseek,
+	.poll		= devkmsg_poll,
+	.release	= devkmsg_release,
+};
@@ -23,6 +23,7 @@
 #include <linux/cpu.h>
 #include <linux/profile.h>
 #include <linux/highmem.h>
+#include <linux/perf_counter.h>
 #include <asm/sections.h>
 #include <asm/semaphore.h>
 
@@ -386,8 +387,11 @@ void profile_hit(int type, void *__pc)
  */
 void profile_tick(int type, struct pt_regs *regs)
 {
-	if (type == CPU_PROFILING && timer_hook)
-		timer_hook(regs);
+	if (type == CPU_PROFILING) {
+		if (timer_hook)
+			timer_hook(regs);
+		perf_counter_tick(regs);
+	}
 	if (!user_mode(regs) && cpu_isset(smp_processor_id(), prof_cpu_mask))
 		profile_hit(type, (void *)profile_pc(regs));
 }
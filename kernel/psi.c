@@ -0,0 +1,249 @@
+/*
+ * kernel/psi.c
+ *
+ * Pressure stall information: the share of time in which tasks could
+ * not make progress because they waited for a cpu, for memory to be
+ * reclaimed or for I/O.  Shown in /proc/pressure/{cpu,memory,io} as
+ *
+ *	some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+ *	full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+ *
+ * "some" is the time at least one task was stalled, "full" the time
+ * nothing but stalled tasks was there to run (not for cpu).  The
+ * averages are percentages over the last 10s, 60s and 300s, total is
+ * the cumulated stall time in microseconds.
+ *
+ * Like the cpu time accounting, this samples: on every timer tick each
+ * cpu looks at its runqueue and counts the tick as
+ *
+ *	cpu some	if tasks wait on the runqueue
+ *	io some		if tasks of this cpu sleep in io_schedule()
+ *	io full		... and nothing runs
+ *	memory some	if tasks of this cpu are in direct reclaim
+ *	memory full	... and nothing else runs
+ *
+ * and as non-idle if anything runs or is stalled at all.  Every
+ * PSI_PERIOD a timer sums the ticks of all cpus: the stalled share of
+ * the non-idle ticks is the pressure over the period, which is folded
+ * into the averages the way the load average is.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/percpu.h>
+#include <linux/timer.h>
+#include <linux/seqlock.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/psi.h>
+#include <asm/div64.h>
+
+#define PSI_PERIOD	(2 * HZ)
+
+/* 1/exp(2s/10s), 1/exp(2s/60s) and 1/exp(2s/300s) as fixed-point */
+#define EXP_10s		1677
+#define EXP_60s		1981
+#define EXP_300s	2034
+
+enum psi_res {
+	PSI_IO,
+	PSI_MEM,
+	PSI_CPU,
+	NR_PSI_RESOURCES,
+};
+
+/* Stall states, some and full for each resource, but cpu has no full */
+enum psi_state {
+	PSI_IO_SOME,
+	PSI_IO_FULL,
+	PSI_MEM_SOME,
+	PSI_MEM_FULL,
+	PSI_CPU_SOME,
+	NR_PSI_STATES,
+	PSI_NONIDLE = NR_PSI_STATES,
+};
+
+struct psi_cpu {
+	atomic_t	nr_memstall;
+	unsigned long	ticks[NR_PSI_STATES + 1];	/* and PSI_NONIDLE */
+};
+
+static DEFINE_PER_CPU(struct psi_cpu, psi_cpu);
+
+/* Tick sums at the last update, only used by the timer */
+static unsigned long psi_last[NR_PSI_STATES + 1];
+static unsigned long psi_last_jiffies;
+
+/* The results, under psi_seq */
+static unsigned long psi_avg[NR_PSI_STATES][3];
+static u64 psi_total[NR_PSI_STATES];
+static seqlock_t psi_seq = SEQLOCK_UNLOCKED;
+
+static struct timer_list psi_timer;
+
+void psi_tick(unsigned long nr_running, int nr_iowait)
+{
+	struct psi_cpu *pc = &__get_cpu_var(psi_cpu);
+	int nr_memstall = atomic_read(&pc->nr_memstall);
+
+	if (!nr_running && !nr_iowait && !nr_memstall)
+		return;
+
+	pc->ticks[PSI_NONIDLE]++;
+	if (nr_running > 1)
+		pc->ticks[PSI_CPU_SOME]++;
+	if (nr_iowait) {
+		pc->ticks[PSI_IO_SOME]++;
+		if (!nr_running)
+			pc->ticks[PSI_IO_FULL]++;
+	}
+	if (nr_memstall) {
+		pc->ticks[PSI_MEM_SOME]++;
+		if (!nr_running ||
+		    (nr_running == 1 && (current->flags & PF_MEMSTALL)))
+			pc->ticks[PSI_MEM_FULL]++;
+	}
+}
+
+/*
+ * The stall is charged to the cpu it began on even if the task moves,
+ * as io_schedule() does with rq->nr_iowait.
+ */
+int psi_memstall_enter(void)
+{
+	int cpu;
+
+	if (current->flags & PF_MEMSTALL)
+		return -1;
+	current->flags |= PF_MEMSTALL;
+
+	cpu = get_cpu();
+	atomic_inc(&per_cpu(psi_cpu, cpu).nr_memstall);
+	put_cpu();
+	return cpu;
+}
+
+void psi_memstall_leave(int cookie)
+{
+	if (cookie < 0)
+		return;
+	atomic_dec(&per_cpu(psi_cpu, cookie).nr_memstall);
+	current->flags &= ~PF_MEMSTALL;
+}
+
+static void psi_update(unsigned long data)
+{
+	unsigned long sum[NR_PSI_STATES + 1], delta[NR_PSI_STATES + 1];
+	unsigned long now = jiffies, nonidle, pct;
+	u64 stall;
+	int cpu, s;
+
+	memset(sum, 0, sizeof(sum));
+	for_each_cpu(cpu)
+		for (s = 0; s <= PSI_NONIDLE; s++)
+			sum[s] += per_cpu(psi_cpu, cpu).ticks[s];
+	for (s = 0; s <= PSI_NONIDLE; s++) {
+		delta[s] = sum[s] - psi_last[s];
+		psi_last[s] = sum[s];
+	}
+	nonidle = delta[PSI_NONIDLE];
+
+	write_seqlock(&psi_seq);
+	for (s = 0; s < NR_PSI_STATES; s++) {
+		pct = 0;
+		if (nonidle) {
+			pct = delta[s] * FIXED_1 / nonidle;
+			stall = (u64)delta[s] *
+				jiffies_to_usecs(now - psi_last_jiffies);
+			do_div(stall, nonidle);
+			psi_total[s] += stall;
+		}
+		CALC_LOAD(psi_avg[s][0], EXP_10s, pct);
+		CALC_LOAD(psi_avg[s][1], EXP_60s, pct);
+		CALC_LOAD(psi_avg[s][2], EXP_300s, pct);
+	}
+	write_sequnlock(&psi_seq);
+
+	psi_last_jiffies = now;
+	mod_timer(&psi_timer, now + PSI_PERIOD);
+}
+
+/* x is a fraction in fixed-point, print it as a percentage */
+#define PSI_INT(x)	(((x) * 100) >> FSHIFT)
+#define PSI_FRAC(x)	((((x) * 100) & (FIXED_1 - 1)) * 100 >> FSHIFT)
+
+static void psi_show_state(struct seq_file *m, const char *name, int s)
+{
+	static const int periods[3] = { 10, 60, 300 };
+	unsigned long avg[3];
+	unsigned long seq;
+	u64 total;
+	int i;
+
+	do {
+		seq = read_seqbegin(&psi_seq);
+		memcpy(avg, psi_avg[s], sizeof(avg));
+		total = psi_total[s];
+	} while (read_seqretry(&psi_seq, seq));
+
+	seq_printf(m, "%s", name);
+	for (i = 0; i < 3; i++)
+		seq_printf(m, " avg%d=%lu.%02lu", periods[i],
+			   PSI_INT(avg[i]), PSI_FRAC(avg[i]));
+	seq_printf(m, " total=%llu\n", (unsigned long long)total);
+}
+
+static int psi_show(struct seq_file *m, void *v)
+{
+	int res = (long)m->private;
+
+	psi_show_state(m, "some", res * 2);
+	if (res != PSI_CPU)
+		psi_show_state(m, "full", res * 2 + 1);
+	return 0;
+}
+
+static int psi_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, psi_show, PDE(inode)->data);
+}
+
+static struct file_operations psi_operations = {
+	.open		= psi_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init psi_init(void)
+{
+	static const char *names[NR_PSI_RESOURCES] = {
+		[PSI_IO]	= "io",
+		[PSI_MEM]	= "memory",
+		[PSI_CPU]	= "cpu",
+	};
+	struct proc_dir_entry *dir, *e;
+	int res;
+
+	dir = proc_mkdir("pressure", NULL);
+	if (!dir)
+		return -ENOMEM;
+	for (res = 0; res < NR_PSI_RESOURCES; res++) {
+		e = create_proc_entry(names[res], S_IRUGO, dir);
+		if (!e)
+			continue;
+		e->proc_fops = &psi_operations;
+		e->data = (void *)(long)res;
+	}
+
+	psi_last_jiffies = jiffies;
+	init_timer(&psi_timer);
+	psi_timer.function = psi_update;
+	psi_timer.expires = jiffies + PSI_PERIOD;
+	add_timer(&psi_timer);
+	return 0;
+}
+
+__initcall(psi_init);
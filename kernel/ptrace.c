@@ -117,6 +117,38 @@ int ptrace_check_attach(struct task_struct *child, int kill)
 	return ret;
 }
 
+/*
+ * May current look at what @task would show a debugger?  The checks of
+ * ptrace_attach(), without the attaching: used for the /proc files and
+ * statistics that give away as much.
+ */
+int may_ptrace_attach(struct task_struct *task)
+{
+	int retval = 0;
+
+	task_lock(task);
+
+	if (!task->mm)
+		goto out;
+	if (((current->uid != task->euid) ||
+	     (current->uid != task->suid) ||
+	     (current->uid != task->uid) ||
+	     (current->gid != task->egid) ||
+	     (current->gid != task->sgid) ||
+	     (current->gid != task->gid)) && !capable(CAP_SYS_PTRACE))
+		goto out;
+	rmb();
+	if (!task->mm->dumpable && !capable(CAP_SYS_PTRACE))
+		goto out;
+	if (security_ptrace(current, task))
+		goto out;
+
+	retval = 1;
+out:
+	task_unlock(task);
+	return retval;
+}
+
 int ptrace_attach(struct task_struct *task)
 {
 	int retval;
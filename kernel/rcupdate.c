@@ -46,6 +46,7 @@
 #include <linux/notifier.h>
 #include <linux/rcupdate.h>
 #include <linux/cpu.h>
+#include <linux/kthread.h>
 
 /* Definition for rcupdate control block. */
 struct rcu_ctrlblk rcu_ctrlblk = 
@@ -53,17 +54,59 @@ struct rcu_ctrlblk rcu_ctrlblk =
 struct rcu_ctrlblk rcu_bh_ctrlblk =
 	{ .cur = -300, .completed = -300 };
 
+/*
+ * Shape of the grace-period tree: each node has up to RCU_FANOUT cpus
+ * (leaves) or child nodes. Level 0 is the root.
+ */
+#ifdef CONFIG_RCU_FANOUT
+#define RCU_FANOUT	CONFIG_RCU_FANOUT
+#else
+#define RCU_FANOUT	BITS_PER_LONG
+#endif
+#define RCU_FANOUT_SQ	(RCU_FANOUT * RCU_FANOUT)
+#define RCU_FANOUT_CUBE	(RCU_FANOUT_SQ * RCU_FANOUT)
+
+#if NR_CPUS <= RCU_FANOUT
+#define NUM_RCU_LVLS	1
+#define NUM_RCU_LVL_1	0
+#define NUM_RCU_LVL_2	0
+#elif NR_CPUS <= RCU_FANOUT_SQ
+#define NUM_RCU_LVLS	2
+#define NUM_RCU_LVL_1	((NR_CPUS + RCU_FANOUT - 1) / RCU_FANOUT)
+#define NUM_RCU_LVL_2	0
+#elif NR_CPUS <= RCU_FANOUT_CUBE
+#define NUM_RCU_LVLS	3
+#define NUM_RCU_LVL_1	((NR_CPUS + RCU_FANOUT_SQ - 1) / RCU_FANOUT_SQ)
+#define NUM_RCU_LVL_2	((NR_CPUS + RCU_FANOUT - 1) / RCU_FANOUT)
+#else
+#error "CONFIG_RCU_FANOUT too small for NR_CPUS"
+#endif
+#define NUM_RCU_NODES	(1 + NUM_RCU_LVL_1 + NUM_RCU_LVL_2)
+
+struct rcu_node {
+	spinlock_t	lock;	/* Guards gpnum and qsmask */
+	long		gpnum;	/* Batch qsmask belongs to */
+	unsigned long	qsmask;	/* Cpus (leaf) or children still to report */
+	unsigned long	grpmask; /* Our bit in parent->qsmask */
+	int		grplo;	/* Lowest cpu below this node */
+	int		grphi;	/* Highest cpu below this node */
+	struct rcu_node	*parent;
+} ____cacheline_aligned_in_smp;
+
 /* Bookkeeping of the progress of the grace period */
 struct rcu_state {
-	spinlock_t	lock; /* Guard this struct and writes to rcu_ctrlblk */
-	cpumask_t	cpumask; /* CPUs that need to switch in order    */
-	                              /* for current batch to proceed.        */
+	spinlock_t	lock; /* Guard starting and ending of batches,    */
+	                      /* i.e. writes to rcu_ctrlblk               */
+	struct rcu_node	node[NUM_RCU_NODES]; /* Breadth-first, root first */
+	struct rcu_node	*level[NUM_RCU_LVLS];
+	int		levelcnt[NUM_RCU_LVLS];
+	int		levelspread[NUM_RCU_LVLS]; /* Fanout at each level */
 };
 
 static struct rcu_state rcu_state ____cacheline_maxaligned_in_smp =
-	  {.lock = SPIN_LOCK_UNLOCKED, .cpumask = CPU_MASK_NONE };
+	  {.lock = SPIN_LOCK_UNLOCKED };
 static struct rcu_state rcu_bh_state ____cacheline_maxaligned_in_smp =
-	  {.lock = SPIN_LOCK_UNLOCKED, .cpumask = CPU_MASK_NONE };
+	  {.lock = SPIN_LOCK_UNLOCKED };
 
 DEFINE_PER_CPU(struct rcu_data, rcu_data) = { 0L };
 DEFINE_PER_CPU(struct rcu_data, rcu_bh_data) = { 0L };
@@ -72,6 +115,86 @@ DEFINE_PER_CPU(struct rcu_data, rcu_bh_data) = { 0L };
 static DEFINE_PER_CPU(struct tasklet_struct, rcu_tasklet) = {NULL};
 static int maxbatch = 10;
 
+/*
+ * Completed callbacks are invoked by a per-cpu krcud thread, so a flood
+ * of call_rcu() does not turn into milliseconds of softirq time. Until
+ * the threads exist (and on their way down) the tasklet does it.
+ * kthread_prio > 0 runs them SCHED_FIFO at that priority.
+ */
+static DEFINE_PER_CPU(struct task_struct *, rcu_kthread);
+static int kthread_prio;
+
+#ifdef CONFIG_PREEMPT_RCU
+/*
+ * Preemptible readers. The outermost rcu_read_lock() of a task bumps
+ * counter [rcu_ctrlblk.cur & 1] of the cpu it runs on, and the matching
+ * rcu_read_unlock() drops the same counter on whatever cpu it ends up
+ * on, so only the sum over all cpus means anything. Once every cpu has
+ * passed a quiescent state for batch cur, nobody can still be bumping
+ * the counter of the previous index, and the batch completes when that
+ * sum drops to zero.
+ */
+static DEFINE_PER_CPU(long, rcu_flipctr[2]);
+
+void __rcu_read_lock(void)
+{
+	struct task_struct *t = current;
+	unsigned long flags;
+	int idx;
+
+	/*
+	 * Irqs off across the nesting count and the counter, or a reader
+	 * in an irq on this task would see a half-done lock or unlock.
+	 */
+	local_irq_save(flags);
+	if (t->rcu_read_lock_nesting++ == 0) {
+		idx = rcu_ctrlblk.cur & 0x1;
+		__get_cpu_var(rcu_flipctr)[idx]++;
+		t->rcu_flipctr_idx = idx;
+	}
+	local_irq_restore(flags);
+	barrier();
+}
+
+void __rcu_read_unlock(void)
+{
+	struct task_struct *t = current;
+	unsigned long flags;
+
+	barrier();
+	local_irq_save(flags);
+	if (--t->rcu_read_lock_nesting == 0) {
+		/* The critical section must be over before the counter drops */
+		smp_mb();
+		__get_cpu_var(rcu_flipctr)[t->rcu_flipctr_idx]--;
+	}
+	local_irq_restore(flags);
+}
+
+EXPORT_SYMBOL(__rcu_read_lock);
+EXPORT_SYMBOL(__rcu_read_unlock);
+
+/* Are there readers left that may have started before batch rcp->cur? */
+static int rcu_readers_blocking(struct rcu_ctrlblk *rcp)
+{
+	long sum = 0;
+	int cpu, idx;
+
+	if (rcp != &rcu_ctrlblk)
+		return 0;
+	idx = (rcp->cur - 1) & 0x1;
+	smp_mb();
+	for_each_cpu(cpu)
+		sum += per_cpu(rcu_flipctr, cpu)[idx];
+	return sum != 0;
+}
+#else
+static inline int rcu_readers_blocking(struct rcu_ctrlblk *rcp)
+{
+	return 0;
+}
+#endif
+
 /**
  * call_rcu - Queue an RCU callback for invocation after a grace period.
  * @head: structure to be used for queueing the RCU updates.
@@ -146,6 +269,12 @@ static void rcu_do_batch(struct rcu_data *rdp)
 {
 	struct rcu_head *next, *list;
 	int count = 0;
+	struct task_struct *t = per_cpu(rcu_kthread, rdp->cpu);
+
+	if (t) {
+		wake_up_process(t);
+		return;
+	}
 
 	list = rdp->donelist;
 	while (list) {
@@ -161,6 +290,107 @@ static void rcu_do_batch(struct rcu_data *rdp)
 		tasklet_schedule(&per_cpu(rcu_tasklet, rdp->cpu));
 }
 
+/* Take the whole donelist away from the tasklet; bottom halves disabled */
+static struct rcu_head *rcu_take_donelist(struct rcu_data *rdp)
+{
+	struct rcu_head *list = rdp->donelist;
+
+	rdp->donelist = NULL;
+	rdp->donetail = &rdp->donelist;
+	return list;
+}
+
+/*
+ * Callbacks invoked by krcud still run with bottom halves disabled, as
+ * they did from the tasklet, but the thread gives up the cpu every
+ * maxbatch of them.
+ */
+static void rcu_invoke_callbacks(struct rcu_head *list)
+{
+	struct rcu_head *next;
+	int count;
+
+	while (list) {
+		local_bh_disable();
+		for (count = 0; list && count < maxbatch; count++) {
+			next = list->next;
+			list->func(list);
+			list = next;
+		}
+		local_bh_enable();
+		cond_resched();
+	}
+}
+
+static int rcu_kthread(void *__bind_cpu)
+{
+	long cpu = (long)__bind_cpu;
+	struct rcu_data *rdp = &per_cpu(rcu_data, cpu);
+	struct rcu_data *bh_rdp = &per_cpu(rcu_bh_data, cpu);
+	struct rcu_head *list, *bh_list;
+
+	if (kthread_prio > 0 && kthread_prio < MAX_USER_RT_PRIO) {
+		struct sched_param param = { .sched_priority = kthread_prio };
+
+		sched_setscheduler(current, SCHED_FIFO, &param);
+	}
+	current->flags |= PF_NOFREEZE;
+
+	set_current_state(TASK_INTERRUPTIBLE);
+	while (!kthread_should_stop()) {
+		if (!rdp->donelist && !bh_rdp->donelist)
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		/*
+		 * Preempt disable stops the cpu going offline; once it
+		 * is, rcu_offline_cpu() owns the lists.
+		 */
+		preempt_disable();
+		if (cpu_is_offline(cpu)) {
+			preempt_enable();
+			goto wait_to_die;
+		}
+		local_bh_disable();
+		list = rcu_take_donelist(rdp);
+		bh_list = rcu_take_donelist(bh_rdp);
+		local_bh_enable();
+		preempt_enable();
+
+		rcu_invoke_callbacks(list);
+		rcu_invoke_callbacks(bh_list);
+		set_current_state(TASK_INTERRUPTIBLE);
+	}
+	__set_current_state(TASK_RUNNING);
+	return 0;
+
+wait_to_die:
+	set_current_state(TASK_INTERRUPTIBLE);
+	while (!kthread_should_stop()) {
+		schedule();
+		set_current_state(TASK_INTERRUPTIBLE);
+	}
+	__set_current_state(TASK_RUNNING);
+	return 0;
+}
+
+static int rcu_spawn_kthread(long cpu)
+{
+	struct task_struct *p;
+
+	p = kthread_create(rcu_kthread, (void *)cpu, "krcud/%ld", cpu);
+	if (IS_ERR(p)) {
+		printk(KERN_ERR "krcud for %ld failed\n", cpu);
+		return PTR_ERR(p);
+	}
+	kthread_bind(p, cpu);
+	per_cpu(rcu_kthread, cpu) = p;
+	return 0;
+}
+
+/* Set once the boot cpus got their threads; hotplug takes over then */
+static int rcu_kthreads_spawned;
+
 /*
  * Grace period handling:
  * The grace period handling consists out of two steps:
@@ -168,17 +398,258 @@ static void rcu_do_batch(struct rcu_data *rdp)
  *   This is done by rcu_start_batch. The start is not broadcasted to
  *   all cpus, they must pick this up by comparing rcp->cur with
  *   rdp->quiescbatch. All cpus are recorded  in the
- *   rcu_state.cpumask bitmap.
+ *   rcu_state.node tree: a bit per cpu in the leaves, a bit per child
+ *   in the nodes above.
  * - All cpus must go through a quiescent state.
  *   Since the start of the grace period is not broadcasted, at least two
  *   calls to rcu_check_quiescent_state are required:
  *   The first call just notices that a new grace period is running. The
  *   following calls check if there was a quiescent state since the beginning
- *   of the grace period. If so, it updates rcu_state.cpumask. If
- *   the bitmap is empty, then the grace period is completed.
- *   rcu_check_quiescent_state calls rcu_start_batch(0) to start the next grace
- *   period (if necessary).
+ *   of the grace period. If so, it clears its bit in its leaf. The last cpu
+ *   of a leaf clears the leaf's bit in the parent, and so on: only one cpu
+ *   per node ever takes the lock one level up. Whoever empties the root
+ *   completes the grace period under rcu_state.lock, and
+ *   rcu_start_batch(0) starts the next one (if necessary).
+ */
+
+static void __init rcu_init_tree(struct rcu_ctrlblk *rcp,
+					struct rcu_state *rsp)
+{
+	struct rcu_node *rnp;
+	int i, j, cprv, ccur, cpustride;
+
+	rsp->levelcnt[0] = 1;
+#if NUM_RCU_LVLS > 1
+	rsp->levelcnt[1] = NUM_RCU_LVL_1;
+#endif
+#if NUM_RCU_LVLS > 2
+	rsp->levelcnt[2] = NUM_RCU_LVL_2;
+#endif
+	rsp->level[0] = &rsp->node[0];
+	for (i = 1; i < NUM_RCU_LVLS; i++)
+		rsp->level[i] = rsp->level[i - 1] + rsp->levelcnt[i - 1];
+
+	/* Spread the cpus (children) evenly over each level */
+	cprv = NR_CPUS;
+	for (i = NUM_RCU_LVLS - 1; i >= 0; i--) {
+		ccur = rsp->levelcnt[i];
+		rsp->levelspread[i] = (cprv + ccur - 1) / ccur;
+		cprv = ccur;
+	}
+
+	cpustride = 1;
+	for (i = NUM_RCU_LVLS - 1; i >= 0; i--) {
+		cpustride *= rsp->levelspread[i];
+		rnp = rsp->level[i];
+		for (j = 0; j < rsp->levelcnt[i]; j++, rnp++) {
+			spin_lock_init(&rnp->lock);
+			rnp->gpnum = rcp->completed;
+			rnp->qsmask = 0;
+			rnp->grplo = j * cpustride;
+			rnp->grphi = (j + 1) * cpustride - 1;
+			if (rnp->grphi >= NR_CPUS)
+				rnp->grphi = NR_CPUS - 1;
+			if (i == 0) {
+				rnp->grpmask = 0;
+				rnp->parent = NULL;
+			} else {
+				rnp->grpmask = 1UL << (j % rsp->levelspread[i - 1]);
+				rnp->parent = rsp->level[i - 1] +
+						j / rsp->levelspread[i - 1];
+			}
+		}
+	}
+}
+
+static inline struct rcu_node *rcu_cpu_node(struct rcu_state *rsp, int cpu)
+{
+	return rsp->level[NUM_RCU_LVLS - 1] +
+			cpu / rsp->levelspread[NUM_RCU_LVLS - 1];
+}
+
+/*
+ * Arm the tree for batch gpnum: every cpu in mask has to report.
+ * Nobody can report for gpnum before rcp->cur reaches it, and reports
+ * for older batches are ignored by the gpnum check, so the order in
+ * which the nodes are filled does not matter.
+ * Caller must hold rsp->lock.
  */
+static void rcu_init_gp(struct rcu_state *rsp, long gpnum, cpumask_t *mask)
+{
+	struct rcu_node *rnp;
+	struct rcu_node *leaves = rsp->level[NUM_RCU_LVLS - 1];
+	unsigned long qsmask;
+	int cpu;
+
+	for (rnp = rsp->node; rnp < rsp->node + NUM_RCU_NODES; rnp++) {
+		qsmask = 0;
+		if (rnp >= leaves)
+			for (cpu = rnp->grplo; cpu <= rnp->grphi; cpu++)
+				if (cpu_isset(cpu, *mask))
+					qsmask |= 1UL << (cpu - rnp->grplo);
+		spin_lock(&rnp->lock);
+		rnp->gpnum = gpnum;
+		rnp->qsmask = qsmask;
+		spin_unlock(&rnp->lock);
+	}
+	/* Deepest level first, so a child is complete before its parent */
+	for (rnp = rsp->node + NUM_RCU_NODES - 1; rnp->parent; rnp--) {
+		if (!rnp->qsmask)
+			continue;
+		spin_lock(&rnp->parent->lock);
+		rnp->parent->qsmask |= rnp->grpmask;
+		spin_unlock(&rnp->parent->lock);
+	}
+}
+
+/* Has cpu yet to report for the current grace period? Only a hint. */
+static inline int rcu_cpu_pending(struct rcu_state *rsp, int cpu)
+{
+	struct rcu_node *rnp = rcu_cpu_node(rsp, cpu);
+
+	return (rnp->qsmask & (1UL << (cpu - rnp->grplo))) != 0;
+}
+
+#ifdef CONFIG_NO_HZ_FULL
+/*
+ * Callbacks handed over by nohz_full cpus before they stop their tick.
+ * The next housekeeping cpu to take a tick adopts them onto its own
+ * nxtlist, where they wait for a later grace period than they would
+ * have at home, which is always safe.
+ */
+struct rcu_offload {
+	struct rcu_head *list;
+	struct rcu_head **tail;
+};
+
+static DEFINE_SPINLOCK(rcu_offload_lock);
+static struct rcu_offload rcu_offload = { NULL, &rcu_offload.list };
+static struct rcu_offload rcu_bh_offload = { NULL, &rcu_bh_offload.list };
+int rcu_offload_queued;
+
+static void rcu_offload_list(struct rcu_offload *ofl, struct rcu_head *list,
+				struct rcu_head **tail)
+{
+	if (list) {
+		*ofl->tail = list;
+		ofl->tail = tail;
+	}
+}
+
+static void __rcu_offload_callbacks(struct rcu_offload *ofl,
+					struct rcu_data *rdp)
+{
+	rcu_offload_list(ofl, rdp->donelist, rdp->donetail);
+	rcu_offload_list(ofl, rdp->curlist, rdp->curtail);
+	rcu_offload_list(ofl, rdp->nxtlist, rdp->nxttail);
+	rdp->donelist = NULL;
+	rdp->donetail = &rdp->donelist;
+	rdp->curlist = NULL;
+	rdp->curtail = &rdp->curlist;
+	rdp->nxtlist = NULL;
+	rdp->nxttail = &rdp->nxtlist;
+}
+
+/*
+ * Hand all of this cpu's callbacks to the housekeeping cpus. Called by
+ * a nohz_full cpu about to stop its tick from user mode, so its rcu
+ * tasklet cannot be in the middle of rcu_do_batch().
+ */
+void rcu_offload_callbacks(int cpu)
+{
+	unsigned long flags;
+	cpumask_t mask;
+
+	spin_lock_irqsave(&rcu_offload_lock, flags);
+	__rcu_offload_callbacks(&rcu_offload, &per_cpu(rcu_data, cpu));
+	__rcu_offload_callbacks(&rcu_bh_offload, &per_cpu(rcu_bh_data, cpu));
+	rcu_offload_queued = 1;
+	spin_unlock_irqrestore(&rcu_offload_lock, flags);
+
+	/* If every housekeeping cpu sleeps tickless, wake one up */
+	cpus_andnot(mask, cpu_online_map, nohz_full_mask);
+	if (cpus_subset(mask, nohz_cpu_mask) && !cpus_empty(mask))
+		smp_send_reschedule(first_cpu(mask));
+}
+
+int rcu_housekeeping_cpu(int cpu)
+{
+	return !cpu_isset(cpu, nohz_full_mask);
+}
+
+static void __rcu_adopt_callbacks(struct rcu_offload *ofl,
+					struct rcu_data *rdp)
+{
+	if (ofl->list) {
+		*rdp->nxttail = ofl->list;
+		rdp->nxttail = ofl->tail;
+		ofl->list = NULL;
+		ofl->tail = &ofl->list;
+	}
+}
+
+static void rcu_adopt_callbacks(int cpu)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&rcu_offload_lock, flags);
+	__rcu_adopt_callbacks(&rcu_offload, &per_cpu(rcu_data, cpu));
+	__rcu_adopt_callbacks(&rcu_bh_offload, &per_cpu(rcu_bh_data, cpu));
+	rcu_offload_queued = 0;
+	spin_unlock_irqrestore(&rcu_offload_lock, flags);
+}
+
+/*
+ * Cpus running tickless in nohz_busy_cpu_mask still count for the new
+ * batch. Kick them: their tick comes back and reports the quiescent
+ * state, then stops again once nothing is pending for them.
+ */
+static void rcu_kick_busy_cpus(struct rcu_state *rsp)
+{
+	int cpu;
+
+	for_each_cpu_mask(cpu, nohz_busy_cpu_mask)
+		if (rcu_cpu_pending(rsp, cpu))
+			smp_send_reschedule(cpu);
+}
+#endif
+
+/*
+ * cpu went through a quiescent state since the beginning of grace period
+ * batch. Clear it from its leaf, and walk up as long as we were the last
+ * one at a node. Returns 1 if that emptied the root: the caller must then
+ * complete the grace period with rcu_batch_done() under rsp->lock, which
+ * also starts another one if someone has further entries pending.
+ * Reports for any other batch are ignored.
+ */
+static int cpu_quiet(int cpu, struct rcu_state *rsp, long batch)
+{
+	struct rcu_node *rnp = rcu_cpu_node(rsp, cpu);
+	struct rcu_node *parent;
+	unsigned long mask = 1UL << (cpu - rnp->grplo);
+
+	for (;;) {
+		spin_lock(&rnp->lock);
+		if (rnp->gpnum != batch || !(rnp->qsmask & mask)) {
+			spin_unlock(&rnp->lock);
+			return 0;
+		}
+		rnp->qsmask &= ~mask;
+		if (rnp->qsmask) {
+			spin_unlock(&rnp->lock);
+			return 0;
+		}
+		mask = rnp->grpmask;
+		parent = rnp->parent;
+		spin_unlock(&rnp->lock);
+		if (!parent)
+			return 1;
+		rnp = parent;
+	}
+}
+
+static void rcu_batch_done(struct rcu_ctrlblk *rcp, struct rcu_state *rsp);
+
 /*
  * Register a new batch of callbacks, and start it up if there is currently no
  * active batch and the batch to be registered has not already occurred.
@@ -192,8 +663,16 @@ static void rcu_start_batch(struct rcu_ctrlblk *rcp, struct rcu_state *rsp,
 
 	if (rcp->next_pending &&
 			rcp->completed == rcp->cur) {
+		cpumask_t mask;
+		int done;
+#ifdef CONFIG_NO_IDLE_HZ
+		int cpu;
+#endif
+
 		/* Can't change, since spin lock held. */
-		cpus_andnot(rsp->cpumask, cpu_online_map, nohz_cpu_mask);
+		cpus_andnot(mask, cpu_online_map, nohz_cpu_mask);
+		rcu_init_gp(rsp, rcp->cur + 1, &mask);
+		done = cpus_empty(mask);
 
 		rcp->next_pending = 0;
 		/* next_pending == 0 must be visible in __rcu_process_callbacks()
@@ -201,24 +680,54 @@ static void rcu_start_batch(struct rcu_ctrlblk *rcp, struct rcu_state *rsp,
 		 */
 		smp_wmb();
 		rcp->cur++;
+#ifdef CONFIG_NO_IDLE_HZ
+		/*
+		 * A cpu that went tickless after the mask was taken would
+		 * never report in. It has been idle ever since it set its
+		 * nohz bit, so it cannot be inside a read-side section that
+		 * started before this batch: count it as quiescent.
+		 */
+		smp_mb();
+		for_each_cpu_mask(cpu, nohz_cpu_mask)
+			done |= cpu_quiet(cpu, rsp, rcp->cur);
+#ifdef CONFIG_NO_HZ_FULL
+		rcu_kick_busy_cpus(rsp);
+#endif
+#endif
+		if (done)
+			rcu_batch_done(rcp, rsp);
 	}
 }
 
 /*
- * cpu went through a quiescent state since the beginning of the grace period.
- * Clear it from the cpu mask and complete the grace period if it was the last
- * cpu. Start another grace period if someone has further entries pending
+ * All cpus went through a quiescent state. Complete the batch unless
+ * preempted readers from before it are still around; then every cpu
+ * polls them (rcu_poll_readers()) until they are gone.
+ * Caller must hold rsp->lock.
  */
-static void cpu_quiet(int cpu, struct rcu_ctrlblk *rcp, struct rcu_state *rsp)
+static void rcu_batch_done(struct rcu_ctrlblk *rcp, struct rcu_state *rsp)
 {
-	cpu_clear(cpu, rsp->cpumask);
-	if (cpus_empty(rsp->cpumask)) {
-		/* batch completed ! */
-		rcp->completed = rcp->cur;
-		rcu_start_batch(rcp, rsp, 0);
+	if (rcu_readers_blocking(rcp)) {
+		rcp->wait_readers = 1;
+		return;
 	}
+	/* batch completed ! */
+	rcp->wait_readers = 0;
+	rcp->completed = rcp->cur;
+	rcu_start_batch(rcp, rsp, 0);
+}
+
+static void rcu_poll_readers(struct rcu_ctrlblk *rcp, struct rcu_state *rsp)
+{
+	if (!rcp->wait_readers)
+		return;
+	spin_lock(&rsp->lock);
+	if (rcp->wait_readers)
+		rcu_batch_done(rcp, rsp);
+	spin_unlock(&rsp->lock);
 }
 
+
 /*
  * Check if the cpu has gone through a quiescent state (say context
  * switch). If so and if it already hasn't done so in this RCU
@@ -250,15 +759,15 @@ static void rcu_check_quiescent_state(struct rcu_ctrlblk *rcp,
 		return;
 	rdp->qs_pending = 0;
 
-	spin_lock(&rsp->lock);
 	/*
-	 * rdp->quiescbatch/rcp->cur and the cpu bitmap can come out of sync
-	 * during cpu startup. Ignore the quiescent state.
+	 * rdp->quiescbatch/rcp->cur and the tree can come out of sync
+	 * during cpu startup. cpu_quiet() then ignores the quiescent state.
 	 */
-	if (likely(rdp->quiescbatch == rcp->cur))
-		cpu_quiet(rdp->cpu, rcp, rsp);
-
-	spin_unlock(&rsp->lock);
+	if (cpu_quiet(rdp->cpu, rsp, rdp->quiescbatch)) {
+		spin_lock(&rsp->lock);
+		rcu_batch_done(rcp, rsp);
+		spin_unlock(&rsp->lock);
+	}
 }
 
 
@@ -286,17 +795,26 @@ static void __rcu_offline_cpu(struct rcu_data *this_rdp,
 	 * it here
 	 */
 	spin_lock_bh(&rsp->lock);
-	if (rcp->cur != rcp->completed)
-		cpu_quiet(rdp->cpu, rcp, rsp);
+	if (rcp->cur != rcp->completed && cpu_quiet(rdp->cpu, rsp, rcp->cur))
+		rcu_batch_done(rcp, rsp);
 	spin_unlock_bh(&rsp->lock);
+	rcu_move_batch(this_rdp, rdp->donelist, rdp->donetail);
 	rcu_move_batch(this_rdp, rdp->curlist, rdp->curtail);
 	rcu_move_batch(this_rdp, rdp->nxtlist, rdp->nxttail);
 
 }
 static void rcu_offline_cpu(int cpu)
 {
-	struct rcu_data *this_rdp = &get_cpu_var(rcu_data);
-	struct rcu_data *this_bh_rdp = &get_cpu_var(rcu_bh_data);
+	struct task_struct *t = per_cpu(rcu_kthread, cpu);
+	struct rcu_data *this_rdp, *this_bh_rdp;
+
+	if (t) {
+		per_cpu(rcu_kthread, cpu) = NULL;
+		kthread_stop(t);
+	}
+
+	this_rdp = &get_cpu_var(rcu_data);
+	this_bh_rdp = &get_cpu_var(rcu_bh_data);
 
 	__rcu_offline_cpu(this_rdp, &rcu_ctrlblk, &rcu_state,
 					&per_cpu(rcu_data, cpu));
@@ -357,6 +875,7 @@ static void __rcu_process_callbacks(struct rcu_ctrlblk *rcp,
 		local_irq_enable();
 	}
 	rcu_check_quiescent_state(rcp, rsp, rdp);
+	rcu_poll_readers(rcp, rsp);
 	if (rdp->donelist)
 		rcu_do_batch(rdp);
 }
@@ -371,6 +890,10 @@ static void rcu_process_callbacks(unsigned long unused)
 
 void rcu_check_callbacks(int cpu, int user)
 {
+#ifdef CONFIG_NO_HZ_FULL
+	if (unlikely(rcu_offload_queued) && rcu_housekeeping_cpu(cpu))
+		rcu_adopt_callbacks(cpu);
+#endif
 	if (user || 
 	    (idle_cpu(cpu) && !in_softirq() && 
 				hardirq_count() <= (1 << HARDIRQ_SHIFT))) {
@@ -410,7 +933,20 @@ static int __devinit rcu_cpu_notify(struct notifier_block *self,
 	switch (action) {
 	case CPU_UP_PREPARE:
 		rcu_online_cpu(cpu);
+		if (rcu_kthreads_spawned && rcu_spawn_kthread(cpu))
+			return NOTIFY_BAD;
+		break;
+	case CPU_ONLINE:
+		if (per_cpu(rcu_kthread, cpu))
+			wake_up_process(per_cpu(rcu_kthread, cpu));
 		break;
+#ifdef CONFIG_HOTPLUG_CPU
+	case CPU_UP_CANCELED:
+		/* Unbind so it can run.  Fall thru. */
+		if (per_cpu(rcu_kthread, cpu))
+			kthread_bind(per_cpu(rcu_kthread, cpu),
+					smp_processor_id());
+#endif
 	case CPU_DEAD:
 		rcu_offline_cpu(cpu);
 		break;
@@ -432,6 +968,8 @@ static struct notifier_block __devinitdata rcu_nb = {
  */
 void __init rcu_init(void)
 {
+	rcu_init_tree(&rcu_ctrlblk, &rcu_state);
+	rcu_init_tree(&rcu_bh_ctrlblk, &rcu_bh_state);
 	rcu_cpu_notify(&rcu_nb, CPU_UP_PREPARE,
 			(void *)(long)smp_processor_id());
 	/* Register notifier for non-boot CPUs */
@@ -473,7 +1011,27 @@ void synchronize_kernel(void)
 	wait_for_completion(&rcu.completion);
 }
 
+/*
+ * rcu_init() runs long before kthreads can be created: start krcud on
+ * the cpus that are up by now, CPU_UP_PREPARE handles the rest.
+ */
+static int __init rcu_spawn_kthreads(void)
+{
+	long cpu;
+
+	lock_cpu_hotplug();
+	for_each_online_cpu(cpu) {
+		if (!rcu_spawn_kthread(cpu))
+			wake_up_process(per_cpu(rcu_kthread, cpu));
+	}
+	rcu_kthreads_spawned = 1;
+	unlock_cpu_hotplug();
+	return 0;
+}
+__initcall(rcu_spawn_kthreads);
+
 module_param(maxbatch, int, 0);
+module_param(kthread_prio, int, 0);
 EXPORT_SYMBOL(call_rcu);
 EXPORT_SYMBOL(call_rcu_bh);
 EXPORT_SYMBOL(synchronize_kernel);
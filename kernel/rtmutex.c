@@ -0,0 +1,414 @@
+/*
+ * kernel/rtmutex.c
+ *
+ * Sleeping locks with priority inheritance.
+ *
+ * The blocked task's priority is propagated to the lock owner through
+ * the O(1) scheduler (rt_mutex_setprio()), and further along the chain
+ * if that owner is itself blocked on another rt_mutex.
+ *
+ * All rt_mutex state, as well as the pi_waiters/pi_blocked_on fields
+ * of every task, is protected by a single irq-safe spinlock. There
+ * are few rt_mutexes in the system (one per contended PI futex), and
+ * a single lock keeps the chain walk free of lock-ordering problems.
+ */
+#include <linux/spinlock.h>
+#include <linux/module.h>
+#include <linux/sched.h>
+#include <linux/rtmutex.h>
+
+/*
+ * Max number of owners we walk along a blocking chain, when checking
+ * for a deadlock or propagating a priority change.
+ */
+#define RT_MUTEX_MAX_CHAIN	1024
+
+static DEFINE_SPINLOCK(rt_mutex_pi_lock);
+
+static inline struct rt_mutex_waiter *rt_mutex_top_waiter(struct rt_mutex *lock)
+{
+	return list_entry(lock->wait_list.next, struct rt_mutex_waiter,
+			  list_entry);
+}
+
+static inline int rt_mutex_has_waiters(struct rt_mutex *lock)
+{
+	return !list_empty(&lock->wait_list);
+}
+
+/*
+ * Insert @entry into a prio-sorted list, after all entries of equal
+ * priority (FIFO order within a priority level).
+ */
+static void prio_list_add(struct list_head *entry, struct list_head *head,
+		      int prio, int offset)
+{
+	struct list_head *pos;
+
+	list_for_each(pos, head) {
+		struct rt_mutex_waiter *w =
+			(struct rt_mutex_waiter *)((char *)pos - offset);
+		if (w->prio > prio)
+			break;
+	}
+	list_add_tail(entry, pos);
+}
+
+#define waiter_add(w, head) \
+	prio_list_add(&(w)->list_entry, head, (w)->prio, \
+		  offsetof(struct rt_mutex_waiter, list_entry))
+#define pi_waiter_add(w, head) \
+	prio_list_add(&(w)->pi_list_entry, head, (w)->prio, \
+		  offsetof(struct rt_mutex_waiter, pi_list_entry))
+
+/*
+ * Recalculate the boost of @task from the top waiters of the locks it
+ * owns. Called with rt_mutex_pi_lock held.
+ */
+static void __rt_mutex_adjust_prio(struct task_struct *task)
+{
+	int prio = MAX_PRIO;
+
+	if (!list_empty(&task->pi_waiters))
+		prio = list_entry(task->pi_waiters.next,
+				  struct rt_mutex_waiter, pi_list_entry)->prio;
+
+	if (task->pi_prio != prio)
+		rt_mutex_setprio(task, prio);
+}
+
+/*
+ * Propagate a priority change of @task along the chain of locks it is
+ * blocked on. Called with rt_mutex_pi_lock held.
+ */
+static void rt_mutex_adjust_prio_chain(struct task_struct *task)
+{
+	struct task_struct *orig = task;
+	int depth;
+
+	for (depth = 0; depth < RT_MUTEX_MAX_CHAIN; depth++) {
+		struct rt_mutex_waiter *waiter, *top;
+		struct rt_mutex *lock;
+
+		__rt_mutex_adjust_prio(task);
+
+		waiter = task->pi_blocked_on;
+		if (!waiter || waiter->prio == task->prio)
+			return;
+
+		/* Requeue the waiter with its new priority: */
+		lock = waiter->lock;
+		top = rt_mutex_top_waiter(lock);
+		list_del(&waiter->list_entry);
+		waiter->prio = task->prio;
+		waiter_add(waiter, &lock->wait_list);
+
+		task = lock->owner;
+		if (!task)
+			return;
+
+		/* The owner only tracks the top waiter of each lock: */
+		list_del_init(&top->pi_list_entry);
+		top = rt_mutex_top_waiter(lock);
+		pi_waiter_add(top, &task->pi_waiters);
+
+		/* Circular chain (userspace deadlock): stop here. */
+		if (task == orig) {
+			__rt_mutex_adjust_prio(task);
+			return;
+		}
+	}
+	if (printk_ratelimit())
+		printk(KERN_WARNING "rt_mutex: maximum lock depth %d exceeded "
+		       "by %s/%d\n", RT_MUTEX_MAX_CHAIN, orig->comm, orig->pid);
+}
+
+/*
+ * Would current deadlock by blocking on @lock? Follow the owners from
+ * @lock: if the chain leads back to current, it does. A chain longer
+ * than RT_MUTEX_MAX_CHAIN is refused as well, since the walk is done
+ * under rt_mutex_pi_lock. Called with rt_mutex_pi_lock held.
+ */
+static int rt_mutex_detect_deadlock(struct rt_mutex *lock)
+{
+	struct task_struct *task = lock->owner;
+	int depth;
+
+	for (depth = 0; depth < RT_MUTEX_MAX_CHAIN; depth++) {
+		if (task == current)
+			return 1;
+		if (!task || !task->pi_blocked_on)
+			return 0;
+		lock = task->pi_blocked_on->lock;
+		task = lock->owner;
+	}
+	if (printk_ratelimit())
+		printk(KERN_WARNING "rt_mutex: maximum lock depth %d exceeded "
+		       "by %s/%d\n", RT_MUTEX_MAX_CHAIN, current->comm,
+		       current->pid);
+	return 1;
+}
+
+/*
+ * Enqueue @waiter on @lock and boost the owner if it became the top
+ * waiter. Called with rt_mutex_pi_lock held.
+ */
+static void task_blocks_on_rt_mutex(struct rt_mutex *lock,
+				    struct rt_mutex_waiter *waiter)
+{
+	struct task_struct *owner = lock->owner;
+	struct rt_mutex_waiter *top = NULL;
+
+	waiter->task = current;
+	waiter->lock = lock;
+	waiter->prio = current->prio;
+	INIT_LIST_HEAD(&waiter->pi_list_entry);
+
+	if (rt_mutex_has_waiters(lock))
+		top = rt_mutex_top_waiter(lock);
+	waiter_add(waiter, &lock->wait_list);
+	current->pi_blocked_on = waiter;
+
+	if (rt_mutex_top_waiter(lock) != waiter)
+		return;
+
+	if (top)
+		list_del_init(&top->pi_list_entry);
+	pi_waiter_add(waiter, &owner->pi_waiters);
+	rt_mutex_adjust_prio_chain(owner);
+}
+
+/*
+ * Remove a waiter which gave up (signal or timeout) and deboost the
+ * owner if necessary. Called with rt_mutex_pi_lock held.
+ */
+static void remove_waiter(struct rt_mutex *lock,
+			  struct rt_mutex_waiter *waiter)
+{
+	struct task_struct *owner = lock->owner;
+	int was_top = (rt_mutex_top_waiter(lock) == waiter);
+
+	list_del_init(&waiter->list_entry);
+	current->pi_blocked_on = NULL;
+
+	if (!was_top || !owner)
+		return;
+
+	list_del_init(&waiter->pi_list_entry);
+	if (rt_mutex_has_waiters(lock))
+		pi_waiter_add(rt_mutex_top_waiter(lock), &owner->pi_waiters);
+	rt_mutex_adjust_prio_chain(owner);
+}
+
+/*
+ * Hand @lock over from @owner to its top waiter (or release it if
+ * there are none). Called with rt_mutex_pi_lock held.
+ */
+static void rt_mutex_handoff(struct rt_mutex *lock, struct task_struct *owner)
+{
+	struct rt_mutex_waiter *waiter;
+	struct task_struct *next;
+
+	if (!rt_mutex_has_waiters(lock)) {
+		lock->owner = NULL;
+		return;
+	}
+
+	waiter = rt_mutex_top_waiter(lock);
+	list_del_init(&waiter->list_entry);
+	list_del_init(&waiter->pi_list_entry);
+	next = waiter->task;
+	next->pi_blocked_on = NULL;
+	lock->owner = next;
+
+	if (rt_mutex_has_waiters(lock)) {
+		pi_waiter_add(rt_mutex_top_waiter(lock), &next->pi_waiters);
+		__rt_mutex_adjust_prio(next);
+	}
+	__rt_mutex_adjust_prio(owner);
+
+	wake_up_process(next);
+}
+
+/**
+ * rt_mutex_init - initialize an rt_mutex
+ * @lock: the lock to initialize
+ */
+void rt_mutex_init(struct rt_mutex *lock)
+{
+	INIT_LIST_HEAD(&lock->wait_list);
+	lock->owner = NULL;
+}
+EXPORT_SYMBOL_GPL(rt_mutex_init);
+
+/**
+ * rt_mutex_timed_lock - lock an rt_mutex, interruptibly, with a timeout
+ * @lock: the lock to take
+ * @timeout: timeout in jiffies, or MAX_SCHEDULE_TIMEOUT
+ *
+ * Returns 0 on success, -EINTR if a signal arrived, -ETIMEDOUT if
+ * the timeout expired before the lock could be acquired and -EDEADLK
+ * if current already owns the lock, or the chain of owners blocked on
+ * other rt_mutexes leads back to current.
+ */
+int rt_mutex_timed_lock(struct rt_mutex *lock, long timeout)
+{
+	struct rt_mutex_waiter waiter;
+	unsigned long flags;
+	int ret = 0;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	if (!lock->owner) {
+		lock->owner = current;
+		spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+		return 0;
+	}
+	if (rt_mutex_detect_deadlock(lock)) {
+		spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+		return -EDEADLK;
+	}
+
+	task_blocks_on_rt_mutex(lock, &waiter);
+
+	for (;;) {
+		/* rt_mutex_handoff() made us the owner: */
+		if (lock->owner == current)
+			break;
+		if (signal_pending(current)) {
+			ret = -EINTR;
+			break;
+		}
+		if (!timeout) {
+			ret = -ETIMEDOUT;
+			break;
+		}
+		set_current_state(TASK_INTERRUPTIBLE);
+		spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+
+		timeout = schedule_timeout(timeout);
+
+		spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	}
+	set_current_state(TASK_RUNNING);
+
+	if (ret)
+		remove_waiter(lock, &waiter);
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(rt_mutex_timed_lock);
+
+/**
+ * rt_mutex_lock - lock an rt_mutex, uninterruptibly
+ * @lock: the lock to take
+ */
+void rt_mutex_lock(struct rt_mutex *lock)
+{
+	struct rt_mutex_waiter waiter;
+	unsigned long flags;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	if (!lock->owner) {
+		lock->owner = current;
+		spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+		return;
+	}
+	BUG_ON(lock->owner == current);
+
+	task_blocks_on_rt_mutex(lock, &waiter);
+
+	while (lock->owner != current) {
+		set_current_state(TASK_UNINTERRUPTIBLE);
+		spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+		schedule();
+		spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	}
+	set_current_state(TASK_RUNNING);
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+}
+EXPORT_SYMBOL_GPL(rt_mutex_lock);
+
+/**
+ * rt_mutex_trylock - try to lock an rt_mutex
+ * @lock: the lock to take
+ *
+ * Returns 1 on success, 0 on contention.
+ */
+int rt_mutex_trylock(struct rt_mutex *lock)
+{
+	unsigned long flags;
+	int ret = 0;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	if (!lock->owner) {
+		lock->owner = current;
+		ret = 1;
+	}
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(rt_mutex_trylock);
+
+/**
+ * rt_mutex_unlock - unlock an rt_mutex
+ * @lock: the lock to release
+ *
+ * Ownership passes directly to the highest priority waiter, so a
+ * lower priority task cannot steal the lock in between.
+ */
+void rt_mutex_unlock(struct rt_mutex *lock)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	BUG_ON(lock->owner != current);
+	rt_mutex_handoff(lock, current);
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+}
+EXPORT_SYMBOL_GPL(rt_mutex_unlock);
+
+/*
+ * Initialize @lock as already held by @proxy_owner. Used by the futex
+ * code when the first waiter arrives on a lock userspace acquired
+ * without entering the kernel.
+ */
+void rt_mutex_init_proxy_locked(struct rt_mutex *lock,
+				struct task_struct *proxy_owner)
+{
+	rt_mutex_init(lock);
+	lock->owner = proxy_owner;
+}
+
+/*
+ * Release @lock on behalf of @proxy_owner. There must be no waiters
+ * left, or the lock must be owned by an exiting task.
+ */
+void rt_mutex_proxy_unlock(struct rt_mutex *lock,
+			   struct task_struct *proxy_owner)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	if (lock->owner == proxy_owner)
+		rt_mutex_handoff(lock, proxy_owner);
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+}
+
+/*
+ * Return the task that will own @lock after the next unlock, or NULL
+ * if there are no waiters.
+ */
+struct task_struct *rt_mutex_next_owner(struct rt_mutex *lock)
+{
+	struct task_struct *next = NULL;
+	unsigned long flags;
+
+	spin_lock_irqsave(&rt_mutex_pi_lock, flags);
+	if (rt_mutex_has_waiters(lock))
+		next = rt_mutex_top_waiter(lock)->task;
+	spin_unlock_irqrestore(&rt_mutex_pi_lock, flags);
+
+	return next;
+}
@@ -42,9 +42,16 @@
 #include <linux/cpu.h>
 #include <linux/percpu.h>
 #include <linux/kthread.h>
+#include <linux/workqueue.h>
+#include <linux/mutex.h>
 #include <linux/seq_file.h>
 #include <linux/syscalls.h>
 #include <linux/times.h>
+#include <linux/ftrace.h>
+#include <linux/perf_counter.h>
+#include <linux/delayacct.h>
+#include <linux/psi.h>
+#include <trace/sched.h>
 #include <asm/tlb.h>
 
 #include <asm/unistd.h>
@@ -153,7 +160,11 @@
 		(MAX_BONUS / 2 + DELTA((p)) + 1) / MAX_BONUS - 1))
 
 #define TASK_PREEMPTS_CURR(p, rq) \
-	((p)->prio < (rq)->curr->prio)
+	(dl_task(p) || dl_task((rq)->curr) ? \
+		dl_preempts_curr(p, rq) : task_preempts_curr(p, rq))
+
+#define rt_policy(policy) \
+	((policy) == SCHED_FIFO || (policy) == SCHED_RR)
 
 /*
  * task_timeslice() scales user-nice values [ -20 ... 0 ... 19 ]
@@ -203,6 +214,69 @@ struct prio_array {
 	struct list_head queue[MAX_PRIO];
 };
 
+/*
+ * The SCHED_FAIR part of a runqueue, see kernel/sched_fair.c:
+ */
+struct cfs_rq {
+	struct rb_root tasks_timeline;	/* entities sorted by vruntime */
+	struct rb_node *rb_leftmost;
+	struct sched_entity *curr;	/* entity charged for the CPU time */
+	unsigned long nr_running;	/* entities queued, but o1 */
+	unsigned long load;		/* sum of the queued weights */
+	unsigned long long min_vruntime;
+	struct list_head list;		/* on rq->cfs_rqs */
+
+	/* Only used in rq->cfs: */
+	struct sched_entity o1;		/* stands for the O(1) arrays */
+	unsigned long nr_o1;		/* tasks queued on the O(1) arrays */
+	struct sched_entity *running;	/* leaf of the running chain */
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+	struct task_group *tg;
+	struct sched_entity *se;	/* queues us on the parent, NULL at the root */
+	int depth;			/* 0 at the root */
+	int throttled;
+	int runtime_enabled;		/* tg has a quota */
+	long long runtime_remaining;	/* of the quota, this period */
+#endif
+};
+
+/*
+ * The SCHED_DEADLINE part of a runqueue, see kernel/sched_dl.c:
+ */
+struct dl_rq {
+	struct rb_root root;		/* runnable tasks by deadline */
+	struct rb_node *rb_leftmost;
+	struct list_head tasks;		/* queued tasks, throttled ones too */
+	unsigned long nr_running;	/* tasks on the list */
+	task_t *curr;			/* task charged for the CPU time */
+};
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+/*
+ * A group of SCHED_FAIR tasks that shares the CPU with its siblings
+ * according to its shares, see kernel/sched_fair.c.  Managed through
+ * the cpugroup filesystem (kernel/cpugroup.c).
+ */
+struct task_group {
+	struct cfs_rq *cfs_rq[NR_CPUS];
+	struct sched_entity *se[NR_CPUS];	/* NULL for the root group */
+
+	struct task_group *parent;
+	struct list_head siblings;
+	struct list_head children;
+	int nr_tasks;				/* tasks pointing to us */
+
+	unsigned long shares;			/* weight of se[] */
+
+	/* CPU bandwidth: quota ns of runtime per period, on every CPU */
+	spinlock_t bandwidth_lock;
+	unsigned long long quota;		/* RUNTIME_INF: no limit */
+	unsigned long long period;
+	struct timer_list period_timer;
+};
+#endif
+
 /*
  * This is the main, per-CPU runqueue data structure.
  *
@@ -272,6 +346,9 @@ struct runqueue {
 	 * arrays-̺͹ڽ̵
 	 */
 	prio_array_t *active, *expired, arrays[2];
+	struct dl_rq dl;
+	struct cfs_rq cfs;
+	struct list_head cfs_rqs;	/* rq->cfs and the group queues */
 	/**
 	 * ڽо̬ȼߵĽ(ȨֵС)
 	 */
@@ -542,7 +619,7 @@ static int cpu_and_siblings_are_idle(int cpu)
 #define cpu_and_siblings_are_idle(A) idle_cpu(A)
 #endif
 
-#ifdef CONFIG_SCHEDSTATS
+#if defined(CONFIG_SCHEDSTATS) || defined(CONFIG_TASK_DELAY_ACCT)
 /*
  * Called when a process is dequeued from the active array and given
  * the cpu.  We should note that with the exception of interactive
@@ -571,7 +648,9 @@ static inline void sched_info_dequeued(task_t *t)
 static inline void sched_info_arrive(task_t *t)
 {
 	unsigned long now = jiffies, diff = 0;
+#ifdef CONFIG_SCHEDSTATS
 	struct runqueue *rq = task_rq(t);
+#endif
 
 	if (t->sched_info.last_queued)
 		diff = now - t->sched_info.last_queued;
@@ -580,11 +659,13 @@ static inline void sched_info_arrive(task_t *t)
 	t->sched_info.last_arrival = now;
 	t->sched_info.pcnt++;
 
+#ifdef CONFIG_SCHEDSTATS
 	if (!rq)
 		return;
 
 	rq->rq_sched_info.run_delay += diff;
 	rq->rq_sched_info.pcnt++;
+#endif
 }
 
 /*
@@ -614,13 +695,18 @@ static inline void sched_info_queued(task_t *t)
  */
 static inline void sched_info_depart(task_t *t)
 {
-	struct runqueue *rq = task_rq(t);
 	unsigned long diff = jiffies - t->sched_info.last_arrival;
 
 	t->sched_info.cpu_time += diff;
 
-	if (rq)
-		rq->rq_sched_info.cpu_time += diff;
+#ifdef CONFIG_SCHEDSTATS
+	{
+		struct runqueue *rq = task_rq(t);
+
+		if (rq)
+			rq->rq_sched_info.cpu_time += diff;
+	}
+#endif
 }
 
 /*
@@ -646,7 +732,10 @@ static inline void sched_info_switch(task_t *prev, task_t *next)
 #else
 #define sched_info_queued(t)		do { } while (0)
 #define sched_info_switch(t, next)	do { } while (0)
-#endif /* CONFIG_SCHEDSTATS */
+#endif /* CONFIG_SCHEDSTATS || CONFIG_TASK_DELAY_ACCT */
+
+#include "sched_fair.c"
+#include "sched_dl.c"
 
 /*
  * Adding/removing a task to/from a priority array:
@@ -656,10 +745,19 @@ static inline void sched_info_switch(task_t *prev, task_t *next)
  */
 static void dequeue_task(struct task_struct *p, prio_array_t *array)
 {
+	if (array == &dl_array) {
+		dequeue_task_dl(task_rq(p), p);
+		return;
+	}
+	if (array == &fair_array) {
+		dequeue_task_fair(task_rq(p), p);
+		return;
+	}
 	array->nr_active--;
 	list_del(&p->run_list);
 	if (list_empty(array->queue + p->prio))
 		__clear_bit(p->prio, array->bitmap);
+	o1_entity_dequeue(task_rq(p));
 }
 
 /**
@@ -668,10 +766,22 @@ static void dequeue_task(struct task_struct *p, prio_array_t *array)
 static void enqueue_task(struct task_struct *p, prio_array_t *array)
 {
 	sched_info_queued(p);
+	if (dl_task(p)) {
+		enqueue_task_dl(task_rq(p), p);
+		return;
+	}
+	if (fair_task(p)) {
+		enqueue_task_fair(task_rq(p), p);
+		return;
+	}
+	/* Requeued after leaving SCHED_FAIR or SCHED_DEADLINE: */
+	if (array == &fair_array || array == &dl_array)
+		array = task_rq(p)->active;
 	list_add_tail(&p->run_list, array->queue + p->prio);
 	__set_bit(p->prio, array->bitmap);
 	array->nr_active++;
 	p->array = array;
+	o1_entity_enqueue(task_rq(p));
 }
 
 /*
@@ -689,6 +799,7 @@ static inline void enqueue_task_head(struct task_struct *p, prio_array_t *array)
 	__set_bit(p->prio, array->bitmap);
 	array->nr_active++;
 	p->array = array;
+	o1_entity_enqueue(task_rq(p));
 }
 
 /*
@@ -712,19 +823,49 @@ static int effective_prio(task_t *p)
 {
 	int bonus, prio;
 
-	if (rt_task(p))
-		return p->prio;
-
-	bonus = CURRENT_BONUS(p) - MAX_BONUS / 2;
-
-	prio = p->static_prio - bonus;
-	if (prio < MAX_RT_PRIO)
-		prio = MAX_RT_PRIO;
-	if (prio > MAX_PRIO-1)
-		prio = MAX_PRIO-1;
+	if (p->policy == SCHED_DEADLINE)
+		prio = MAX_DL_PRIO-1;
+	else if (rt_policy(p->policy))
+		prio = MAX_USER_RT_PRIO-1 - p->rt_priority;
+	else if (p->policy == SCHED_FAIR)
+		prio = p->static_prio;
+	else {
+		bonus = CURRENT_BONUS(p) - MAX_BONUS / 2;
+
+		prio = p->static_prio - bonus;
+		if (prio < MAX_RT_PRIO)
+			prio = MAX_RT_PRIO;
+		if (prio > MAX_PRIO-1)
+			prio = MAX_PRIO-1;
+	}
+	/*
+	 * An rt_mutex owner runs at least at the priority of its
+	 * highest priority waiter (see kernel/rtmutex.c):
+	 */
+	if (p->pi_prio < prio)
+		prio = p->pi_prio;
+	/* Only SCHED_DEADLINE tasks have a deadline to run at: */
+	if (dl_prio(prio) && p->policy != SCHED_DEADLINE)
+		prio = 0;
 	return prio;
 }
 
+#ifdef CONFIG_NO_HZ_FULL
+/*
+ * A second task queued on a cpu that runs tickless needs the tick back
+ * for timeslicing: the reschedule IPI restarts it.
+ */
+static inline void nohz_full_kick(int cpu)
+{
+	if (unlikely(cpu_isset(cpu, nohz_busy_cpu_mask)))
+		smp_send_reschedule(cpu);
+}
+#else
+static inline void nohz_full_kick(int cpu)
+{
+}
+#endif
+
 /*
  * __activate_task - move a task to the runqueue.
  */
@@ -732,6 +873,7 @@ static inline void __activate_task(task_t *p, runqueue_t *rq)
 {
 	enqueue_task(p, rq->active);
 	rq->nr_running++;
+	nohz_full_kick(task_cpu(p));
 }
 
 /*
@@ -940,6 +1082,34 @@ inline int task_curr(const task_t *p)
 	return cpu_curr(task_cpu(p)) == p;
 }
 
+#ifdef MUTEX_SPIN_ON_OWNER
+/*
+ * Spin while @owner holds @lock and is running.  Returns 1 if the owner
+ * changed (most likely the lock was released), 0 if we should stop
+ * spinning and go to sleep instead.
+ */
+int mutex_spin_on_owner(struct mutex *lock, struct thread_info *owner)
+{
+	unsigned int cpu;
+	runqueue_t *rq;
+
+	/* The owner may have released the lock and exited: it's only a hint */
+	cpu = owner->cpu;
+	if (cpu >= NR_CPUS || !cpu_online(cpu))
+		return 0;
+
+	rq = cpu_rq(cpu);
+	for (;;) {
+		if (lock->owner != owner)
+			break;
+		if (rq->curr->thread_info != owner || need_resched())
+			return 0;
+		cpu_relax();
+	}
+	return 1;
+}
+#endif
+
 #ifdef CONFIG_SMP
 enum request_type {
 	REQ_MOVE_TASK,
@@ -1066,12 +1236,34 @@ static inline unsigned long target_load(int cpu)
 
 #endif
 
+#ifdef CONFIG_SMP
+/*
+ * The widest domain of @cpu whose CPUs share its last level cache,
+ * or NULL if @cpu shares it with nobody.
+ */
+static inline struct sched_domain *llc_domain(int cpu)
+{
+	struct sched_domain *sd, *llc = NULL;
+
+	for_each_domain(cpu, sd) {
+		if (!(sd->flags & SD_SHARE_PKG_RESOURCES))
+			break;
+		llc = sd;
+	}
+	return llc;
+}
+#endif
+
 /*
  * wake_idle() will wake a task on an idle cpu if task->cpu is
  * not idle and an idle cpu is available.  The span of cpus to
  * search starts with cpus closest then further out as needed,
  * so we always favor a closer, idle cpu.
  *
+ * Within the cache domain of @cpu the previous CPU of @p comes first,
+ * as @p may still have data in its cache, then any idle CPU sharing
+ * the cache.  Only then are the wider SD_WAKE_IDLE domains searched.
+ *
  * Returns the CPU we should wake onto.
  */
 #if defined(ARCH_HAS_SCHED_WAKE_IDLE)
@@ -1079,11 +1271,23 @@ static int wake_idle(int cpu, task_t *p)
 {
 	cpumask_t tmp;
 	struct sched_domain *sd;
-	int i;
+	int i, prev = task_cpu(p);
 
 	if (idle_cpu(cpu))
 		return cpu;
 
+	sd = llc_domain(cpu);
+	if (sd) {
+		if (prev != cpu && cpu_isset(prev, sd->span) && idle_cpu(prev))
+			return prev;
+		cpus_and(tmp, sd->span, cpu_online_map);
+		cpus_and(tmp, tmp, p->cpus_allowed);
+		for_each_cpu_mask(i, tmp) {
+			if (idle_cpu(i))
+				return i;
+		}
+	}
+
 	for_each_domain(cpu, sd) {
 		if (sd->flags & SD_WAKE_IDLE) {
 			cpus_and(tmp, sd->span, cpu_online_map);
@@ -1104,6 +1308,48 @@ static inline int wake_idle(int cpu, task_t *p)
 }
 #endif
 
+#ifdef CONFIG_SMP
+/*
+ * Count how often current switches between the tasks it wakes.  A
+ * waker that keeps waking the same partner has a low count; one that
+ * feeds many consumers has a high one.  The count halves every second.
+ */
+static inline void record_wakee(task_t *p)
+{
+	if (time_after(jiffies, current->wakee_flip_decay_ts + HZ)) {
+		current->wakee_flips >>= 1;
+		current->wakee_flip_decay_ts = jiffies;
+	}
+	if (current->last_wakee != p) {
+		current->last_wakee = p;
+		current->wakee_flips++;
+	}
+}
+
+/*
+ * Pulling every wakee next to the waker only helps 1:1 pairs.  When
+ * the waker (or the wakee) switches partners more often than there
+ * are CPUs in the cache domain, the wakees would just pile up on the
+ * waker's cache, so leave them where they were.
+ */
+static int wake_wide(task_t *p, int this_cpu)
+{
+	unsigned int master = current->wakee_flips;
+	unsigned int slave = p->wakee_flips;
+	struct sched_domain *sd = llc_domain(this_cpu);
+	unsigned int factor = sd ? cpus_weight(sd->span) : 1;
+
+	if (master < slave) {
+		unsigned int tmp = master;
+		master = slave;
+		slave = tmp;
+	}
+	if (slave < factor || master < slave * factor)
+		return 0;
+	return 1;
+}
+#endif
+
 /***
  * try_to_wake_up - wake up a thread
  * @p: the to-be-woken-up thread
@@ -1159,6 +1405,9 @@ static int try_to_wake_up(task_t * p, unsigned int state, int sync)
 	this_cpu = smp_processor_id();
 
 #ifdef CONFIG_SMP
+	if (!in_interrupt())
+		record_wakee(p);
+
 	/**
 	 * SMPϣҪ鱻ѵĽǷӦôеCPUжǨƵһCPUжС
 	 */
@@ -1200,6 +1449,10 @@ static int try_to_wake_up(task_t * p, unsigned int state, int sync)
 	/**
 	 * ͼǨƵCPU
 	 */
+	/* Many-to-many wakeups: spread the wakees instead of pulling them */
+	if (wake_wide(p, this_cpu))
+		goto out_set_cpu;
+
 	new_cpu = this_cpu; /* Wake to this CPU if we can */
 
 	/*
@@ -1289,6 +1542,8 @@ out_activate:
 	 *     5:̲̼ϡ
 	 */
 	activate_task(p, rq, cpu == this_cpu);
+	if (p->flags & PF_WQ_WORKER)
+		wq_worker_waking_up(p, cpu);
 	/**
 	 * ĿCPUǱCPUûSYNC־ͼ½̵Ķ̬ȼǷжеǰ̵ȼߡ
 	 */
@@ -1302,8 +1557,10 @@ out_activate:
 			resched_task(rq->curr);
 	}
 	success = 1;
+	trace_latency_wakeup(p);
 
 out_running:
+	trace_sched_wakeup(p, success);
 	/**
 	 * ״̬ΪΪTASK_RUNNINGע̻ߵ
 	 */
@@ -1320,6 +1577,25 @@ out:
 	return success;
 }
 
+/*
+ * Wake up a sleeping task bound to this cpu, from within schedule() with
+ * this runqueue's lock already held. Used for workqueue pool workers.
+ */
+static void try_to_wake_up_local(task_t *p)
+{
+	runqueue_t *rq = task_rq(p);
+
+	BUG_ON(rq != this_rq());
+	if (!(p->state & (TASK_INTERRUPTIBLE | TASK_UNINTERRUPTIBLE)))
+		return;
+	if (!p->array) {
+		if (p->state == TASK_UNINTERRUPTIBLE)
+			rq->nr_uninterruptible--;
+		activate_task(p, rq, 1);
+	}
+	p->state = TASK_RUNNING;
+}
+
 int fastcall wake_up_process(task_t * p)
 {
 	return try_to_wake_up(p, TASK_STOPPED | TASK_TRACED |
@@ -1354,7 +1630,36 @@ void fastcall sched_fork(task_t *p)
 	INIT_LIST_HEAD(&p->run_list);
 	p->array = NULL;
 	spin_lock_init(&p->switch_lock);
-#ifdef CONFIG_SCHEDSTATS
+	/* The child does not inherit the parent's rt_mutex boost: */
+	INIT_LIST_HEAD(&p->pi_waiters);
+	p->pi_blocked_on = NULL;
+	p->pi_prio = MAX_PRIO;
+	/*
+	 * Nor its SCHED_DEADLINE reservation: admission control only
+	 * covered the parent.
+	 */
+	if (p->policy == SCHED_DEADLINE)
+		p->policy = SCHED_NORMAL;
+	init_dl_entity(p);
+	p->prio = effective_prio(p);
+	/*
+	 * A new SCHED_FAIR task starts half a latency period behind the
+	 * ones already queued (vruntime is relative until it is queued):
+	 */
+	p->se.on_rq = 0;
+	p->se.vruntime = sysctl_sched_latency >> 1;
+	p->se.sum_exec_runtime = 0;
+	p->se.prev_sum_exec_runtime = 0;
+#ifdef CONFIG_SMP
+	p->last_wakee = NULL;
+	p->wakee_flips = 0;
+	p->wakee_flip_decay_ts = jiffies;
+#endif
+#ifdef CONFIG_PREEMPT_RCU
+	p->rcu_read_lock_nesting = 0;
+	p->rcu_flipctr_idx = 0;
+#endif
+#if defined(CONFIG_SCHEDSTATS) || defined(CONFIG_TASK_DELAY_ACCT)
 	memset(&p->sched_info, 0, sizeof(p->sched_info));
 #endif
 #ifdef CONFIG_PREEMPT
@@ -1443,7 +1748,8 @@ void fastcall wake_up_new_task(task_t * p, unsigned long clone_flags)
 			 * do child-runs-first in anticipation of an exec. This
 			 * usually avoids a lot of COW overhead.
 			 */
-			if (unlikely(!current->array))
+			if (unlikely(!current->array) || fair_task(p) ||
+						fair_queued(current))
 				__activate_task(p, rq);
 			else {
 				p->prio = current->prio;
@@ -1451,6 +1757,7 @@ void fastcall wake_up_new_task(task_t * p, unsigned long clone_flags)
 				p->array = current->array;
 				p->array->nr_active++;
 				rq->nr_running++;
+				o1_entity_enqueue(rq);
 			}
 			set_need_resched();
 		} else
@@ -1518,6 +1825,8 @@ void fastcall sched_exit(task_t * p)
 		(EXIT_WEIGHT + 1) * EXIT_WEIGHT + p->sleep_avg /
 		(EXIT_WEIGHT + 1);
 	task_rq_unlock(rq, &flags);
+
+	dl_release_bw(p);
 }
 
 /**
@@ -1564,6 +1873,7 @@ static void finish_task_switch(task_t *prev)
 	 * жϲͷ
 	 */
 	finish_arch_switch(rq, prev);
+	perf_counter_task_sched_in(current, smp_processor_id());
 	/**
 	 * ǰһ߳ں̣߳ĳһû̵߳ĵַռ䣬ڴ˽mm_structü1.
 	 */
@@ -1602,6 +1912,9 @@ task_t * context_switch(runqueue_t *rq, task_t *prev, task_t *next)
 	struct mm_struct *mm = next->mm;
 	struct mm_struct *oldmm = prev->active_mm;
 
+	trace_sched_switch(prev, next);
+	trace_latency_switch(prev, next);
+	perf_counter_task_sched_out(prev, smp_processor_id());
 	/**
 	 * лһں̣߳½̾ʹpreĵַռ䣬TLBл
 	 */
@@ -1931,6 +2244,41 @@ int can_migrate_task(task_t *p, runqueue_t *rq, int this_cpu,
 	return 1;
 }
 
+/*
+ * move_fair_tasks - move_tasks() for the SCHED_FAIR tasks of busiest.
+ * The walk starts at the rightmost entity, the one due to run last.
+ */
+static int move_fair_tasks(runqueue_t *this_rq, int this_cpu,
+			   runqueue_t *busiest, unsigned long max_nr_move,
+			   struct sched_domain *sd, enum idle_type idle)
+{
+	struct rb_node *node, *prev;
+	struct sched_entity *se;
+	struct cfs_rq *cfs;
+	int pulled = 0;
+	task_t *p;
+
+	list_for_each_entry(cfs, &busiest->cfs_rqs, list) {
+		for (node = rb_last(&cfs->tasks_timeline);
+		     node && pulled < max_nr_move; node = prev) {
+			prev = rb_prev(node);
+			se = rb_entry(node, struct sched_entity, run_node);
+			if (se == &busiest->cfs.o1 || group_cfs_rq(se))
+				continue;
+			p = task_of(se);
+			if (!can_migrate_task(p, busiest, this_cpu, sd, idle))
+				continue;
+
+			schedstat_inc(this_rq, pt_gained[idle]);
+			schedstat_inc(busiest, pt_lost[idle]);
+			pull_task(busiest, p->array, p, this_rq,
+				  this_rq->active, this_cpu);
+			pulled++;
+		}
+	}
+	return pulled;
+}
+
 /*
  * move_tasks tries to move up to max_nr_move tasks from busiest to this_rq,
  * as part of a balancing operation within "domain". Returns the number of
@@ -2003,7 +2351,7 @@ skip_bitmap:
 		/**
 		 * жˣ˳
 		 */
-		goto out;
+		goto move_fair;
 	}
 
 	/**
@@ -2050,6 +2398,9 @@ skip_queue:
 		idx++;
 		goto skip_bitmap;
 	}
+move_fair:
+	pulled += move_fair_tasks(this_rq, this_cpu, busiest,
+				  max_nr_move - pulled, sd, idle);
 out:
 	return pulled;
 }
@@ -2502,6 +2853,28 @@ static void active_load_balance(runqueue_t *busiest_rq, int busiest_cpu)
 /* Don't have all balancing operations going off at once */
 #define CPU_OFFSET(cpu) (HZ * cpu / NR_CPUS)
 
+#ifdef CONFIG_NO_IDLE_HZ
+/*
+ * Tickless idle cpus don't run rebalance_tick(), so nothing would ever
+ * pull work over to them. When this cpu is overloaded at balance time,
+ * kick one of them in the domain: it goes through schedule() and
+ * idle_balance() and comes back with a task.
+ */
+static void nohz_kick_idle(int this_cpu, struct sched_domain *sd)
+{
+	cpumask_t mask;
+
+	cpus_and(mask, sd->span, nohz_cpu_mask);
+	cpu_clear(this_cpu, mask);
+	if (!cpus_empty(mask))
+		resched_task(cpu_rq(first_cpu(mask))->idle);
+}
+#else
+static inline void nohz_kick_idle(int this_cpu, struct sched_domain *sd)
+{
+}
+#endif
+
 /**
  * жƽ⺯ÿξһʱӽʱscheduler_tická
  * this_cpu-CPU±ꡣ
@@ -2565,6 +2938,8 @@ static void rebalance_tick(int this_cpu, runqueue_t *this_rq,
 				/* We've pulled tasks over so no longer idle */
 				idle = NOT_IDLE;
 			}
+			if (idle == NOT_IDLE && this_rq->nr_running > 1)
+				nohz_kick_idle(this_cpu, sd);
 			sd->last_balance += interval;
 		}
 	}
@@ -2823,6 +3198,7 @@ void scheduler_tick(void)
 	 * תΪTSCĵǰֵ뱾жеtimestamp_last_tickСʱsched_clocká
 	 */
 	rq->timestamp_last_tick = sched_clock();
+	psi_tick(rq->nr_running, atomic_read(&rq->nr_iowait));
 
 	/**
 	 * 鵱ǰǷidle̡
@@ -2841,6 +3217,22 @@ void scheduler_tick(void)
 		return;
 	}
 
+	/* SCHED_DEADLINE tasks are charged against their budget instead: */
+	if (dl_queued(p)) {
+		spin_lock(&rq->lock);
+		task_tick_dl(rq, p);
+		spin_unlock(&rq->lock);
+		goto out;
+	}
+
+	/* SCHED_FAIR tasks do not use the timeslice machinery below: */
+	if (fair_queued(p)) {
+		spin_lock(&rq->lock);
+		task_tick_fair(rq);
+		spin_unlock(&rq->lock);
+		goto out;
+	}
+
 	/* Task might have expired already, but not scheduled off yet */
 	/**
 	 * current->arrayǷָ򱾵жеĻ
@@ -2854,6 +3246,8 @@ void scheduler_tick(void)
 	 * же
 	 */
 	spin_lock(&rq->lock);
+	if (rq->cfs.nr_running)
+		task_tick_fair(rq);
 	/*
 	 * The task was running during this tick - update the
 	 * time slice counter. Note: we do not update a thread's
@@ -3125,24 +3519,33 @@ static inline int dependent_sleeper(int this_cpu, runqueue_t *this_rq)
 }
 #endif
 
-#if defined(CONFIG_PREEMPT) && defined(CONFIG_DEBUG_PREEMPT)
+#if defined(CONFIG_DEBUG_PREEMPT) || defined(CONFIG_PREEMPT_TRACER)
 
 void fastcall add_preempt_count(int val)
 {
+#ifdef CONFIG_DEBUG_PREEMPT
 	/*
 	 * Underflow?
 	 */
 	BUG_ON(((int)preempt_count() < 0));
+#endif
 	preempt_count() += val;
+#ifdef CONFIG_DEBUG_PREEMPT
 	/*
 	 * Spinlock count overflowing soon?
 	 */
 	BUG_ON((preempt_count() & PREEMPT_MASK) >= PREEMPT_MASK-10);
+#endif
+#ifdef CONFIG_PREEMPT_TRACER
+	if (preempt_count() == val)
+		trace_preempt_off((unsigned long)__builtin_return_address(0));
+#endif
 }
 EXPORT_SYMBOL(add_preempt_count);
 
 void fastcall sub_preempt_count(int val)
 {
+#ifdef CONFIG_DEBUG_PREEMPT
 	/*
 	 * Underflow?
 	 */
@@ -3151,6 +3554,11 @@ void fastcall sub_preempt_count(int val)
 	 * Is the spinlock portion underflowing?
 	 */
 	BUG_ON((val < PREEMPT_MASK) && !(preempt_count() & PREEMPT_MASK));
+#endif
+#ifdef CONFIG_PREEMPT_TRACER
+	if (preempt_count() == val)
+		trace_preempt_on((unsigned long)__builtin_return_address(0));
+#endif
 	preempt_count() -= val;
 }
 EXPORT_SYMBOL(sub_preempt_count);
@@ -3193,6 +3601,15 @@ asmlinkage void __sched schedule(void)
 	}
 	profile_hit(SCHED_PROFILING, __builtin_return_address(0));
 
+#ifdef CONFIG_NO_HZ_FULL
+	/*
+	 * Restart a stopped tick while current is still the task its
+	 * missed ticks belong to.
+	 */
+	if (unlikely(cpu_isset(_smp_processor_id(), nohz_busy_cpu_mask)))
+		start_hz_timer();
+#endif
+
 need_resched:
 	/**
 	 * ȽֹռٳʼһЩ
@@ -3248,6 +3665,11 @@ need_resched_nonpreemptible:
 	if (unlikely(prev->flags & PF_DEAD))
 		prev->state = EXIT_DEAD;
 
+	/* Charge prev before it is dequeued or something else is picked: */
+	update_curr_dl(rq, now);
+	if (rq->cfs.nr_running)
+		update_curr_fair(rq, now);
+
 	switch_count = &prev->nivcsw;
 	/**
 	 * ̲TASK_RUNNING״̬ûбںռͰѸý̴жɾ
@@ -3264,6 +3686,18 @@ need_resched_nonpreemptible:
 			if (prev->state == TASK_UNINTERRUPTIBLE)
 				rq->nr_uninterruptible++;
 			deactivate_task(prev, rq);
+			/*
+			 * A workqueue worker blocking in a work function may
+			 * have to hand the rest of its pool's work over.
+			 */
+			if (prev->flags & PF_WQ_WORKER) {
+				task_t *to_wakeup;
+
+				to_wakeup = wq_worker_sleeping(prev,
+							smp_processor_id());
+				if (to_wakeup)
+					try_to_wake_up_local(to_wakeup);
+			}
 		}
 	}
 
@@ -3313,6 +3747,22 @@ go_idle:
 	/**
 	 * еˣ˵ж߳̿ɱС
 	 */
+	if (rq->dl.nr_running) {
+		next = pick_next_task_dl(rq);
+		if (next)
+			goto switch_tasks;
+	}
+	if (rq->cfs.nr_running) {
+		next = pick_next_task_fair(rq);
+		if (next)
+			goto switch_tasks;
+	}
+	if (unlikely(!rq->cfs.nr_o1)) {
+		/* Only throttled tasks are left: */
+		next = rq->idle;
+		goto switch_tasks;
+	}
+
 	array = rq->active;
 	if (unlikely(!array->nr_active)) {
 		/**
@@ -3362,6 +3812,8 @@ go_idle:
 	}
 	next->activated = 0;
 switch_tasks:
+	set_next_dl(rq, next, now);
+	set_next_entity(rq, next, now);
 	/**
 	 * еʼнлˡ
 	 */
@@ -4060,20 +4512,67 @@ static void __setscheduler(struct task_struct *p, int policy, int prio)
 	BUG_ON(p->array);
 	p->policy = policy;
 	p->rt_priority = prio;
-	if (policy != SCHED_NORMAL)
+	if (policy == SCHED_DEADLINE)
+		p->prio = MAX_DL_PRIO-1;
+	else if (rt_policy(policy))
 		p->prio = MAX_USER_RT_PRIO-1 - p->rt_priority;
 	else
 		p->prio = p->static_prio;
+	/* Don't drop an inherited boost: */
+	if (p->pi_prio < p->prio)
+		p->prio = p->pi_prio;
+	if (dl_prio(p->prio) && policy != SCHED_DEADLINE)
+		p->prio = 0;
 }
 
 /**
- * sched_setscheduler - change the scheduling policy and/or RT priority of
- * a thread.
- * @p: the task in question.
- * @policy: new policy.
- * @param: structure containing the new RT priority.
+ * rt_mutex_setprio - set the priority inherited from rt_mutex waiters
+ * @p: the task
+ * @prio: the inherited priority, MAX_PRIO to drop the boost
+ *
+ * Called by the rt_mutex code with its pi lock held. The task is
+ * requeued on its prio array just like set_user_nice() does.
  */
-int sched_setscheduler(struct task_struct *p, int policy, struct sched_param *param)
+void rt_mutex_setprio(task_t *p, int prio)
+{
+	unsigned long flags;
+	prio_array_t *array;
+	runqueue_t *rq;
+	int oldprio;
+
+	rq = task_rq_lock(p, &flags);
+
+	oldprio = p->prio;
+	array = p->array;
+	if (array)
+		dequeue_task(p, array);
+	p->pi_prio = prio;
+	p->prio = effective_prio(p);
+
+	if (array) {
+		/*
+		 * A boosted task must not sit out the rest of the
+		 * epoch in the expired array:
+		 */
+		if (rt_task(p))
+			array = rq->active;
+		enqueue_task(p, array);
+		if (task_running(rq, p)) {
+			if (p->prio > oldprio)
+				resched_task(rq->curr);
+		} else if (TASK_PREEMPTS_CURR(p, rq))
+			resched_task(rq->curr);
+	}
+	task_rq_unlock(rq, &flags);
+}
+
+/*
+ * Common part of sched_setscheduler() and sched_setattr(); @attr is
+ * only needed for SCHED_DEADLINE.
+ */
+static int __sched_setscheduler(struct task_struct *p, int policy,
+				struct sched_param *param,
+				struct sched_attr *attr)
 {
 	int retval;
 	int oldprio, oldpolicy = -1;
@@ -4086,20 +4585,29 @@ recheck:
 	if (policy < 0)
 		policy = oldpolicy = p->policy;
 	else if (policy != SCHED_FIFO && policy != SCHED_RR &&
-				policy != SCHED_NORMAL)
+			policy != SCHED_NORMAL && policy != SCHED_FAIR &&
+			policy != SCHED_DEADLINE)
 			return -EINVAL;
+	/*
+	 * The deadline parameters only come with sched_setattr().  Check
+	 * them here, once the policy is known: a task that already is
+	 * SCHED_DEADLINE keeps it with a policy of -1.
+	 */
+	if (policy == SCHED_DEADLINE && (!attr || !dl_param_valid(attr)))
+		return -EINVAL;
 	/*
 	 * Valid priorities for SCHED_FIFO and SCHED_RR are
-	 * 1..MAX_USER_RT_PRIO-1, valid priority for SCHED_NORMAL is 0.
+	 * 1..MAX_USER_RT_PRIO-1, valid priority for SCHED_NORMAL,
+	 * SCHED_FAIR and SCHED_DEADLINE is 0.
 	 */
 	if (param->sched_priority < 0 ||
 	    param->sched_priority > MAX_USER_RT_PRIO-1)
 		return -EINVAL;
-	if ((policy == SCHED_NORMAL) != (param->sched_priority == 0))
+	if (rt_policy(policy) != (param->sched_priority != 0))
 		return -EINVAL;
 
-	if ((policy == SCHED_FIFO || policy == SCHED_RR) &&
-	    !capable(CAP_SYS_NICE))
+	if ((rt_policy(policy) || policy == SCHED_DEADLINE) &&
+			!capable(CAP_SYS_NICE))
 		return -EPERM;
 	if ((current->euid != p->euid) && (current->euid != p->uid) &&
 	    !capable(CAP_SYS_NICE))
@@ -4119,10 +4627,18 @@ recheck:
 		task_rq_unlock(rq, &flags);
 		goto recheck;
 	}
+	/* Admission control, with the policy of p stable under rq->lock: */
+	retval = dl_overflow(p, policy, attr);
+	if (retval) {
+		task_rq_unlock(rq, &flags);
+		return retval;
+	}
 	array = p->array;
 	if (array)
 		deactivate_task(p, rq);
 	oldprio = p->prio;
+	if (policy == SCHED_DEADLINE)
+		__setparam_dl(p, attr);
 	__setscheduler(p, policy, param->sched_priority);
 	if (array) {
 		__activate_task(p, rq);
@@ -4140,8 +4656,52 @@ recheck:
 	task_rq_unlock(rq, &flags);
 	return 0;
 }
+
+/**
+ * sched_setscheduler - change the scheduling policy and/or RT priority of
+ * a thread.
+ * @p: the task in question.
+ * @policy: new policy.
+ * @param: structure containing the new RT priority.
+ */
+int sched_setscheduler(struct task_struct *p, int policy, struct sched_param *param)
+{
+	return __sched_setscheduler(p, policy, param, NULL);
+}
 EXPORT_SYMBOL_GPL(sched_setscheduler);
 
+/**
+ * sched_setattr - change the scheduling policy and parameters of a thread
+ * @p: the task in question.
+ * @attr: the new policy, and its nice level, RT priority or
+ *	  SCHED_DEADLINE parameters.
+ *
+ * Returns -EBUSY if the SCHED_DEADLINE reservation does not fit.
+ */
+int sched_setattr(struct task_struct *p, struct sched_attr *attr)
+{
+	struct sched_param param = { .sched_priority = attr->sched_priority };
+	int policy = attr->sched_policy;
+	int retval;
+
+	if (attr->sched_flags)
+		return -EINVAL;
+	if (policy == SCHED_NORMAL || policy == SCHED_FAIR) {
+		if (attr->sched_nice < -20 || attr->sched_nice > 19)
+			return -EINVAL;
+		if (attr->sched_nice < task_nice(p) && !capable(CAP_SYS_NICE))
+			return -EPERM;
+	}
+
+	retval = __sched_setscheduler(p, policy, &param, attr);
+	if (retval)
+		return retval;
+	if (policy == SCHED_NORMAL || policy == SCHED_FAIR)
+		set_user_nice(p, attr->sched_nice);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sched_setattr);
+
 /**
  * ʵsys_sched_setschedulerϵͳá
  * ɲpolicyָĵȲԺɲparam->sched_priorityָȼǷЧ
@@ -4258,6 +4818,93 @@ out_unlock:
 	return retval;
 }
 
+/**
+ * sys_sched_setattr - set/change the scheduling policy and parameters
+ * @pid: the pid in question.
+ * @uattr: structure containing the policy and its parameters.
+ * @flags: for future extension, must be 0.
+ */
+asmlinkage long sys_sched_setattr(pid_t pid, struct sched_attr __user *uattr,
+				  unsigned int flags)
+{
+	struct sched_attr attr;
+	struct task_struct *p;
+	u32 size;
+	int retval;
+
+	if (!uattr || pid < 0 || flags)
+		return -EINVAL;
+	if (get_user(size, &uattr->size))
+		return -EFAULT;
+	if (size < SCHED_ATTR_SIZE_VER0)
+		return -EINVAL;
+	if (copy_from_user(&attr, uattr, sizeof(attr)))
+		return -EFAULT;
+	/* A negative policy would mean "keep the current one" below */
+	if ((int)attr.sched_policy < 0)
+		return -EINVAL;
+
+	read_lock_irq(&tasklist_lock);
+	p = find_process_by_pid(pid);
+	if (!p) {
+		read_unlock_irq(&tasklist_lock);
+		return -ESRCH;
+	}
+	retval = sched_setattr(p, &attr);
+	read_unlock_irq(&tasklist_lock);
+	return retval;
+}
+
+/**
+ * sys_sched_getattr - get the scheduling policy and parameters
+ * @pid: the pid in question.
+ * @uattr: structure to store the policy and its parameters in.
+ * @size: sizeof(*uattr) as userspace knows it.
+ * @flags: for future extension, must be 0.
+ */
+asmlinkage long sys_sched_getattr(pid_t pid, struct sched_attr __user *uattr,
+				  unsigned int size, unsigned int flags)
+{
+	struct sched_attr attr;
+	int retval = -EINVAL;
+	task_t *p;
+
+	if (!uattr || pid < 0 || flags || size < SCHED_ATTR_SIZE_VER0)
+		goto out_nounlock;
+
+	read_lock(&tasklist_lock);
+	p = find_process_by_pid(pid);
+	retval = -ESRCH;
+	if (!p)
+		goto out_unlock;
+
+	retval = security_task_getscheduler(p);
+	if (retval)
+		goto out_unlock;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.sched_policy = p->policy;
+	if (p->policy == SCHED_DEADLINE) {
+		attr.sched_runtime = p->dl.dl_runtime;
+		attr.sched_deadline = p->dl.dl_deadline;
+		attr.sched_period = p->dl.dl_period;
+	} else if (rt_policy(p->policy))
+		attr.sched_priority = p->rt_priority;
+	else
+		attr.sched_nice = task_nice(p);
+	read_unlock(&tasklist_lock);
+
+	retval = copy_to_user(uattr, &attr, sizeof(attr)) ? -EFAULT : 0;
+
+out_nounlock:
+	return retval;
+
+out_unlock:
+	read_unlock(&tasklist_lock);
+	return retval;
+}
+
 long sched_setaffinity(pid_t pid, cpumask_t new_mask)
 {
 	task_t *p;
@@ -4403,6 +5050,14 @@ asmlinkage long sys_sched_yield(void)
 	prio_array_t *target = rq->expired;
 
 	schedstat_inc(rq, yld_cnt);
+	if (dl_queued(current)) {
+		yield_task_dl(rq, current);
+		goto out;
+	}
+	if (fair_queued(current)) {
+		yield_task_fair(rq, current);
+		goto out;
+	}
 	/*
 	 * We implement yielding by moving the task into the expired
 	 * queue.
@@ -4429,6 +5084,7 @@ asmlinkage long sys_sched_yield(void)
 		 */
 		requeue_task(current, array);
 
+out:
 	/*
 	 * Since we are going to call schedule() anyway, there's
 	 * no need to preempt or enable interrupts:
@@ -4536,9 +5192,11 @@ void __sched io_schedule(void)
 {
 	struct runqueue *rq = &per_cpu(runqueues, _smp_processor_id());
 
+	delayacct_blkio_start();
 	atomic_inc(&rq->nr_iowait);
 	schedule();
 	atomic_dec(&rq->nr_iowait);
+	delayacct_blkio_end();
 }
 
 EXPORT_SYMBOL(io_schedule);
@@ -4548,9 +5206,11 @@ long __sched io_schedule_timeout(long timeout)
 	struct runqueue *rq = &per_cpu(runqueues, _smp_processor_id());
 	long ret;
 
+	delayacct_blkio_start();
 	atomic_inc(&rq->nr_iowait);
 	ret = schedule_timeout(timeout);
 	atomic_dec(&rq->nr_iowait);
+	delayacct_blkio_end();
 	return ret;
 }
 
@@ -4571,6 +5231,8 @@ asmlinkage long sys_sched_get_priority_max(int policy)
 		ret = MAX_USER_RT_PRIO-1;
 		break;
 	case SCHED_NORMAL:
+	case SCHED_FAIR:
+	case SCHED_DEADLINE:
 		ret = 0;
 		break;
 	}
@@ -4594,6 +5256,8 @@ asmlinkage long sys_sched_get_priority_min(int policy)
 		ret = 1;
 		break;
 	case SCHED_NORMAL:
+	case SCHED_FAIR:
+	case SCHED_DEADLINE:
 		ret = 0;
 	}
 	return ret;
@@ -4627,7 +5291,8 @@ long sys_sched_rr_get_interval(pid_t pid, struct timespec __user *interval)
 	if (retval)
 		goto out_unlock;
 
-	jiffies_to_timespec(p->policy & SCHED_FIFO ?
+	jiffies_to_timespec(p->policy == SCHED_FIFO ||
+				p->policy == SCHED_DEADLINE ?
 				0 : task_timeslice(p), &t);
 	read_unlock(&tasklist_lock);
 	retval = copy_to_user(interval, &t, sizeof(t)) ? -EFAULT : 0;
@@ -4769,6 +5434,78 @@ void __devinit init_idle(task_t *idle, int cpu)
  */
 cpumask_t nohz_cpu_mask = CPU_MASK_NONE;
 
+/*
+ * Cpus running a single task with their tick stopped (CONFIG_NO_HZ_FULL).
+ * Unlike idle ones they are not in nohz_cpu_mask: the task may enter the
+ * kernel at any time, so rcu keeps waiting for them and kicks them out
+ * of this state when a grace period starts.
+ */
+cpumask_t nohz_busy_cpu_mask = CPU_MASK_NONE;
+
+#ifdef CONFIG_NO_HZ_FULL
+/* Cpus named with nohz_full=, never cpu 0 */
+cpumask_t nohz_full_mask = CPU_MASK_NONE;
+
+/*
+ * nohz_full cpus are isolated from load balancing like isolcpus= ones,
+ * and may stop their tick while running a single task in user mode.
+ */
+static int __init nohz_full_setup(char *str)
+{
+	int ints[NR_CPUS], i;
+
+	str = get_options(str, ARRAY_SIZE(ints), ints);
+	cpus_clear(nohz_full_mask);
+	for (i = 1; i <= ints[0]; i++)
+		if (ints[i] > 0 && ints[i] < NR_CPUS)
+			cpu_set(ints[i], nohz_full_mask);
+	return 1;
+}
+
+__setup("nohz_full=", nohz_full_setup);
+
+/*
+ * Called by the architecture from the local tick, with interrupts
+ * disabled: may this cpu run without the tick? Only if its single
+ * runnable task needs nothing the tick does for it.
+ */
+int sched_can_stop_tick(void)
+{
+	runqueue_t *rq = this_rq();
+	task_t *p = current;
+
+	if (!cpu_isset(smp_processor_id(), nohz_full_mask))
+		return 0;
+	if (rq->nr_running != 1 || p == rq->idle || need_resched())
+		return 0;
+	/* CBS runtime is only enforced from the tick */
+	if (dl_task(p))
+		return 0;
+	/* itimers and RLIMIT_CPU are only checked from the tick */
+	if (!cputime_eq(p->it_virt_value, cputime_zero) ||
+	    !cputime_eq(p->it_prof_value, cputime_zero))
+		return 0;
+	return p->signal->rlim[RLIMIT_CPU].rlim_cur == RLIM_INFINITY;
+}
+
+/*
+ * @p was just given something sched_can_stop_tick() says only the tick
+ * enforces.  If it runs tickless, the tick must come back: it entered
+ * the kernel by a syscall, which does not restart it.
+ */
+void nohz_full_kick_task(task_t *p)
+{
+	int cpu = get_cpu();
+
+	if (task_cpu(p) == cpu) {
+		if (cpu_isset(cpu, nohz_busy_cpu_mask))
+			start_hz_timer();
+	} else
+		nohz_full_kick(task_cpu(p));
+	put_cpu();
+}
+#endif
+
 #ifdef CONFIG_SMP
 /*
  * This is how migration works:
@@ -5098,6 +5835,19 @@ static void migrate_dead_tasks(unsigned int dead_cpu)
 							run_list));
 		}
 	}
+#ifdef CONFIG_FAIR_GROUP_SCHED
+	{
+		struct cfs_rq *cfs;
+
+		list_for_each_entry(cfs, &rq->cfs_rqs, list)
+			if (cfs->throttled)
+				unthrottle_cfs_rq(cfs, rq->timestamp_last_tick);
+	}
+#endif
+	while (rq->cfs.nr_running)
+		migrate_dead(dead_cpu, first_fair_task(rq));
+	while (rq->dl.nr_running)
+		migrate_dead(dead_cpu, first_dl_task(rq));
 }
 #endif /* CONFIG_HOTPLUG_CPU */
 
@@ -5457,6 +6207,9 @@ static void __devinit arch_init_sched_domains(void)
 	 * exclude other special cases in the future.
 	 */
 	cpus_complement(cpu_default_map, cpu_isolated_map);
+#ifdef CONFIG_NO_HZ_FULL
+	cpus_andnot(cpu_default_map, cpu_default_map, nohz_full_mask);
+#endif
 	cpus_and(cpu_default_map, cpu_default_map, cpu_online_map);
 
 	/*
@@ -5633,6 +6386,349 @@ void __init sched_init_smp(void)
 }
 #endif /* CONFIG_SMP */
 
+#ifdef CONFIG_FAIR_GROUP_SCHED
+/*
+ * Task groups.  Tasks of the root group have p->sched_group == NULL and
+ * are queued on rq->cfs directly.  task_group_lock protects the
+ * hierarchy, p->sched_group and nr_tasks; it nests outside rq->lock.
+ */
+struct task_group root_task_group = {
+	.siblings	= LIST_HEAD_INIT(root_task_group.siblings),
+	.children	= LIST_HEAD_INIT(root_task_group.children),
+	.shares		= NICE_0_LOAD,
+	.bandwidth_lock	= SPIN_LOCK_UNLOCKED,
+	.quota		= RUNTIME_INF,
+};
+
+static DEFINE_SPINLOCK(task_group_lock);
+
+/* Limits of cpu.shares, cpu.cfs_period_us and cpu.cfs_quota_us: */
+#define MIN_SHARES		2UL
+#define MAX_SHARES		(1UL << 18)
+#define MIN_CFS_PERIOD		1000000ULL	/* 1ms */
+#define MAX_CFS_PERIOD		1000000000ULL	/* 1s */
+#define DEF_CFS_PERIOD		100000000ULL	/* 100ms */
+
+/*
+ * Period timer of a group with a quota: hand every CPU its quota for
+ * the new period, and put the queues that were throttled back.
+ */
+static void sched_group_period_timer(unsigned long data)
+{
+	struct task_group *tg = (struct task_group *)data;
+	unsigned long long quota, period;
+	unsigned long flags;
+	struct cfs_rq *cfs;
+	runqueue_t *rq;
+	int i;
+
+	spin_lock_irqsave(&tg->bandwidth_lock, flags);
+	quota = tg->quota;
+	period = tg->period;
+	spin_unlock_irqrestore(&tg->bandwidth_lock, flags);
+	if (quota == RUNTIME_INF)
+		return;
+
+	for_each_online_cpu(i) {
+		rq = cpu_rq(i);
+		cfs = tg->cfs_rq[i];
+
+		spin_lock_irqsave(&rq->lock, flags);
+		cfs->runtime_remaining += quota;
+		if (cfs->runtime_remaining > (long long)quota)
+			cfs->runtime_remaining = quota;
+		if (cfs->throttled && cfs->runtime_remaining > 0) {
+			unthrottle_cfs_rq(cfs, rq->timestamp_last_tick);
+			resched_task(rq->curr);
+		}
+		spin_unlock_irqrestore(&rq->lock, flags);
+	}
+	do_div(period, NSEC_PER_SEC / HZ);
+	mod_timer(&tg->period_timer, jiffies + (period ? : 1));
+}
+
+/**
+ * sched_create_group - create a task group below @parent
+ * @parent: the parent group, &root_task_group for a top level group
+ *
+ * The new group has NICE_0_LOAD shares and no quota.
+ */
+struct task_group *sched_create_group(struct task_group *parent)
+{
+	struct task_group *tg;
+	struct cfs_rq *cfs;
+	struct sched_entity *se;
+	unsigned long flags;
+	runqueue_t *rq;
+	int i;
+
+	tg = kmalloc(sizeof(*tg), GFP_KERNEL);
+	if (!tg)
+		return ERR_PTR(-ENOMEM);
+	memset(tg, 0, sizeof(*tg));
+
+	for_each_cpu(i) {
+		cfs = kmalloc(sizeof(*cfs), GFP_KERNEL);
+		se = kmalloc(sizeof(*se), GFP_KERNEL);
+		if (!cfs || !se) {
+			kfree(cfs);
+			kfree(se);
+			goto err;
+		}
+		memset(cfs, 0, sizeof(*cfs));
+		memset(se, 0, sizeof(*se));
+		tg->cfs_rq[i] = cfs;
+		tg->se[i] = se;
+	}
+
+	tg->parent = parent;
+	INIT_LIST_HEAD(&tg->children);
+	tg->shares = NICE_0_LOAD;
+	spin_lock_init(&tg->bandwidth_lock);
+	tg->quota = RUNTIME_INF;
+	tg->period = DEF_CFS_PERIOD;
+	init_timer(&tg->period_timer);
+	tg->period_timer.function = sched_group_period_timer;
+	tg->period_timer.data = (unsigned long)tg;
+
+	for_each_cpu(i) {
+		cfs = tg->cfs_rq[i];
+		se = tg->se[i];
+
+		cfs->tasks_timeline = RB_ROOT;
+		cfs->tg = tg;
+		cfs->se = se;
+		cfs->depth = parent->cfs_rq[i]->depth + 1;
+		se->cfs_rq = parent->cfs_rq[i];
+		se->my_q = cfs;
+		se->load_weight = tg->shares;
+
+		rq = cpu_rq(i);
+		spin_lock_irqsave(&rq->lock, flags);
+		list_add_tail(&cfs->list, &rq->cfs_rqs);
+		spin_unlock_irqrestore(&rq->lock, flags);
+	}
+
+	spin_lock_irqsave(&task_group_lock, flags);
+	list_add(&tg->siblings, &parent->children);
+	spin_unlock_irqrestore(&task_group_lock, flags);
+	return tg;
+
+err:
+	for_each_cpu(i) {
+		kfree(tg->cfs_rq[i]);
+		kfree(tg->se[i]);
+	}
+	kfree(tg);
+	return ERR_PTR(-ENOMEM);
+}
+
+/**
+ * sched_destroy_group - free an empty task group
+ * @tg: the group
+ *
+ * Returns -EBUSY if tasks or child groups still refer to @tg.
+ */
+int sched_destroy_group(struct task_group *tg)
+{
+	unsigned long flags;
+	runqueue_t *rq;
+	int i;
+
+	spin_lock_irqsave(&task_group_lock, flags);
+	if (tg->nr_tasks || !list_empty(&tg->children)) {
+		spin_unlock_irqrestore(&task_group_lock, flags);
+		return -EBUSY;
+	}
+	list_del(&tg->siblings);
+	spin_unlock_irqrestore(&task_group_lock, flags);
+
+	spin_lock_irqsave(&tg->bandwidth_lock, flags);
+	tg->quota = RUNTIME_INF;
+	spin_unlock_irqrestore(&tg->bandwidth_lock, flags);
+	del_timer_sync(&tg->period_timer);
+
+	/* Without tasks, none of the queues has anything queued: */
+	for_each_cpu(i) {
+		rq = cpu_rq(i);
+		spin_lock_irqsave(&rq->lock, flags);
+		list_del(&tg->cfs_rq[i]->list);
+		spin_unlock_irqrestore(&rq->lock, flags);
+		kfree(tg->cfs_rq[i]);
+		kfree(tg->se[i]);
+	}
+	kfree(tg);
+	return 0;
+}
+
+/**
+ * sched_move_task - move a task to another group
+ * @p: the task
+ * @tg: the new group
+ *
+ * Only SCHED_FAIR tasks are scheduled by group; other tasks just
+ * remember their group for when they switch to SCHED_FAIR.
+ */
+int sched_move_task(task_t *p, struct task_group *tg)
+{
+	struct task_group *old;
+	unsigned long flags, rq_flags;
+	prio_array_t *array;
+	runqueue_t *rq;
+
+	if (tg == &root_task_group)
+		tg = NULL;
+
+	spin_lock_irqsave(&task_group_lock, flags);
+	if (p->flags & PF_EXITING) {
+		spin_unlock_irqrestore(&task_group_lock, flags);
+		return -ESRCH;
+	}
+	old = p->sched_group;
+	if (tg)
+		tg->nr_tasks++;
+
+	rq = task_rq_lock(p, &rq_flags);
+	array = p->array;
+	if (array)
+		dequeue_task(p, array);
+	p->sched_group = tg;
+	if (array) {
+		enqueue_task(p, array);
+		if (!task_running(rq, p) && TASK_PREEMPTS_CURR(p, rq))
+			resched_task(rq->curr);
+	}
+	task_rq_unlock(rq, &rq_flags);
+
+	if (old)
+		old->nr_tasks--;
+	spin_unlock_irqrestore(&task_group_lock, flags);
+	return 0;
+}
+
+/* Called from dup_task_struct(): the child starts in the parent's group. */
+void sched_group_fork(task_t *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&task_group_lock, flags);
+	p->sched_group = current->sched_group;
+	if (p->sched_group)
+		p->sched_group->nr_tasks++;
+	spin_unlock_irqrestore(&task_group_lock, flags);
+}
+
+/* Called from free_task(), when @p cannot be on a runqueue any more. */
+void sched_group_free(task_t *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&task_group_lock, flags);
+	if (p->sched_group)
+		p->sched_group->nr_tasks--;
+	spin_unlock_irqrestore(&task_group_lock, flags);
+}
+
+/* The group of @p, for reporting it: */
+struct task_group *sched_task_group(task_t *p)
+{
+	return p->sched_group ? : &root_task_group;
+}
+
+int sched_group_set_shares(struct task_group *tg, unsigned long shares)
+{
+	struct sched_entity *se;
+	unsigned long flags;
+	runqueue_t *rq;
+	int i;
+
+	if (tg == &root_task_group)
+		return -EINVAL;
+	if (shares < MIN_SHARES)
+		shares = MIN_SHARES;
+	if (shares > MAX_SHARES)
+		shares = MAX_SHARES;
+
+	tg->shares = shares;
+	for_each_cpu(i) {
+		rq = cpu_rq(i);
+		se = tg->se[i];
+		spin_lock_irqsave(&rq->lock, flags);
+		if (se->on_rq)
+			se->cfs_rq->load += shares - se->load_weight;
+		se->load_weight = shares;
+		spin_unlock_irqrestore(&rq->lock, flags);
+	}
+	return 0;
+}
+
+unsigned long sched_group_shares(struct task_group *tg)
+{
+	return tg->shares;
+}
+
+/**
+ * sched_group_set_bandwidth - limit the CPU time of a group
+ * @tg: the group
+ * @quota: runtime in ns the group may use on every CPU per period,
+ *	   RUNTIME_INF for no limit
+ * @period: the period in ns
+ */
+int sched_group_set_bandwidth(struct task_group *tg,
+			      unsigned long long quota,
+			      unsigned long long period)
+{
+	unsigned long flags;
+	struct cfs_rq *cfs;
+	runqueue_t *rq;
+	int i;
+
+	if (tg == &root_task_group)
+		return -EINVAL;
+	if (period < MIN_CFS_PERIOD || period > MAX_CFS_PERIOD)
+		return -EINVAL;
+	if (quota != RUNTIME_INF && (quota < MIN_CFS_PERIOD || quota > period))
+		return -EINVAL;
+
+	spin_lock_irqsave(&tg->bandwidth_lock, flags);
+	tg->quota = quota;
+	tg->period = period;
+	spin_unlock_irqrestore(&tg->bandwidth_lock, flags);
+
+	for_each_cpu(i) {
+		rq = cpu_rq(i);
+		cfs = tg->cfs_rq[i];
+		spin_lock_irqsave(&rq->lock, flags);
+		cfs->runtime_enabled = quota != RUNTIME_INF;
+		cfs->runtime_remaining = cfs->runtime_enabled ? quota : 0;
+		if (cfs->throttled) {
+			unthrottle_cfs_rq(cfs, rq->timestamp_last_tick);
+			resched_task(rq->curr);
+		}
+		spin_unlock_irqrestore(&rq->lock, flags);
+	}
+
+	if (quota == RUNTIME_INF)
+		del_timer_sync(&tg->period_timer);
+	else {
+		do_div(period, NSEC_PER_SEC / HZ);
+		mod_timer(&tg->period_timer, jiffies + (period ? : 1));
+	}
+	return 0;
+}
+
+void sched_group_bandwidth(struct task_group *tg, unsigned long long *quota,
+			   unsigned long long *period)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&tg->bandwidth_lock, flags);
+	*quota = tg->quota;
+	*period = tg->period;
+	spin_unlock_irqrestore(&tg->bandwidth_lock, flags);
+}
+#endif /* CONFIG_FAIR_GROUP_SCHED */
+
 int in_sched_functions(unsigned long addr)
 {
 	/* Linker adds these: start and end of __sched functions */
@@ -5655,6 +6751,22 @@ void __init sched_init(void)
 		rq->active = rq->arrays;
 		rq->expired = rq->arrays + 1;
 		rq->best_expired_prio = MAX_PRIO;
+		rq->dl.root = RB_ROOT;
+		rq->dl.rb_leftmost = NULL;
+		INIT_LIST_HEAD(&rq->dl.tasks);
+		rq->dl.curr = NULL;
+		rq->cfs.tasks_timeline = RB_ROOT;
+		rq->cfs.rb_leftmost = NULL;
+		rq->cfs.curr = NULL;
+		rq->cfs.running = NULL;
+		rq->cfs.o1.cfs_rq = &rq->cfs;
+		INIT_LIST_HEAD(&rq->cfs_rqs);
+		list_add(&rq->cfs.list, &rq->cfs_rqs);
+#ifdef CONFIG_FAIR_GROUP_SCHED
+		rq->cfs.tg = &root_task_group;
+		root_task_group.cfs_rq[i] = &rq->cfs;
+		root_task_group.se[i] = NULL;
+#endif
 
 #ifdef CONFIG_SMP
 		rq->sd = &sched_domain_dummy;
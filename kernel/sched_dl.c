@@ -0,0 +1,411 @@
+/*
+ * kernel/sched_dl.c
+ *
+ * SCHED_DEADLINE: earliest deadline first scheduling with a constant
+ * bandwidth server (CBS) for every task.
+ *
+ * A task asks for dl_runtime ns of CPU time within dl_deadline ns of
+ * the start of every dl_period.  Runnable SCHED_DEADLINE tasks are kept
+ * in a per-runqueue rbtree (rq->dl) ordered by absolute deadline, and
+ * run before every RT and SCHED_NORMAL/SCHED_FAIR task; the one with
+ * the earliest deadline runs first.
+ *
+ * The CBS is what keeps them from locking up the box: the CPU time a
+ * task uses is charged against its budget (dl.runtime), and a task
+ * that ran out of budget is throttled - taken out of the tree, though
+ * still queued - until the start of its next period, when dl_timer
+ * refills the budget and moves the deadline one period ahead.  A task
+ * waking up with more budget left than it could use before its
+ * deadline at its reserved bandwidth gets a fresh deadline instead.
+ *
+ * Admission control keeps the sum of dl_runtime/dl_period of all
+ * SCHED_DEADLINE tasks under sysctl_sched_dl_bandwidth percent of the
+ * online CPUs.  The tasks are not pushed or pulled between CPUs by the
+ * load balancer; they move only on wakeup and on affinity changes.
+ *
+ * This file is #included from kernel/sched.c, after sched_fair.c.
+ */
+
+/* Percentage of every CPU SCHED_DEADLINE tasks may reserve: */
+int sysctl_sched_dl_bandwidth = 95;
+
+#define DL_BW_SHIFT		20
+#define DL_MIN_RUNTIME		(1ULL << 10)		/* ~1us */
+#define DL_MAX_PERIOD		4000000000ULL		/* 4s, fits do_div() */
+
+/* Bandwidth reserved by all SCHED_DEADLINE tasks, << DL_BW_SHIFT: */
+static unsigned long long dl_total_bw;
+static DEFINE_SPINLOCK(dl_bw_lock);
+
+/*
+ * p->array of a queued SCHED_DEADLINE task, like fair_array.  Queued
+ * tasks are linked on rq->dl.tasks through p->run_list, throttled ones
+ * included.
+ */
+static prio_array_t dl_array;
+
+#define dl_queued(p)	((p)->array == &dl_array)
+
+static inline int dl_time_before(unsigned long long a, unsigned long long b)
+{
+	return (long long)(a - b) < 0;
+}
+
+/* runtime/period, << DL_BW_SHIFT; period is at most DL_MAX_PERIOD: */
+static inline unsigned long to_ratio(unsigned long long period,
+				     unsigned long long runtime)
+{
+	runtime <<= DL_BW_SHIFT;
+	do_div(runtime, (unsigned long)period);
+	return runtime;
+}
+
+static void __enqueue_dl_entity(struct dl_rq *dl, struct sched_dl_entity *dl_se)
+{
+	struct rb_node **link = &dl->root.rb_node;
+	struct rb_node *parent = NULL;
+	struct sched_dl_entity *entry;
+	int leftmost = 1;
+
+	while (*link) {
+		parent = *link;
+		entry = rb_entry(parent, struct sched_dl_entity, rb_node);
+		if (dl_time_before(dl_se->deadline, entry->deadline))
+			link = &parent->rb_left;
+		else {
+			link = &parent->rb_right;
+			leftmost = 0;
+		}
+	}
+	if (leftmost)
+		dl->rb_leftmost = &dl_se->rb_node;
+
+	rb_link_node(&dl_se->rb_node, parent, link);
+	rb_insert_color(&dl_se->rb_node, &dl->root);
+	dl_se->on_rq = 1;
+}
+
+static void __dequeue_dl_entity(struct dl_rq *dl, struct sched_dl_entity *dl_se)
+{
+	if (dl->rb_leftmost == &dl_se->rb_node)
+		dl->rb_leftmost = rb_next(&dl_se->rb_node);
+	rb_erase(&dl_se->rb_node, &dl->root);
+	dl_se->on_rq = 0;
+}
+
+/*
+ * Would the budget left last beyond the deadline at the reserved
+ * bandwidth, i.e. is runtime/(deadline-now) > dl_runtime/dl_period?
+ * Both sides are scaled down to keep the products within 64 bits.
+ */
+static int dl_entity_overflow(struct sched_dl_entity *dl_se,
+			      unsigned long long now)
+{
+	unsigned long long left, right;
+
+	if (!dl_time_before(now, dl_se->deadline))
+		return 1;
+	left = (dl_se->dl_period >> 10) * ((unsigned long long)dl_se->runtime >> 10);
+	right = ((dl_se->deadline - now) >> 10) * (dl_se->dl_runtime >> 10);
+	return left > right;
+}
+
+/* Start a new instance: full budget, deadline relative to now. */
+static inline void setup_new_dl_entity(struct sched_dl_entity *dl_se,
+				       unsigned long long now)
+{
+	dl_se->deadline = now + dl_se->dl_deadline;
+	dl_se->runtime = dl_se->dl_runtime;
+}
+
+/*
+ * Refill the budget of a throttled task: one dl_runtime per period its
+ * deadline is moved.  A task that fell behind by more than that starts
+ * over.
+ */
+static void replenish_dl_entity(struct sched_dl_entity *dl_se,
+				unsigned long long now)
+{
+	while (dl_se->runtime <= 0) {
+		dl_se->deadline += dl_se->dl_period;
+		dl_se->runtime += dl_se->dl_runtime;
+	}
+	if (dl_time_before(dl_se->deadline, now))
+		setup_new_dl_entity(dl_se, now);
+}
+
+static void resched_task(task_t *p);
+static void dl_timer_fn(unsigned long data);
+
+/*
+ * Arm dl_timer for the start of the next period of @p.  Returns 0 if
+ * that is already past, and the budget can be refilled right away.
+ * The timer holds a reference to @p.
+ */
+static int start_dl_timer(task_t *p, unsigned long long now)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+	unsigned long long act, delta;
+
+	act = dl_se->deadline - dl_se->dl_deadline + dl_se->dl_period;
+	if (!dl_time_before(now, act))
+		return 0;
+	delta = act - now;
+
+	do_div(delta, NSEC_PER_SEC / HZ);
+	dl_se->dl_throttled = 1;
+	get_task_struct(p);
+	dl_se->dl_timer.function = dl_timer_fn;
+	dl_se->dl_timer.data = (unsigned long)p;
+	dl_se->dl_timer.expires = jiffies + delta + 1;
+	add_timer(&dl_se->dl_timer);
+	return 1;
+}
+
+/*
+ * @p ran out of budget: take it out of the tree until dl_timer refills
+ * the budget.  It stays queued (p->array, rq->nr_running), so that it
+ * need not be woken again.
+ */
+static void throttle_dl_task(runqueue_t *rq, task_t *p,
+			     unsigned long long now)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	if (dl_se->on_rq)
+		__dequeue_dl_entity(&rq->dl, dl_se);
+	if (!start_dl_timer(p, now)) {
+		replenish_dl_entity(dl_se, now);
+		if (dl_queued(p))
+			__enqueue_dl_entity(&rq->dl, dl_se);
+	}
+	if (task_running(rq, p))
+		set_tsk_need_resched(p);
+}
+
+/* Charge the SCHED_DEADLINE task running on @rq, if any. */
+static void update_curr_dl(runqueue_t *rq, unsigned long long now)
+{
+	task_t *curr = rq->dl.curr;
+	long long delta;
+
+	if (!curr || curr->policy != SCHED_DEADLINE)
+		return;
+	delta = now - curr->dl.exec_start;
+	if (delta <= 0)
+		return;
+	curr->dl.exec_start = now;
+	curr->dl.runtime -= delta;
+	if (curr->dl.runtime <= 0 && !curr->dl.dl_throttled)
+		throttle_dl_task(rq, curr, now);
+}
+
+/*
+ * TASK_PREEMPTS_CURR() when a SCHED_DEADLINE task is involved.  They
+ * preempt everything else, and each other by earlier deadline; a
+ * throttled one preempts nobody.
+ */
+static int dl_preempts_curr(task_t *p, runqueue_t *rq)
+{
+	task_t *curr = rq->curr;
+
+	if (!dl_task(p) || !p->dl.on_rq)
+		return 0;
+	if (dl_task(curr) && curr->dl.on_rq)
+		return dl_time_before(p->dl.deadline, curr->dl.deadline);
+	return 1;
+}
+
+static void dl_timer_fn(unsigned long data)
+{
+	task_t *p = (task_t *)data;
+	struct sched_dl_entity *dl_se = &p->dl;
+	unsigned long flags;
+	runqueue_t *rq;
+
+	rq = task_rq_lock(p, &flags);
+	dl_se->dl_throttled = 0;
+	/* Left SCHED_DEADLINE while throttled: */
+	if (p->policy != SCHED_DEADLINE)
+		goto out;
+
+	replenish_dl_entity(dl_se, rq_clock(rq));
+	if (dl_queued(p) && !dl_se->on_rq) {
+		__enqueue_dl_entity(&rq->dl, dl_se);
+		if (!task_running(rq, p) && TASK_PREEMPTS_CURR(p, rq))
+			resched_task(rq->curr);
+	}
+out:
+	task_rq_unlock(rq, &flags);
+	put_task_struct(p);
+}
+
+static void enqueue_task_dl(runqueue_t *rq, task_t *p)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+	unsigned long long now = rq_clock(rq);
+
+	/* CBS wakeup rule: */
+	if (!dl_se->dl_throttled && dl_entity_overflow(dl_se, now))
+		setup_new_dl_entity(dl_se, now);
+
+	list_add_tail(&p->run_list, &rq->dl.tasks);
+	rq->dl.nr_running++;
+	p->array = &dl_array;
+	if (!dl_se->dl_throttled)
+		__enqueue_dl_entity(&rq->dl, dl_se);
+
+	/* Became SCHED_DEADLINE while running: */
+	if (task_running(rq, p)) {
+		rq->dl.curr = p;
+		dl_se->exec_start = now;
+	}
+}
+
+static void dequeue_task_dl(runqueue_t *rq, task_t *p)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	if (rq->dl.curr == p)
+		update_curr_dl(rq, rq_clock(rq));
+	if (dl_se->on_rq)
+		__dequeue_dl_entity(&rq->dl, dl_se);
+	list_del(&p->run_list);
+	rq->dl.nr_running--;
+}
+
+/* The SCHED_DEADLINE task with the earliest deadline, if not throttled: */
+static inline task_t *pick_next_task_dl(runqueue_t *rq)
+{
+	struct rb_node *node = rq->dl.rb_leftmost;
+
+	if (!node)
+		return NULL;
+	return container_of(rb_entry(node, struct sched_dl_entity, rb_node),
+			    task_t, dl);
+}
+
+/* Called by schedule() for the task it switches to: */
+static inline void set_next_dl(runqueue_t *rq, task_t *next,
+			       unsigned long long now)
+{
+	if (dl_queued(next)) {
+		rq->dl.curr = next;
+		next->dl.exec_start = now;
+	} else
+		rq->dl.curr = NULL;
+}
+
+/*
+ * Called from scheduler_tick() with the runqueue locked while a
+ * SCHED_DEADLINE task runs.
+ */
+static void task_tick_dl(runqueue_t *rq, task_t *p)
+{
+	update_curr_dl(rq, rq->timestamp_last_tick);
+	if (p->dl.on_rq && rq->dl.rb_leftmost != &p->dl.rb_node)
+		set_tsk_need_resched(p);
+}
+
+/* sched_yield(): give up the rest of the budget of this period. */
+static void yield_task_dl(runqueue_t *rq, task_t *p)
+{
+	unsigned long long now = rq_clock(rq);
+
+	update_curr_dl(rq, now);
+	if (p->dl.dl_throttled)
+		return;
+	p->dl.runtime = 0;
+	throttle_dl_task(rq, p, now);
+}
+
+/* Some SCHED_DEADLINE task on @rq, for migrating them off a dead CPU: */
+static inline task_t *first_dl_task(runqueue_t *rq)
+{
+	return list_entry(rq->dl.tasks.next, task_t, run_list);
+}
+
+/*
+ * Check the parameters of sched_setattr(): dl_runtime <= dl_deadline
+ * <= dl_period, a period of 0 meaning dl_deadline.
+ */
+static int dl_param_valid(struct sched_attr *attr)
+{
+	unsigned long long period = attr->sched_period ? : attr->sched_deadline;
+
+	if (attr->sched_runtime < DL_MIN_RUNTIME)
+		return 0;
+	if (attr->sched_deadline < attr->sched_runtime)
+		return 0;
+	if (period < attr->sched_deadline || period > DL_MAX_PERIOD)
+		return 0;
+	return 1;
+}
+
+/*
+ * Admission control: reserve the bandwidth @p needs under @policy and
+ * @attr, and release what it had.  Returns -EBUSY if that would exceed
+ * sysctl_sched_dl_bandwidth of the online CPUs.  Called with the
+ * runqueue of @p locked.
+ */
+static int dl_overflow(task_t *p, int policy, struct sched_attr *attr)
+{
+	unsigned long new_bw = 0, old_bw = p->dl.dl_bw;
+	unsigned long long cap;
+	int retval = 0;
+
+	if (policy == SCHED_DEADLINE)
+		new_bw = to_ratio(attr->sched_period ? : attr->sched_deadline,
+				  attr->sched_runtime);
+	if (new_bw == old_bw)
+		return 0;
+
+	cap = ((unsigned long long)num_online_cpus() *
+			sysctl_sched_dl_bandwidth) << DL_BW_SHIFT;
+	do_div(cap, 100);
+
+	spin_lock(&dl_bw_lock);
+	if (new_bw > old_bw && dl_total_bw - old_bw + new_bw > cap)
+		retval = -EBUSY;
+	else {
+		dl_total_bw = dl_total_bw - old_bw + new_bw;
+		p->dl.dl_bw = new_bw;
+	}
+	spin_unlock(&dl_bw_lock);
+	return retval;
+}
+
+/* Release the bandwidth of a task that is gone. */
+static void dl_release_bw(task_t *p)
+{
+	unsigned long flags;
+
+	if (!p->dl.dl_bw)
+		return;
+	spin_lock_irqsave(&dl_bw_lock, flags);
+	dl_total_bw -= p->dl.dl_bw;
+	p->dl.dl_bw = 0;
+	spin_unlock_irqrestore(&dl_bw_lock, flags);
+}
+
+/* Install the parameters of a task becoming (or staying) SCHED_DEADLINE. */
+static void __setparam_dl(task_t *p, struct sched_attr *attr)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	dl_se->dl_runtime = attr->sched_runtime;
+	dl_se->dl_deadline = attr->sched_deadline;
+	dl_se->dl_period = attr->sched_period ? : attr->sched_deadline;
+	/* Makes enqueue_task_dl() start a new instance: */
+	dl_se->runtime = 0;
+	dl_se->deadline = 0;
+}
+
+/* A forked task never inherits a reservation. */
+static inline void init_dl_entity(task_t *p)
+{
+	struct sched_dl_entity *dl_se = &p->dl;
+
+	memset(dl_se, 0, sizeof(*dl_se));
+	init_timer(&dl_se->dl_timer);
+}
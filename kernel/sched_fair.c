@@ -0,0 +1,658 @@
+/*
+ * kernel/sched_fair.c
+ *
+ * SCHED_FAIR: fair scheduling by weighted virtual runtime.
+ *
+ * Every runqueue keeps its runnable SCHED_FAIR tasks in an rbtree
+ * (rq->cfs.tasks_timeline) ordered by vruntime: the nanoseconds of CPU
+ * time an entity consumed, scaled by NICE_0_LOAD / its nice weight.
+ * The leftmost entity is the one the CPU is most owed to and runs
+ * next.  Time comes from sched_clock() rather than from the tick, and
+ * there are no sleep_avg heuristics: the share of a task only depends
+ * on its nice level.
+ *
+ * SCHED_FAIR tasks share the CPU with the O(1) arrays.  All tasks queued
+ * on rq->active and rq->expired are represented in the tree by a single
+ * pseudo-entity, rq->cfs.o1, weighted as one nice-0 task per queued
+ * task.  When it is leftmost schedule() picks from the O(1) arrays as
+ * it always did; RT tasks preempt everything as before.
+ *
+ * While an entity is not queued its vruntime is kept relative to the
+ * min_vruntime of the runqueue it left, so it can be queued again on
+ * any CPU.
+ *
+ * With CONFIG_FAIR_GROUP_SCHED, tasks can be put into a hierarchy of
+ * task groups.  A group has a cfs_rq of its own on every CPU, and is
+ * queued on its parent's cfs_rq of that CPU through a group entity
+ * weighted by the group's shares.  A group can also be given a CPU
+ * quota per period; a group cfs_rq that used up its quota on a CPU is
+ * throttled (its entity taken off the parent) until the period timer
+ * refills it.  Each cfs_rq has its own curr: the entities from the
+ * running task up to the root form the running chain, whose leaf is
+ * rq->cfs.running.
+ *
+ * This file is #included from kernel/sched.c.
+ */
+
+/*
+ * Targeted period in which every runnable entity runs once, and the
+ * minimal slice it gets when there are too many of them (both in ns):
+ */
+unsigned int sysctl_sched_latency = 20000000U;
+unsigned int sysctl_sched_min_granularity = 4000000U;
+
+/*
+ * How far (in ns of nice-0 runtime) a waking task has to be behind
+ * current before it preempts it.  Limits over-scheduling.
+ */
+unsigned int sysctl_sched_wakeup_granularity = 5000000U;
+
+#define NICE_0_LOAD		1024
+
+/*
+ * Nice levels are multiplicative, with a gentle 10% change for every
+ * nice level changed: a task that goes up by one level gets ~10% less
+ * CPU than one that stays, against ~10% more for the other.  Hence the
+ * ~1.25 ratio between neighbouring weights.
+ */
+static const unsigned long prio_to_weight[40] = {
+ /* -20 */     88761,     71755,     56483,     46273,     36291,
+ /* -15 */     29154,     23254,     18705,     14949,     11916,
+ /* -10 */      9548,      7620,      6100,      4904,      3906,
+ /*  -5 */      3121,      2501,      1991,      1586,      1277,
+ /*   0 */      1024,       820,       655,       526,       423,
+ /*   5 */       335,       272,       215,       172,       137,
+ /*  10 */       110,        87,        70,        56,        45,
+ /*  15 */        36,        29,        23,        18,        15,
+};
+
+/*
+ * p->array of a queued SCHED_FAIR task.  Only its address is used, to
+ * tell fair tasks apart from tasks on the O(1) arrays.
+ */
+static prio_array_t fair_array;
+
+#define fair_task(p)	((p)->policy == SCHED_FAIR && !rt_task(p))
+#define fair_queued(p)	((p)->array == &fair_array)
+
+static inline task_t *task_of(struct sched_entity *se)
+{
+	return container_of(se, task_t, se);
+}
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+
+/* The group entity that owns the queue @se is on, NULL at the root: */
+static inline struct sched_entity *parent_entity(struct sched_entity *se)
+{
+	return se->cfs_rq->se;
+}
+
+/* The queue of a group entity, NULL for tasks and the O(1) entity: */
+static inline struct cfs_rq *group_cfs_rq(struct sched_entity *se)
+{
+	return se->my_q;
+}
+
+static inline int cfs_rq_throttled(struct cfs_rq *cfs)
+{
+	return cfs->throttled;
+}
+
+/* The queue a SCHED_FAIR task of @rq belongs on: */
+static inline struct cfs_rq *task_cfs_rq(runqueue_t *rq, task_t *p)
+{
+	if (p->sched_group)
+		return p->sched_group->cfs_rq[task_cpu(p)];
+	return &rq->cfs;
+}
+
+#else
+
+static inline struct sched_entity *parent_entity(struct sched_entity *se)
+{
+	return NULL;
+}
+
+static inline struct cfs_rq *group_cfs_rq(struct sched_entity *se)
+{
+	return NULL;
+}
+
+static inline int cfs_rq_throttled(struct cfs_rq *cfs)
+{
+	return 0;
+}
+
+static inline struct cfs_rq *task_cfs_rq(runqueue_t *rq, task_t *p)
+{
+	return &rq->cfs;
+}
+
+#endif /* CONFIG_FAIR_GROUP_SCHED */
+
+/*
+ * sched_clock() of the local CPU, adjusted to the timebase of @rq
+ * the same way activate_task() does it.
+ */
+static inline unsigned long long rq_clock(runqueue_t *rq)
+{
+	unsigned long long now = sched_clock();
+#ifdef CONFIG_SMP
+	runqueue_t *this_rq = this_rq();
+
+	if (rq != this_rq)
+		now = (now - this_rq->timestamp_last_tick)
+			+ rq->timestamp_last_tick;
+#endif
+	return now;
+}
+
+/* delta ns of runtime in nice-0 ns: */
+static inline unsigned long long
+calc_delta_fair(unsigned long long delta, struct sched_entity *se)
+{
+	if (likely(se->load_weight == NICE_0_LOAD))
+		return delta;
+	delta *= NICE_0_LOAD;
+	do_div(delta, se->load_weight);
+	return delta;
+}
+
+/* vruntime wraps, so compare differences only: */
+static inline long long vruntime_cmp(struct sched_entity *a,
+				     struct sched_entity *b)
+{
+	return (long long)(a->vruntime - b->vruntime);
+}
+
+static inline struct sched_entity *__pick_first_entity(struct cfs_rq *cfs)
+{
+	if (!cfs->rb_leftmost)
+		return NULL;
+	return rb_entry(cfs->rb_leftmost, struct sched_entity, run_node);
+}
+
+static void __enqueue_entity(struct cfs_rq *cfs, struct sched_entity *se)
+{
+	struct rb_node **link = &cfs->tasks_timeline.rb_node;
+	struct rb_node *parent = NULL;
+	struct sched_entity *entry;
+	int leftmost = 1;
+
+	while (*link) {
+		parent = *link;
+		entry = rb_entry(parent, struct sched_entity, run_node);
+		/* Equal keys go to the right, behind the ones already there: */
+		if (vruntime_cmp(se, entry) < 0)
+			link = &parent->rb_left;
+		else {
+			link = &parent->rb_right;
+			leftmost = 0;
+		}
+	}
+	if (leftmost)
+		cfs->rb_leftmost = &se->run_node;
+
+	rb_link_node(&se->run_node, parent, link);
+	rb_insert_color(&se->run_node, &cfs->tasks_timeline);
+}
+
+static void __dequeue_entity(struct cfs_rq *cfs, struct sched_entity *se)
+{
+	if (cfs->rb_leftmost == &se->run_node)
+		cfs->rb_leftmost = rb_next(&se->run_node);
+	rb_erase(&se->run_node, &cfs->tasks_timeline);
+}
+
+/*
+ * min_vruntime only ever moves forward.  The running entity stays in
+ * the tree, so the leftmost entity is the minimum.
+ */
+static void update_min_vruntime(struct cfs_rq *cfs)
+{
+	struct sched_entity *se = __pick_first_entity(cfs);
+
+	if (se && (long long)(se->vruntime - cfs->min_vruntime) > 0)
+		cfs->min_vruntime = se->vruntime;
+}
+
+/*
+ * Charge the entity running on @cfs for the time since it was last
+ * charged, and move it right in the tree if it is no longer in order.
+ */
+static void update_curr(struct cfs_rq *cfs, unsigned long long now)
+{
+	struct sched_entity *curr = cfs->curr;
+	struct rb_node *next;
+	long long delta;
+
+	if (!curr)
+		return;
+	delta = now - curr->exec_start;
+	if (delta <= 0)
+		return;
+	curr->exec_start = now;
+	curr->sum_exec_runtime += delta;
+	curr->vruntime += calc_delta_fair(delta, curr);
+#ifdef CONFIG_FAIR_GROUP_SCHED
+	if (cfs->runtime_enabled)
+		cfs->runtime_remaining -= delta;
+#endif
+	if (!curr->on_rq)
+		return;
+
+	next = rb_next(&curr->run_node);
+	if (next && vruntime_cmp(curr,
+			rb_entry(next, struct sched_entity, run_node)) > 0) {
+		__dequeue_entity(cfs, curr);
+		__enqueue_entity(cfs, curr);
+	}
+	update_min_vruntime(cfs);
+}
+
+/*
+ * An entity that slept is credited at most half a latency period, so
+ * that sleepers get on the CPU quickly but cannot bank runtime.
+ */
+static void place_entity(struct cfs_rq *cfs, struct sched_entity *se)
+{
+	unsigned long long vruntime;
+
+	vruntime = cfs->min_vruntime - (sysctl_sched_latency >> 1);
+	if ((long long)(se->vruntime - vruntime) < 0)
+		se->vruntime = vruntime;
+}
+
+static void enqueue_entity(struct cfs_rq *cfs, struct sched_entity *se)
+{
+	se->vruntime += cfs->min_vruntime;
+	place_entity(cfs, se);
+	__enqueue_entity(cfs, se);
+	se->on_rq = 1;
+	cfs->load += se->load_weight;
+}
+
+static void dequeue_entity(struct cfs_rq *cfs, struct sched_entity *se)
+{
+	__dequeue_entity(cfs, se);
+	se->on_rq = 0;
+	cfs->load -= se->load_weight;
+	update_min_vruntime(cfs);
+	se->vruntime -= cfs->min_vruntime;
+}
+
+/*
+ * Queue @se, and the group entities above it whose queue just became
+ * non-empty.  Stops below a throttled queue.
+ */
+static void enqueue_entity_chain(struct sched_entity *se,
+				 unsigned long long now)
+{
+	struct cfs_rq *cfs;
+
+	for (; se; se = parent_entity(se)) {
+		if (se->on_rq)
+			break;
+		cfs = se->cfs_rq;
+		update_curr(cfs, now);
+		enqueue_entity(cfs, se);
+		cfs->nr_running++;
+		if (cfs_rq_throttled(cfs))
+			break;
+	}
+}
+
+/*
+ * Dequeue @se, and the group entities above it whose queue just became
+ * empty.
+ */
+static void dequeue_entity_chain(struct sched_entity *se,
+				 unsigned long long now)
+{
+	struct cfs_rq *cfs;
+
+	for (; se; se = parent_entity(se)) {
+		if (!se->on_rq)
+			break;
+		cfs = se->cfs_rq;
+		if (se == cfs->curr) {
+			update_curr(cfs, now);
+			cfs->curr = NULL;
+		}
+		dequeue_entity(cfs, se);
+		if (--cfs->nr_running)
+			break;
+	}
+}
+
+static inline void set_curr_entity(struct cfs_rq *cfs,
+				   struct sched_entity *se,
+				   unsigned long long now)
+{
+	cfs->curr = se;
+	se->exec_start = now;
+	se->prev_sum_exec_runtime = se->sum_exec_runtime;
+}
+
+/* Charge and forget the running chain of @rq: */
+static void put_running_chain(runqueue_t *rq, unsigned long long now)
+{
+	struct sched_entity *se;
+
+	for (se = rq->cfs.running; se; se = parent_entity(se)) {
+		update_curr(se->cfs_rq, now);
+		se->cfs_rq->curr = NULL;
+	}
+	rq->cfs.running = NULL;
+}
+
+/* Make @se (a task, the O(1) entity or NULL) the leaf of the running chain: */
+static void set_running_chain(runqueue_t *rq, struct sched_entity *se,
+			      unsigned long long now)
+{
+	put_running_chain(rq, now);
+	rq->cfs.running = se;
+	for (; se; se = parent_entity(se))
+		set_curr_entity(se->cfs_rq, se, now);
+}
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+
+/*
+ * Take the entity of a group queue that used up its quota off its
+ * parent.  The tasks stay queued on it until unthrottle_cfs_rq().
+ */
+static void throttle_cfs_rq(runqueue_t *rq, struct cfs_rq *cfs,
+			    unsigned long long now)
+{
+	cfs->throttled = 1;
+	dequeue_entity_chain(cfs->se, now);
+	set_tsk_need_resched(rq->curr);
+}
+
+static void unthrottle_cfs_rq(struct cfs_rq *cfs, unsigned long long now)
+{
+	cfs->throttled = 0;
+	if (cfs->nr_running)
+		enqueue_entity_chain(cfs->se, now);
+}
+
+static void check_throttle(runqueue_t *rq, unsigned long long now)
+{
+	struct sched_entity *se;
+	struct cfs_rq *cfs;
+
+	for (se = rq->cfs.running; se; se = parent_entity(se)) {
+		cfs = se->cfs_rq;
+		if (cfs->runtime_enabled && cfs->runtime_remaining <= 0 &&
+						!cfs->throttled)
+			throttle_cfs_rq(rq, cfs, now);
+	}
+}
+
+#else
+
+static inline void check_throttle(runqueue_t *rq, unsigned long long now)
+{
+}
+
+#endif /* CONFIG_FAIR_GROUP_SCHED */
+
+/*
+ * Charge every level of the running chain, and throttle the groups
+ * that ran out of quota.
+ */
+static void update_curr_fair(runqueue_t *rq, unsigned long long now)
+{
+	struct sched_entity *se;
+
+	for (se = rq->cfs.running; se; se = parent_entity(se))
+		update_curr(se->cfs_rq, now);
+	check_throttle(rq, now);
+}
+
+static void enqueue_task_fair(runqueue_t *rq, task_t *p)
+{
+	struct sched_entity *se = &p->se;
+	unsigned long long now = rq_clock(rq);
+	int running = task_running(rq, p);
+
+	/* Requeued while running, e.g. by set_user_nice(): */
+	if (running)
+		put_running_chain(rq, now);
+	se->cfs_rq = task_cfs_rq(rq, p);
+	se->load_weight = prio_to_weight[p->static_prio - MAX_RT_PRIO];
+	enqueue_entity_chain(se, now);
+	p->array = &fair_array;
+	if (running)
+		set_running_chain(rq, se, now);
+}
+
+static void dequeue_task_fair(runqueue_t *rq, task_t *p)
+{
+	dequeue_entity_chain(&p->se, rq_clock(rq));
+}
+
+/*
+ * Account a task entering or leaving the O(1) arrays of @rq in the
+ * weight of the pseudo-entity that stands for them.
+ */
+static void o1_entity_enqueue(runqueue_t *rq)
+{
+	struct cfs_rq *cfs = &rq->cfs;
+	struct sched_entity *se = &cfs->o1;
+	task_t *curr = rq->curr;
+
+	if (cfs->nr_o1++) {
+		se->load_weight += NICE_0_LOAD;
+		cfs->load += NICE_0_LOAD;
+		return;
+	}
+	if (cfs->curr)
+		update_curr(cfs, rq_clock(rq));
+	se->load_weight = NICE_0_LOAD;
+	enqueue_entity(cfs, se);
+	if (curr != rq->idle && curr->array && !fair_queued(curr) &&
+							!rt_task(curr))
+		set_running_chain(rq, se, rq_clock(rq));
+}
+
+static void o1_entity_dequeue(runqueue_t *rq)
+{
+	struct cfs_rq *cfs = &rq->cfs;
+	struct sched_entity *se = &cfs->o1;
+
+	if (--cfs->nr_o1) {
+		se->load_weight -= NICE_0_LOAD;
+		cfs->load -= NICE_0_LOAD;
+		return;
+	}
+	if (se == cfs->curr) {
+		/* Nobody to be fair against otherwise: */
+		if (cfs->nr_running)
+			update_curr(cfs, rq_clock(rq));
+		cfs->curr = NULL;
+		cfs->running = NULL;
+	}
+	dequeue_entity(cfs, se);
+}
+
+/*
+ * The slice of an entity: its share of sysctl_sched_latency on its
+ * queue, but not less than sysctl_sched_min_granularity.
+ */
+static unsigned long long sched_slice(struct cfs_rq *cfs,
+				      struct sched_entity *se)
+{
+	unsigned long long slice;
+
+	slice = (unsigned long long)sysctl_sched_latency * se->load_weight;
+	do_div(slice, cfs->load);
+	if (slice < sysctl_sched_min_granularity)
+		slice = sysctl_sched_min_granularity;
+	return slice;
+}
+
+/*
+ * Called from scheduler_tick() with the runqueue locked, whenever the
+ * running entity has someone to be fair against.  Each level of the
+ * running chain is checked against its own slice.
+ */
+static void task_tick_fair(runqueue_t *rq)
+{
+	struct sched_entity *se;
+	struct cfs_rq *cfs;
+	unsigned long long ran;
+
+	update_curr_fair(rq, rq->timestamp_last_tick);
+	for (se = rq->cfs.running; se; se = parent_entity(se)) {
+		cfs = se->cfs_rq;
+		if (cfs->curr != se || __pick_first_entity(cfs) == se)
+			continue;
+		ran = se->sum_exec_runtime - se->prev_sum_exec_runtime;
+		if (ran > sched_slice(cfs, se)) {
+			set_tsk_need_resched(rq->curr);
+			break;
+		}
+	}
+}
+
+/*
+ * Return the SCHED_FAIR task to run next, or NULL if schedule() should
+ * pick from the O(1) arrays: an RT task is runnable, or the O(1)
+ * pseudo-entity is the leftmost one.
+ */
+static task_t *pick_next_task_fair(runqueue_t *rq)
+{
+	struct sched_entity *se;
+
+	if (sched_find_first_bit(rq->active->bitmap) < MAX_RT_PRIO)
+		return NULL;
+	se = __pick_first_entity(&rq->cfs);
+	if (!se || se == &rq->cfs.o1)
+		return NULL;
+	/* A queued group entity never has an empty queue: */
+	while (group_cfs_rq(se))
+		se = __pick_first_entity(group_cfs_rq(se));
+	return task_of(se);
+}
+
+/*
+ * Called by schedule() for the task it switches to, after charging the
+ * previous one.  RT tasks and the idle task are not charged to anybody.
+ */
+static void set_next_entity(runqueue_t *rq, task_t *next,
+			    unsigned long long now)
+{
+	struct sched_entity *se = NULL;
+
+	if (fair_queued(next))
+		se = &next->se;
+	else if (next != rq->idle && !rt_task(next) && rq->cfs.o1.on_rq)
+		se = &rq->cfs.o1;
+	set_running_chain(rq, se, now);
+}
+
+/*
+ * sched_yield() for SCHED_FAIR: go behind every other runnable entity
+ * of the same queue.
+ */
+static void yield_task_fair(runqueue_t *rq, task_t *p)
+{
+	struct sched_entity *se = &p->se, *last;
+	struct cfs_rq *cfs = se->cfs_rq;
+
+	update_curr_fair(rq, rq_clock(rq));
+	if (!se->on_rq)
+		return;
+	last = rb_entry(rb_last(&cfs->tasks_timeline),
+			struct sched_entity, run_node);
+	if (last == se)
+		return;
+	__dequeue_entity(cfs, se);
+	se->vruntime = last->vruntime + 1;
+	__enqueue_entity(cfs, se);
+	update_min_vruntime(cfs);
+}
+
+/* Is @se runnable all the way up, i.e. not inside a throttled group? */
+static inline int entity_chain_queued(struct sched_entity *se)
+{
+	for (; se; se = parent_entity(se))
+		if (!se->on_rq)
+			return 0;
+	return 1;
+}
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+/* Walk @se and @pse up to the entities that share a queue: */
+static void find_matching_se(struct sched_entity **se,
+			     struct sched_entity **pse)
+{
+	while ((*se)->cfs_rq->depth > (*pse)->cfs_rq->depth)
+		*se = parent_entity(*se);
+	while ((*pse)->cfs_rq->depth > (*se)->cfs_rq->depth)
+		*pse = parent_entity(*pse);
+	while ((*se)->cfs_rq != (*pse)->cfs_rq) {
+		*se = parent_entity(*se);
+		*pse = parent_entity(*pse);
+	}
+}
+#else
+static inline void find_matching_se(struct sched_entity **se,
+				    struct sched_entity **pse)
+{
+}
+#endif
+
+/*
+ * Should the just queued task @p preempt rq->curr?  RT and O(1) tasks
+ * compare priorities as before; as soon as a SCHED_FAIR task is
+ * involved the vruntimes decide, at the level where the two entities
+ * share a queue, with the O(1) side represented by its pseudo-entity.
+ */
+static int task_preempts_curr(task_t *p, runqueue_t *rq)
+{
+	task_t *curr = rq->curr;
+	struct sched_entity *se, *cse;
+	long long gran;
+
+	if ((!fair_queued(p) && !fair_queued(curr)) || rt_task(p) ||
+				rt_task(curr) || curr == rq->idle)
+		return p->prio < curr->prio;
+
+	update_curr_fair(rq, rq_clock(rq));
+	se = fair_queued(p) ? &p->se : &rq->cfs.o1;
+	cse = fair_queued(curr) ? &curr->se : &rq->cfs.o1;
+	if (!entity_chain_queued(se))
+		return 0;
+	/* curr is on its way out of schedule() or got throttled: */
+	if (!entity_chain_queued(cse))
+		return 1;
+
+	find_matching_se(&se, &cse);
+	if (se == cse)
+		return 0;
+	gran = calc_delta_fair(sysctl_sched_wakeup_granularity, se);
+	return vruntime_cmp(cse, se) > gran;
+}
+
+/*
+ * Some SCHED_FAIR task on @rq, for migrating them all off a dead CPU.
+ * Throttled queues have to be unthrottled first.
+ */
+static task_t *first_fair_task(runqueue_t *rq)
+{
+	struct rb_node *node = rq->cfs.rb_leftmost;
+	struct sched_entity *se;
+
+	if (node == &rq->cfs.o1.run_node)
+		node = rb_next(node);
+	if (!node)
+		return NULL;
+	se = rb_entry(node, struct sched_entity, run_node);
+	while (group_cfs_rq(se))
+		se = __pick_first_entity(group_cfs_rq(se));
+	return task_of(se);
+}
@@ -13,6 +13,51 @@
 #include <linux/interrupt.h>
 #include <linux/module.h>
 
+#ifdef CONFIG_LOCK_STAT
+/*
+ * Lock statistics: try the lock first, so that only real waits are
+ * timed.  The call site recorded for a contention is our caller.
+ */
+#define LOCK_STAT_IP	((unsigned long)__builtin_return_address(0))
+
+#define LOCK_CONTENDED(_lock, try, lock, type)				\
+do {									\
+	unsigned long long __start = 0;					\
+									\
+	if (!try(_lock)) {						\
+		__start = lock_stat_clock();				\
+		lock(_lock);						\
+	}								\
+	lock_stat_acquired(&(_lock)->stat_map, (_lock), (type),		\
+			   __start, LOCK_STAT_IP);			\
+} while (0)
+
+#define LOCK_CONTENDED_FLAGS(_lock, try, lock, flags, type)		\
+do {									\
+	unsigned long long __start = 0;					\
+									\
+	if (!try(_lock)) {						\
+		__start = lock_stat_clock();				\
+		lock(_lock, flags);					\
+	}								\
+	lock_stat_acquired(&(_lock)->stat_map, (_lock), (type),		\
+			   __start, LOCK_STAT_IP);			\
+} while (0)
+
+#define LOCK_WAIT_START(start)						\
+	do { if (!(start)) (start) = lock_stat_clock(); } while (0)
+#define LOCK_ACQUIRED(_lock, type, start, ip)				\
+	lock_stat_acquired(&(_lock)->stat_map, (_lock), (type), (start), (ip))
+#define LOCK_RELEASED(_lock)	lock_stat_released(&(_lock)->stat_map)
+#else
+#define LOCK_STAT_IP	0UL
+#define LOCK_CONTENDED(_lock, try, lock, type)	lock(_lock)
+#define LOCK_CONTENDED_FLAGS(_lock, try, lock, flags, type) lock(_lock, flags)
+#define LOCK_WAIT_START(start)			do { } while (0)
+#define LOCK_ACQUIRED(_lock, type, start, ip)	do { (void)(start); } while (0)
+#define LOCK_RELEASED(_lock)			do { } while (0)
+#endif
+
 /*
  * Generic declaration of the raw read_trylock() function,
  * architectures are supposed to optimize this:
@@ -27,8 +72,10 @@ EXPORT_SYMBOL(generic_raw_read_trylock);
 int __lockfunc _spin_trylock(spinlock_t *lock)
 {
 	preempt_disable();
-	if (_raw_spin_trylock(lock))
+	if (_raw_spin_trylock(lock)) {
+		LOCK_ACQUIRED(lock, LOCK_STAT_SPIN, 0, LOCK_STAT_IP);
 		return 1;
+	}
 	
 	preempt_enable();
 	return 0;
@@ -38,8 +85,10 @@ EXPORT_SYMBOL(_spin_trylock);
 int __lockfunc _read_trylock(rwlock_t *lock)
 {
 	preempt_disable();
-	if (_raw_read_trylock(lock))
+	if (_raw_read_trylock(lock)) {
+		LOCK_ACQUIRED(lock, LOCK_STAT_READ, 0, LOCK_STAT_IP);
 		return 1;
+	}
 
 	preempt_enable();
 	return 0;
@@ -49,8 +98,10 @@ EXPORT_SYMBOL(_read_trylock);
 int __lockfunc _write_trylock(rwlock_t *lock)
 {
 	preempt_disable();
-	if (_raw_write_trylock(lock))
+	if (_raw_write_trylock(lock)) {
+		LOCK_ACQUIRED(lock, LOCK_STAT_WRITE, 0, LOCK_STAT_IP);
 		return 1;
+	}
 
 	preempt_enable();
 	return 0;
@@ -65,7 +116,7 @@ EXPORT_SYMBOL(_write_trylock);
 void __lockfunc _read_lock(rwlock_t *lock)
 {
 	preempt_disable();
-	_raw_read_lock(lock);
+	LOCK_CONTENDED(lock, _raw_read_trylock, _raw_read_lock, LOCK_STAT_READ);
 }
 EXPORT_SYMBOL(_read_lock);
 
@@ -75,7 +126,8 @@ unsigned long __lockfunc _spin_lock_irqsave(spinlock_t *lock)
 
 	local_irq_save(flags);
 	preempt_disable();
-	_raw_spin_lock_flags(lock, flags);
+	LOCK_CONTENDED_FLAGS(lock, _raw_spin_trylock, _raw_spin_lock_flags,
+			     flags, LOCK_STAT_SPIN);
 	return flags;
 }
 EXPORT_SYMBOL(_spin_lock_irqsave);
@@ -84,7 +136,7 @@ void __lockfunc _spin_lock_irq(spinlock_t *lock)
 {
 	local_irq_disable();
 	preempt_disable();
-	_raw_spin_lock(lock);
+	LOCK_CONTENDED(lock, _raw_spin_trylock, _raw_spin_lock, LOCK_STAT_SPIN);
 }
 EXPORT_SYMBOL(_spin_lock_irq);
 
@@ -92,7 +144,7 @@ void __lockfunc _spin_lock_bh(spinlock_t *lock)
 {
 	local_bh_disable();
 	preempt_disable();
-	_raw_spin_lock(lock);
+	LOCK_CONTENDED(lock, _raw_spin_trylock, _raw_spin_lock, LOCK_STAT_SPIN);
 }
 EXPORT_SYMBOL(_spin_lock_bh);
 
@@ -102,7 +154,7 @@ unsigned long __lockfunc _read_lock_irqsave(rwlock_t *lock)
 
 	local_irq_save(flags);
 	preempt_disable();
-	_raw_read_lock(lock);
+	LOCK_CONTENDED(lock, _raw_read_trylock, _raw_read_lock, LOCK_STAT_READ);
 	return flags;
 }
 EXPORT_SYMBOL(_read_lock_irqsave);
@@ -111,7 +163,7 @@ void __lockfunc _read_lock_irq(rwlock_t *lock)
 {
 	local_irq_disable();
 	preempt_disable();
-	_raw_read_lock(lock);
+	LOCK_CONTENDED(lock, _raw_read_trylock, _raw_read_lock, LOCK_STAT_READ);
 }
 EXPORT_SYMBOL(_read_lock_irq);
 
@@ -119,7 +171,7 @@ void __lockfunc _read_lock_bh(rwlock_t *lock)
 {
 	local_bh_disable();
 	preempt_disable();
-	_raw_read_lock(lock);
+	LOCK_CONTENDED(lock, _raw_read_trylock, _raw_read_lock, LOCK_STAT_READ);
 }
 EXPORT_SYMBOL(_read_lock_bh);
 
@@ -129,7 +181,7 @@ unsigned long __lockfunc _write_lock_irqsave(rwlock_t *lock)
 
 	local_irq_save(flags);
 	preempt_disable();
-	_raw_write_lock(lock);
+	LOCK_CONTENDED(lock, _raw_write_trylock, _raw_write_lock, LOCK_STAT_WRITE);
 	return flags;
 }
 EXPORT_SYMBOL(_write_lock_irqsave);
@@ -138,7 +190,7 @@ void __lockfunc _write_lock_irq(rwlock_t *lock)
 {
 	local_irq_disable();
 	preempt_disable();
-	_raw_write_lock(lock);
+	LOCK_CONTENDED(lock, _raw_write_trylock, _raw_write_lock, LOCK_STAT_WRITE);
 }
 EXPORT_SYMBOL(_write_lock_irq);
 
@@ -146,14 +198,14 @@ void __lockfunc _write_lock_bh(rwlock_t *lock)
 {
 	local_bh_disable();
 	preempt_disable();
-	_raw_write_lock(lock);
+	LOCK_CONTENDED(lock, _raw_write_trylock, _raw_write_lock, LOCK_STAT_WRITE);
 }
 EXPORT_SYMBOL(_write_lock_bh);
 
 void __lockfunc _spin_lock(spinlock_t *lock)
 {
 	preempt_disable();
-	_raw_spin_lock(lock);
+	LOCK_CONTENDED(lock, _raw_spin_trylock, _raw_spin_lock, LOCK_STAT_SPIN);
 }
 
 EXPORT_SYMBOL(_spin_lock);
@@ -161,7 +213,7 @@ EXPORT_SYMBOL(_spin_lock);
 void __lockfunc _write_lock(rwlock_t *lock)
 {
 	preempt_disable();
-	_raw_write_lock(lock);
+	LOCK_CONTENDED(lock, _raw_write_trylock, _raw_write_lock, LOCK_STAT_WRITE);
 }
 
 EXPORT_SYMBOL(_write_lock);
@@ -179,9 +231,11 @@ EXPORT_SYMBOL(_write_lock);
  * ͨBUILD_LOCK_OPS(spin, spinlock);_spin_lockʵspin_lock
  * ھںռʱspin_lockʵ֡
  */
-#define BUILD_LOCK_OPS(op, locktype)					\
+#define BUILD_LOCK_OPS(op, locktype, type)				\
 void __lockfunc _##op##_lock(locktype##_t *lock)			\
 {									\
+	unsigned long long start = 0;					\
+									\
 	/**
 	 * preempt_disableںռ
 	 * ڲspinlockֵǰȽֹռԭܼ򵥣ڲֵʱռʲô
@@ -207,6 +261,7 @@ void __lockfunc _##op##_lock(locktype##_t *lock)			\
 		 * ޷ѭһֱCPUͷ
 		 * ѭǰʱpreempt_enableҲ˵ڵȴм䣬ǿܱռġ
 		 */
+		LOCK_WAIT_START(start);					\
 		preempt_enable();					\
 		/**
 		 * break_lockʾڵȴ
@@ -230,13 +285,16 @@ void __lockfunc _##op##_lock(locktype##_t *lock)			\
 		 */
 		preempt_disable();					\
 	}								\
+	LOCK_ACQUIRED(lock, type, start, LOCK_STAT_IP);			\
 }									\
 									\
 EXPORT_SYMBOL(_##op##_lock);						\
 									\
-unsigned long __lockfunc _##op##_lock_irqsave(locktype##_t *lock)	\
+static inline unsigned long						\
+__##op##_lock_irqsave(locktype##_t *lock, unsigned long ip)		\
 {									\
 	unsigned long flags;						\
+	unsigned long long start = 0;					\
 									\
 	preempt_disable();						\
 	for (;;) {							\
@@ -245,6 +303,7 @@ unsigned long __lockfunc _##op##_lock_irqsave(locktype##_t *lock)	\
 			break;						\
 		local_irq_restore(flags);				\
 									\
+		LOCK_WAIT_START(start);					\
 		preempt_enable();					\
 		if (!(lock)->break_lock)				\
 			(lock)->break_lock = 1;				\
@@ -252,14 +311,20 @@ unsigned long __lockfunc _##op##_lock_irqsave(locktype##_t *lock)	\
 			cpu_relax();					\
 		preempt_disable();					\
 	}								\
+	LOCK_ACQUIRED(lock, type, start, ip);				\
 	return flags;							\
 }									\
 									\
+unsigned long __lockfunc _##op##_lock_irqsave(locktype##_t *lock)	\
+{									\
+	return __##op##_lock_irqsave(lock, LOCK_STAT_IP);		\
+}									\
+									\
 EXPORT_SYMBOL(_##op##_lock_irqsave);					\
 									\
 void __lockfunc _##op##_lock_irq(locktype##_t *lock)			\
 {									\
-	_##op##_lock_irqsave(lock);					\
+	__##op##_lock_irqsave(lock, LOCK_STAT_IP);			\
 }									\
 									\
 EXPORT_SYMBOL(_##op##_lock_irq);					\
@@ -273,7 +338,7 @@ void __lockfunc _##op##_lock_bh(locktype##_t *lock)			\
 	/* irq-disabling. We use the generic preemption-aware	*/	\
 	/* function:						*/	\
 	/**/								\
-	flags = _##op##_lock_irqsave(lock);				\
+	flags = __##op##_lock_irqsave(lock, LOCK_STAT_IP);		\
 	local_bh_disable();						\
 	local_irq_restore(flags);					\
 }									\
@@ -289,14 +354,15 @@ EXPORT_SYMBOL(_##op##_lock_bh)
  *         _[spin|read|write]_lock_irqsave()
  *         _[spin|read|write]_lock_bh()
  */
-BUILD_LOCK_OPS(spin, spinlock);
-BUILD_LOCK_OPS(read, rwlock);
-BUILD_LOCK_OPS(write, rwlock);
+BUILD_LOCK_OPS(spin, spinlock, LOCK_STAT_SPIN);
+BUILD_LOCK_OPS(read, rwlock, LOCK_STAT_READ);
+BUILD_LOCK_OPS(write, rwlock, LOCK_STAT_WRITE);
 
 #endif /* CONFIG_PREEMPT */
 
 void __lockfunc _spin_unlock(spinlock_t *lock)
 {
+	LOCK_RELEASED(lock);
 	_raw_spin_unlock(lock);
 	preempt_enable();
 }
@@ -309,6 +375,7 @@ void __lockfunc _write_unlock(rwlock_t *lock)
 	/**
 	 * ûlock ; addl $0x01000000, rwlpֶеδ־λ
 	 */
+	LOCK_RELEASED(lock);
 	_raw_write_unlock(lock);
 	/**
 	 * ȻˣڻʱǽռģʱҪռ򿪡
@@ -327,6 +394,7 @@ EXPORT_SYMBOL(_read_unlock);
 
 void __lockfunc _spin_unlock_irqrestore(spinlock_t *lock, unsigned long flags)
 {
+	LOCK_RELEASED(lock);
 	_raw_spin_unlock(lock);
 	local_irq_restore(flags);
 	preempt_enable();
@@ -335,6 +403,7 @@ EXPORT_SYMBOL(_spin_unlock_irqrestore);
 
 void __lockfunc _spin_unlock_irq(spinlock_t *lock)
 {
+	LOCK_RELEASED(lock);
 	_raw_spin_unlock(lock);
 	local_irq_enable();
 	preempt_enable();
@@ -343,6 +412,7 @@ EXPORT_SYMBOL(_spin_unlock_irq);
 
 void __lockfunc _spin_unlock_bh(spinlock_t *lock)
 {
+	LOCK_RELEASED(lock);
 	_raw_spin_unlock(lock);
 	preempt_enable();
 	local_bh_enable();
@@ -375,6 +445,7 @@ EXPORT_SYMBOL(_read_unlock_bh);
 
 void __lockfunc _write_unlock_irqrestore(rwlock_t *lock, unsigned long flags)
 {
+	LOCK_RELEASED(lock);
 	_raw_write_unlock(lock);
 	local_irq_restore(flags);
 	preempt_enable();
@@ -383,6 +454,7 @@ EXPORT_SYMBOL(_write_unlock_irqrestore);
 
 void __lockfunc _write_unlock_irq(rwlock_t *lock)
 {
+	LOCK_RELEASED(lock);
 	_raw_write_unlock(lock);
 	local_irq_enable();
 	preempt_enable();
@@ -391,6 +463,7 @@ EXPORT_SYMBOL(_write_unlock_irq);
 
 void __lockfunc _write_unlock_bh(rwlock_t *lock)
 {
+	LOCK_RELEASED(lock);
 	_raw_write_unlock(lock);
 	preempt_enable();
 	local_bh_enable();
@@ -401,8 +474,10 @@ int __lockfunc _spin_trylock_bh(spinlock_t *lock)
 {
 	local_bh_disable();
 	preempt_disable();
-	if (_raw_spin_trylock(lock))
+	if (_raw_spin_trylock(lock)) {
+		LOCK_ACQUIRED(lock, LOCK_STAT_SPIN, 0, LOCK_STAT_IP);
 		return 1;
+	}
 
 	preempt_enable();
 	local_bh_enable();
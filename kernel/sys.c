@@ -1516,6 +1516,17 @@ asmlinkage long sys_setrlimit(unsigned int resource, struct rlimit __user *rlim)
 	task_lock(current->group_leader);
 	*old_rlim = new_rlim;
 	task_unlock(current->group_leader);
+
+	/* Only the tick checks RLIMIT_CPU, for every thread of the group */
+	if (resource == RLIMIT_CPU && new_rlim.rlim_cur != RLIM_INFINITY) {
+		task_t *t = current;
+
+		read_lock(&tasklist_lock);
+		do {
+			nohz_full_kick_task(t);
+		} while_each_thread(current, t);
+		read_unlock(&tasklist_lock);
+	}
 	return 0;
 }
 
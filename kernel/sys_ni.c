@@ -40,6 +40,8 @@ cond_syscall(sys_recvmsg)
 cond_syscall(sys_socketcall)
 cond_syscall(sys_futex)
 cond_syscall(compat_sys_futex)
+cond_syscall(sys_set_robust_list)
+cond_syscall(sys_get_robust_list)
 cond_syscall(sys_epoll_create)
 cond_syscall(sys_epoll_ctl)
 cond_syscall(sys_epoll_wait)
@@ -83,3 +85,4 @@ cond_syscall(sys_pciconfig_write)
 cond_syscall(sys_pciconfig_iobase)
 cond_syscall(sys32_ipc)
 cond_syscall(sys32_sysctl)
+cond_syscall(sys_perf_counter_open)
@@ -0,0 +1,250 @@
+/*
+ * kernel/taskstats.c
+ *
+ * Task statistics over netlink, see linux/taskstats.h.
+ *
+ * Requests are answered from the sender's context, in the input
+ * callback of the kernel socket, so current is the requester: like
+ * /proc/<pid>/io, a task's statistics are only given to those who may
+ * ptrace it.  Exit records are built by the exiting task itself and
+ * broadcast to the TASKSTATS_GRP_EXIT group.
+ *
+ * The statistics of a thread group are those of its live threads plus
+ * signal->stats, to which __exit_signal() adds the threads that die
+ * before the group does.  Both are stable under tasklist_lock.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/string.h>
+#include <linux/skbuff.h>
+#include <linux/netlink.h>
+#include <linux/taskstats.h>
+#include <linux/ptrace.h>
+#include <net/sock.h>
+
+static struct sock *taskstats_sock;
+
+#define JIFFIES_TO_NS(j)	((u64)(j) * (NSEC_PER_SEC / HZ))
+
+/* Add the counters of @tsk to @stats */
+static void taskstats_add(struct taskstats *stats, struct task_struct *tsk)
+{
+#ifdef CONFIG_TASK_DELAY_ACCT
+	struct task_delay_info *d = &tsk->delays;
+
+	stats->cpu_count += tsk->sched_info.pcnt;
+	stats->cpu_delay_total += JIFFIES_TO_NS(tsk->sched_info.run_delay);
+	stats->cpu_run_total += JIFFIES_TO_NS(tsk->sched_info.cpu_time);
+
+	spin_lock(&d->lock);
+	stats->blkio_count += d->blkio_count;
+	stats->blkio_delay_total += d->blkio_delay;
+	stats->swapin_count += d->swapin_count;
+	stats->swapin_delay_total += d->swapin_delay;
+	spin_unlock(&d->lock);
+#endif
+	stats->read_char += tsk->rchar;
+	stats->write_char += tsk->wchar;
+	stats->read_syscalls += tsk->syscr;
+	stats->write_syscalls += tsk->syscw;
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+	stats->read_bytes += tsk->ioac.read_bytes;
+	stats->write_bytes += tsk->ioac.write_bytes;
+	stats->cancelled_write_bytes += tsk->ioac.cancelled_write_bytes;
+#endif
+}
+
+static void taskstats_add_stats(struct taskstats *dst, struct taskstats *src)
+{
+	dst->cpu_count += src->cpu_count;
+	dst->cpu_delay_total += src->cpu_delay_total;
+	dst->cpu_run_total += src->cpu_run_total;
+	dst->blkio_count += src->blkio_count;
+	dst->blkio_delay_total += src->blkio_delay_total;
+	dst->swapin_count += src->swapin_count;
+	dst->swapin_delay_total += src->swapin_delay_total;
+	dst->read_char += src->read_char;
+	dst->write_char += src->write_char;
+	dst->read_syscalls += src->read_syscalls;
+	dst->write_syscalls += src->write_syscalls;
+	dst->read_bytes += src->read_bytes;
+	dst->write_bytes += src->write_bytes;
+	dst->cancelled_write_bytes += src->cancelled_write_bytes;
+}
+
+static void taskstats_init(struct taskstats *stats, struct task_struct *tsk,
+			   pid_t pid)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->version = TASKSTATS_VERSION;
+	stats->ac_pid = pid;
+	stats->ac_tgid = tsk->tgid;
+	stats->ac_uid = tsk->uid;
+	stats->ac_gid = tsk->gid;
+	memcpy(stats->ac_comm, tsk->comm,
+	       min(sizeof(stats->ac_comm), sizeof(tsk->comm)));
+}
+
+/* Called by __exit_signal() for every thread but the last one */
+void taskstats_exit_thread(struct signal_struct *sig, struct task_struct *tsk)
+{
+	taskstats_add(&sig->stats, tsk);
+}
+
+static int taskstats_fill_pid(struct taskstats *stats, pid_t pid)
+{
+	struct task_struct *tsk;
+	int err = -ESRCH;
+
+	read_lock(&tasklist_lock);
+	tsk = find_task_by_pid(pid);
+	if (tsk && !may_ptrace_attach(tsk))
+		err = -EPERM;
+	else if (tsk) {
+		taskstats_init(stats, tsk, tsk->pid);
+		taskstats_add(stats, tsk);
+		err = 0;
+	}
+	read_unlock(&tasklist_lock);
+	return err;
+}
+
+static int taskstats_fill_tgid(struct taskstats *stats, pid_t tgid)
+{
+	struct task_struct *first, *tsk;
+	int err = -ESRCH;
+
+	read_lock(&tasklist_lock);
+	first = find_task_by_pid(tgid);
+	if (first && thread_group_leader(first) && !may_ptrace_attach(first))
+		err = -EPERM;
+	else if (first && thread_group_leader(first) && first->signal) {
+		taskstats_init(stats, first, 0);
+		taskstats_add_stats(stats, &first->signal->stats);
+		tsk = first;
+		do {
+			taskstats_add(stats, tsk);
+		} while_each_thread(first, tsk);
+		err = 0;
+	}
+	read_unlock(&tasklist_lock);
+	return err;
+}
+
+static struct sk_buff *taskstats_skb(struct taskstats *stats, u32 pid,
+				     u32 seq, int type, int gfp_mask)
+{
+	struct sk_buff *skb;
+	struct nlmsghdr *nlh;
+
+	skb = alloc_skb(NLMSG_SPACE(sizeof(*stats)), gfp_mask);
+	if (!skb)
+		return NULL;
+
+	nlh = NLMSG_PUT(skb, pid, seq, type, sizeof(*stats));
+	memcpy(NLMSG_DATA(nlh), stats, sizeof(*stats));
+	return skb;
+
+nlmsg_failure:			/* Used by NLMSG_PUT */
+	kfree_skb(skb);
+	return NULL;
+}
+
+void taskstats_exit(struct task_struct *tsk, long code)
+{
+	struct taskstats stats;
+	struct sk_buff *skb;
+
+	if (!taskstats_sock)
+		return;
+
+	taskstats_init(&stats, tsk, tsk->pid);
+	stats.ac_exitcode = code;
+	taskstats_add(&stats, tsk);
+
+	skb = taskstats_skb(&stats, 0, 0, TASKSTATS_MSG_EXIT, GFP_KERNEL);
+	if (skb)
+		netlink_broadcast(taskstats_sock, skb, 0, TASKSTATS_GRP_EXIT,
+				  GFP_KERNEL);
+}
+
+static int taskstats_receive_msg(struct sk_buff *skb, struct nlmsghdr *nlh)
+{
+	struct taskstats stats;
+	struct sk_buff *reply;
+	pid_t pid;
+	int err;
+
+	if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(u32)))
+		return -EINVAL;
+	pid = *(u32 *)NLMSG_DATA(nlh);
+
+	switch (nlh->nlmsg_type) {
+	case TASKSTATS_MSG_GET_PID:
+		err = taskstats_fill_pid(&stats, pid);
+		break;
+	case TASKSTATS_MSG_GET_TGID:
+		err = taskstats_fill_tgid(&stats, pid);
+		break;
+	default:
+		err = -EINVAL;
+		break;
+	}
+	if (err)
+		return err;
+
+	reply = taskstats_skb(&stats, NETLINK_CB(skb).pid, nlh->nlmsg_seq,
+			      TASKSTATS_MSG_STATS, GFP_KERNEL);
+	if (!reply)
+		return -ENOMEM;
+	netlink_unicast(taskstats_sock, reply, NETLINK_CB(skb).pid,
+			MSG_DONTWAIT);
+	return 0;
+}
+
+/* Each message of the skb is a request; see audit_receive_skb() */
+static void taskstats_receive_skb(struct sk_buff *skb)
+{
+	struct nlmsghdr	*nlh;
+	u32 rlen;
+	int err;
+
+	while (skb->len >= NLMSG_SPACE(0)) {
+		nlh = (struct nlmsghdr *)skb->data;
+		if (nlh->nlmsg_len < sizeof(*nlh) || skb->len < nlh->nlmsg_len)
+			return;
+		rlen = NLMSG_ALIGN(nlh->nlmsg_len);
+		if (rlen > skb->len)
+			rlen = skb->len;
+		err = taskstats_receive_msg(skb, nlh);
+		if (err)
+			netlink_ack(skb, nlh, err);
+		else if (nlh->nlmsg_flags & NLM_F_ACK)
+			netlink_ack(skb, nlh, 0);
+		skb_pull(skb, rlen);
+	}
+}
+
+static void taskstats_receive(struct sock *sk, int length)
+{
+	struct sk_buff *skb;
+
+	while ((skb = skb_dequeue(&sk->sk_receive_queue))) {
+		taskstats_receive_skb(skb);
+		kfree_skb(skb);
+	}
+}
+
+static int __init taskstats_init_sock(void)
+{
+	taskstats_sock = netlink_kernel_create(NETLINK_TASKSTATS,
+					       taskstats_receive);
+	if (!taskstats_sock)
+		printk(KERN_ERR "taskstats: cannot create netlink socket\n");
+	return 0;
+}
+
+__initcall(taskstats_init_sock);
@@ -245,6 +245,15 @@ repeat:
 		spin_unlock(&old_base->lock);
 	spin_unlock(&new_base->lock);
 	spin_unlock_irqrestore(&timer->lock, flags);
+#ifdef CONFIG_NO_HZ_FULL
+	/*
+	 * A cpu running tickless got here by a syscall, with its one-shot
+	 * programmed for the timers it had then.  Bring the tick back; it
+	 * is stopped again with the new timer in mind.
+	 */
+	if (unlikely(cpu_isset(_smp_processor_id(), nohz_busy_cpu_mask)))
+		start_hz_timer();
+#endif
 
 	return ret;
 }
@@ -271,6 +280,15 @@ void add_timer_on(struct timer_list *timer, int cpu)
 	internal_add_timer(base, timer);
 	timer->base = base;
 	spin_unlock_irqrestore(&base->lock, flags);
+#ifdef CONFIG_NO_IDLE_HZ
+	/*
+	 * The target cpu may be sleeping tickless with its one-shot
+	 * timer programmed past this expiry. Kick it so that it goes
+	 * back through the idle loop and looks at its wheel again.
+	 */
+	if (cpu_isset(cpu, nohz_cpu_mask))
+		smp_send_reschedule(cpu);
+#endif
 }
 
 
@@ -569,9 +587,15 @@ repeat:
 }
 
 #ifdef CONFIG_NO_IDLE_HZ
+/*
+ * Non-zero keeps the periodic tick running on idle CPUs
+ * (/proc/sys/kernel/hz_timer).
+ */
+int sysctl_hz_timer = 0;
+
 /*
  * Find out when the next timer event is due to happen. This
- * is used on S/390 to stop all activity when a cpus is idle.
+ * is used to stop the local tick while a cpu is idle.
  * This functions needs to be called disabled.
  */
 unsigned long next_timer_interrupt(void)
@@ -931,6 +955,7 @@ void update_process_times(int user_tick)
 	 */
 	if (rcu_pending(cpu))
 		rcu_check_callbacks(cpu, user_tick);
+	printk_tick();
 	/**
 	 * scheduler_tickʹǰ̵ʱƬ1
 	 */
@@ -0,0 +1,200 @@
+/*
+ * kernel/trace/blktrace.c
+ *
+ * The recorders behind the block_* tracepoints of include/trace/block.h.
+ * They all record a struct blk_io_trace, so that a reader of the raw
+ * buffer can follow a request through its events without knowing their
+ * types, and they only do so for queues with tracing turned on.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/string.h>
+#include <linux/bio.h>
+#include <linux/blkdev.h>
+#include <linux/genhd.h>
+#include <linux/blktrace.h>
+#include <trace/block.h>
+
+#include "trace.h"
+
+static int print_blk_io_trace(char *buf, int len, void *data)
+{
+	static const char actions[] = "?QMFGSIDCR";
+	struct blk_io_trace *t = data;
+	char rwbs[8];
+	int i = 0, ret;
+
+	if (t->rw & BLK_TC_PC)
+		rwbs[i++] = 'N';
+	else
+		rwbs[i++] = t->rw & BLK_TC_WRITE ? 'W' : 'R';
+	if (t->rw & BLK_TC_BARRIER)
+		rwbs[i++] = 'B';
+	if (t->rw & BLK_TC_AHEAD)
+		rwbs[i++] = 'A';
+	if (t->rw & BLK_TC_SYNC)
+		rwbs[i++] = 'S';
+	rwbs[i] = '\0';
+
+	ret = scnprintf(buf, len, "%u,%u %c %s %llu + %u [%s:%u]",
+			MAJOR(t->device), MINOR(t->device),
+			t->action < sizeof(actions) - 1 ?
+				actions[t->action] : '?',
+			rwbs, (unsigned long long)t->sector, t->bytes >> 9,
+			t->comm, t->pid);
+	if (t->error)
+		ret += scnprintf(buf + ret, len - ret, " error=%d", t->error);
+	return ret;
+}
+
+static void blk_add_trace(struct tracepoint *tp, int action, dev_t dev,
+			  sector_t sector, unsigned int bytes, unsigned short rw,
+			  int error)
+{
+	struct blk_io_trace *t;
+	struct ring_buffer_event *event;
+	unsigned long flags;
+
+	TRACE_RESERVE(*tp, struct blk_io_trace, t, event, flags);
+	t->magic = BLK_IO_TRACE_MAGIC | BLK_IO_TRACE_VERSION;
+	t->action = action;
+	t->rw = rw;
+	t->sector = sector;
+	t->bytes = bytes;
+	t->error = error;
+	t->device = dev;
+	t->pid = current->pid;
+	memcpy(t->comm, current->comm, sizeof(t->comm));
+	ring_buffer_unlock_commit(trace_buffer, event, flags);
+}
+
+static void blk_add_trace_bio(struct tracepoint *tp, int action,
+			      request_queue_t *q, struct bio *bio)
+{
+	unsigned short rw = 0;
+
+	if (!blk_queue_traced(q))
+		return;
+
+	if (bio_data_dir(bio) == WRITE)
+		rw |= BLK_TC_WRITE;
+	if (bio_sync(bio))
+		rw |= BLK_TC_SYNC;
+	if (bio_barrier(bio))
+		rw |= BLK_TC_BARRIER;
+	if (bio_rw_ahead(bio))
+		rw |= BLK_TC_AHEAD;
+
+	blk_add_trace(tp, action, bio->bi_bdev ? bio->bi_bdev->bd_dev : 0,
+		      bio->bi_sector, bio->bi_size, rw, 0);
+}
+
+/* @bytes < 0 means all of what is left of the request */
+static void blk_add_trace_rq(struct tracepoint *tp, int action,
+			     request_queue_t *q, struct request *rq,
+			     int bytes, int error)
+{
+	struct gendisk *disk = rq->rq_disk;
+	unsigned short rw = 0;
+
+	if (!blk_queue_traced(q))
+		return;
+
+	if (rq_data_dir(rq) == WRITE)
+		rw |= BLK_TC_WRITE;
+	if (rq->flags & REQ_HARDBARRIER)
+		rw |= BLK_TC_BARRIER;
+	if (rq->flags & REQ_FAILFAST)
+		rw |= BLK_TC_AHEAD;
+	if (!blk_fs_request(rq))
+		rw |= BLK_TC_PC;
+	if (bytes < 0)
+		bytes = blk_fs_request(rq) ? rq->hard_nr_sectors << 9 :
+					     rq->data_len;
+
+	blk_add_trace(tp, action,
+		      disk ? MKDEV(disk->major, disk->first_minor) : 0,
+		      rq->hard_sector, bytes, rw, error);
+}
+
+DEFINE_TRACE(block_bio_queue, print_blk_io_trace);
+DEFINE_TRACE(block_bio_backmerge, print_blk_io_trace);
+DEFINE_TRACE(block_bio_frontmerge, print_blk_io_trace);
+DEFINE_TRACE(block_getrq, print_blk_io_trace);
+DEFINE_TRACE(block_sleeprq, print_blk_io_trace);
+DEFINE_TRACE(block_rq_insert, print_blk_io_trace);
+DEFINE_TRACE(block_rq_issue, print_blk_io_trace);
+DEFINE_TRACE(block_rq_complete, print_blk_io_trace);
+DEFINE_TRACE(block_rq_requeue, print_blk_io_trace);
+
+void __trace_block_bio_queue(struct request_queue *q, struct bio *bio)
+{
+	blk_add_trace_bio(&__tracepoint_block_bio_queue, BLK_TA_QUEUE,
+			  q, bio);
+}
+
+void __trace_block_bio_backmerge(struct request_queue *q, struct bio *bio)
+{
+	blk_add_trace_bio(&__tracepoint_block_bio_backmerge, BLK_TA_BACKMERGE,
+			  q, bio);
+}
+
+void __trace_block_bio_frontmerge(struct request_queue *q, struct bio *bio)
+{
+	blk_add_trace_bio(&__tracepoint_block_bio_frontmerge,
+			  BLK_TA_FRONTMERGE, q, bio);
+}
+
+void __trace_block_getrq(struct request_queue *q, struct bio *bio)
+{
+	blk_add_trace_bio(&__tracepoint_block_getrq, BLK_TA_GETRQ, q, bio);
+}
+
+void __trace_block_sleeprq(struct request_queue *q, struct bio *bio)
+{
+	blk_add_trace_bio(&__tracepoint_block_sleeprq, BLK_TA_SLEEPRQ, q, bio);
+}
+
+void __trace_block_rq_insert(struct request_queue *q, struct request *rq)
+{
+	blk_add_trace_rq(&__tracepoint_block_rq_insert, BLK_TA_INSERT,
+			 q, rq, -1, 0);
+}
+
+void __trace_block_rq_issue(struct request_queue *q, struct request *rq)
+{
+	blk_add_trace_rq(&__tracepoint_block_rq_issue, BLK_TA_ISSUE,
+			 q, rq, -1, 0);
+}
+
+void __trace_block_rq_complete(struct request_queue *q, struct request *rq,
+			       int bytes, int error)
+{
+	blk_add_trace_rq(&__tracepoint_block_rq_complete, BLK_TA_COMPLETE,
+			 q, rq, bytes, error);
+}
+
+void __trace_block_rq_requeue(struct request_queue *q, struct request *rq)
+{
+	blk_add_trace_rq(&__tracepoint_block_rq_requeue, BLK_TA_REQUEUE,
+			 q, rq, -1, 0);
+}
+
+static int __init blk_trace_init(void)
+{
+	register_trace_event(&__tracepoint_block_bio_queue);
+	register_trace_event(&__tracepoint_block_bio_backmerge);
+	register_trace_event(&__tracepoint_block_bio_frontmerge);
+	register_trace_event(&__tracepoint_block_getrq);
+	register_trace_event(&__tracepoint_block_sleeprq);
+	register_trace_event(&__tracepoint_block_rq_insert);
+	register_trace_event(&__tracepoint_block_rq_issue);
+	register_trace_event(&__tracepoint_block_rq_complete);
+	register_trace_event(&__tracepoint_block_rq_requeue);
+	return 0;
+}
+
+core_initcall(blk_trace_init);
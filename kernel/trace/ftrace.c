@@ -0,0 +1,414 @@
+/*
+ * kernel/trace/ftrace.c
+ *
+ * Function tracer.  Built-in code is compiled with gcc -pg, which puts
+ * a call to mcount at the start of every function.  At boot we find
+ * these calls in the kernel text and rewrite them into nops, so that
+ * a function that is not traced only pays for a 5 byte nop.  While the
+ * tracer is on, the calls in the functions being traced are turned into
+ * calls to ftrace_caller, which records the function and its caller
+ * into the trace buffer as a "function" event.
+ *
+ * Turn the tracer on and off by enabling the "function" event in
+ * tracing/set_event.  The functions to trace are set by writing their
+ * names, '*' matching anything, to tracing/set_ftrace_filter; an empty
+ * filter traces them all.  tracing/available_filter_functions lists
+ * the functions that can be traced.
+ *
+ * The code is rewritten under stop_machine_run(), so no cpu executes
+ * it meanwhile.
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/vmalloc.h>
+#include <linux/fs.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/kallsyms.h>
+#include <linux/mutex.h>
+#include <linux/stop_machine.h>
+#include <linux/ftrace.h>
+#include <asm/sections.h>
+#include <asm/uaccess.h>
+
+#include "trace.h"
+
+struct dyn_ftrace {
+	unsigned long	ip;		/* Address of the mcount call */
+	unsigned long	flags;
+};
+
+#define FTRACE_FL_FILTER	1	/* Picked in set_ftrace_filter */
+#define FTRACE_FL_ENABLED	2	/* Calls ftrace_caller */
+#define FTRACE_FL_FAILED	4	/* Not what we expected, left alone */
+
+/* Sorted by address, as we find them in the text */
+static struct dyn_ftrace *ftrace_records;
+static unsigned long ftrace_nr_records;
+static unsigned long ftrace_nr_filtered;
+static unsigned long ftrace_nr_failed;
+static int ftrace_function_enabled;
+
+/* Protects the above */
+static DEFINE_MUTEX(ftrace_mutex);
+
+ftrace_func_t ftrace_trace_function = ftrace_stub;
+
+void fastcall ftrace_stub(unsigned long ip, unsigned long parent_ip)
+{
+}
+
+struct ftrace_entry {
+	unsigned long	ip;
+	unsigned long	parent_ip;
+};
+
+static struct tracepoint ftrace_event;
+
+static void fastcall function_trace_call(unsigned long ip,
+					 unsigned long parent_ip)
+{
+	struct ftrace_entry *entry;
+	struct ring_buffer_event *event;
+	unsigned long flags;
+
+	event = ring_buffer_lock_reserve(trace_buffer, ftrace_event.type,
+					 sizeof(*entry), &flags);
+	if (!event)
+		return;
+	entry = ring_buffer_event_data(event);
+	entry->ip = ip;
+	entry->parent_ip = parent_ip;
+	ring_buffer_unlock_commit(trace_buffer, event, flags);
+}
+
+static const char *ftrace_symbol(unsigned long addr, char *namebuf)
+{
+	unsigned long size, offset;
+	const char *name;
+	char *modname;
+
+	name = kallsyms_lookup(addr, &size, &offset, &modname, namebuf);
+	if (!name) {
+		sprintf(namebuf, "0x%lx", addr);
+		name = namebuf;
+	}
+	return name;
+}
+
+static int print_function(char *buf, int len, void *data)
+{
+	struct ftrace_entry *entry = data;
+	char name[KSYM_NAME_LEN + 1], parent[KSYM_NAME_LEN + 1];
+
+	return scnprintf(buf, len, "%s <-%s",
+			 ftrace_symbol(entry->ip, name),
+			 ftrace_symbol(entry->parent_ip, parent));
+}
+
+/* Bring the code in line with the filter and the enabled state */
+static int __ftrace_update_code(void *unused)
+{
+	unsigned long i, caller = (unsigned long)ftrace_caller;
+	struct dyn_ftrace *rec;
+	int enable;
+
+	if (ftrace_function_enabled)
+		ftrace_trace_function = function_trace_call;
+
+	for (i = 0; i < ftrace_nr_records; i++) {
+		rec = &ftrace_records[i];
+		if (rec->flags & FTRACE_FL_FAILED)
+			continue;
+
+		enable = ftrace_function_enabled &&
+			 (!ftrace_nr_filtered || (rec->flags & FTRACE_FL_FILTER));
+		if (enable == !!(rec->flags & FTRACE_FL_ENABLED))
+			continue;
+
+		if ((enable ? ftrace_make_call(rec->ip, caller) :
+			      ftrace_make_nop(rec->ip, caller))) {
+			rec->flags |= FTRACE_FL_FAILED;
+			ftrace_nr_failed++;
+			continue;
+		}
+		rec->flags ^= FTRACE_FL_ENABLED;
+	}
+
+	if (!ftrace_function_enabled)
+		ftrace_trace_function = ftrace_stub;
+	return 0;
+}
+
+static void ftrace_update_code(void)
+{
+	unsigned long failed = ftrace_nr_failed;
+
+	stop_machine_run(__ftrace_update_code, NULL, NR_CPUS);
+	if (ftrace_nr_failed != failed)
+		printk(KERN_WARNING "ftrace: %lu mcount call sites were "
+		       "modified behind our back, leaving them alone\n",
+		       ftrace_nr_failed - failed);
+}
+
+static int ftrace_event_enable(struct tracepoint *tp, int enable)
+{
+	if (!ftrace_records)
+		return -ENODEV;
+
+	mutex_lock(&ftrace_mutex);
+	ftrace_function_enabled = enable;
+	ftrace_update_code();
+	mutex_unlock(&ftrace_mutex);
+	return 0;
+}
+
+static struct tracepoint ftrace_event = {
+	.name		= "function",
+	.print		= print_function,
+	.enable		= ftrace_event_enable,
+};
+
+/* Glob match, with '*' as the only wildcard */
+static int ftrace_match(const char *name, const char *glob)
+{
+	if (*glob == '*') {
+		do {
+			if (ftrace_match(name, glob + 1))
+				return 1;
+		} while (*name++);
+		return 0;
+	}
+	if (*glob != *name)
+		return 0;
+	return *glob ? ftrace_match(name + 1, glob + 1) : 1;
+}
+
+/* Adds the functions matching @glob to the filter */
+static int ftrace_filter_add(const char *glob)
+{
+	char namebuf[KSYM_NAME_LEN + 1];
+	struct dyn_ftrace *rec;
+	unsigned long i;
+	int found = 0;
+
+	for (i = 0; i < ftrace_nr_records; i++) {
+		rec = &ftrace_records[i];
+		if (rec->flags & FTRACE_FL_FAILED)
+			continue;
+		if (!ftrace_match(ftrace_symbol(rec->ip, namebuf), glob))
+			continue;
+		found = 1;
+		if (!(rec->flags & FTRACE_FL_FILTER)) {
+			rec->flags |= FTRACE_FL_FILTER;
+			ftrace_nr_filtered++;
+		}
+	}
+	return found;
+}
+
+static void ftrace_filter_clear(void)
+{
+	unsigned long i;
+
+	for (i = 0; i < ftrace_nr_records; i++)
+		ftrace_records[i].flags &= ~FTRACE_FL_FILTER;
+	ftrace_nr_filtered = 0;
+}
+
+/* Iterates over the records that have all flags in m->private set */
+static void *ftrace_seq_find(struct seq_file *m, loff_t *pos)
+{
+	unsigned long flags = (unsigned long)m->private;
+	struct dyn_ftrace *rec;
+
+	for (; *pos < ftrace_nr_records; (*pos)++) {
+		rec = &ftrace_records[*pos];
+		if (!(rec->flags & FTRACE_FL_FAILED) &&
+		    (rec->flags & flags) == flags)
+			return rec;
+	}
+	return NULL;
+}
+
+static void *ftrace_seq_start(struct seq_file *m, loff_t *pos)
+{
+	mutex_lock(&ftrace_mutex);
+	return ftrace_seq_find(m, pos);
+}
+
+static void *ftrace_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	(*pos)++;
+	return ftrace_seq_find(m, pos);
+}
+
+static void ftrace_seq_stop(struct seq_file *m, void *v)
+{
+	mutex_unlock(&ftrace_mutex);
+}
+
+static int ftrace_seq_show(struct seq_file *m, void *v)
+{
+	struct dyn_ftrace *rec = v;
+	char namebuf[KSYM_NAME_LEN + 1];
+
+	seq_printf(m, "%s\n", ftrace_symbol(rec->ip, namebuf));
+	return 0;
+}
+
+static struct seq_operations ftrace_seq_ops = {
+	.start		= ftrace_seq_start,
+	.next		= ftrace_seq_next,
+	.stop		= ftrace_seq_stop,
+	.show		= ftrace_seq_show,
+};
+
+static int ftrace_seq_open(struct file *file, unsigned long flags)
+{
+	int ret;
+
+	ret = seq_open(file, &ftrace_seq_ops);
+	if (!ret)
+		((struct seq_file *)file->private_data)->private =
+			(void *)flags;
+	return ret;
+}
+
+static int available_functions_open(struct inode *inode, struct file *file)
+{
+	return ftrace_seq_open(file, 0);
+}
+
+static struct file_operations available_functions_fops = {
+	.open		= available_functions_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= seq_release,
+};
+
+/* Opening with O_TRUNC, as the shell's '>' does, empties the filter */
+static int ftrace_filter_open(struct inode *inode, struct file *file)
+{
+	if ((file->f_mode & FMODE_WRITE) && (file->f_flags & O_TRUNC)) {
+		mutex_lock(&ftrace_mutex);
+		ftrace_filter_clear();
+		if (ftrace_function_enabled)
+			ftrace_update_code();
+		mutex_unlock(&ftrace_mutex);
+	}
+	if (file->f_mode & FMODE_READ)
+		return ftrace_seq_open(file, FTRACE_FL_FILTER);
+	return 0;
+}
+
+static ssize_t ftrace_filter_write(struct file *file, const char __user *ubuf,
+				   size_t cnt, loff_t *ppos)
+{
+	char buf[256], *p, *glob;
+	ssize_t ret = cnt;
+
+	if (cnt >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, cnt))
+		return -EFAULT;
+	buf[cnt] = '\0';
+
+	mutex_lock(&ftrace_mutex);
+	p = buf;
+	while ((glob = strsep(&p, " \t\n")) != NULL) {
+		if (!*glob)
+			continue;
+		if (!ftrace_filter_add(glob))
+			ret = -EINVAL;
+	}
+	if (ftrace_function_enabled)
+		ftrace_update_code();
+	mutex_unlock(&ftrace_mutex);
+
+	if (ret > 0)
+		*ppos += cnt;
+	return ret;
+}
+
+static ssize_t ftrace_filter_read(struct file *file, char __user *ubuf,
+				  size_t cnt, loff_t *ppos)
+{
+	if (!(file->f_mode & FMODE_READ))
+		return -EINVAL;
+	return seq_read(file, ubuf, cnt, ppos);
+}
+
+static int ftrace_filter_release(struct inode *inode, struct file *file)
+{
+	if (file->f_mode & FMODE_READ)
+		return seq_release(inode, file);
+	return 0;
+}
+
+static struct file_operations ftrace_filter_fops = {
+	.open		= ftrace_filter_open,
+	.read		= ftrace_filter_read,
+	.write		= ftrace_filter_write,
+	.release	= ftrace_filter_release,
+};
+
+/*
+ * Called from start_kernel() while we are still alone, before any
+ * other cpu is up.  Until then the mcount calls go to a bare return.
+ */
+void __init ftrace_init(void)
+{
+	unsigned long ip, start, end, mcount_addr, n = 0;
+	unsigned long flags;
+
+	start = (unsigned long)_stext;
+	end = (unsigned long)_etext - MCOUNT_INSN_SIZE;
+	mcount_addr = (unsigned long)mcount;
+
+	for (ip = start; ip <= end; ip++)
+		if (ftrace_is_call(ip, mcount_addr)) {
+			n++;
+			ip += MCOUNT_INSN_SIZE - 1;
+		}
+	if (!n)
+		return;
+
+	ftrace_records = vmalloc(n * sizeof(struct dyn_ftrace));
+	if (!ftrace_records) {
+		printk(KERN_ERR "ftrace: no memory for %lu call sites\n", n);
+		return;
+	}
+
+	local_irq_save(flags);
+	for (ip = start; ip <= end && ftrace_nr_records < n; ip++) {
+		if (!ftrace_is_call(ip, mcount_addr))
+			continue;
+		ftrace_make_nop(ip, mcount_addr);
+		ftrace_records[ftrace_nr_records].ip = ip;
+		ftrace_records[ftrace_nr_records].flags = 0;
+		ftrace_nr_records++;
+		ip += MCOUNT_INSN_SIZE - 1;
+	}
+	local_irq_restore(flags);
+
+	printk(KERN_INFO "ftrace: %lu functions\n", ftrace_nr_records);
+}
+
+static int __init ftrace_init_debugfs(void)
+{
+	if (!ftrace_records || !tracing_dir)
+		return 0;
+
+	register_trace_event(&ftrace_event);
+	debugfs_create_file("available_filter_functions", 0444, tracing_dir,
+			    NULL, &available_functions_fops);
+	debugfs_create_file("set_ftrace_filter", 0644, tracing_dir,
+			    NULL, &ftrace_filter_fops);
+	return 0;
+}
+
+__initcall(ftrace_init_debugfs);
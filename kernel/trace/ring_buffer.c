@@ -0,0 +1,577 @@
+/*
+ * kernel/trace/ring_buffer.c
+ *
+ * Per-cpu ring buffer for tracing, see include/linux/ring_buffer.h.
+ *
+ * Only the owning cpu writes to a cpu's ring, with interrupts disabled,
+ * so writers need neither locks nor atomic operations.  An event is
+ * written behind the page's commit offset and becomes visible when
+ * commit is advanced past it.  When the writer moves on to a page that
+ * may still hold old events it first bumps the page's seq.
+ *
+ * Readers never stop the writer.  They copy the committed part of a
+ * page and check that the page's seq did not change while copying; if
+ * it did, the writer lapped them and they start again from the oldest
+ * page.  Events from a reader's copy are handed out from there.
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/percpu.h>
+#include <linux/ring_buffer.h>
+#include <asm/system.h>
+
+/* Deltas that do not fit into an event start a new page */
+#define RB_MAX_DELTA	0xffffffffULL
+
+/* Give up on a reader that keeps getting lapped */
+#define RB_READ_RETRIES	10
+
+struct ring_buffer_per_cpu {
+	unsigned long		nr_pages;
+	struct buffer_page	**pages;
+
+	/* Writer side, only touched by the owning cpu */
+	unsigned long		head;		/* Page being written */
+	int			committing;	/* Event reserved, not committed */
+	unsigned long		entries;	/* Events written */
+	unsigned long		overrun;	/* Events overwritten unread */
+	unsigned long		dropped;	/* Events not written at all */
+
+	/* Reader side */
+	unsigned long		read;		/* Page being read */
+	unsigned long		read_seq;	/* Its seq when we got there */
+	unsigned long		consumed;	/* Bytes of it already copied */
+	struct buffer_page	*reader_page;	/* Copy being handed out */
+	unsigned long		read_offset;	/* Next event in reader_page */
+};
+
+struct ring_buffer {
+	unsigned		flags;
+	unsigned long		nr_pages;	/* Per cpu */
+	atomic_t		record_disabled;
+	struct ring_buffer_per_cpu *buffers[NR_CPUS];
+};
+
+static void rb_free_cpu_buffer(struct ring_buffer_per_cpu *cpu_buffer)
+{
+	unsigned long i;
+
+	if (cpu_buffer->pages) {
+		for (i = 0; i < cpu_buffer->nr_pages; i++)
+			if (cpu_buffer->pages[i])
+				free_page((unsigned long)cpu_buffer->pages[i]);
+		kfree(cpu_buffer->pages);
+	}
+	if (cpu_buffer->reader_page)
+		free_page((unsigned long)cpu_buffer->reader_page);
+	kfree(cpu_buffer);
+}
+
+static struct ring_buffer_per_cpu *rb_alloc_cpu_buffer(unsigned long nr_pages)
+{
+	struct ring_buffer_per_cpu *cpu_buffer;
+	unsigned long i;
+
+	cpu_buffer = kmalloc(sizeof(*cpu_buffer), GFP_KERNEL);
+	if (!cpu_buffer)
+		return NULL;
+	memset(cpu_buffer, 0, sizeof(*cpu_buffer));
+	cpu_buffer->nr_pages = nr_pages;
+
+	cpu_buffer->pages = kmalloc(nr_pages * sizeof(struct buffer_page *),
+				    GFP_KERNEL);
+	if (!cpu_buffer->pages)
+		goto fail;
+	memset(cpu_buffer->pages, 0, nr_pages * sizeof(struct buffer_page *));
+
+	for (i = 0; i < nr_pages; i++) {
+		cpu_buffer->pages[i] = (void *)get_zeroed_page(GFP_KERNEL);
+		if (!cpu_buffer->pages[i])
+			goto fail;
+	}
+	cpu_buffer->reader_page = (void *)get_zeroed_page(GFP_KERNEL);
+	if (!cpu_buffer->reader_page)
+		goto fail;
+	return cpu_buffer;
+
+fail:
+	rb_free_cpu_buffer(cpu_buffer);
+	return NULL;
+}
+
+/**
+ * ring_buffer_alloc - allocate a new ring buffer
+ * @pages: number of pages for each cpu, at least 2
+ * @flags: RB_FL_OVERWRITE to overwrite old events when full
+ *
+ * Recording is on once the buffer is returned.
+ */
+struct ring_buffer *ring_buffer_alloc(unsigned long pages, unsigned flags)
+{
+	struct ring_buffer *buffer;
+	int cpu;
+
+	if (pages < 2)
+		pages = 2;
+
+	buffer = kmalloc(sizeof(*buffer), GFP_KERNEL);
+	if (!buffer)
+		return NULL;
+	memset(buffer, 0, sizeof(*buffer));
+	buffer->flags = flags;
+	buffer->nr_pages = pages;
+	atomic_set(&buffer->record_disabled, 0);
+
+	for_each_cpu(cpu) {
+		buffer->buffers[cpu] = rb_alloc_cpu_buffer(pages);
+		if (!buffer->buffers[cpu]) {
+			ring_buffer_free(buffer);
+			return NULL;
+		}
+	}
+	return buffer;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_alloc);
+
+/**
+ * ring_buffer_free - free a ring buffer
+ * @buffer: the buffer, which must no longer be written to
+ */
+void ring_buffer_free(struct ring_buffer *buffer)
+{
+	int cpu;
+
+	for (cpu = 0; cpu < NR_CPUS; cpu++)
+		if (buffer->buffers[cpu])
+			rb_free_cpu_buffer(buffer->buffers[cpu]);
+	kfree(buffer);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_free);
+
+void ring_buffer_record_off(struct ring_buffer *buffer)
+{
+	atomic_inc(&buffer->record_disabled);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_record_off);
+
+void ring_buffer_record_on(struct ring_buffer *buffer)
+{
+	atomic_dec(&buffer->record_disabled);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_record_on);
+
+int ring_buffer_record_is_on(struct ring_buffer *buffer)
+{
+	return !atomic_read(&buffer->record_disabled);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_record_is_on);
+
+/* Size of each cpu's ring, in bytes */
+unsigned long ring_buffer_size(struct ring_buffer *buffer)
+{
+	return buffer->nr_pages * PAGE_SIZE;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_size);
+
+/*
+ * Move the writer on to the next page, the one holding the oldest
+ * events.  Readers that are copying it will see seq change and drop
+ * their copy.  Returns NULL if the page has not been read yet and we
+ * may not overwrite it.
+ */
+static struct buffer_page *rb_next_page(struct ring_buffer *buffer,
+					struct ring_buffer_per_cpu *cpu_buffer)
+{
+	struct buffer_page *page;
+	unsigned long next;
+
+	next = cpu_buffer->head + 1;
+	if (next == cpu_buffer->nr_pages)
+		next = 0;
+	page = cpu_buffer->pages[next];
+
+	/*
+	 * The page is unread if the reader is on it, or if we lapped the
+	 * reader already and it has not caught up yet.
+	 */
+	if (next == cpu_buffer->read) {
+		if (!(buffer->flags & RB_FL_OVERWRITE))
+			return NULL;
+		cpu_buffer->overrun += page->entries;
+	} else if (cpu_buffer->pages[cpu_buffer->read]->seq !=
+		   cpu_buffer->read_seq)
+		cpu_buffer->overrun += page->entries;
+
+	page->seq++;
+	smp_wmb();
+	page->commit = 0;
+	page->entries = 0;
+	smp_wmb();
+	cpu_buffer->head = next;
+	return page;
+}
+
+/**
+ * ring_buffer_lock_reserve - reserve space for an event
+ * @buffer: the buffer to write to
+ * @type: the event's type, not 0
+ * @len: payload length
+ * @flags: saved interrupt state, to pass to ring_buffer_unlock_commit()
+ *
+ * Returns the event whose data is to be filled in, with interrupts
+ * disabled, or NULL if the event could not be recorded.  The event must
+ * be committed with ring_buffer_unlock_commit() before anything else is
+ * written to @buffer on this cpu; events written meanwhile, e.g. from
+ * code called by the tracer itself, are dropped.
+ */
+struct ring_buffer_event *
+ring_buffer_lock_reserve(struct ring_buffer *buffer, unsigned type,
+			 unsigned long len, unsigned long *flags)
+{
+	struct ring_buffer_per_cpu *cpu_buffer;
+	struct ring_buffer_event *event;
+	struct buffer_page *page;
+	unsigned long length;
+	u64 ts, delta = 0;
+
+	length = ALIGN(len, RB_EVENT_ALIGN);
+	if (length > RB_MAX_EVENT_LEN)
+		return NULL;
+
+	/* Raw, or the irqsoff tracer would trace its own tracing */
+	raw_local_irq_save(*flags);
+	if (atomic_read(&buffer->record_disabled))
+		goto out;
+	cpu_buffer = buffer->buffers[smp_processor_id()];
+	if (cpu_buffer->committing) {
+		cpu_buffer->dropped++;
+		goto out;
+	}
+	/* From here on an NMI cannot write under us */
+	cpu_buffer->committing = 1;
+	barrier();
+
+	ts = sched_clock();
+	page = cpu_buffer->pages[cpu_buffer->head];
+	if (page->commit) {
+		delta = ts - page->time_stamp;
+		if (delta > RB_MAX_DELTA ||
+		    page->commit + sizeof(*event) + length > BUF_PAGE_SIZE) {
+			page = rb_next_page(buffer, cpu_buffer);
+			if (!page) {
+				cpu_buffer->dropped++;
+				cpu_buffer->committing = 0;
+				goto out;
+			}
+		}
+	}
+	if (!page->commit) {
+		page->time_stamp = ts;
+		delta = 0;
+	}
+
+	event = (struct ring_buffer_event *)(page->data + page->commit);
+	event->type = type;
+	event->len = length;
+	event->time_delta = delta;
+	return event;
+
+out:
+	raw_local_irq_restore(*flags);
+	return NULL;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_lock_reserve);
+
+/**
+ * ring_buffer_unlock_commit - make a reserved event visible to readers
+ * @buffer: the buffer written to
+ * @event: the event returned by ring_buffer_lock_reserve()
+ * @flags: the interrupt state saved by ring_buffer_lock_reserve()
+ */
+void ring_buffer_unlock_commit(struct ring_buffer *buffer,
+			       struct ring_buffer_event *event,
+			       unsigned long flags)
+{
+	struct ring_buffer_per_cpu *cpu_buffer;
+	struct buffer_page *page;
+
+	cpu_buffer = buffer->buffers[smp_processor_id()];
+	page = cpu_buffer->pages[cpu_buffer->head];
+
+	/* The event's contents must be seen before the new commit */
+	smp_wmb();
+	page->commit += sizeof(*event) + event->len;
+	page->entries++;
+	cpu_buffer->entries++;
+	cpu_buffer->committing = 0;
+
+	raw_local_irq_restore(flags);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_unlock_commit);
+
+/* We were lapped: carry on from the oldest page */
+static void rb_reader_resync(struct ring_buffer_per_cpu *cpu_buffer)
+{
+	unsigned long oldest;
+
+	oldest = cpu_buffer->head + 1;
+	if (oldest == cpu_buffer->nr_pages)
+		oldest = 0;
+	cpu_buffer->read = oldest;
+	cpu_buffer->read_seq = cpu_buffer->pages[oldest]->seq;
+	smp_rmb();
+	cpu_buffer->consumed = 0;
+}
+
+/*
+ * Copy the events committed to the ring since the last copy into
+ * reader_page.  Returns the number of bytes copied, 0 if there is
+ * nothing new.
+ */
+static unsigned long rb_fill_reader(struct ring_buffer_per_cpu *cpu_buffer)
+{
+	struct buffer_page *page, *dst = cpu_buffer->reader_page;
+	unsigned long seq, commit, len;
+	int retries = RB_READ_RETRIES;
+
+	while (retries) {
+		unsigned long head = cpu_buffer->head;
+
+		smp_rmb();
+		page = cpu_buffer->pages[cpu_buffer->read];
+		seq = page->seq;
+		smp_rmb();
+		if (seq != cpu_buffer->read_seq) {
+			rb_reader_resync(cpu_buffer);
+			retries--;
+			continue;
+		}
+
+		commit = page->commit;
+		smp_rmb();
+		if (cpu_buffer->consumed < commit) {
+			len = commit - cpu_buffer->consumed;
+			memcpy(dst->data, page->data + cpu_buffer->consumed, len);
+			dst->time_stamp = page->time_stamp;
+			smp_rmb();
+			if (page->seq != seq) {
+				rb_reader_resync(cpu_buffer);
+				retries--;
+				continue;
+			}
+			dst->seq = seq;
+			dst->commit = len;
+			cpu_buffer->consumed = commit;
+			cpu_buffer->read_offset = 0;
+			return len;
+		}
+
+		if (cpu_buffer->read == head)
+			return 0;
+
+		/* Done with this page, it is not being written any more */
+		if (++cpu_buffer->read == cpu_buffer->nr_pages)
+			cpu_buffer->read = 0;
+		cpu_buffer->read_seq = cpu_buffer->pages[cpu_buffer->read]->seq;
+		cpu_buffer->consumed = 0;
+	}
+	return 0;
+}
+
+/**
+ * ring_buffer_peek - look at the next event of a cpu
+ * @buffer: the buffer to read from
+ * @cpu: the cpu whose events to read
+ * @ts: returns the event's time stamp
+ *
+ * Returns the next event without consuming it, or NULL if there is
+ * none.  The event stays valid until it is consumed.
+ */
+struct ring_buffer_event *
+ring_buffer_peek(struct ring_buffer *buffer, int cpu, u64 *ts)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+	struct buffer_page *page;
+	struct ring_buffer_event *event;
+
+	if (!cpu_buffer)
+		return NULL;
+	page = cpu_buffer->reader_page;
+	if (cpu_buffer->read_offset >= page->commit &&
+	    !rb_fill_reader(cpu_buffer))
+		return NULL;
+
+	event = (struct ring_buffer_event *)(page->data +
+					     cpu_buffer->read_offset);
+	if (ts)
+		*ts = page->time_stamp + event->time_delta;
+	return event;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_peek);
+
+/**
+ * ring_buffer_consume - consume the event returned by ring_buffer_peek()
+ * @buffer: the buffer read from
+ * @cpu: the cpu whose event it was
+ */
+void ring_buffer_consume(struct ring_buffer *buffer, int cpu)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+	struct ring_buffer_event *event;
+
+	if (!cpu_buffer ||
+	    cpu_buffer->read_offset >= cpu_buffer->reader_page->commit)
+		return;
+	event = (struct ring_buffer_event *)(cpu_buffer->reader_page->data +
+					     cpu_buffer->read_offset);
+	cpu_buffer->read_offset += sizeof(*event) + event->len;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_consume);
+
+/**
+ * ring_buffer_read_page - consume a page worth of events of a cpu
+ * @buffer: the buffer to read from
+ * @cpu: the cpu whose events to read
+ * @dst: a page to copy the events to, in the ring's own page format
+ *
+ * Returns the number of bytes of events copied, 0 if there were none.
+ * Event time deltas in @dst are relative to @dst->time_stamp.
+ */
+int ring_buffer_read_page(struct ring_buffer *buffer, int cpu,
+			  struct buffer_page *dst)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+	struct buffer_page *page;
+	unsigned long len;
+
+	if (!cpu_buffer)
+		return 0;
+	page = cpu_buffer->reader_page;
+	if (cpu_buffer->read_offset >= page->commit &&
+	    !rb_fill_reader(cpu_buffer))
+		return 0;
+
+	len = page->commit - cpu_buffer->read_offset;
+	memcpy(dst->data, page->data + cpu_buffer->read_offset, len);
+	dst->time_stamp = page->time_stamp;
+	dst->seq = page->seq;
+	dst->commit = len;
+	dst->entries = 0;
+	cpu_buffer->read_offset = page->commit;
+	return len;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_read_page);
+
+/**
+ * ring_buffer_snapshot_cpu - copy this cpu's recent events
+ * @buffer: the buffer to copy from
+ * @since: time of the oldest event wanted
+ * @pages: pages to copy the events to, in the ring's own page format
+ * @nr_pages: number of pages in @pages
+ *
+ * Copies the events written on the current cpu at or after @since,
+ * or as many of the most recent of them as fit, without consuming
+ * them.  Must be called with interrupts disabled.  Returns the number
+ * of pages filled in, 0 if we interrupted a writer on this cpu.
+ */
+int ring_buffer_snapshot_cpu(struct ring_buffer *buffer, u64 since,
+			     struct buffer_page **pages, int nr_pages)
+{
+	struct ring_buffer_per_cpu *cpu_buffer;
+	struct ring_buffer_event *event;
+	struct buffer_page *page, *dst;
+	unsigned long index, offset;
+	int nr, filled = 0;
+
+	cpu_buffer = buffer->buffers[smp_processor_id()];
+	if (cpu_buffer->committing)
+		return 0;
+	cpu_buffer->committing = 1;
+	barrier();
+
+	/* Find the page the window starts on */
+	index = cpu_buffer->head;
+	for (nr = 1; nr < nr_pages && nr < cpu_buffer->nr_pages; nr++) {
+		if (cpu_buffer->pages[index]->time_stamp <= since)
+			break;
+		index = index ? index - 1 : cpu_buffer->nr_pages - 1;
+	}
+
+	for (; nr > 0; nr--) {
+		page = cpu_buffer->pages[index];
+		if (++index == cpu_buffer->nr_pages)
+			index = 0;
+
+		/* Skip the events before the window on its first page */
+		offset = 0;
+		while (offset < page->commit) {
+			event = (struct ring_buffer_event *)(page->data + offset);
+			if (page->time_stamp + event->time_delta >= since)
+				break;
+			offset += sizeof(*event) + event->len;
+		}
+		if (offset >= page->commit)
+			continue;
+
+		dst = pages[filled++];
+		memcpy(dst->data, page->data + offset, page->commit - offset);
+		dst->time_stamp = page->time_stamp;
+		dst->seq = page->seq;
+		dst->commit = page->commit - offset;
+		dst->entries = 0;
+	}
+
+	cpu_buffer->committing = 0;
+	return filled;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_snapshot_cpu);
+
+/* Events written on @cpu since the buffer was allocated */
+unsigned long ring_buffer_entries(struct ring_buffer *buffer, int cpu)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+
+	return cpu_buffer ? cpu_buffer->entries : 0;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_entries);
+
+/* Events on @cpu that were overwritten or dropped before being read */
+unsigned long ring_buffer_overruns(struct ring_buffer *buffer, int cpu)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+
+	return cpu_buffer ? cpu_buffer->overrun + cpu_buffer->dropped : 0;
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_overruns);
+
+/* The @index'th page of @cpu's ring, for mapping it to userspace */
+struct page *ring_buffer_page(struct ring_buffer *buffer, int cpu,
+			      unsigned long index)
+{
+	struct ring_buffer_per_cpu *cpu_buffer = buffer->buffers[cpu];
+
+	if (!cpu_buffer || index >= cpu_buffer->nr_pages)
+		return NULL;
+	return virt_to_page(cpu_buffer->pages[index]);
+}
+
+EXPORT_SYMBOL_GPL(ring_buffer_page);
@@ -0,0 +1,536 @@
+/*
+ * kernel/trace/trace.c
+ *
+ * The trace buffer and its interface in debugfs, under tracing/:
+ *
+ *	tracing_on		0 or 1: whether events are recorded
+ *	buffer_size_kb		size of each cpu's buffer
+ *	available_events	events that can be enabled
+ *	set_event		enabled events; write "name" to enable an
+ *				event, "!name" to disable it
+ *	trace_pipe		consuming read of all events, as text and
+ *				merged across cpus in time order
+ *	per_cpu/cpuN/trace_pipe_raw
+ *				consuming read of cpu N's events, one
+ *				buffer_page at a time.  Can also be mmap()ed
+ *				read-only to get at the ring itself.
+ *	per_cpu/cpuN/stats	events written and lost on cpu N
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/mm.h>
+#include <linux/fs.h>
+#include <linux/debugfs.h>
+#include <linux/mutex.h>
+#include <linux/string.h>
+#include <linux/ctype.h>
+#include <asm/uaccess.h>
+#include <asm/div64.h>
+
+#include "trace.h"
+
+#define TRACE_MAX_TYPES		256
+
+struct ring_buffer *trace_buffer;
+struct dentry *tracing_dir;
+
+static unsigned long trace_buf_size = 1UL << 20;
+
+/* Registered events, and their index by ring buffer event type */
+static LIST_HEAD(trace_events);
+static struct tracepoint *trace_types[TRACE_MAX_TYPES];
+static unsigned short trace_last_type;
+static DEFINE_MUTEX(trace_types_mutex);
+
+static int tracing_on = 1;
+
+/* Serializes consuming readers, and protects trace_line */
+static DEFINE_MUTEX(trace_read_mutex);
+static char trace_line[TRACE_LINE_MAX];
+
+static int __init set_trace_buf_size(char *str)
+{
+	unsigned long size = memparse(str, &str);
+
+	if (size)
+		trace_buf_size = size;
+	return 1;
+}
+
+__setup("trace_buf_size=", set_trace_buf_size);
+
+/**
+ * register_trace_event - make an event known to the tracer
+ * @tp: the event, with name and print set
+ *
+ * Assigns the event its ring buffer event type and lists it in
+ * available_events.
+ */
+int register_trace_event(struct tracepoint *tp)
+{
+	int ret = 0;
+
+	mutex_lock(&trace_types_mutex);
+	if (trace_last_type + 1 >= TRACE_MAX_TYPES) {
+		ret = -ENOSPC;
+		goto out;
+	}
+	tp->type = ++trace_last_type;
+	trace_types[tp->type] = tp;
+	list_add_tail(&tp->list, &trace_events);
+out:
+	mutex_unlock(&trace_types_mutex);
+	return ret;
+}
+
+EXPORT_SYMBOL_GPL(register_trace_event);
+
+struct tracepoint *trace_find_event(const char *name)
+{
+	struct tracepoint *tp;
+
+	list_for_each_entry(tp, &trace_events, list)
+		if (!strcmp(tp->name, name))
+			return tp;
+	return NULL;
+}
+
+/* Called with trace_types_mutex held */
+int trace_enable_event(struct tracepoint *tp, int enable)
+{
+	int ret = 0;
+
+	if (!trace_buffer)
+		return -ENODEV;
+	if (tp->enable)
+		ret = tp->enable(tp, enable);
+	if (!ret)
+		tp->enabled = enable;
+	return ret;
+}
+
+int tracing_open_generic(struct inode *inode, struct file *filp)
+{
+	filp->private_data = inode->u.generic_ip;
+	return 0;
+}
+
+/* Copies a short, possibly newline terminated word from userspace */
+ssize_t tracing_get_word(const char __user *ubuf, size_t cnt,
+				char *buf, size_t size)
+{
+	size_t len;
+
+	if (cnt >= size)
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, cnt))
+		return -EFAULT;
+	buf[cnt] = '\0';
+
+	len = cnt;
+	while (len && isspace(buf[len - 1]))
+		buf[--len] = '\0';
+	return len;
+}
+
+static ssize_t tracing_on_read(struct file *filp, char __user *ubuf,
+			       size_t cnt, loff_t *ppos)
+{
+	char buf[4];
+	int len;
+
+	len = sprintf(buf, "%d\n", tracing_on);
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+}
+
+static ssize_t tracing_on_write(struct file *filp, const char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	char buf[16];
+	ssize_t ret;
+	int on;
+
+	ret = tracing_get_word(ubuf, cnt, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+	on = simple_strtoul(buf, NULL, 10) != 0;
+
+	mutex_lock(&trace_types_mutex);
+	if (on != tracing_on) {
+		if (on)
+			ring_buffer_record_on(trace_buffer);
+		else
+			ring_buffer_record_off(trace_buffer);
+		tracing_on = on;
+	}
+	mutex_unlock(&trace_types_mutex);
+
+	*ppos += cnt;
+	return cnt;
+}
+
+static struct file_operations tracing_on_fops = {
+	.open		= tracing_open_generic,
+	.read		= tracing_on_read,
+	.write		= tracing_on_write,
+};
+
+static ssize_t buffer_size_read(struct file *filp, char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	char buf[32];
+	int len;
+
+	len = sprintf(buf, "%lu\n", ring_buffer_size(trace_buffer) >> 10);
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+}
+
+static struct file_operations buffer_size_fops = {
+	.open		= tracing_open_generic,
+	.read		= buffer_size_read,
+};
+
+/* Lists the events, all of them or only the enabled ones */
+static ssize_t events_read(struct file *filp, char __user *ubuf,
+			   size_t cnt, loff_t *ppos, int enabled_only)
+{
+	struct tracepoint *tp;
+	char *buf;
+	int len = 0;
+	ssize_t ret;
+
+	buf = (char *)__get_free_page(GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	mutex_lock(&trace_types_mutex);
+	list_for_each_entry(tp, &trace_events, list) {
+		if (enabled_only && !tp->enabled)
+			continue;
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%s\n", tp->name);
+	}
+	mutex_unlock(&trace_types_mutex);
+
+	ret = simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+	free_page((unsigned long)buf);
+	return ret;
+}
+
+static ssize_t available_events_read(struct file *filp, char __user *ubuf,
+				     size_t cnt, loff_t *ppos)
+{
+	return events_read(filp, ubuf, cnt, ppos, 0);
+}
+
+static struct file_operations available_events_fops = {
+	.open		= tracing_open_generic,
+	.read		= available_events_read,
+};
+
+static ssize_t set_event_read(struct file *filp, char __user *ubuf,
+			      size_t cnt, loff_t *ppos)
+{
+	return events_read(filp, ubuf, cnt, ppos, 1);
+}
+
+static ssize_t set_event_write(struct file *filp, const char __user *ubuf,
+			       size_t cnt, loff_t *ppos)
+{
+	struct tracepoint *tp;
+	char buf[64], *name = buf;
+	int enable = 1;
+	ssize_t ret;
+
+	ret = tracing_get_word(ubuf, cnt, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+	if (*name == '!') {
+		enable = 0;
+		name++;
+	}
+
+	mutex_lock(&trace_types_mutex);
+	tp = trace_find_event(name);
+	if (tp)
+		ret = trace_enable_event(tp, enable);
+	else
+		ret = -EINVAL;
+	mutex_unlock(&trace_types_mutex);
+	if (ret)
+		return ret;
+
+	*ppos += cnt;
+	return cnt;
+}
+
+static struct file_operations set_event_fops = {
+	.open		= tracing_open_generic,
+	.read		= set_event_read,
+	.write		= set_event_write,
+};
+
+/**
+ * trace_print_event - format an event as a line of text
+ * @line: TRACE_LINE_MAX bytes to format into
+ * @event: the event
+ * @cpu: the cpu it was recorded on
+ * @ts: its time stamp
+ *
+ * Returns the length of the line, which ends in a newline.
+ */
+int trace_print_event(char *line, struct ring_buffer_event *event, int cpu,
+		      u64 ts)
+{
+	struct tracepoint *tp = NULL;
+	unsigned long nsec;
+	int len;
+
+	nsec = do_div(ts, NSEC_PER_SEC);
+	if (event->type < TRACE_MAX_TYPES)
+		tp = trace_types[event->type];
+
+	len = scnprintf(line, TRACE_LINE_MAX, "[%03d] %5lu.%06lu: ",
+			cpu, (unsigned long)ts, nsec / 1000);
+	if (tp) {
+		len += scnprintf(line + len, TRACE_LINE_MAX - len,
+				 "%s: ", tp->name);
+		len += tp->print(line + len, TRACE_LINE_MAX - len - 1,
+				 ring_buffer_event_data(event));
+	} else
+		len += scnprintf(line + len, TRACE_LINE_MAX - len,
+				 "unknown event %u", event->type);
+	if (len > TRACE_LINE_MAX - 2)
+		len = TRACE_LINE_MAX - 2;
+	line[len++] = '\n';
+	line[len] = '\0';
+	return len;
+}
+
+/*
+ * Consumes as many events as fit into @size bytes of text, oldest first
+ * across all cpus.  Returns the number of bytes formatted.
+ */
+static int trace_format_events(char *buf, int size)
+{
+	struct ring_buffer_event *event, *next;
+	int cpu, next_cpu, len, ret = 0;
+	u64 ts, next_ts;
+
+	for (;;) {
+		next = NULL;
+		next_cpu = 0;
+		next_ts = 0;
+		for_each_cpu(cpu) {
+			event = ring_buffer_peek(trace_buffer, cpu, &ts);
+			if (event && (!next || ts < next_ts)) {
+				next = event;
+				next_cpu = cpu;
+				next_ts = ts;
+			}
+		}
+		if (!next)
+			break;
+
+		len = trace_print_event(trace_line, next, next_cpu, next_ts);
+		if (len > size - ret) {
+			/* Do not get stuck on a line the reader cannot take */
+			if (ret)
+				break;
+			len = size;
+		}
+		memcpy(buf + ret, trace_line, len);
+		ret += len;
+		ring_buffer_consume(trace_buffer, next_cpu);
+	}
+	return ret;
+}
+
+/*
+ * Waits, with trace_read_mutex dropped, for events to show up.  There
+ * is no wakeup from the writers, which may run in any context, so we
+ * poll.
+ */
+static int trace_wait_pipe(struct file *filp)
+{
+	if (filp->f_flags & O_NONBLOCK)
+		return -EAGAIN;
+
+	mutex_unlock(&trace_read_mutex);
+	set_current_state(TASK_INTERRUPTIBLE);
+	schedule_timeout(HZ / 10);
+	mutex_lock(&trace_read_mutex);
+
+	if (signal_pending(current))
+		return -ERESTARTSYS;
+	return 0;
+}
+
+static ssize_t trace_pipe_read(struct file *filp, char __user *ubuf,
+			       size_t cnt, loff_t *ppos)
+{
+	char *buf;
+	ssize_t ret;
+	int len;
+
+	buf = (char *)__get_free_page(GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+	if (cnt > PAGE_SIZE)
+		cnt = PAGE_SIZE;
+
+	mutex_lock(&trace_read_mutex);
+	while (!(len = trace_format_events(buf, cnt))) {
+		ret = trace_wait_pipe(filp);
+		if (ret)
+			goto out;
+	}
+	ret = len;
+	if (copy_to_user(ubuf, buf, len))
+		ret = -EFAULT;
+out:
+	mutex_unlock(&trace_read_mutex);
+	free_page((unsigned long)buf);
+	return ret;
+}
+
+static struct file_operations trace_pipe_fops = {
+	.open		= tracing_open_generic,
+	.read		= trace_pipe_read,
+};
+
+static ssize_t trace_raw_read(struct file *filp, char __user *ubuf,
+			      size_t cnt, loff_t *ppos)
+{
+	int cpu = (long)filp->private_data;
+	struct buffer_page *page;
+	ssize_t ret;
+	int len;
+
+	if (cnt < PAGE_SIZE)
+		return -EINVAL;
+	page = (struct buffer_page *)__get_free_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	mutex_lock(&trace_read_mutex);
+	while (!(len = ring_buffer_read_page(trace_buffer, cpu, page))) {
+		ret = trace_wait_pipe(filp);
+		if (ret)
+			goto out;
+	}
+	memset(page->data + len, 0, BUF_PAGE_SIZE - len);
+	ret = PAGE_SIZE;
+	if (copy_to_user(ubuf, page, PAGE_SIZE))
+		ret = -EFAULT;
+out:
+	mutex_unlock(&trace_read_mutex);
+	free_page((unsigned long)page);
+	return ret;
+}
+
+static struct page *trace_raw_nopage(struct vm_area_struct *vma,
+				     unsigned long address, int *type)
+{
+	int cpu = (long)vma->vm_private_data;
+	unsigned long index;
+	struct page *page;
+
+	index = ((address - vma->vm_start) >> PAGE_SHIFT) + vma->vm_pgoff;
+	page = ring_buffer_page(trace_buffer, cpu, index);
+	if (!page)
+		return NOPAGE_SIGBUS;
+	get_page(page);
+	if (type)
+		*type = VM_FAULT_MINOR;
+	return page;
+}
+
+static struct vm_operations_struct trace_raw_vm_ops = {
+	.nopage		= trace_raw_nopage,
+};
+
+/* The ring pages, in ring order but not starting at the oldest one */
+static int trace_raw_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_flags |= VM_RESERVED;
+	vma->vm_ops = &trace_raw_vm_ops;
+	vma->vm_private_data = filp->private_data;
+	return 0;
+}
+
+static struct file_operations trace_raw_fops = {
+	.open		= tracing_open_generic,
+	.read		= trace_raw_read,
+	.mmap		= trace_raw_mmap,
+};
+
+static ssize_t trace_stats_read(struct file *filp, char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	int cpu = (long)filp->private_data;
+	char buf[64];
+	int len;
+
+	len = sprintf(buf, "entries: %lu\noverrun: %lu\n",
+		      ring_buffer_entries(trace_buffer, cpu),
+		      ring_buffer_overruns(trace_buffer, cpu));
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+}
+
+static struct file_operations trace_stats_fops = {
+	.open		= tracing_open_generic,
+	.read		= trace_stats_read,
+};
+
+static int __init tracer_init(void)
+{
+	struct dentry *per_cpu, *dir;
+	char name[16];
+	int cpu;
+
+	trace_buffer = ring_buffer_alloc(PAGE_ALIGN(trace_buf_size) >>
+					 PAGE_SHIFT, RB_FL_OVERWRITE);
+	if (!trace_buffer) {
+		printk(KERN_ERR "tracing: failed to allocate trace buffer\n");
+		return -ENOMEM;
+	}
+
+	tracing_dir = debugfs_create_dir("tracing", NULL);
+	if (!tracing_dir)
+		return -ENOMEM;
+
+	debugfs_create_file("tracing_on", 0644, tracing_dir, NULL,
+			    &tracing_on_fops);
+	debugfs_create_file("buffer_size_kb", 0444, tracing_dir, NULL,
+			    &buffer_size_fops);
+	debugfs_create_file("available_events", 0444, tracing_dir, NULL,
+			    &available_events_fops);
+	debugfs_create_file("set_event", 0644, tracing_dir, NULL,
+			    &set_event_fops);
+	debugfs_create_file("trace_pipe", 0444, tracing_dir, NULL,
+			    &trace_pipe_fops);
+
+	per_cpu = debugfs_create_dir("per_cpu", tracing_dir);
+	if (!per_cpu)
+		return 0;
+	for_each_cpu(cpu) {
+		sprintf(name, "cpu%d", cpu);
+		dir = debugfs_create_dir(name, per_cpu);
+		if (!dir)
+			continue;
+		debugfs_create_file("trace_pipe_raw", 0444, dir,
+				    (void *)(long)cpu, &trace_raw_fops);
+		debugfs_create_file("stats", 0444, dir,
+				    (void *)(long)cpu, &trace_stats_fops);
+	}
+	return 0;
+}
+
+fs_initcall(tracer_init);
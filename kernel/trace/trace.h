@@ -0,0 +1,78 @@
+#ifndef _KERNEL_TRACE_TRACE_H
+#define _KERNEL_TRACE_TRACE_H
+
+#include <linux/ring_buffer.h>
+#include <linux/tracepoint.h>
+
+struct dentry;
+struct inode;
+struct file;
+
+/* The buffer all events are recorded into, NULL until boot is done */
+extern struct ring_buffer *trace_buffer;
+
+/* The "tracing" directory in debugfs, for tracers to add files to */
+extern struct dentry *tracing_dir;
+
+extern struct tracepoint *trace_find_event(const char *name);
+extern int trace_enable_event(struct tracepoint *tp, int enable);
+
+/* Helpers for the tracers' debugfs files */
+extern int tracing_open_generic(struct inode *inode, struct file *filp);
+extern ssize_t tracing_get_word(const char __user *ubuf, size_t cnt,
+				char *buf, size_t size);
+
+#define TRACE_LINE_MAX		256
+
+/*
+ * Reserve an entry of @entry_type for the tracepoint @tp, or return
+ * from the recorder if it cannot be recorded.
+ */
+#define TRACE_RESERVE(tp, entry_type, entry, event, flags)		\
+	do {								\
+		event = ring_buffer_lock_reserve(trace_buffer, (tp).type, \
+						 sizeof(entry_type), &flags); \
+		if (!event)						\
+			return;						\
+		entry = ring_buffer_event_data(event);			\
+	} while (0)
+
+extern int trace_print_event(char *line, struct ring_buffer_event *event,
+			     int cpu, u64 ts);
+
+#ifdef CONFIG_LATENCY_TRACER
+
+struct task_struct;
+
+/* The latency tracer selected in tracing/latency_tracer */
+enum {
+	LAT_NONE,
+	LAT_IRQSOFF,
+	LAT_PREEMPTOFF,
+	LAT_WAKEUP,
+};
+
+extern int latency_tracer;
+
+/*
+ * Bumped whenever the tracer changes.  A tracer keeps it with the start
+ * of a measurement and drops the measurement if it has changed by the
+ * end, e.g. because it was switched off and on again meanwhile.
+ */
+extern unsigned long latency_gen;
+
+extern void latency_record_max(struct task_struct *tsk, u64 start,
+			       u64 latency, unsigned long start_ip,
+			       unsigned long end_ip);
+
+#ifdef CONFIG_SCHED_TRACER
+extern void trace_latency_wakeup_reset(void);
+#else
+static inline void trace_latency_wakeup_reset(void)
+{
+}
+#endif
+
+#endif /* CONFIG_LATENCY_TRACER */
+
+#endif /* _KERNEL_TRACE_TRACE_H */
@@ -0,0 +1,138 @@
+/*
+ * kernel/trace/trace_events.c
+ *
+ * The recorders behind the static tracepoints of include/trace/, but for
+ * the block ones which are in blktrace.c.  Each records a fixed size
+ * entry into the trace buffer and knows how to print it back for
+ * trace_pipe.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/string.h>
+#include <linux/skbuff.h>
+#include <linux/netdevice.h>
+#include <trace/sched.h>
+#include <trace/net.h>
+
+#include "trace.h"
+
+struct sched_switch_entry {
+	pid_t		prev_pid;
+	pid_t		next_pid;
+	int		prev_prio;
+	int		next_prio;
+	long		prev_state;
+	char		prev_comm[TASK_COMM_LEN];
+	char		next_comm[TASK_COMM_LEN];
+};
+
+static int print_sched_switch(char *buf, int len, void *data)
+{
+	struct sched_switch_entry *entry = data;
+
+	return scnprintf(buf, len, "%s:%d [%d] %ld ==> %s:%d [%d]",
+			 entry->prev_comm, entry->prev_pid, entry->prev_prio,
+			 entry->prev_state, entry->next_comm, entry->next_pid,
+			 entry->next_prio);
+}
+
+DEFINE_TRACE(sched_switch, print_sched_switch);
+
+void __trace_sched_switch(struct task_struct *prev, struct task_struct *next)
+{
+	struct sched_switch_entry *entry;
+	struct ring_buffer_event *event;
+	unsigned long flags;
+
+	TRACE_RESERVE(__tracepoint_sched_switch, struct sched_switch_entry,
+		      entry, event, flags);
+	entry->prev_pid = prev->pid;
+	entry->next_pid = next->pid;
+	entry->prev_prio = prev->prio;
+	entry->next_prio = next->prio;
+	entry->prev_state = prev->state;
+	memcpy(entry->prev_comm, prev->comm, TASK_COMM_LEN);
+	memcpy(entry->next_comm, next->comm, TASK_COMM_LEN);
+	ring_buffer_unlock_commit(trace_buffer, event, flags);
+}
+
+struct sched_wakeup_entry {
+	pid_t		pid;
+	int		prio;
+	int		cpu;
+	int		success;
+	char		comm[TASK_COMM_LEN];
+};
+
+static int print_sched_wakeup(char *buf, int len, void *data)
+{
+	struct sched_wakeup_entry *entry = data;
+
+	return scnprintf(buf, len, "%s:%d [%d] cpu=%d success=%d",
+			 entry->comm, entry->pid, entry->prio, entry->cpu,
+			 entry->success);
+}
+
+DEFINE_TRACE(sched_wakeup, print_sched_wakeup);
+
+void __trace_sched_wakeup(struct task_struct *p, int success)
+{
+	struct sched_wakeup_entry *entry;
+	struct ring_buffer_event *event;
+	unsigned long flags;
+
+	TRACE_RESERVE(__tracepoint_sched_wakeup, struct sched_wakeup_entry,
+		      entry, event, flags);
+	entry->pid = p->pid;
+	entry->prio = p->prio;
+	entry->cpu = task_cpu(p);
+	entry->success = success;
+	memcpy(entry->comm, p->comm, TASK_COMM_LEN);
+	ring_buffer_unlock_commit(trace_buffer, event, flags);
+}
+
+struct net_receive_skb_entry {
+	char		dev[IFNAMSIZ];
+	unsigned int	len;
+	unsigned short	protocol;
+};
+
+static int print_net_receive_skb(char *buf, int len, void *data)
+{
+	struct net_receive_skb_entry *entry = data;
+
+	return scnprintf(buf, len, "dev=%s len=%u protocol=0x%04x",
+			 entry->dev, entry->len, entry->protocol);
+}
+
+DEFINE_TRACE(net_receive_skb, print_net_receive_skb);
+
+void __trace_net_receive_skb(struct sk_buff *skb)
+{
+	struct net_receive_skb_entry *entry;
+	struct ring_buffer_event *event;
+	unsigned long flags;
+
+	TRACE_RESERVE(__tracepoint_net_receive_skb,
+		      struct net_receive_skb_entry, entry, event, flags);
+	if (skb->dev)
+		memcpy(entry->dev, skb->dev->name, IFNAMSIZ);
+	else
+		entry->dev[0] = '\0';
+	entry->len = skb->len;
+	entry->protocol = ntohs(skb->protocol);
+	ring_buffer_unlock_commit(trace_buffer, event, flags);
+}
+
+static int __init trace_events_init(void)
+{
+	register_trace_event(&__tracepoint_sched_switch);
+	register_trace_event(&__tracepoint_sched_wakeup);
+	register_trace_event(&__tracepoint_net_receive_skb);
+	return 0;
+}
+
+core_initcall(trace_events_init);
@@ -0,0 +1,112 @@
+/*
+ * kernel/trace/trace_irqsoff.c
+ *
+ * The irqsoff and preemptoff latency tracers: measure for how long a
+ * cpu runs with interrupts, or preemption, disabled.
+ *
+ * local_irq_disable() and friends call trace_hardirqs_off() when they
+ * turn interrupts off and trace_hardirqs_on() when they turn them back
+ * on, and so do interrupt entry and exit.  Code that toggles interrupts
+ * in assembly only is not seen.  The preempt count calls
+ * trace_preempt_off() and trace_preempt_on() when it leaves and
+ * reaches 0.
+ *
+ * All of this runs with nothing else to protect it, from the very
+ * primitives that other code uses for protection: only raw interrupt
+ * operations and raw spinlocks may be used here.
+ */
+
+#include <linux/config.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/percpu.h>
+#include <linux/preempt.h>
+
+#include "trace.h"
+
+struct critical_timing {
+	int		tracing;	/* A measurement is running */
+	unsigned long	gen;		/* latency_gen when it began */
+	u64		start;
+	unsigned long	start_ip;
+};
+
+static DEFINE_PER_CPU(struct critical_timing, critical_timing);
+
+static inline void start_critical_timing(unsigned long ip)
+{
+	struct critical_timing *ct;
+
+	ct = &per_cpu(critical_timing, _smp_processor_id());
+	ct->gen = latency_gen;
+	ct->start = sched_clock();
+	ct->start_ip = ip;
+	ct->tracing = 1;
+}
+
+static inline void stop_critical_timing(unsigned long ip)
+{
+	struct critical_timing *ct;
+	u64 now;
+
+	ct = &per_cpu(critical_timing, _smp_processor_id());
+	if (!ct->tracing)
+		return;
+	ct->tracing = 0;
+	if (ct->gen != latency_gen)
+		return;
+
+	now = sched_clock();
+	if (now > ct->start)
+		latency_record_max(current, ct->start, now - ct->start,
+				   ct->start_ip, ip);
+}
+
+#ifdef CONFIG_IRQSOFF_TRACER
+/* Interrupts have just been disabled */
+void trace_hardirqs_off(void)
+{
+	if (likely(latency_tracer != LAT_IRQSOFF))
+		return;
+	start_critical_timing((unsigned long)__builtin_return_address(0));
+}
+
+EXPORT_SYMBOL(trace_hardirqs_off);
+
+/* Interrupts are about to be enabled */
+void trace_hardirqs_on(void)
+{
+	if (likely(latency_tracer != LAT_IRQSOFF))
+		return;
+	stop_critical_timing((unsigned long)__builtin_return_address(0));
+}
+
+EXPORT_SYMBOL(trace_hardirqs_on);
+#endif
+
+#ifdef CONFIG_PREEMPT_TRACER
+/* The preempt count has just left 0, at @ip */
+void trace_preempt_off(unsigned long ip)
+{
+	unsigned long flags;
+
+	if (likely(latency_tracer != LAT_PREEMPTOFF))
+		return;
+	raw_local_irq_save(flags);
+	start_critical_timing(ip);
+	raw_local_irq_restore(flags);
+}
+
+/* The preempt count is about to get back to 0, at @ip */
+void trace_preempt_on(unsigned long ip)
+{
+	unsigned long flags;
+
+	if (likely(latency_tracer != LAT_PREEMPTOFF))
+		return;
+	raw_local_irq_save(flags);
+	stop_critical_timing(ip);
+	raw_local_irq_restore(flags);
+}
+#endif
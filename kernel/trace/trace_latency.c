@@ -0,0 +1,446 @@
+/*
+ * kernel/trace/trace_latency.c
+ *
+ * Common part of the latency tracers, in debugfs under tracing/:
+ *
+ *	latency_tracer		the tracer measuring: none, irqsoff,
+ *				preemptoff or wakeup
+ *	tracing_max_latency	longest latency seen, in microseconds.
+ *				Write 0 to start over, or a threshold
+ *				below which latencies are not recorded.
+ *	latency_trace		the longest latency, and the events that
+ *				its cpu recorded while it lasted
+ *
+ * A tracer measures the latencies it is after on its own and hands each
+ * of them to latency_record_max(), which keeps the longest.  The events
+ * are copied out of the trace buffer right away, before they can be
+ * overwritten.  Enable e.g. the "function" event to get a trace of
+ * what the kernel was doing meanwhile.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/sched.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/fs.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/kallsyms.h>
+#include <linux/mutex.h>
+#include <linux/string.h>
+#include <linux/rcupdate.h>
+#include <asm/uaccess.h>
+#include <asm/div64.h>
+
+#include "trace.h"
+
+/* Pages of events kept with the longest latency */
+#define LAT_SNAPSHOT_PAGES	64
+
+static const char *latency_tracer_names[] = {
+	[LAT_NONE]	= "none",
+#ifdef CONFIG_IRQSOFF_TRACER
+	[LAT_IRQSOFF]	= "irqsoff",
+#endif
+#ifdef CONFIG_PREEMPT_TRACER
+	[LAT_PREEMPTOFF] = "preemptoff",
+#endif
+#ifdef CONFIG_SCHED_TRACER
+	[LAT_WAKEUP]	= "wakeup",
+#endif
+};
+
+#define LAT_NR_TRACERS	ARRAY_SIZE(latency_tracer_names)
+
+int latency_tracer = LAT_NONE;
+unsigned long latency_gen;
+
+/* Serializes switching tracers and resetting the maximum */
+static DEFINE_MUTEX(latency_mutex);
+
+struct latency_snapshot {
+	int			tracer;
+	u64			latency;	/* ns */
+	int			cpu;
+	pid_t			pid;
+	char			comm[TASK_COMM_LEN];
+	unsigned long		start_ip;
+	unsigned long		end_ip;
+	int			nr_pages;
+	struct buffer_page	*pages[LAT_SNAPSHOT_PAGES];
+};
+
+/*
+ * The longest latency, in ns, and its snapshot.  max_lock is a raw
+ * spinlock taken with interrupts disabled: we are called from the
+ * places that enable interrupts and preemption, and must not end up in
+ * them again.  The snapshot is left alone while somebody reads it.
+ */
+static u64 latency_max;
+static struct latency_snapshot latency_snapshot;
+static int snapshot_readers;
+static spinlock_t max_lock = SPIN_LOCK_UNLOCKED;
+
+/**
+ * latency_record_max - record a latency if it is the longest yet
+ * @tsk: the task that suffered it
+ * @start: time it began at
+ * @latency: its length, in ns
+ * @start_ip: where it began, or 0
+ * @end_ip: where it ended, or 0
+ *
+ * Must be called on the cpu where the latency ended.
+ */
+void latency_record_max(struct task_struct *tsk, u64 start, u64 latency,
+			unsigned long start_ip, unsigned long end_ip)
+{
+	struct latency_snapshot *snap = &latency_snapshot;
+	unsigned long flags;
+
+	if (latency <= latency_max)
+		return;
+
+	raw_local_irq_save(flags);
+	_raw_spin_lock(&max_lock);
+	if (latency <= latency_max || snapshot_readers || !snap->pages[0])
+		goto out;
+
+	latency_max = latency;
+	snap->tracer = latency_tracer;
+	snap->latency = latency;
+	snap->cpu = _smp_processor_id();
+	snap->pid = tsk->pid;
+	memcpy(snap->comm, tsk->comm, sizeof(snap->comm));
+	snap->start_ip = start_ip;
+	snap->end_ip = end_ip;
+	snap->nr_pages = ring_buffer_snapshot_cpu(trace_buffer, start,
+						  snap->pages,
+						  LAT_SNAPSHOT_PAGES);
+out:
+	_raw_spin_unlock(&max_lock);
+	raw_local_irq_restore(flags);
+}
+
+static void latency_reset_max(u64 threshold)
+{
+	unsigned long flags;
+
+	raw_local_irq_save(flags);
+	_raw_spin_lock(&max_lock);
+	latency_max = threshold;
+	latency_snapshot.tracer = LAT_NONE;
+	latency_snapshot.nr_pages = 0;
+	_raw_spin_unlock(&max_lock);
+	raw_local_irq_restore(flags);
+}
+
+static int latency_alloc_snapshot(void)
+{
+	struct latency_snapshot *snap = &latency_snapshot;
+	int i;
+
+	for (i = 0; i < LAT_SNAPSHOT_PAGES; i++) {
+		if (snap->pages[i])
+			continue;
+		snap->pages[i] = (void *)__get_free_page(GFP_KERNEL);
+		if (!snap->pages[i])
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+static ssize_t latency_tracer_read(struct file *filp, char __user *ubuf,
+				   size_t cnt, loff_t *ppos)
+{
+	char buf[128];
+	int i, len = 0;
+
+	for (i = 0; i < LAT_NR_TRACERS; i++) {
+		if (!latency_tracer_names[i])
+			continue;
+		len += sprintf(buf + len, i == latency_tracer ? "[%s] " : "%s ",
+			       latency_tracer_names[i]);
+	}
+	buf[len - 1] = '\n';
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+}
+
+static ssize_t latency_tracer_write(struct file *filp,
+				    const char __user *ubuf, size_t cnt,
+				    loff_t *ppos)
+{
+	char buf[32];
+	ssize_t ret;
+	int i;
+
+	ret = tracing_get_word(ubuf, cnt, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+	for (i = 0; i < LAT_NR_TRACERS; i++)
+		if (latency_tracer_names[i] &&
+		    !strcmp(buf, latency_tracer_names[i]))
+			break;
+	if (i == LAT_NR_TRACERS)
+		return -EINVAL;
+
+	mutex_lock(&latency_mutex);
+	if (i != LAT_NONE) {
+		ret = latency_alloc_snapshot();
+		if (ret)
+			goto out;
+	}
+
+	/*
+	 * Let the hooks still running for the old tracer finish before
+	 * the measurements they began are invalidated.
+	 */
+	latency_tracer = LAT_NONE;
+	synchronize_kernel();
+	trace_latency_wakeup_reset();
+	latency_gen++;
+	latency_reset_max(0);
+	smp_wmb();
+	latency_tracer = i;
+
+	*ppos += cnt;
+	ret = cnt;
+out:
+	mutex_unlock(&latency_mutex);
+	return ret;
+}
+
+static struct file_operations latency_tracer_fops = {
+	.open		= tracing_open_generic,
+	.read		= latency_tracer_read,
+	.write		= latency_tracer_write,
+};
+
+static ssize_t max_latency_read(struct file *filp, char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	u64 max = latency_max;
+	char buf[32];
+	int len;
+
+	do_div(max, 1000);
+	len = sprintf(buf, "%llu\n", (unsigned long long)max);
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, len);
+}
+
+static ssize_t max_latency_write(struct file *filp, const char __user *ubuf,
+				 size_t cnt, loff_t *ppos)
+{
+	char buf[32];
+	ssize_t ret;
+
+	ret = tracing_get_word(ubuf, cnt, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&latency_mutex);
+	latency_reset_max((u64)simple_strtoul(buf, NULL, 10) * 1000);
+	mutex_unlock(&latency_mutex);
+
+	*ppos += cnt;
+	return cnt;
+}
+
+static struct file_operations max_latency_fops = {
+	.open		= tracing_open_generic,
+	.read		= max_latency_read,
+	.write		= max_latency_write,
+};
+
+/* Position in the snapshot of a latency_trace reader */
+struct latency_iter {
+	loff_t		pos;
+	int		page;
+	unsigned long	offset;
+	char		line[TRACE_LINE_MAX];
+};
+
+static struct ring_buffer_event *latency_iter_event(struct latency_iter *iter)
+{
+	struct latency_snapshot *snap = &latency_snapshot;
+
+	while (iter->page < snap->nr_pages) {
+		if (iter->offset < snap->pages[iter->page]->commit)
+			return (struct ring_buffer_event *)
+				(snap->pages[iter->page]->data + iter->offset);
+		iter->page++;
+		iter->offset = 0;
+	}
+	return NULL;
+}
+
+static void *latency_iter_next(struct latency_iter *iter)
+{
+	struct ring_buffer_event *event = latency_iter_event(iter);
+
+	if (event) {
+		iter->offset += sizeof(*event) + event->len;
+		event = latency_iter_event(iter);
+	}
+	iter->pos++;
+	return event;
+}
+
+/* Position 0 is the header, the events follow */
+static void *latency_seq_start(struct seq_file *m, loff_t *pos)
+{
+	struct latency_iter *iter = m->private;
+
+	if (*pos == 0)
+		return SEQ_START_TOKEN;
+	if (*pos < iter->pos || iter->pos == 0) {
+		iter->pos = 1;
+		iter->page = 0;
+		iter->offset = 0;
+	}
+	while (iter->pos < *pos)
+		if (!latency_iter_next(iter))
+			return NULL;
+	return latency_iter_event(iter);
+}
+
+static void *latency_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	struct latency_iter *iter = m->private;
+	void *next;
+
+	if (v == SEQ_START_TOKEN) {
+		iter->pos = 1;
+		iter->page = 0;
+		iter->offset = 0;
+		next = latency_iter_event(iter);
+	} else
+		next = latency_iter_next(iter);
+	*pos = iter->pos;
+	return next;
+}
+
+static void latency_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static void latency_print_ip(struct seq_file *m, const char *what,
+			     unsigned long ip)
+{
+	char namebuf[KSYM_NAME_LEN + 1];
+	unsigned long size, offset;
+	const char *name;
+	char *modname;
+
+	if (!ip)
+		return;
+	name = kallsyms_lookup(ip, &size, &offset, &modname, namebuf);
+	if (name)
+		seq_printf(m, "# %5s: %s+0x%lx/0x%lx\n", what, name, offset,
+			   size);
+	else
+		seq_printf(m, "# %5s: 0x%lx\n", what, ip);
+}
+
+static int latency_seq_show(struct seq_file *m, void *v)
+{
+	struct latency_snapshot *snap = &latency_snapshot;
+	struct latency_iter *iter = m->private;
+	struct buffer_page *page;
+	u64 latency;
+
+	if (v == SEQ_START_TOKEN) {
+		if (snap->tracer == LAT_NONE) {
+			seq_printf(m, "# no latency recorded\n");
+			return 0;
+		}
+		latency = snap->latency;
+		do_div(latency, 1000);
+		seq_printf(m, "# tracer: %s\n",
+			   latency_tracer_names[snap->tracer]);
+		seq_printf(m, "# latency: %llu us, cpu %d, pid %d (%s)\n",
+			   (unsigned long long)latency, snap->cpu, snap->pid,
+			   snap->comm);
+		latency_print_ip(m, "start", snap->start_ip);
+		latency_print_ip(m, "end", snap->end_ip);
+		return 0;
+	}
+
+	page = snap->pages[iter->page];
+	trace_print_event(iter->line, v, snap->cpu, page->time_stamp +
+			  ((struct ring_buffer_event *)v)->time_delta);
+	seq_puts(m, iter->line);
+	return 0;
+}
+
+static struct seq_operations latency_seq_ops = {
+	.start		= latency_seq_start,
+	.next		= latency_seq_next,
+	.stop		= latency_seq_stop,
+	.show		= latency_seq_show,
+};
+
+static int latency_trace_open(struct inode *inode, struct file *filp)
+{
+	struct latency_iter *iter;
+	unsigned long flags;
+	int ret;
+
+	iter = kmalloc(sizeof(*iter), GFP_KERNEL);
+	if (!iter)
+		return -ENOMEM;
+	memset(iter, 0, sizeof(*iter));
+
+	ret = seq_open(filp, &latency_seq_ops);
+	if (ret) {
+		kfree(iter);
+		return ret;
+	}
+	((struct seq_file *)filp->private_data)->private = iter;
+
+	raw_local_irq_save(flags);
+	_raw_spin_lock(&max_lock);
+	snapshot_readers++;
+	_raw_spin_unlock(&max_lock);
+	raw_local_irq_restore(flags);
+	return 0;
+}
+
+static int latency_trace_release(struct inode *inode, struct file *filp)
+{
+	struct seq_file *m = filp->private_data;
+	unsigned long flags;
+
+	raw_local_irq_save(flags);
+	_raw_spin_lock(&max_lock);
+	snapshot_readers--;
+	_raw_spin_unlock(&max_lock);
+	raw_local_irq_restore(flags);
+
+	kfree(m->private);
+	return seq_release(inode, filp);
+}
+
+static struct file_operations latency_trace_fops = {
+	.open		= latency_trace_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= latency_trace_release,
+};
+
+static __init int latency_tracer_init(void)
+{
+	if (!tracing_dir)
+		return -ENODEV;
+
+	debugfs_create_file("latency_tracer", 0644, tracing_dir, NULL,
+			    &latency_tracer_fops);
+	debugfs_create_file("tracing_max_latency", 0644, tracing_dir, NULL,
+			    &max_latency_fops);
+	debugfs_create_file("latency_trace", 0444, tracing_dir, NULL,
+			    &latency_trace_fops);
+	return 0;
+}
+
+__initcall(latency_tracer_init);
@@ -0,0 +1,97 @@
+/*
+ * kernel/trace/trace_sched_wakeup.c
+ *
+ * The wakeup latency tracer: measures the time from the wakeup of the
+ * highest priority task woken so far until it gets to run.  Once it has
+ * run, the next wakeup starts a new measurement.
+ *
+ * Called from the scheduler with the runqueue lock held and interrupts
+ * disabled.  The tracked task is pinned with a reference, so a freed and
+ * reused task_struct can not be mistaken for it.
+ *
+ * sched_clock() is not synchronized between CPUs here, so the latency is
+ * only measured when the task gets to run on the CPU that took the wakeup
+ * timestamp; a task that runs elsewhere just ends the measurement.
+ */
+
+#include <linux/config.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/spinlock.h>
+#include <linux/ftrace.h>
+
+#include "trace.h"
+
+static struct task_struct *wakeup_task;
+static int wakeup_prio = MAX_PRIO;
+static int wakeup_cpu;
+static unsigned long wakeup_gen;
+static u64 wakeup_start;
+static spinlock_t wakeup_lock = SPIN_LOCK_UNLOCKED;
+
+/* Stop tracking wakeup_task, wakeup_lock held */
+static void wakeup_reset(void)
+{
+	if (wakeup_task) {
+		put_task_struct(wakeup_task);
+		wakeup_task = NULL;
+	}
+}
+
+void trace_latency_wakeup(struct task_struct *p)
+{
+	if (likely(latency_tracer != LAT_WAKEUP))
+		return;
+
+	_raw_spin_lock(&wakeup_lock);
+	if (wakeup_gen != latency_gen) {
+		wakeup_reset();
+		wakeup_gen = latency_gen;
+	}
+	if (!wakeup_task || p->prio < wakeup_prio) {
+		wakeup_reset();
+		get_task_struct(p);
+		wakeup_task = p;
+		wakeup_prio = p->prio;
+		wakeup_cpu = smp_processor_id();
+		wakeup_start = sched_clock();
+	}
+	_raw_spin_unlock(&wakeup_lock);
+}
+
+/* Drop the task still tracked when the tracer is changed */
+void trace_latency_wakeup_reset(void)
+{
+	unsigned long flags;
+
+	local_irq_save(flags);
+	_raw_spin_lock(&wakeup_lock);
+	wakeup_reset();
+	_raw_spin_unlock(&wakeup_lock);
+	local_irq_restore(flags);
+}
+
+void trace_latency_switch(struct task_struct *prev, struct task_struct *next)
+{
+	u64 start, now;
+	int cpu;
+
+	if (likely(latency_tracer != LAT_WAKEUP) || next != wakeup_task)
+		return;
+
+	_raw_spin_lock(&wakeup_lock);
+	if (next != wakeup_task || wakeup_gen != latency_gen) {
+		_raw_spin_unlock(&wakeup_lock);
+		return;
+	}
+	start = wakeup_start;
+	cpu = wakeup_cpu;
+	wakeup_reset();
+	_raw_spin_unlock(&wakeup_lock);
+
+	if (cpu != smp_processor_id())
+		return;
+	now = sched_clock();
+	if (now > start)
+		latency_record_max(next, start, now - start, 0, 0);
+}
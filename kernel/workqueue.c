@@ -25,6 +25,7 @@
 #include <linux/cpu.h>
 #include <linux/notifier.h>
 #include <linux/kthread.h>
+#include <linux/hash.h>
 
 /*
  * The per-CPU workqueue (if single thread, we always use cpu 0's).
@@ -79,8 +80,81 @@ struct cpu_workqueue_struct {
 	 * ǰִȣеĺʱֶεֵ1
 	 */
 	int run_depth;		/* Detect run_workqueue() recursion depth */
+
+	/*
+	 * The rest is for multi-threaded workqueues, whose works are run
+	 * by the shared worker pool of the cpu. Guarded by pool->lock.
+	 */
+	struct worker_pool *pool;
+	int nr_active;		/* Works on the pool's list or running */
+	int max_active;
+	struct list_head delayed_works;	/* Works over max_active */
+	int work_color;		/* Color of newly queued works */
+	int nr_in_flight[2];	/* Queued or running works, per color */
 } ____cacheline_aligned;
 
+/*
+ * Works of the multi-threaded workqueues are not run by threads of their
+ * own, but by a pool of workers per cpu that all of them share. The pool
+ * keeps one worker running at a time: when it goes to sleep inside a
+ * work function, the scheduler tells us (wq_worker_sleeping()) and an
+ * idle worker takes over the rest of the list. Before a worker starts on
+ * work, it makes sure there is an idle one left to do that, creating one
+ * if needed. Idle workers beyond MAX_IDLE_WORKERS go away after
+ * IDLE_WORKER_TIMEOUT.
+ *
+ * Single threaded workqueues keep their own thread: they promise to run
+ * their works in order, and kthread_create() relies on one.
+ */
+#define BUSY_WORKER_HASH_ORDER	4
+#define BUSY_WORKER_HASH_SIZE	(1 << BUSY_WORKER_HASH_ORDER)
+#define MAX_IDLE_WORKERS	2
+#define IDLE_WORKER_TIMEOUT	(300 * HZ)
+
+/* Bit in work->pending: the work was queued with color 1 */
+#define WORK_STRUCT_COLOR	1
+
+/* worker->flags */
+#define WORKER_IDLE		0x1	/* On the idle list, not in nr_running */
+
+/* pool->flags */
+#define POOL_MANAGING		0x1	/* A worker is creating another one */
+#define POOL_DYING		0x2	/* Cpu is gone: drain the list and exit */
+
+struct worker_pool {
+	spinlock_t lock;
+	struct list_head worklist;	/* Works ready to run, of all queues */
+	int cpu;
+	unsigned int flags;
+	int nr_workers;
+	int nr_idle;
+	int next_id;			/* For naming workers */
+	struct list_head idle_list;
+	/* Workers running a work, hashed by the work */
+	struct hlist_head busy_hash[BUSY_WORKER_HASH_SIZE];
+	/*
+	 * Workers neither idle nor asleep. The scheduler hooks change it
+	 * under the runqueue lock instead of ours, hence atomic.
+	 */
+	atomic_t nr_running;
+	wait_queue_head_t workers_gone;	/* Pool teardown waits here */
+	struct worker *first;		/* Created at CPU_UP_PREPARE */
+} ____cacheline_aligned_in_smp;
+
+struct worker {
+	struct list_head entry;		/* On the idle list */
+	struct hlist_node hentry;	/* In the busy hash */
+	struct work_struct *current_work;
+	struct cpu_workqueue_struct *current_cwq;
+	int current_color;
+	struct list_head scheduled;	/* Works to run after current_work */
+	task_t *task;
+	struct worker_pool *pool;
+	unsigned int flags;
+};
+
+static DEFINE_PER_CPU(struct worker_pool, worker_pools);
+
 /*
  * The externally visible workqueue abstraction is an array of
  * per-CPU workqueues:
@@ -106,12 +180,69 @@ static inline int is_single_threaded(struct workqueue_struct *wq)
 	return list_empty(&wq->list);
 }
 
+static inline struct worker *first_idle_worker(struct worker_pool *pool)
+{
+	if (list_empty(&pool->idle_list))
+		return NULL;
+	return list_entry(pool->idle_list.next, struct worker, entry);
+}
+
+/* Is there work nobody is running on? */
+static inline int need_more_worker(struct worker_pool *pool)
+{
+	return !list_empty(&pool->worklist) &&
+		(!atomic_read(&pool->nr_running) ||
+		 (pool->flags & POOL_DYING));
+}
+
+/* Should a worker that just finished a work go on to the next one? */
+static inline int keep_working(struct worker_pool *pool)
+{
+	return !list_empty(&pool->worklist) &&
+		(atomic_read(&pool->nr_running) <= 1 ||
+		 (pool->flags & POOL_DYING));
+}
+
+/* Caller must hold pool->lock. */
+static void pool_queue_work(struct cpu_workqueue_struct *cwq,
+			    struct work_struct *work)
+{
+	struct worker_pool *pool = cwq->pool;
+	struct worker *worker;
+
+	work->wq_data = cwq;
+	if (cwq->work_color)
+		set_bit(WORK_STRUCT_COLOR, &work->pending);
+	cwq->nr_in_flight[cwq->work_color]++;
+	if (cwq->nr_active >= cwq->max_active) {
+		list_add_tail(&work->entry, &cwq->delayed_works);
+		return;
+	}
+	cwq->nr_active++;
+	list_add_tail(&work->entry, &pool->worklist);
+
+	/* Pairs with the atomic_dec_and_test() in wq_worker_sleeping() */
+	smp_mb();
+	if (need_more_worker(pool)) {
+		worker = first_idle_worker(pool);
+		if (worker)
+			wake_up_process(worker->task);
+	}
+}
+
 /* Preempt must be disabled. */
 static void __queue_work(struct cpu_workqueue_struct *cwq,
 			 struct work_struct *work)
 {
 	unsigned long flags;
 
+	if (cwq->pool) {
+		spin_lock_irqsave(&cwq->pool->lock, flags);
+		pool_queue_work(cwq, work);
+		spin_unlock_irqrestore(&cwq->pool->lock, flags);
+		return;
+	}
+
 	spin_lock_irqsave(&cwq->lock, flags);
 	work->wq_data = cwq;
 	list_add_tail(&work->entry, &cwq->worklist);
@@ -226,10 +357,8 @@ static inline void run_workqueue(struct cpu_workqueue_struct *cwq)
 	spin_unlock_irqrestore(&cwq->lock, flags);
 }
 
-static int worker_thread(void *__cwq)
+static void worker_thread_init(void)
 {
-	struct cpu_workqueue_struct *cwq = __cwq;
-	DECLARE_WAITQUEUE(wait, current);
 	struct k_sigaction sa;
 	sigset_t blocked;
 
@@ -247,6 +376,14 @@ static int worker_thread(void *__cwq)
 	sa.sa.sa_flags = 0;
 	siginitset(&sa.sa.sa_mask, sigmask(SIGCHLD));
 	do_sigaction(SIGCHLD, &sa, (struct k_sigaction *)0);
+}
+
+static int worker_thread(void *__cwq)
+{
+	struct cpu_workqueue_struct *cwq = __cwq;
+	DECLARE_WAITQUEUE(wait, current);
+
+	worker_thread_init();
 
 	set_current_state(TASK_INTERRUPTIBLE);
 	while (!kthread_should_stop()) {
@@ -265,9 +402,315 @@ static int worker_thread(void *__cwq)
 	return 0;
 }
 
+static inline struct hlist_head *busy_worker_head(struct worker_pool *pool,
+						  struct work_struct *work)
+{
+	return &pool->busy_hash[hash_ptr(work, BUSY_WORKER_HASH_ORDER)];
+}
+
+static struct worker *find_worker_executing_work(struct worker_pool *pool,
+						 struct work_struct *work)
+{
+	struct worker *worker;
+	struct hlist_node *tmp;
+
+	hlist_for_each_entry(worker, tmp, busy_worker_head(pool, work), hentry)
+		if (worker->current_work == work)
+			return worker;
+	return NULL;
+}
+
+/* A work of cwq is done: let the next delayed one in. */
+static void cwq_work_done(struct cpu_workqueue_struct *cwq, int color)
+{
+	struct worker_pool *pool = cwq->pool;
+
+	cwq->nr_active--;
+	if (!list_empty(&cwq->delayed_works)) {
+		list_move_tail(cwq->delayed_works.next, &pool->worklist);
+		cwq->nr_active++;
+	}
+	if (!--cwq->nr_in_flight[color])
+		wake_up(&cwq->work_done);
+}
+
+/*
+ * Run one work off the pool's list or our scheduled list. Called and
+ * returns with pool->lock held, drops it while the work runs.
+ */
+static void process_one_work(struct worker *worker, struct work_struct *work)
+{
+	struct worker_pool *pool = worker->pool;
+	struct cpu_workqueue_struct *cwq = work->wq_data;
+	void (*f) (void *) = work->func;
+	void *data = work->data;
+	struct worker *collision;
+	int color;
+
+	/*
+	 * A work must not run twice at once. If it is still running from
+	 * an earlier queueing, leave it to that worker to run it again.
+	 */
+	collision = find_worker_executing_work(pool, work);
+	if (unlikely(collision)) {
+		list_move_tail(&work->entry, &collision->scheduled);
+		return;
+	}
+
+	list_del_init(&work->entry);
+	color = test_and_clear_bit(WORK_STRUCT_COLOR, &work->pending);
+	hlist_add_head(&worker->hentry, busy_worker_head(pool, work));
+	worker->current_work = work;
+	worker->current_cwq = cwq;
+	worker->current_color = color;
+	spin_unlock_irq(&pool->lock);
+
+	clear_bit(0, &work->pending);
+	f(data);
+
+	spin_lock_irq(&pool->lock);
+	hlist_del_init(&worker->hentry);
+	worker->current_work = NULL;
+	worker->current_cwq = NULL;
+	cwq_work_done(cwq, color);
+}
+
+/* Caller must hold pool->lock. */
+static void worker_enter_idle(struct worker *worker)
+{
+	struct worker_pool *pool = worker->pool;
+
+	worker->flags |= WORKER_IDLE;
+	/* LIFO, so the surplus workers are the ones that time out */
+	list_add(&worker->entry, &pool->idle_list);
+	pool->nr_idle++;
+	atomic_dec(&pool->nr_running);
+}
+
+/* Caller must hold pool->lock. */
+static void worker_leave_idle(struct worker *worker)
+{
+	struct worker_pool *pool = worker->pool;
+
+	worker->flags &= ~WORKER_IDLE;
+	list_del_init(&worker->entry);
+	pool->nr_idle--;
+	atomic_inc(&pool->nr_running);
+}
+
+static int pool_worker_thread(void *__worker);
+
+static struct worker *create_worker(struct worker_pool *pool)
+{
+	struct worker *worker;
+
+	worker = kmalloc(sizeof(*worker), GFP_KERNEL);
+	if (!worker)
+		return NULL;
+	memset(worker, 0, sizeof(*worker));
+	INIT_LIST_HEAD(&worker->entry);
+	INIT_HLIST_NODE(&worker->hentry);
+	INIT_LIST_HEAD(&worker->scheduled);
+	worker->pool = pool;
+	worker->flags = WORKER_IDLE;
+
+	worker->task = kthread_create(pool_worker_thread, worker, "kworker/%d:%d",
+				      pool->cpu, pool->next_id++);
+	if (IS_ERR(worker->task)) {
+		kfree(worker);
+		return NULL;
+	}
+	return worker;
+}
+
+/*
+ * Put a new, bound worker on the idle list and let it run.
+ * Caller must hold pool->lock.
+ */
+static void start_worker(struct worker *worker)
+{
+	struct worker_pool *pool = worker->pool;
+
+	list_add(&worker->entry, &pool->idle_list);
+	pool->nr_idle++;
+	pool->nr_workers++;
+	wake_up_process(worker->task);
+}
+
+/*
+ * Keep an idle worker in reserve, to take over should the caller go to
+ * sleep in a work function. If creating one fails we go on without, and
+ * the next worker to start on work tries again.
+ * Called and returns with pool->lock held, may drop it.
+ */
+static void maybe_create_worker(struct worker_pool *pool)
+{
+	struct worker *worker;
+
+	if (pool->nr_idle || (pool->flags & (POOL_MANAGING | POOL_DYING)))
+		return;
+	pool->flags |= POOL_MANAGING;
+	spin_unlock_irq(&pool->lock);
+
+	worker = create_worker(pool);
+	if (worker)
+		kthread_bind(worker->task, pool->cpu);
+
+	spin_lock_irq(&pool->lock);
+	if (worker)
+		start_worker(worker);
+	pool->flags &= ~POOL_MANAGING;
+}
+
+/*
+ * Sleep on the idle list. Returns 1 if the worker should exit because
+ * it timed out with too many idle workers around.
+ * Called and returns with pool->lock held.
+ */
+static int worker_sleep(struct worker *worker)
+{
+	struct worker_pool *pool = worker->pool;
+	long timeout = MAX_SCHEDULE_TIMEOUT;
+
+	if (pool->nr_idle > MAX_IDLE_WORKERS)
+		timeout = IDLE_WORKER_TIMEOUT;
+	set_current_state(TASK_INTERRUPTIBLE);
+	spin_unlock_irq(&pool->lock);
+	timeout = schedule_timeout(timeout);
+	spin_lock_irq(&pool->lock);
+
+	return !timeout && pool->nr_idle > MAX_IDLE_WORKERS &&
+		!need_more_worker(pool);
+}
+
+static int pool_worker_thread(void *__worker)
+{
+	struct worker *worker = __worker;
+	struct worker_pool *pool = worker->pool;
+	struct work_struct *work;
+
+	worker_thread_init();
+	current->wq_worker = worker;
+	current->flags |= PF_WQ_WORKER;
+
+	spin_lock_irq(&pool->lock);
+	for (;;) {
+		if (!need_more_worker(pool)) {
+			/* A dying pool exits once its list is drained */
+			if ((pool->flags & POOL_DYING) || worker_sleep(worker))
+				break;
+			continue;
+		}
+
+		worker_leave_idle(worker);
+		maybe_create_worker(pool);
+		while (keep_working(pool)) {
+			work = list_entry(pool->worklist.next,
+					  struct work_struct, entry);
+			process_one_work(worker, work);
+			while (!list_empty(&worker->scheduled)) {
+				work = list_entry(worker->scheduled.next,
+						  struct work_struct, entry);
+				process_one_work(worker, work);
+			}
+		}
+		worker_enter_idle(worker);
+	}
+
+	list_del_init(&worker->entry);
+	pool->nr_idle--;
+	if (!--pool->nr_workers)
+		wake_up(&pool->workers_gone);
+	current->flags &= ~PF_WQ_WORKER;
+	spin_unlock_irq(&pool->lock);
+
+	kfree(worker);
+	return 0;
+}
+
+/*
+ * Scheduler hooks, called with the runqueue lock of cpu held. They must
+ * not take pool->lock, which is held around wake_up_process(). They can
+ * still look at the idle list: only workers of the pool change it, on
+ * the pool's cpu, with interrupts off.
+ */
+
+/*
+ * A worker that is not idle goes to sleep on cpu. If it was the last
+ * one running and there is work left, return an idle worker to wake.
+ */
+task_t *wq_worker_sleeping(task_t *task, int cpu)
+{
+	struct worker *worker = task->wq_worker;
+	struct worker_pool *pool = worker->pool;
+	struct worker *to_wakeup = NULL;
+
+	if ((worker->flags & WORKER_IDLE) || cpu != pool->cpu ||
+	    (pool->flags & POOL_DYING))
+		return NULL;
+	if (atomic_dec_and_test(&pool->nr_running) &&
+	    !list_empty(&pool->worklist))
+		to_wakeup = first_idle_worker(pool);
+	return to_wakeup ? to_wakeup->task : NULL;
+}
+
+/* A worker that is not idle woke up on cpu. */
+void wq_worker_waking_up(task_t *task, int cpu)
+{
+	struct worker *worker = task->wq_worker;
+	struct worker_pool *pool = worker->pool;
+
+	if (!(worker->flags & WORKER_IDLE) && cpu == pool->cpu &&
+	    !(pool->flags & POOL_DYING))
+		atomic_inc(&pool->nr_running);
+}
+
+/*
+ * Wait for the works queued on a pool cwq before we were called. Works
+ * carry the color of the flush generation they were queued in: wait for
+ * the older color to drain (an earlier flush), flip the color so new
+ * works cannot livelock us, then wait for our color to drain.
+ * A work flushing its own workqueue does not wait for itself.
+ */
+static void flush_pool_cwq(struct cpu_workqueue_struct *cwq)
+{
+	struct worker_pool *pool = cwq->pool;
+	int self = -1, color;
+	DEFINE_WAIT(wait);
+
+	if ((current->flags & PF_WQ_WORKER) &&
+	    current->wq_worker->current_cwq == cwq)
+		self = current->wq_worker->current_color;
+
+	spin_lock_irq(&pool->lock);
+	for (;;) {
+		color = cwq->work_color;
+		if (cwq->nr_in_flight[!color] == (self == !color))
+			break;
+		prepare_to_wait(&cwq->work_done, &wait, TASK_UNINTERRUPTIBLE);
+		spin_unlock_irq(&pool->lock);
+		schedule();
+		spin_lock_irq(&pool->lock);
+	}
+	if (cwq->nr_in_flight[color] != (self == color)) {
+		cwq->work_color = !color;
+		while (cwq->nr_in_flight[color] != (self == color)) {
+			prepare_to_wait(&cwq->work_done, &wait,
+					TASK_UNINTERRUPTIBLE);
+			spin_unlock_irq(&pool->lock);
+			schedule();
+			spin_lock_irq(&pool->lock);
+		}
+	}
+	finish_wait(&cwq->work_done, &wait);
+	spin_unlock_irq(&pool->lock);
+}
+
 static void flush_cpu_workqueue(struct cpu_workqueue_struct *cwq)
 {
-	if (cwq->thread == current) {
+	if (cwq->pool) {
+		flush_pool_cwq(cwq);
+	} else if (cwq->thread == current) {
 		/*
 		 * Probably keventd trying to flush its own queue. So simply run
 		 * it by hand rather than deadlocking.
@@ -301,7 +744,9 @@ static void flush_cpu_workqueue(struct cpu_workqueue_struct *cwq)
  * This function will sample each workqueue's current insert_sequence number and
  * will sleep until the head sequence is greater than or equal to that.  This
  * means that we sleep until all works which were queued on entry have been
- * handled, but we are not livelocked by new incoming ones.
+ * handled, but we are not livelocked by new incoming ones.  The works of
+ * multi-threaded workqueues may complete out of order, so there we count
+ * them by color instead (see flush_pool_cwq()).
  *
  * This function used to run the workqueues itself.  Now we just wait for the
  * helper threads to do it.
@@ -348,8 +793,25 @@ static struct task_struct *create_workqueue_thread(struct workqueue_struct *wq,
 	return p;
 }
 
+/* Hook a multi-threaded workqueue's cwq up to the cpu's worker pool. */
+static void init_pool_cwq(struct workqueue_struct *wq, int cpu, int max_active)
+{
+	struct cpu_workqueue_struct *cwq = wq->cpu_wq + cpu;
+
+	cwq->wq = wq;
+	cwq->pool = &per_cpu(worker_pools, cpu);
+	cwq->max_active = max_active;
+	INIT_LIST_HEAD(&cwq->delayed_works);
+	init_waitqueue_head(&cwq->work_done);
+}
+
+/*
+ * max_active bounds how many works of the workqueue may be queued to or
+ * run by one cpu's pool at a time; further ones wait their turn.  It is
+ * ignored for single threaded workqueues, which run one at a time.
+ */
 struct workqueue_struct *__create_workqueue(const char *name,
-					    int singlethread)
+					    int singlethread, int max_active)
 {
 	int cpu, destroy = 0;
 	struct workqueue_struct *wq;
@@ -357,6 +819,11 @@ struct workqueue_struct *__create_workqueue(const char *name,
 
 	BUG_ON(strlen(name) > 10);
 
+	if (max_active < 1)
+		max_active = 1;
+	if (max_active > WQ_MAX_ACTIVE)
+		max_active = WQ_MAX_ACTIVE;
+
 	wq = kmalloc(sizeof(*wq), GFP_KERNEL);
 	if (!wq)
 		return NULL;
@@ -376,14 +843,9 @@ struct workqueue_struct *__create_workqueue(const char *name,
 		spin_lock(&workqueue_lock);
 		list_add(&wq->list, &workqueues);
 		spin_unlock(&workqueue_lock);
-		for_each_online_cpu(cpu) {
-			p = create_workqueue_thread(wq, cpu);
-			if (p) {
-				kthread_bind(p, cpu);
-				wake_up_process(p);
-			} else
-				destroy = 1;
-		}
+		/* No threads of our own: the pools come and go with the cpus */
+		for_each_cpu(cpu)
+			init_pool_cwq(wq, cpu, max_active);
 	}
 	unlock_cpu_hotplug();
 
@@ -417,8 +879,6 @@ static void cleanup_workqueue_thread(struct workqueue_struct *wq, int cpu)
  */
 void destroy_workqueue(struct workqueue_struct *wq)
 {
-	int cpu;
-
 	flush_workqueue(wq);
 
 	/* We don't need the distraction of CPUs appearing and vanishing. */
@@ -426,8 +886,6 @@ void destroy_workqueue(struct workqueue_struct *wq)
 	if (is_single_threaded(wq))
 		cleanup_workqueue_thread(wq, 0);
 	else {
-		for_each_online_cpu(cpu)
-			cleanup_workqueue_thread(wq, cpu);
 		spin_lock(&workqueue_lock);
 		list_del(&wq->list);
 		spin_unlock(&workqueue_lock);
@@ -478,40 +936,73 @@ int keventd_up(void)
 	return keventd_wq != NULL;
 }
 
+/* Is current a pool worker running a keventd work? */
 int current_is_keventd(void)
 {
 	struct cpu_workqueue_struct *cwq;
-	int cpu = smp_processor_id();	/* preempt-safe: keventd is per-cpu */
-	int ret = 0;
 
 	BUG_ON(!keventd_wq);
 
-	cwq = keventd_wq->cpu_wq + cpu;
-	if (current == cwq->thread)
-		ret = 1;
+	if (!(current->flags & PF_WQ_WORKER))
+		return 0;
+	cwq = current->wq_worker->current_cwq;
+	return cwq && cwq->wq == keventd_wq;
+}
 
-	return ret;
+/* Create the first worker of a cpu's pool; it runs once the cpu is up. */
+static int pool_prepare(int cpu)
+{
+	struct worker_pool *pool = &per_cpu(worker_pools, cpu);
+
+	pool->flags = 0;
+	atomic_set(&pool->nr_running, 0);
+	pool->first = create_worker(pool);
+	return pool->first ? 0 : -ENOMEM;
+}
 
+static void pool_online(int cpu)
+{
+	struct worker_pool *pool = &per_cpu(worker_pools, cpu);
+
+	kthread_bind(pool->first->task, cpu);
+	spin_lock_irq(&pool->lock);
+	start_worker(pool->first);
+	spin_unlock_irq(&pool->lock);
+	pool->first = NULL;
+}
+
+static void __init pool_init(int cpu)
+{
+	struct worker_pool *pool = &per_cpu(worker_pools, cpu);
+	int i;
+
+	spin_lock_init(&pool->lock);
+	INIT_LIST_HEAD(&pool->worklist);
+	INIT_LIST_HEAD(&pool->idle_list);
+	for (i = 0; i < BUSY_WORKER_HASH_SIZE; i++)
+		INIT_HLIST_HEAD(&pool->busy_hash[i]);
+	init_waitqueue_head(&pool->workers_gone);
+	pool->cpu = cpu;
 }
 
 #ifdef CONFIG_HOTPLUG_CPU
-/* Take the work from this (downed) CPU. */
-static void take_over_work(struct workqueue_struct *wq, unsigned int cpu)
+/*
+ * The cpu is gone and its workers have been moved to other cpus. Let
+ * them run what is left on the pool, then exit, so that everything
+ * queued there is done by the time hotplug (which flushes wait on) is.
+ */
+static void pool_drain(int cpu)
 {
-	struct cpu_workqueue_struct *cwq = wq->cpu_wq + cpu;
-	LIST_HEAD(list);
-	struct work_struct *work;
+	struct worker_pool *pool = &per_cpu(worker_pools, cpu);
+	struct worker *worker;
 
-	spin_lock_irq(&cwq->lock);
-	list_splice_init(&cwq->worklist, &list);
+	spin_lock_irq(&pool->lock);
+	pool->flags |= POOL_DYING;
+	list_for_each_entry(worker, &pool->idle_list, entry)
+		wake_up_process(worker->task);
+	spin_unlock_irq(&pool->lock);
 
-	while (!list_empty(&list)) {
-		printk("Taking work for %s\n", wq->name);
-		work = list_entry(list.next,struct work_struct,entry);
-		list_del(&work->entry);
-		__queue_work(wq->cpu_wq + smp_processor_id(), work);
-	}
-	spin_unlock_irq(&cwq->lock);
+	wait_event(pool->workers_gone, !pool->nr_workers);
 }
 
 /* We're holding the cpucontrol mutex here */
@@ -520,41 +1011,32 @@ static int __devinit workqueue_cpu_callback(struct notifier_block *nfb,
 				  void *hcpu)
 {
 	unsigned int hotcpu = (unsigned long)hcpu;
-	struct workqueue_struct *wq;
+	struct worker_pool *pool = &per_cpu(worker_pools, hotcpu);
 
 	switch (action) {
 	case CPU_UP_PREPARE:
-		/* Create a new workqueue thread for it. */
-		list_for_each_entry(wq, &workqueues, list) {
-			if (create_workqueue_thread(wq, hotcpu) < 0) {
-				printk("workqueue for %i failed\n", hotcpu);
-				return NOTIFY_BAD;
-			}
+		/* Create a new worker for it. */
+		if (pool_prepare(hotcpu) < 0) {
+			printk("workqueue for %i failed\n", hotcpu);
+			return NOTIFY_BAD;
 		}
 		break;
 
 	case CPU_ONLINE:
-		/* Kick off worker threads. */
-		list_for_each_entry(wq, &workqueues, list) {
-			kthread_bind(wq->cpu_wq[hotcpu].thread, hotcpu);
-			wake_up_process(wq->cpu_wq[hotcpu].thread);
-		}
+		/* Kick off the worker. */
+		pool_online(hotcpu);
 		break;
 
 	case CPU_UP_CANCELED:
-		list_for_each_entry(wq, &workqueues, list) {
-			/* Unbind so it can run. */
-			kthread_bind(wq->cpu_wq[hotcpu].thread,
-				     smp_processor_id());
-			cleanup_workqueue_thread(wq, hotcpu);
+		if (pool->first) {
+			kthread_stop(pool->first->task);
+			kfree(pool->first);
+			pool->first = NULL;
 		}
 		break;
 
 	case CPU_DEAD:
-		list_for_each_entry(wq, &workqueues, list)
-			cleanup_workqueue_thread(wq, hotcpu);
-		list_for_each_entry(wq, &workqueues, list)
-			take_over_work(wq, hotcpu);
+		pool_drain(hotcpu);
 		break;
 	}
 
@@ -562,8 +1044,16 @@ static int __devinit workqueue_cpu_callback(struct notifier_block *nfb,
 }
 #endif
 
-void init_workqueues(void)
+void __init init_workqueues(void)
 {
+	int cpu;
+
+	for_each_cpu(cpu)
+		pool_init(cpu);
+	for_each_online_cpu(cpu) {
+		BUG_ON(pool_prepare(cpu));
+		pool_online(cpu);
+	}
 	hotcpu_notifier(workqueue_cpu_callback, 0);
 	keventd_wq = create_workqueue("events");
 	BUG_ON(!keventd_wq);
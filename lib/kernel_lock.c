@@ -15,7 +15,7 @@
 /*
  * Debugging check.
  */
-unsigned int smp_processor_id(void)
+unsigned int notrace smp_processor_id(void)
 {
 	unsigned long preempt_count = preempt_count();
 	int this_cpu = __smp_processor_id();
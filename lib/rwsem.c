@@ -7,6 +7,7 @@
 #include <linux/sched.h>
 #include <linux/init.h>
 #include <linux/module.h>
+#include <linux/lockstat.h>
 
 struct rwsem_waiter {
 	struct list_head list;
@@ -145,6 +146,7 @@ rwsem_down_failed_common(struct rw_semaphore *sem,
 			struct rwsem_waiter *waiter, signed long adjustment)
 {
 	struct task_struct *tsk = current;
+	unsigned long long start = lock_stat_clock();
 	signed long count;
 
 	set_task_state(tsk, TASK_UNINTERRUPTIBLE);
@@ -175,6 +177,8 @@ rwsem_down_failed_common(struct rw_semaphore *sem,
 
 	tsk->state = TASK_RUNNING;
 
+	lock_stat_waited(sem, waiter->flags & RWSEM_WAITING_FOR_WRITE ?
+			 LOCK_STAT_RWSEM_WRITE : LOCK_STAT_RWSEM_READ, start);
 	return sem;
 }
 
@@ -49,6 +49,7 @@
 #include <linux/acct.h>
 #include <linux/module.h>
 #include <linux/init.h>
+#include <linux/delayacct.h>
 
 #include <asm/pgalloc.h>
 #include <asm/uaccess.h>
@@ -1802,6 +1803,7 @@ static int do_swap_page(struct mm_struct * mm,
 	/**
 	 * ҳǷڸٻ
 	 */
+	delayacct_set_flag(DELAYACCT_PF_SWAPIN);
 	page = lookup_swap_cache(entry);
 	if (!page) {/* ҳڸٻ */
 		/**
@@ -1835,6 +1837,7 @@ static int do_swap_page(struct mm_struct * mm,
 				ret = VM_FAULT_MINOR;
 			pte_unmap(page_table);
 			spin_unlock(&mm->page_table_lock);
+			delayacct_clear_flag(DELAYACCT_PF_SWAPIN);
 			goto out;
 		}
 
@@ -1857,6 +1860,7 @@ static int do_swap_page(struct mm_struct * mm,
 	 * סҳ
 	 */
 	lock_page(page);
+	delayacct_clear_flag(DELAYACCT_PF_SWAPIN);
 
 	/*
 	 * Back out if somebody else faulted in this pte while we
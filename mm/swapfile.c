@@ -1163,7 +1163,7 @@ add_swap_extent(struct swap_info_struct *sis, unsigned long start_page,
  * requirements, they are simply tossed out - we will never use those blocks
  * for swapping.
  *
- * For S_ISREG swapfiles we hold i_sem across the life of the swapon.  This
+ * For S_ISREG swapfiles we hold i_mutex across the life of the swapon.  This
  * prevents root from shooting her foot off by ftruncating an in-use swapfile,
  * which will scribble on the fs.
  *
@@ -1447,9 +1447,9 @@ asmlinkage long sys_swapoff(const char __user * specialfile)
 		/**
 		 * ͨļУļڵS_SWAPFILE־0.
 		 */
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		inode->i_flags &= ~S_SWAPFILE;
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 	}
 	/**
 	 * رļ:swap_filevictim
@@ -1715,7 +1715,7 @@ asmlinkage long sys_swapon(const char __user * specialfile, int swap_flags)
 		 * һͨļ
 		 */
 		p->bdev = inode->i_sb->s_bdev;
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		did_down = 1;
 		/**
 		 * ļڵi_flagsֶеS_SWAPFILEֶΡñ־λ˵ļѾʧܡ
@@ -1928,7 +1928,7 @@ out:
 	if (did_down) {
 		if (!error)
 			inode->i_flags |= S_SWAPFILE;
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 	}
 	return error;
 }
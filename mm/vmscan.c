@@ -32,6 +32,7 @@
 #include <linux/cpu.h>
 #include <linux/notifier.h>
 #include <linux/rwsem.h>
+#include <linux/psi.h>
 
 #include <asm/tlbflush.h>
 #include <asm/div64.h>
@@ -1179,7 +1180,7 @@ int try_to_free_pages(struct zone **zones,
 	struct reclaim_state *reclaim_state = current->reclaim_state;
 	struct scan_control sc;
 	unsigned long lru_pages = 0;
-	int i;
+	int i, memstall;
 
 	/**
 	 * ʼscan_controlṹgfp_mask롣
@@ -1188,6 +1189,7 @@ int try_to_free_pages(struct zone **zones,
 	sc.may_writepage = 0;
 
 	inc_page_state(allocstall);
+	memstall = psi_memstall_enter();
 
 	/**
 	 * ÿtemp_priorityΪʼȼйLRUеҳ
@@ -1264,6 +1266,7 @@ out:
 	 */
 	for (i = 0; zones[i] != 0; i++)
 		zones[i]->prev_priority = zones[i]->temp_priority;
+	psi_memstall_leave(memstall);
 	return ret;
 }
 
@@ -109,6 +109,7 @@
 #include <linux/netpoll.h>
 #include <linux/rcupdate.h>
 #include <linux/delay.h>
+#include <trace/net.h>
 #ifdef CONFIG_NET_RADIO
 #include <linux/wireless.h>		/* Note : will define WIRELESS_EXT */
 #include <net/iw_handler.h>
@@ -1916,6 +1917,8 @@ int netif_receive_skb(struct sk_buff *skb)
 	}
 #endif
 
+	trace_net_receive_skb(skb);
+
 	/**
 	 * ĴƺǶģҲΪݣȥӦû⡣
 	 */
@@ -1326,11 +1326,11 @@ static int post_create(struct inode *dir,
 			       -rc, inode->i_sb->s_id, inode->i_ino);
 			return rc;
 		}
-		down(&inode->i_sem);
+		mutex_lock(&inode->i_mutex);
 		rc = inode->i_op->setxattr(dentry,
 					   XATTR_NAME_SELINUX,
 					   context, len, 0);
-		up(&inode->i_sem);
+		mutex_unlock(&inode->i_mutex);
 		kfree(context);
 		if (rc < 0) {
 			printk(KERN_WARNING "post_create:  setxattr failed, "
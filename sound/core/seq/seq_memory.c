@@ -33,7 +33,7 @@
 #include "seq_lock.h"
 
 /* semaphore in struct file record */
-#define semaphore_of(fp)	((fp)->f_dentry->d_inode->i_sem)
+#define semaphore_of(fp)	((fp)->f_dentry->d_inode->i_mutex)
 
 
 inline static int snd_seq_pool_available(pool_t *pool)